@@ -64,7 +64,7 @@ if(ANDROID_BUILD)
 endif()
 
 #set(AllTargets ${AllStaticLibs} local_drive drive sqlite cryptopp gmock gtest)
-set(AllTargets ${AllStaticLibs} sqlite cryptopp gmock gtest)
+set(AllTargets ${AllStaticLibs} sqlite sqlite_sharded_store sqlite_blob_stream sqlite_path_index sqlite_value_compression cryptopp gmock gtest)
 if(NOT CMAKE_VERSION VERSION_LESS "3.0")
   list(APPEND AllTargets asio cereal)
 endif()
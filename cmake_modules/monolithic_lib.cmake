@@ -36,7 +36,11 @@ set(DevLibDepends maidsafe_common
                   #maidsafe_launcher
                   ${AllBoostLibs}
                   cryptopp
-                  sqlite)
+                  sqlite
+                  sqlite_sharded_store
+                  sqlite_blob_stream
+                  sqlite_path_index
+                  sqlite_value_compression)
 list(REMOVE_ITEM DevLibDepends BoostContext BoostPython BoostGraphParallel BoostMath BoostMpi BoostRegex BoostSerialization BoostTest)
 
 set(SourceFile "${MaidsafeGeneratedSourcesDir}/monolithic.cc")
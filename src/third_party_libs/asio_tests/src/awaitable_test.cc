@@ -0,0 +1,140 @@
+/*  Copyright 2026 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "asio/awaitable.hpp"
+
+#if defined(ASIO_HAS_CO_AWAIT)
+
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+#include "asio/co_spawn.hpp"
+#include "asio/detached.hpp"
+#include "asio/io_service.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/use_awaitable.hpp"
+
+namespace maidsafe {
+
+namespace test {
+
+namespace {
+
+asio::awaitable<int> Increment(int i) { co_return i + 1; }
+
+asio::awaitable<void> Fail() {
+  throw std::runtime_error("child failed");
+  co_return;
+}
+
+asio::awaitable<int> Nested(int depth) {
+  if (depth == 0)
+    co_return 0;
+  co_return 1 + co_await Nested(depth - 1);
+}
+
+// Each co_await of Increment completes without suspending on an operation,
+// so control only moves between frames. The stack must not grow with the
+// number of iterations, however the frames are compiled.
+asio::awaitable<long long> SumSynchronously(int count) {
+  long long sum(0);
+  for (int i(0); i != count; ++i)
+    sum += co_await Increment(i);
+  co_return sum;
+}
+
+asio::awaitable<int> WaitThenIncrement(asio::io_service& io_service, int i) {
+  asio::steady_timer timer(io_service);
+  timer.expires_from_now(std::chrono::milliseconds(1));
+  co_await timer.async_wait(asio::use_awaitable);
+  co_return i + 1;
+}
+
+}  // unnamed namespace
+
+TEST(AwaitableTest, BEH_LongRunOfSynchronousChildren) {
+  const int kCount(1000000);
+  asio::io_service io_service;
+  long long result(-1);
+  asio::co_spawn(io_service, SumSynchronously(kCount),
+                 [&](std::exception_ptr ex, long long sum) {
+                   EXPECT_FALSE(ex);
+                   result = sum;
+                 });
+  io_service.run();
+  EXPECT_EQ(static_cast<long long>(kCount) * (kCount + 1) / 2, result);
+}
+
+TEST(AwaitableTest, BEH_DeeplyNestedChildren) {
+  asio::io_service io_service;
+  int result(-1);
+  asio::co_spawn(io_service, Nested(100000), [&](std::exception_ptr ex, int depth) {
+    EXPECT_FALSE(ex);
+    result = depth;
+  });
+  io_service.run();
+  EXPECT_EQ(100000, result);
+}
+
+TEST(AwaitableTest, BEH_ChildrenWaitingOnOperations) {
+  asio::io_service io_service;
+  int result(-1);
+  asio::co_spawn(io_service,
+                 [&]() -> asio::awaitable<int> {
+                   int value(0);
+                   for (int i(0); i != 20; ++i)
+                     value = co_await WaitThenIncrement(io_service, value);
+                   co_return value;
+                 },
+                 [&](std::exception_ptr ex, int value) {
+                   EXPECT_FALSE(ex);
+                   result = value;
+                 });
+  io_service.run();
+  EXPECT_EQ(20, result);
+}
+
+TEST(AwaitableTest, BEH_ExceptionPropagatesToCaller) {
+  asio::io_service io_service;
+  int caught(0);
+  std::exception_ptr spawn_ex;
+  asio::co_spawn(io_service,
+                 [&]() -> asio::awaitable<void> {
+                   for (int i(0); i != 1000; ++i) {
+                     try {
+                       co_await Fail();
+                     } catch (const std::runtime_error&) {
+                       ++caught;
+                     }
+                   }
+                   co_await Fail();
+                 },
+                 [&](std::exception_ptr ex) { spawn_ex = ex; });
+  io_service.run();
+  EXPECT_EQ(1000, caught);
+  EXPECT_TRUE(static_cast<bool>(spawn_ex));
+}
+
+}  // namespace test
+
+}  // namespace maidsafe
+
+#endif  // defined(ASIO_HAS_CO_AWAIT)
@@ -0,0 +1,326 @@
+/*  Copyright 2026 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "asio/rudp.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO)
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "asio/io_service.hpp"
+#include "asio/read.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/write.hpp"
+
+namespace maidsafe {
+
+namespace test {
+
+namespace {
+
+typedef asio::rudp::basic_multiplexer<asio::rudp::simulated_socket> SimulatedMultiplexer;
+typedef asio::rudp::basic_stream<asio::rudp::simulated_socket> SimulatedStream;
+typedef asio::rudp::simulated_socket::endpoint_type Endpoint;
+
+Endpoint MakeEndpoint(const char* address, unsigned short port) {
+  return Endpoint(asio::ip::address::from_string(address), port);
+}
+
+std::vector<char> PseudoRandomBytes(std::size_t size, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::vector<char> bytes(size);
+  for (auto& byte : bytes)
+    byte = static_cast<char>(generator());
+  return bytes;
+}
+
+// Connects to a server, writes all of its data and then shuts down the sending direction.
+class Sender {
+ public:
+  Sender(asio::rudp::simulated_network& network, const char* address,
+         asio::rudp::stream_base::congestion_control_type congestion_control,
+         const Endpoint& server, std::vector<char> data)
+      : multiplexer_(network, MakeEndpoint(address, 0)),
+        stream_(multiplexer_),
+        data_(std::move(data)),
+        done_(false) {
+    stream_.set_congestion_control(congestion_control);
+    stream_.async_connect(server, [this](const asio::error_code& ec) {
+      ASSERT_FALSE(ec) << ec.message();
+      asio::async_write(stream_, asio::buffer(data_),
+                        [this](const asio::error_code& ec, std::size_t) {
+        ASSERT_FALSE(ec) << ec.message();
+        stream_.async_shutdown([this](const asio::error_code& ec) {
+          EXPECT_FALSE(ec) << ec.message();
+          done_ = true;
+        });
+      });
+    });
+  }
+
+  bool done() const { return done_; }
+
+ private:
+  SimulatedMultiplexer multiplexer_;
+  SimulatedStream stream_;
+  std::vector<char> data_;
+  bool done_;
+};
+
+// Writes forever, for measuring throughput.
+class BulkSender {
+ public:
+  BulkSender(asio::rudp::simulated_network& network, const char* address,
+             asio::rudp::stream_base::congestion_control_type congestion_control,
+             const Endpoint& server)
+      : multiplexer_(network, MakeEndpoint(address, 0)),
+        stream_(multiplexer_),
+        data_(65536, 'x') {
+    stream_.set_congestion_control(congestion_control);
+    stream_.async_connect(server, [this](const asio::error_code& ec) {
+      ASSERT_FALSE(ec) << ec.message();
+      Write();
+    });
+  }
+
+ private:
+  void Write() {
+    asio::async_write(stream_, asio::buffer(data_), [this](const asio::error_code& ec, std::size_t) {
+      if (!ec)
+        Write();
+    });
+  }
+
+  SimulatedMultiplexer multiplexer_;
+  SimulatedStream stream_;
+  std::vector<char> data_;
+};
+
+// Accepts one stream and keeps everything read from it until the end of the stream.
+class Receiver {
+ public:
+  explicit Receiver(SimulatedMultiplexer& multiplexer)
+      : stream_(multiplexer), buffer_(65536), eof_(false), keep_data_(true) {}
+
+  void Accept(SimulatedMultiplexer& multiplexer, std::function<void()> accepted) {
+    multiplexer.async_accept(stream_, [this, accepted](const asio::error_code& ec) {
+      ASSERT_FALSE(ec) << ec.message();
+      if (accepted)
+        accepted();
+      Read();
+    });
+  }
+
+  void DiscardData() { keep_data_ = false; }
+  const std::vector<char>& received() const { return received_; }
+  std::size_t bytes_received() const { return bytes_received_; }
+  bool eof() const { return eof_; }
+
+ private:
+  void Read() {
+    stream_.async_read_some(asio::buffer(buffer_),
+                            [this](const asio::error_code& ec, std::size_t size) {
+      if (ec == asio::error::eof) {
+        eof_ = true;
+        return;
+      }
+      ASSERT_FALSE(ec) << ec.message();
+      bytes_received_ += size;
+      if (keep_data_)
+        received_.insert(received_.end(), buffer_.begin(), buffer_.begin() + size);
+      Read();
+    });
+  }
+
+  SimulatedStream stream_;
+  std::vector<char> buffer_, received_;
+  std::size_t bytes_received_ = 0;
+  bool eof_, keep_data_;
+};
+
+// Sends data from 10.0.0.1 to 10.0.0.2. Both hosts send through a 20 Mbit/s link with a 10 ms
+// delay, which loses and reorders datagrams at the given rates, so data and acknowledgements
+// are affected alike.
+void CheckTransfer(asio::rudp::stream_base::congestion_control_type congestion_control,
+                   double loss_rate, double reorder_rate, unsigned seed) {
+  asio::io_service io_service;
+  asio::rudp::simulated_network network(io_service, seed);
+  auto lan(network.add_link(125000000, std::chrono::microseconds(50), 1000000));
+  auto forward(network.add_link(2500000, std::chrono::milliseconds(10), 125000, loss_rate,
+                                reorder_rate));
+  auto reverse(network.add_link(2500000, std::chrono::milliseconds(10), 125000, loss_rate,
+                                reorder_rate));
+  network.add_host(asio::ip::address::from_string("10.0.0.1"), forward, lan);
+  network.add_host(asio::ip::address::from_string("10.0.0.2"), reverse, lan);
+
+  const Endpoint server(MakeEndpoint("10.0.0.2", 5000));
+  SimulatedMultiplexer server_multiplexer(network, server);
+  Receiver receiver(server_multiplexer);
+  receiver.Accept(server_multiplexer, nullptr);
+  const std::vector<char> data(PseudoRandomBytes(1 << 20, seed));
+  Sender sender(network, "10.0.0.1", congestion_control, server, data);
+
+  // Give up well within the test timeout rather than hang.
+  asio::steady_timer deadline(io_service);
+  deadline.expires_from_now(std::chrono::seconds(40));
+  deadline.async_wait([&](const asio::error_code& ec) {
+    if (!ec)
+      io_service.stop();
+  });
+  std::function<void()> poll;
+  asio::steady_timer poll_timer(io_service);
+  poll = [&] {
+    if (receiver.eof() && sender.done()) {
+      deadline.cancel();
+      io_service.stop();
+      return;
+    }
+    poll_timer.expires_from_now(std::chrono::milliseconds(10));
+    poll_timer.async_wait([&](const asio::error_code& ec) {
+      if (!ec)
+        poll();
+    });
+  };
+  poll();
+  io_service.run();
+
+  ASSERT_TRUE(receiver.eof()) << "received " << receiver.received().size() << " of "
+                              << data.size() << " bytes";
+  EXPECT_TRUE(sender.done());
+  ASSERT_EQ(data.size(), receiver.received().size());
+  EXPECT_TRUE(data == receiver.received());
+  EXPECT_NE(0U, network.dropped(forward));
+}
+
+struct Throughput {
+  std::vector<double> megabits_per_second;
+  double total, fairness;
+  std::size_t bottleneck_drops;
+};
+
+// Runs streams from 10.0.0.1, 10.0.0.2, ... to 10.0.0.100 through a shared 10 Mbit/s bottleneck
+// with a 20 ms delay and a 100 ms drop-tail queue, and measures each stream's goodput over
+// `seconds`, after a two second warm-up. Fairness is Jain's index.
+Throughput MeasureThroughput(
+    const std::vector<asio::rudp::stream_base::congestion_control_type>& congestion_controls,
+    double loss_rate, int seconds) {
+  asio::io_service io_service;
+  asio::rudp::simulated_network network(io_service);
+  auto bottleneck(network.add_link(1250000, std::chrono::milliseconds(20), 125000, loss_rate));
+  auto lan(network.add_link(125000000, std::chrono::microseconds(50), 1000000));
+  const char* const senders[] = {"10.0.0.1", "10.0.0.2", "10.0.0.3", "10.0.0.4"};
+  const std::size_t count(congestion_controls.size());
+  for (std::size_t i(0); i != count; ++i)
+    network.add_host(asio::ip::address::from_string(senders[i]), bottleneck, lan);
+  network.add_host(asio::ip::address::from_string("10.0.0.100"), lan, lan);
+
+  const Endpoint server(MakeEndpoint("10.0.0.100", 5000));
+  SimulatedMultiplexer server_multiplexer(network, server);
+  std::vector<std::unique_ptr<Receiver>> receivers;
+  for (std::size_t i(0); i != count; ++i) {
+    receivers.emplace_back(new Receiver(server_multiplexer));
+    receivers.back()->DiscardData();
+  }
+  std::function<void(std::size_t)> accept = [&](std::size_t i) {
+    if (i != count)
+      receivers[i]->Accept(server_multiplexer, [&accept, i] { accept(i + 1); });
+  };
+  accept(0);
+  std::vector<std::unique_ptr<BulkSender>> bulk_senders;
+  for (std::size_t i(0); i != count; ++i)
+    bulk_senders.emplace_back(new BulkSender(network, senders[i], congestion_controls[i], server));
+
+  std::vector<std::size_t> start(count);
+  asio::steady_timer warm_up(io_service), finish(io_service);
+  warm_up.expires_from_now(std::chrono::seconds(2));
+  warm_up.async_wait([&](const asio::error_code&) {
+    for (std::size_t i(0); i != count; ++i)
+      start[i] = receivers[i]->bytes_received();
+  });
+  finish.expires_from_now(std::chrono::seconds(2 + seconds));
+  finish.async_wait([&](const asio::error_code&) { io_service.stop(); });
+  io_service.run();
+
+  Throughput result;
+  double sum(0), sum_of_squares(0);
+  for (std::size_t i(0); i != count; ++i) {
+    double rate((receivers[i]->bytes_received() - start[i]) * 8.0 / seconds / 1e6);
+    result.megabits_per_second.push_back(rate);
+    sum += rate;
+    sum_of_squares += rate * rate;
+  }
+  result.total = sum;
+  result.fairness = sum_of_squares > 0 ? sum * sum / (count * sum_of_squares) : 0;
+  result.bottleneck_drops = network.dropped(bottleneck);
+  return result;
+}
+
+void Report(const char* name, const Throughput& throughput) {
+  std::printf("  %-28s", name);
+  for (std::size_t i(0); i != throughput.megabits_per_second.size(); ++i)
+    std::printf("%s%.2f", i == 0 ? "" : " + ", throughput.megabits_per_second[i]);
+  std::printf(" Mbit/s, Jain index %.3f, %u drops\n", throughput.fairness,
+              static_cast<unsigned>(throughput.bottleneck_drops));
+}
+
+}  // unnamed namespace
+
+TEST(RudpTest, BEH_RenoDeliversExactlyUnderLossAndReordering) {
+  CheckTransfer(asio::rudp::stream_base::reno, 0.02, 0.05, 1);
+}
+
+TEST(RudpTest, BEH_LedbatDeliversExactlyUnderLossAndReordering) {
+  CheckTransfer(asio::rudp::stream_base::ledbat, 0.02, 0.05, 2);
+}
+
+TEST(RudpTest, FUNC_CongestionControlThroughput) {
+  const auto reno(asio::rudp::stream_base::reno);
+  const auto ledbat(asio::rudp::stream_base::ledbat);
+  const int kSeconds(10);
+
+  Throughput one_reno(MeasureThroughput({reno}, 0, kSeconds));
+  Report("one Reno stream", one_reno);
+  EXPECT_GT(one_reno.total, 8.0);
+
+  Throughput two_reno(MeasureThroughput({reno, reno}, 0, kSeconds));
+  Report("two Reno streams", two_reno);
+  EXPECT_GT(two_reno.total, 8.0);
+  EXPECT_GT(two_reno.fairness, 0.9);
+
+  Throughput reno_and_ledbat(MeasureThroughput({reno, ledbat}, 0, kSeconds));
+  Report("Reno + LEDBAT", reno_and_ledbat);
+  EXPECT_GT(reno_and_ledbat.total, 8.0);
+  EXPECT_LT(reno_and_ledbat.megabits_per_second[1], reno_and_ledbat.megabits_per_second[0]);
+
+  Throughput lossy_reno(MeasureThroughput({reno}, 0.01, kSeconds));
+  Report("one Reno stream, 1% loss", lossy_reno);
+  EXPECT_GT(lossy_reno.total, 1.0);
+}
+
+}  // namespace test
+
+}  // namespace maidsafe
+
+#endif  // defined(ASIO_HAS_STD_CHRONO)
@@ -0,0 +1,532 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+/**
+ * \file boost/process/posix/resource_monitor.hpp
+ *
+ * Defines a class to sample the resource usage of child processes.
+ *
+ * \remark <em>Linux only.</em>
+ */
+
+#ifndef BOOST_PROCESS_POSIX_RESOURCE_MONITOR_HPP
+#define BOOST_PROCESS_POSIX_RESOURCE_MONITOR_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+/**
+ * The resource usage of a child process, as of the last sample.
+ *
+ * Counters are cumulative since the process started. Rates are per
+ * second, averaged over the time since the previous sample, and are
+ * zero until a process has been sampled twice.
+ */
+struct resource_usage
+{
+    /** Process identifier. */
+    pid_t pid;
+
+    /** False once the process has exited, whether reaped or not. */
+    bool running;
+
+    /** The state letter from /proc/<pid>/stat, e.g. 'R', 'S' or 'Z'. */
+    char state;
+
+    /** Number of threads. */
+    unsigned threads;
+
+    /** CPU time in seconds, in user and kernel mode. */
+    double user_time;
+    double system_time;
+
+    /** CPU time per second: 1.0 is one core kept fully busy. */
+    double cpu;
+
+    /** Memory, in bytes. */
+    boost::uint64_t virtual_memory;
+    boost::uint64_t resident_memory;
+    boost::uint64_t shared_memory;
+
+    /**
+     * Bytes passed to read and write calls of any kind, including on
+     * sockets and pipes, and bytes actually fetched from or sent to
+     * storage. Zero if /proc/<pid>/io cannot be read.
+     */
+    boost::uint64_t read_chars;
+    boost::uint64_t write_chars;
+    boost::uint64_t read_bytes;
+    boost::uint64_t write_bytes;
+
+    double read_chars_rate;
+    double write_chars_rate;
+    double read_bytes_rate;
+    double write_bytes_rate;
+
+    /** Number of open file descriptors. */
+    std::size_t open_fds;
+};
+
+/**
+ * Samples the resource usage of many child processes.
+ *
+ * Each monitored process has four files under /proc/<pid> opened when it
+ * is added, and a sample reads each with a single pread(2), so sampling
+ * costs four system calls per process and no path lookups. As the files
+ * belong to the process rather than to its pid, a process that exits
+ * stays exited even if its pid is reused. The caller must allow for the
+ * extra descriptors in RLIMIT_NOFILE.
+ *
+ * The monitor has no thread or timer of its own: call sample() on a
+ * schedule, for instance from a boost::asio::deadline_timer handler.
+ * Threshold handlers are called from sample().
+ *
+ * \remark <em>Linux only.</em>
+ */
+class resource_monitor : boost::noncopyable
+{
+public:
+    /** Quantities that thresholds can be set on. */
+    enum metric
+    {
+        cpu,
+        resident_memory,
+        open_fds,
+        read_chars_rate,
+        write_chars_rate,
+        read_bytes_rate,
+        write_bytes_rate
+    };
+
+    typedef boost::function<void (const resource_usage&)> threshold_handler;
+
+    resource_monitor() :
+        clock_ticks_(::sysconf(_SC_CLK_TCK)),
+        page_size_(::sysconf(_SC_PAGESIZE)) {}
+
+    ~resource_monitor()
+    {
+        for (std::size_t i = 0; i < children_.size(); ++i)
+            close_files(children_[i]);
+    }
+
+    /**
+     * Starts monitoring a process. Does nothing if it is already
+     * monitored.
+     *
+     * \throws boost::system::system_error in case of an error
+     */
+    template <class Process>
+    void add(const Process &p)
+    {
+        boost::system::error_code ec;
+        add(p, ec);
+        if (ec)
+            BOOST_PROCESS_THROW(boost::system::system_error(ec,
+                BOOST_PROCESS_SOURCE_LOCATION "open(2) of /proc failed"));
+    }
+
+    /**
+     * Starts monitoring a process. Does nothing if it is already
+     * monitored.
+     */
+    template <class Process>
+    void add(const Process &p, boost::system::error_code &ec)
+    {
+        ec.clear();
+        if (find(p.pid))
+            return;
+
+        child_entry e;
+        std::memset(&e.usage, 0, sizeof(e.usage));
+        e.usage.pid = p.pid;
+        e.usage.running = true;
+        e.sampled = false;
+        e.time = 0;
+        e.io_fd = e.fd_dir = -1;
+        e.stat_fd = open_proc(p.pid, "stat", O_RDONLY);
+        if (e.stat_fd == -1)
+        {
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+            return;
+        }
+        e.statm_fd = open_proc(p.pid, "statm", O_RDONLY);
+        if (e.statm_fd == -1)
+        {
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+            ::close(e.stat_fd);
+            return;
+        }
+        // Reading io needs ptrace access, which a child of another user
+        // does not grant; its I/O counters then stay zero.
+        e.io_fd = open_proc(p.pid, "io", O_RDONLY);
+        e.fd_dir = open_proc(p.pid, "fd", O_RDONLY | O_DIRECTORY);
+        children_.push_back(e);
+    }
+
+    /** Stops monitoring a process. */
+    template <class Process>
+    void remove(const Process &p)
+    {
+        for (std::size_t i = 0; i < children_.size(); ++i)
+        {
+            if (children_[i].usage.pid == p.pid)
+            {
+                close_files(children_[i]);
+                children_[i] = children_.back();
+                children_.pop_back();
+                return;
+            }
+        }
+    }
+
+    /** Returns the number of monitored processes. */
+    std::size_t size() const { return children_.size(); }
+
+    /**
+     * Calls \a handler from sample() when \a m rises above \a limit for a
+     * process. The handler is called again only after the value has
+     * fallen back to \a limit or below.
+     */
+    void set_threshold(metric m, double limit, const threshold_handler &handler)
+    {
+        threshold t;
+        t.m = m;
+        t.limit = limit;
+        t.handler = handler;
+        thresholds_.push_back(t);
+    }
+
+    /**
+     * Samples every monitored process that is still running, and calls
+     * the threshold handlers of any that cross a threshold.
+     */
+    void sample()
+    {
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        double now = ts.tv_sec + ts.tv_nsec / 1e9;
+        std::vector<std::pair<std::size_t, resource_usage> > crossed;
+
+        for (std::size_t i = 0; i < children_.size(); ++i)
+        {
+            child_entry &e = children_[i];
+            if (!e.usage.running)
+                continue;
+            resource_usage prev = e.usage;
+            bool ok = read_stat(e);
+            if (!ok || e.usage.state == 'Z' || e.usage.state == 'X')
+            {
+                // Keep the last figures, but let go of the files.
+                char state = ok ? e.usage.state : 'X';
+                e.usage = prev;
+                e.usage.state = state;
+                e.usage.running = false;
+                e.usage.cpu = 0;
+                e.usage.read_chars_rate = e.usage.write_chars_rate = 0;
+                e.usage.read_bytes_rate = e.usage.write_bytes_rate = 0;
+                close_files(e);
+                continue;
+            }
+            read_statm(e);
+            read_io(e);
+            count_fds(e);
+
+            if (e.sampled && now > e.time)
+            {
+                double dt = now - e.time;
+                resource_usage &u = e.usage;
+                u.cpu = (u.user_time + u.system_time
+                    - prev.user_time - prev.system_time) / dt;
+                u.read_chars_rate = rate(u.read_chars, prev.read_chars, dt);
+                u.write_chars_rate = rate(u.write_chars, prev.write_chars, dt);
+                u.read_bytes_rate = rate(u.read_bytes, prev.read_bytes, dt);
+                u.write_bytes_rate = rate(u.write_bytes, prev.write_bytes, dt);
+            }
+            e.sampled = true;
+            e.time = now;
+
+            check_thresholds(e, crossed);
+        }
+
+        // Handlers run once all processes are sampled, so that they may
+        // add or remove processes.
+        for (std::size_t i = 0; i < crossed.size(); ++i)
+            thresholds_[crossed[i].first].handler(crossed[i].second);
+    }
+
+    /** Returns the usage of every monitored process. */
+    std::vector<resource_usage> snapshot() const
+    {
+        std::vector<resource_usage> v;
+        v.reserve(children_.size());
+        for (std::size_t i = 0; i < children_.size(); ++i)
+            v.push_back(children_[i].usage);
+        return v;
+    }
+
+    /**
+     * Stores the usage of a process in \a u. Returns false if the process
+     * is not monitored.
+     */
+    template <class Process>
+    bool usage(const Process &p, resource_usage &u) const
+    {
+        const child_entry *e = find(p.pid);
+        if (!e)
+            return false;
+        u = e->usage;
+        return true;
+    }
+
+private:
+    struct threshold
+    {
+        metric m;
+        double limit;
+        threshold_handler handler;
+    };
+
+    struct child_entry
+    {
+        resource_usage usage;
+        bool sampled;
+        double time;
+        int stat_fd;
+        int statm_fd;
+        int io_fd;
+        int fd_dir;
+        std::vector<bool> exceeded;
+    };
+
+    const child_entry *find(pid_t pid) const
+    {
+        for (std::size_t i = 0; i < children_.size(); ++i)
+        {
+            if (children_[i].usage.pid == pid)
+                return &children_[i];
+        }
+        return 0;
+    }
+
+    static int open_proc(pid_t pid, const char *file, int flags)
+    {
+        char path[64];
+        std::snprintf(path, sizeof(path), "/proc/%d/%s",
+            static_cast<int>(pid), file);
+        int fd;
+        do
+        {
+            fd = ::open(path, flags | O_CLOEXEC);
+        } while (fd == -1 && errno == EINTR);
+        return fd;
+    }
+
+    static void close_files(child_entry &e)
+    {
+        int *fds[] = { &e.stat_fd, &e.statm_fd, &e.io_fd, &e.fd_dir };
+        for (std::size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); ++i)
+        {
+            if (*fds[i] != -1)
+                ::close(*fds[i]);
+            *fds[i] = -1;
+        }
+    }
+
+    // Reads a whole /proc file, which the kernel generates afresh for
+    // each read from offset zero. Returns the number of bytes read, or
+    // -1 on error, which for a process that has been reaped is ESRCH.
+    static ssize_t read_proc(int fd, char *buf, std::size_t size)
+    {
+        ssize_t n;
+        do
+        {
+            n = ::pread(fd, buf, size - 1, 0);
+        } while (n == -1 && errno == EINTR);
+        if (n >= 0)
+            buf[n] = '\0';
+        return n;
+    }
+
+    static boost::uint64_t parse_number(const char *&p)
+    {
+        while (*p == ' ')
+            ++p;
+        boost::uint64_t n = 0;
+        for (; *p >= '0' && *p <= '9'; ++p)
+            n = n * 10 + (*p - '0');
+        return n;
+    }
+
+    static const char *skip_fields(const char *p, int n)
+    {
+        for (; n > 0 && *p; --n)
+        {
+            while (*p == ' ')
+                ++p;
+            while (*p && *p != ' ')
+                ++p;
+        }
+        return p;
+    }
+
+    bool read_stat(child_entry &e) const
+    {
+        char buf[1024];
+        if (read_proc(e.stat_fd, buf, sizeof(buf)) <= 0)
+            return false;
+        // The command name in field 2 may contain spaces and parentheses,
+        // so fields are counted from the last ')'.
+        const char *p = std::strrchr(buf, ')');
+        if (!p || p[1] != ' ')
+            return false;
+        p += 2;
+        e.usage.state = *p;
+        p = skip_fields(p, 11);                     // Fields 3 to 13.
+        boost::uint64_t utime = parse_number(p);    // Field 14.
+        boost::uint64_t stime = parse_number(p);    // Field 15.
+        p = skip_fields(p, 4);                      // Fields 16 to 19.
+        e.usage.threads = static_cast<unsigned>(parse_number(p));
+        e.usage.user_time = static_cast<double>(utime) / clock_ticks_;
+        e.usage.system_time = static_cast<double>(stime) / clock_ticks_;
+        return true;
+    }
+
+    void read_statm(child_entry &e) const
+    {
+        char buf[256];
+        if (read_proc(e.statm_fd, buf, sizeof(buf)) <= 0)
+            return;
+        const char *p = buf;
+        e.usage.virtual_memory = parse_number(p) * page_size_;
+        e.usage.resident_memory = parse_number(p) * page_size_;
+        e.usage.shared_memory = parse_number(p) * page_size_;
+    }
+
+    static void read_io(child_entry &e)
+    {
+        char buf[512];
+        if (e.io_fd == -1 || read_proc(e.io_fd, buf, sizeof(buf)) <= 0)
+            return;
+        for (const char *p = buf; p && *p; )
+        {
+            const char *colon = std::strchr(p, ':');
+            if (!colon)
+                break;
+            std::size_t len = colon - p;
+            const char *value = colon + 1;
+            boost::uint64_t n = parse_number(value);
+            if (len == 5 && std::memcmp(p, "rchar", 5) == 0)
+                e.usage.read_chars = n;
+            else if (len == 5 && std::memcmp(p, "wchar", 5) == 0)
+                e.usage.write_chars = n;
+            else if (len == 10 && std::memcmp(p, "read_bytes", 10) == 0)
+                e.usage.read_bytes = n;
+            else if (len == 11 && std::memcmp(p, "write_bytes", 11) == 0)
+                e.usage.write_bytes = n;
+            p = std::strchr(value, '\n');
+            if (p)
+                ++p;
+        }
+    }
+
+    static void count_fds(child_entry &e)
+    {
+        if (e.fd_dir == -1)
+            return;
+        // Since Linux 6.2 the size of /proc/<pid>/fd is the number of open
+        // descriptors. Earlier kernels report zero, and the directory is
+        // listed instead.
+        struct stat st;
+        if (::fstat(e.fd_dir, &st) == 0 && st.st_size > 0)
+        {
+            e.usage.open_fds = static_cast<std::size_t>(st.st_size);
+            return;
+        }
+        if (::lseek(e.fd_dir, 0, SEEK_SET) == -1)
+            return;
+        std::size_t count = 0;
+        char buf[4096];
+        long n;
+        while ((n = ::syscall(SYS_getdents64, e.fd_dir, buf, sizeof(buf))) > 0)
+        {
+            for (long off = 0; off < n; )
+            {
+                // struct linux_dirent64: d_ino, d_off, d_reclen, d_type,
+                // d_name.
+                unsigned short reclen;
+                std::memcpy(&reclen, buf + off + 16, sizeof(reclen));
+                if (buf[off + 19] != '.')
+                    ++count;
+                off += reclen;
+            }
+        }
+        e.usage.open_fds = count;
+    }
+
+    static double rate(boost::uint64_t now, boost::uint64_t prev, double dt)
+    {
+        return now >= prev ? (now - prev) / dt : 0;
+    }
+
+    static double value(const resource_usage &u, metric m)
+    {
+        switch (m)
+        {
+        case cpu: return u.cpu;
+        case resident_memory: return static_cast<double>(u.resident_memory);
+        case open_fds: return static_cast<double>(u.open_fds);
+        case read_chars_rate: return u.read_chars_rate;
+        case write_chars_rate: return u.write_chars_rate;
+        case read_bytes_rate: return u.read_bytes_rate;
+        case write_bytes_rate: return u.write_bytes_rate;
+        }
+        return 0;
+    }
+
+    // Records, in \a crossed, each threshold that \a e has just risen
+    // above.
+    void check_thresholds(child_entry &e,
+        std::vector<std::pair<std::size_t, resource_usage> > &crossed) const
+    {
+        e.exceeded.resize(thresholds_.size(), false);
+        for (std::size_t i = 0; i < thresholds_.size(); ++i)
+        {
+            bool above = value(e.usage, thresholds_[i].m) > thresholds_[i].limit;
+            if (above && !e.exceeded[i])
+                crossed.push_back(std::make_pair(i, e.usage));
+            e.exceeded[i] = above;
+        }
+    }
+
+    long clock_ticks_;
+    long page_size_;
+    std::vector<child_entry> children_;
+    std::vector<threshold> thresholds_;
+};
+
+}}}
+
+#endif
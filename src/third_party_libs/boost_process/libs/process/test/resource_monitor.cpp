@@ -0,0 +1,134 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_IGNORE_SIGCHLD
+#include <boost/test/included/unit_test.hpp>
+#include <boost/process.hpp>
+#include <boost/process/posix/resource_monitor.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <vector>
+#include <unistd.h>
+
+namespace bp = boost::process;
+namespace bpi = boost::process::initializers;
+
+namespace {
+
+struct count_calls
+{
+    int *calls;
+
+    explicit count_calls(int *c) : calls(c) {}
+
+    void operator()(const bp::posix::resource_usage&) const
+    {
+        ++*calls;
+    }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(sample_busy_child)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    bp::posix::resource_monitor monitor;
+    int calls = 0;
+    monitor.set_threshold(bp::posix::resource_monitor::cpu, 0.25,
+        count_calls(&calls));
+    monitor.add(c);
+    monitor.add(c);
+    BOOST_CHECK_EQUAL(monitor.size(), 1u);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        monitor.sample();
+        usleep(200000);
+    }
+    monitor.sample();
+
+    bp::posix::resource_usage u;
+    BOOST_REQUIRE(monitor.usage(c, u));
+    BOOST_CHECK(u.running);
+    BOOST_CHECK_EQUAL(u.pid, c.pid);
+    BOOST_CHECK_GT(u.cpu, 0.25);
+    BOOST_CHECK_GT(u.user_time, 0.0);
+    BOOST_CHECK_GT(u.resident_memory, 0u);
+    BOOST_CHECK_GE(u.virtual_memory, u.resident_memory);
+    BOOST_CHECK_GE(u.threads, 1u);
+    BOOST_CHECK_GE(u.open_fds, 3u);
+    BOOST_CHECK_EQUAL(calls, 1);
+
+    bp::terminate(c);
+    bp::wait_for_exit(c, ec);
+    monitor.sample();
+    BOOST_REQUIRE(monitor.usage(c, u));
+    BOOST_CHECK(!u.running);
+    BOOST_CHECK_EQUAL(u.cpu, 0.0);
+    BOOST_CHECK_GT(u.user_time, 0.0);
+
+    monitor.remove(c);
+    BOOST_CHECK_EQUAL(monitor.size(), 0u);
+    BOOST_CHECK(!monitor.usage(c, u));
+}
+
+BOOST_AUTO_TEST_CASE(sample_many_children)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::posix::resource_monitor monitor;
+    std::vector<bp::child> children;
+    for (int i = 0; i < 8; ++i)
+    {
+        boost::system::error_code ec;
+        children.push_back(bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --wait 2"),
+            bpi::set_on_error(ec)
+        ));
+        BOOST_REQUIRE(!ec);
+        monitor.add(children.back());
+    }
+
+    monitor.sample();
+    usleep(100000);
+    monitor.sample();
+
+    std::vector<bp::posix::resource_usage> v = monitor.snapshot();
+    BOOST_CHECK_EQUAL(v.size(), children.size());
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        BOOST_CHECK(v[i].running);
+        BOOST_CHECK_LT(v[i].cpu, 0.5);
+    }
+
+    for (std::size_t i = 0; i < children.size(); ++i)
+        bp::wait_for_exit(children[i]);
+}
+
+BOOST_AUTO_TEST_CASE(add_set_on_error)
+{
+    bp::posix::resource_monitor monitor;
+    bp::child c(-1);
+    boost::system::error_code ec;
+    monitor.add(c, ec);
+    BOOST_CHECK(ec);
+    BOOST_CHECK_EQUAL(monitor.size(), 0u);
+    BOOST_CHECK_THROW(monitor.add(c), boost::system::system_error);
+}
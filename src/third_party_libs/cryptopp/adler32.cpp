@@ -2,52 +2,19 @@
 
 #include "pch.h"
 #include "adler32.h"
+#include "multiver.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
 void Adler32::Update(const byte *input, size_t length)
 {
-	const unsigned long BASE = 65521;
+	word32 s1 = m_s1;
+	word32 s2 = m_s2;
 
-	unsigned long s1 = m_s1;
-	unsigned long s2 = m_s2;
+	GetMultiVersionKernels().Adler32_Update(s1, s2, input, length);
 
-	if (length % 8 != 0)
-	{
-		do
-		{
-			s1 += *input++;
-			s2 += s1;
-			length--;
-		} while (length % 8 != 0);
-
-		if (s1 >= BASE)
-			s1 -= BASE;
-		s2 %= BASE;
-	}
-
-	while (length > 0)
-	{
-		s1 += input[0]; s2 += s1;
-		s1 += input[1]; s2 += s1;
-		s1 += input[2]; s2 += s1;
-		s1 += input[3]; s2 += s1;
-		s1 += input[4]; s2 += s1;
-		s1 += input[5]; s2 += s1;
-		s1 += input[6]; s2 += s1;
-		s1 += input[7]; s2 += s1;
-
-		length -= 8;
-		input += 8;
-
-		if (s1 >= BASE)
-			s1 -= BASE;
-		if (length % 0x8000 == 0)
-			s2 %= BASE;
-	}
-
-	assert(s1 < BASE);
-	assert(s2 < BASE);
+	assert(s1 < 65521);
+	assert(s2 < 65521);
 
 	m_s1 = (word16)s1;
 	m_s2 = (word16)s2;
@@ -5,6 +5,7 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "asn.h"
+#include "integer.h"
 
 #include <iomanip>
 #include <time.h>
@@ -510,6 +511,105 @@ void DERGeneralEncoder::MessageEnd()
 	TransferTo(m_outQueue);
 }
 
+DERSpanDecoder::DERSpanDecoder(DERSpanDecoder &outer, byte asnTag)
+{
+	size_t length;
+	m_ptr = outer.DecodeContents(asnTag, length);
+	m_end = m_ptr + length;
+}
+
+byte DERSpanDecoder::PeekByte() const
+{
+	if (EndReached())
+		BERDecodeError();
+	return *m_ptr;
+}
+
+void DERSpanDecoder::CheckByte(byte check)
+{
+	if (EndReached() || *m_ptr != check)
+		BERDecodeError();
+	m_ptr++;
+}
+
+const byte * DERSpanDecoder::DecodeContents(byte asnTag, size_t &length)
+{
+	CheckByte(asnTag);
+	if (EndReached())
+		BERDecodeError();
+
+	byte b = *m_ptr++;
+	if (!(b & 0x80))
+		length = b;
+	else
+	{
+		unsigned int lengthBytes = b & 0x7f;
+		if (lengthBytes == 0 || lengthBytes > RemainingLength())
+			BERDecodeError();	// indefinite length, or truncated
+
+		length = 0;
+		while (lengthBytes--)
+		{
+			if (length >> (8*(sizeof(length)-1)))
+				BERDecodeError();	// length about to overflow
+			length = (length << 8) | *m_ptr++;
+		}
+	}
+
+	if (length > RemainingLength())
+		BERDecodeError();
+
+	const byte *contents = m_ptr;
+	m_ptr += length;
+	return contents;
+}
+
+void DERSpanDecoder::DecodeNull()
+{
+	size_t length;
+	DecodeContents(TAG_NULL, length);
+	if (length != 0)
+		BERDecodeError();
+}
+
+void DERSpanDecoder::DecodeInteger(Integer &value)
+{
+	size_t length;
+	const byte *contents = DecodeContents(INTEGER, length);
+	value.Decode(contents, length, Integer::SIGNED);
+}
+
+void DERSpanDecoder::DecodeAndCheckOID(const OID &oid)
+{
+	size_t length;
+	const byte *contents = DecodeContents(OBJECT_IDENTIFIER, length);
+	const byte *end = contents + length;
+
+	if (length < 1 || oid.m_values.size() < 2 || contents[0] != oid.m_values[0]*40 + oid.m_values[1])
+		BERDecodeError();
+	contents++;
+
+	for (size_t i=2; i<oid.m_values.size(); i++)
+	{
+		word32 v = 0;
+		byte b;
+		do
+		{
+			if (contents == end || (v >> (8*sizeof(v)-7)))
+				BERDecodeError();
+			b = *contents++;
+			v <<= 7;
+			v += b & 0x7f;
+		} while (b & 0x80);
+
+		if (v != oid.m_values[i])
+			BERDecodeError();
+	}
+
+	if (contents != end)
+		BERDecodeError();
+}
+
 // *************************************************************
 
 void X509PublicKey::BERDecode(BufferedTransformation &bt)
@@ -213,6 +213,39 @@ public:
 		: DERGeneralEncoder(outQueue, asnTag) {}
 };
 
+class Integer;
+
+//! DER decoder that reads from contiguous memory
+/*! Unlike BERGeneralDecoder, no data is copied into queues: each decoder is a pair of
+	pointers into the caller's buffer, which must stay valid while decoding. Constructing a
+	decoder from another one consumes the header of the next element and covers its
+	contents. Only definite lengths are accepted. Errors throw BERDecodeErr. */
+class CRYPTOPP_DLL DERSpanDecoder
+{
+public:
+	DERSpanDecoder(const byte *data, size_t length)
+		: m_ptr(data), m_end(data+length) {}
+	DERSpanDecoder(DERSpanDecoder &outer, byte asnTag);
+
+	bool EndReached() const {return m_ptr == m_end;}
+	size_t RemainingLength() const {return m_end - m_ptr;}
+	byte PeekByte() const;
+	void CheckByte(byte b);
+
+	//! decode an element with the given tag, returning a pointer to its contents
+	const byte * DecodeContents(byte asnTag, size_t &length);
+	void DecodeNull();
+	void DecodeInteger(Integer &value);
+	//! throw BERDecodeErr() if the next element isn't oid
+	void DecodeAndCheckOID(const OID &oid);
+
+	// call this to denote end of sequence
+	void MessageEnd() {if (!EndReached()) BERDecodeError();}
+
+private:
+	const byte *m_ptr, *m_end;
+};
+
 template <class T>
 class ASNOptional : public member_ptr<T>
 {
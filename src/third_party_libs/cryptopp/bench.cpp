@@ -9,6 +9,9 @@
 #include "files.h"
 #include "hex.h"
 #include "modes.h"
+#include "xts.h"
+#include "gcmsiv.h"
+#include "multiver.h"
 #include "factory.h"
 #include "cpu.h"
 
@@ -16,6 +19,7 @@
 #include <math.h>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 USING_NAMESPACE(CryptoPP)
 USING_NAMESPACE(std)
@@ -122,6 +126,119 @@ void BenchMark(const char *name, AuthenticatedSymmetricCipher &cipher, double ti
 	BenchMark(name, static_cast<StreamTransformation &>(cipher), timeTotal);
 }
 
+void BenchMark(const char *name, XTS_ModeBase &cipher, double timeTotal)
+{
+	const int SECTOR_SIZE=4096;
+	AlignedSecByteBlock buf(SECTOR_SIZE);
+	GlobalRNG().GenerateBlock(buf, SECTOR_SIZE);
+	clock_t start = clock();
+
+	unsigned long i=0, blocks=1;
+	double timeTaken;
+	do
+	{
+		blocks *= 2;
+		for (; i<blocks; i++)
+			cipher.ProcessSector(i, buf, SECTOR_SIZE);
+		timeTaken = double(clock() - start) / CLOCK_TICKS_PER_SECOND;
+	}
+	while (timeTaken < 2.0/3*timeTotal);
+
+	OutputResultBytes(name, double(blocks) * SECTOR_SIZE, timeTaken);
+}
+
+// GCM-SIV can't be used through filters, so time EncryptAndAuthenticate() on 4 KiB messages,
+// including the per-message key derivation
+void BenchMark(const char *name, GCM_SIV_Base &cipher, double timeTotal)
+{
+	const int BUF_SIZE=4096;
+	AlignedSecByteBlock buf(BUF_SIZE);
+	byte nonce[12], mac[16];
+	GlobalRNG().GenerateBlock(buf, BUF_SIZE);
+	GlobalRNG().GenerateBlock(nonce, sizeof(nonce));
+	clock_t start = clock();
+
+	unsigned long i=0, blocks=1;
+	double timeTaken;
+	do
+	{
+		blocks *= 2;
+		for (; i<blocks; i++)
+			cipher.EncryptAndAuthenticate(buf, mac, sizeof(mac), nonce, sizeof(nonce), NULL, 0, buf, BUF_SIZE);
+		timeTaken = double(clock() - start) / CLOCK_TICKS_PER_SECOND;
+	}
+	while (timeTaken < 2.0/3*timeTotal);
+
+	OutputResultBytes(name, double(blocks) * BUF_SIZE, timeTaken);
+}
+
+// call one of the MultiVersionKernels on a buffer the way SHA1, SHA256, SHA512 and Adler32 do
+static void RunMultiVersionKernel(const MultiVersionKernels &kernels, unsigned int kernel, const byte *buf, size_t size)
+{
+	static word32 state32[8], s1 = 1, s2 = 0;
+	static word64 state64[8];
+	size_t i;
+	switch (kernel)
+	{
+	case 0:
+		for (i=0; i<size; i+=64)
+			kernels.SHA1_Transform(state32, (const word32 *)(buf+i));
+		break;
+	case 1:
+		for (i=0; i<size; i+=64)
+			kernels.SHA256_Transform(state32, (const word32 *)(buf+i));
+		break;
+	case 2:
+		for (i=0; i<size; i+=128)
+			kernels.SHA512_Transform(state64, (const word64 *)(buf+i));
+		break;
+	default:
+		kernels.Adler32_Update(s1, s2, buf, size);
+	}
+}
+
+// run each kernel compiled for each instruction set level this CPU supports, and report the speedup over the baseline
+void BenchMarkMultiVersionKernels(double timeTotal)
+{
+	static const char *const kernelNames[] = {"SHA-1", "SHA-256", "SHA-512", "Adler32"};
+	const unsigned int KERNELS = sizeof(kernelNames)/sizeof(kernelNames[0]);
+	const int BUF_SIZE=2048U;
+	AlignedSecByteBlock buf(BUF_SIZE);
+	GlobalRNG().GenerateBlock(buf, BUF_SIZE);
+	double baseline[KERNELS];
+
+	for (int level = MULTIVERSION_BASELINE; level < MULTIVERSION_LEVEL_COUNT; level++)
+	{
+		const MultiVersionKernels *kernels = GetMultiVersionKernels(MultiVersionLevel(level));
+		if (!kernels)
+			continue;
+
+		for (unsigned int kernel = 0; kernel < KERNELS; kernel++)
+		{
+			clock_t start = clock();
+			unsigned long i=0, blocks=1;
+			double timeTaken;
+			do
+			{
+				blocks *= 2;
+				for (; i<blocks; i++)
+					RunMultiVersionKernel(*kernels, kernel, buf, BUF_SIZE);
+				timeTaken = double(clock() - start) / CLOCK_TICKS_PER_SECOND;
+			}
+			while (timeTaken < 2.0/3*timeTotal);
+
+			double rate = blocks / timeTaken;
+			std::ostringstream name;
+			name << kernelNames[kernel] << " kernel, " << kernels->name;
+			if (level == MULTIVERSION_BASELINE)
+				baseline[kernel] = rate;
+			else
+				name << " (" << setprecision(2) << setiosflags(ios::fixed) << rate / baseline[kernel] << "x baseline)";
+			OutputResultBytes(name.str().c_str(), double(blocks) * BUF_SIZE, timeTaken);
+		}
+	}
+}
+
 void BenchMark(const char *name, HashTransformation &ht, double timeTotal)
 {
 	const int BUF_SIZE=2048U;
@@ -252,6 +369,15 @@ void BenchmarkAll(double t, double hertz)
 		BenchMarkByName2<AuthenticatedSymmetricCipher, AuthenticatedSymmetricCipher>("AES/GCM", 0, "AES/GCM (2K tables)", MakeParameters(Name::TableSize(), 2048));
 		BenchMarkByName2<AuthenticatedSymmetricCipher, AuthenticatedSymmetricCipher>("AES/GCM", 0, "AES/GCM (64K tables)", MakeParameters(Name::TableSize(), 64*1024));
 	}
+	{
+		GCM_SIV<AES>::Encryption gcmsiv;
+		for (size_t keyLength = 16; keyLength <= 32; keyLength += 16)
+		{
+			gcmsiv.SetKey(key, keyLength);
+			BenchMark(("AES/GCM-SIV (" + IntToString(keyLength * 8) + "-bit key)").c_str(), gcmsiv, g_allocatedTime);
+			BenchMarkKeying(gcmsiv, keyLength, g_nullNameValuePairs);
+		}
+	}
 	BenchMarkByName2<AuthenticatedSymmetricCipher, AuthenticatedSymmetricCipher>("AES/CCM");
 	BenchMarkByName2<AuthenticatedSymmetricCipher, AuthenticatedSymmetricCipher>("AES/EAX");
 
@@ -285,6 +411,7 @@ void BenchmarkAll(double t, double hertz)
 	BenchMarkByNameKeyLess<HashTransformation>("RIPEMD-320");
 	BenchMarkByNameKeyLess<HashTransformation>("RIPEMD-128");
 	BenchMarkByNameKeyLess<HashTransformation>("RIPEMD-256");
+	BenchMarkMultiVersionKernels(g_allocatedTime);
 
 	cout << "\n<TBODY style=\"background: white\">";
 	BenchMarkByName<SymmetricCipher>("Panama-LE");
@@ -307,6 +434,15 @@ void BenchmarkAll(double t, double hertz)
 	BenchMarkByName<SymmetricCipher>("AES/OFB", 16);
 	BenchMarkByName<SymmetricCipher>("AES/CFB", 16);
 	BenchMarkByName<SymmetricCipher>("AES/ECB", 16);
+	{
+		XTS_Mode<AES>::Encryption xts;
+		for (size_t keyLength = 32; keyLength <= 64; keyLength += 32)
+		{
+			xts.SetKey(key, keyLength);
+			BenchMark(("AES/XTS (" + IntToString(keyLength * 8) + "-bit key)").c_str(), xts, g_allocatedTime);
+			BenchMarkKeying(xts, keyLength, g_nullNameValuePairs);
+		}
+	}
 	BenchMarkByName<SymmetricCipher>("Camellia/CTR", 16);
 	BenchMarkByName<SymmetricCipher>("Camellia/CTR", 32);
 	BenchMarkByName<SymmetricCipher>("Twofish/CTR");
@@ -21,6 +21,8 @@
 #include "pssr.h"
 #include "oids.h"
 #include "randpool.h"
+#include "nbtheory.h"
+#include "keycache.h"
 
 #include <time.h>
 #include <math.h>
@@ -227,6 +229,60 @@ void BenchMarkKeyAgreement(const char *filename, const char *name, double timeTo
 	BenchMarkAgreement(name, d, timeTotal);
 }
 
+//VC60 workaround: compiler bug triggered without the extra dummy parameters
+template <class SCHEME>
+void BenchMarkPrimalityTest(const char *filename, const char *name, double timeTotal, SCHEME *x=NULL)
+{
+	FileSource f(filename, true, new HexDecoder());
+	typename SCHEME::PrivateKey key;
+	key.BERDecode(f);
+	const Integer &p = key.GetPrime1();
+
+	clock_t start = clock();
+	unsigned int i;
+	double timeTaken;
+	for (timeTaken=(double)0, i=0; timeTaken < timeTotal; timeTaken = double(clock() - start) / CLOCK_TICKS_PER_SECOND, i++)
+		RabinMillerTest(GlobalRNG(), p, 1);
+
+	OutputResultOperations(name, "Primality Test", false, i, timeTaken);
+}
+
+void BenchMarkPublicKeyLoad(const char *filename, const char *name, double timeTotal)
+{
+	FileSource f(filename, true, new HexDecoder());
+	InvertibleRSAFunction priv;
+	priv.BERDecode(f);
+	std::string encoded;
+	StringSink sink(encoded);
+	RSAFunction(priv).DEREncode(sink);
+	const byte *data = (const byte *)encoded.data();
+
+	clock_t start = clock();
+	unsigned int i;
+	double timeTaken;
+	for (timeTaken=(double)0, i=0; timeTaken < timeTotal; timeTaken = double(clock() - start) / CLOCK_TICKS_PER_SECOND, i++)
+	{
+		RSAFunction key;
+		StringStore store(encoded);
+		key.BERDecode(store);
+	}
+	OutputResultOperations(name, "Public Key Load", false, i, timeTaken);
+
+	start = clock();
+	for (timeTaken=(double)0, i=0; timeTaken < timeTotal; timeTaken = double(clock() - start) / CLOCK_TICKS_PER_SECOND, i++)
+	{
+		RSAFunction key;
+		key.BERDecodeSubjectPublicKeyInfo(data, encoded.size());
+	}
+	OutputResultOperations(name, "Public Key Load In Place", false, i, timeTaken);
+
+	PublicKeyCache cache;
+	start = clock();
+	for (timeTaken=(double)0, i=0; timeTaken < timeTotal; timeTaken = double(clock() - start) / CLOCK_TICKS_PER_SECOND, i++)
+		cache.GetRSAFunction(data, encoded.size());
+	OutputResultOperations(name, "Public Key Cache Lookup", false, i, timeTaken);
+}
+
 extern double g_hertz;
 
 void BenchmarkAll2(double t, double hertz)
@@ -313,5 +369,13 @@ void BenchmarkAll2(double t, double hertz)
 		BenchMarkKeyGen("ECMQVC over GF(2^n) 233", ecmqvc, t);
 		BenchMarkAgreement("ECMQVC over GF(2^n) 233", ecmqvc, t);
 	}
+
+	cout << "\n<TBODY style=\"background: white\">";
+	BenchMarkPrimalityTest<RSA>("TestData/rsa1024.dat", "Rabin-Miller 512", t);
+	BenchMarkPrimalityTest<RSA>("TestData/rsa2048.dat", "Rabin-Miller 1024", t);
+
+	cout << "\n<TBODY style=\"background: yellow\">";
+	BenchMarkPublicKeyLoad("TestData/rsa1024.dat", "RSA 1024", t);
+	BenchMarkPublicKeyLoad("TestData/rsa2048.dat", "RSA 2048", t);
 	cout << "</TABLE>" << endl;
 }
@@ -46,6 +46,15 @@
 // set the name of Rijndael cipher, was "Rijndael" before version 5.3
 #define CRYPTOPP_RIJNDAEL_NAME "AES"
 
+// Integers of up to this many bits keep their words inside the Integer object rather than
+// on the heap, which saves an allocation and a wipe-and-free for every temporary. Every
+// Integer grows by this many bits, so the default covers elliptic curve values and the
+// halves of an RSA-2048 modulus, where the allocation is a large part of the cost, rather
+// than whole RSA moduli. Define as 0 to always use the heap.
+#ifndef CRYPTOPP_INTEGER_INLINE_BITS
+#define CRYPTOPP_INTEGER_INLINE_BITS 1024
+#endif
+
 // ***************** Important Settings Again ********************
 // But the defaults should be ok.
 
@@ -246,6 +255,10 @@ NAMESPACE_END
 #define CRYPTOPP_UNCAUGHT_EXCEPTION_AVAILABLE
 #endif
 
+#if __cplusplus >= 201103L || defined(__GXX_EXPERIMENTAL_CXX0X__) || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#define CRYPTOPP_RVALUE_REFERENCES_AVAILABLE
+#endif
+
 #ifdef CRYPTOPP_DISABLE_X86ASM		// for backwards compatibility: this macro had both meanings
 #define CRYPTOPP_DISABLE_ASM
 #define CRYPTOPP_DISABLE_SSE2
@@ -21,6 +21,10 @@
 #include <emmintrin.h>
 #endif
 
+#if defined(_MSC_VER) && _MSC_VER >= 1600
+#include <immintrin.h>
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
 #ifdef CRYPTOPP_CPUID_AVAILABLE
@@ -146,7 +150,44 @@ static bool TrySSE2()
 #endif
 }
 
-bool g_hasISSE = false, g_hasSSE2 = false, g_hasSSSE3 = false, g_hasMMX = false, g_hasAESNI = false, g_hasCLMUL = false, g_isP4 = false;
+// leaf 7 takes a sub-leaf in ecx, which CpuId() leaves unset
+static bool CpuIdCount(word32 input, word32 count, word32 *output)
+{
+#if defined(_MSC_VER) && _MSC_VER >= 1500
+	__cpuidex((int *)output, input, count);
+	return true;
+#elif defined(CRYPTOPP_MS_STYLE_INLINE_ASSEMBLY)
+	return false;
+#else
+	asm
+	(
+#if CRYPTOPP_BOOL_X86
+		"push %%ebx; cpuid; mov %%ebx, %%edi; pop %%ebx"
+#else
+		"pushq %%rbx; cpuid; mov %%ebx, %%edi; popq %%rbx"
+#endif
+		: "=a" (output[0]), "=D" (output[1]), "=c" (output[2]), "=d" (output[3])
+		: "a" (input), "c" (count)
+	);
+	return true;
+#endif
+}
+
+// the register state the OS saves on a context switch; only meaningful when OSXSAVE is set
+static word64 GetXCR0()
+{
+#if defined(_MSC_VER) && _MSC_VER >= 1600
+	return _xgetbv(0);
+#elif defined(CRYPTOPP_MS_STYLE_INLINE_ASSEMBLY)
+	return 0;
+#else
+	word32 a, d;
+	asm (".byte 0x0f, 0x01, 0xd0" : "=a" (a), "=d" (d) : "c" (0));	// xgetbv
+	return ((word64)d << 32) | a;
+#endif
+}
+
+bool g_hasISSE = false, g_hasSSE2 = false, g_hasSSSE3 = false, g_hasMMX = false, g_hasAESNI = false, g_hasCLMUL = false, g_hasSSE42 = false, g_hasAVX2 = false, g_isP4 = false;
 word32 g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
 
 void DetectX86Features()
@@ -176,6 +217,22 @@ void DetectX86Features()
 	  g_hasAESNI = g_hasSSE2 && (cpuid1[2] & (1<<25));
 	  g_hasCLMUL = g_hasSSE2 && (cpuid1[2] & (1<<1));
 
+	  // SSE3, SSSE3, CMPXCHG16B, SSE4.1, SSE4.2 and POPCNT
+	  const word32 v2Mask = (1<<0) | (1<<9) | (1<<13) | (1<<19) | (1<<20) | (1<<23);
+	  g_hasSSE42 = g_hasSSE2 && (cpuid1[2] & v2Mask) == v2Mask;
+
+	  // AVX, FMA, MOVBE, F16C and OSXSAVE, then AVX2, BMI1 and BMI2 in leaf 7 and LZCNT in leaf 0x80000001
+	  const word32 v3Mask = (1<<12) | (1<<22) | (1<<27) | (1<<28) | (1<<29);
+	  if (g_hasSSE42 && (cpuid1[2] & v3Mask) == v3Mask && cpuid[0] >= 7 && (GetXCR0() & 6) == 6)
+	  {
+		  word32 cpuid7[4], cpuid8[4];
+		  const word32 leaf7Mask = (1<<3) | (1<<5) | (1<<8);
+		  if (CpuIdCount(7, 0, cpuid7) && (cpuid7[1] & leaf7Mask) == leaf7Mask
+			  && CpuId(0x80000000, cpuid8) && cpuid8[0] >= 0x80000001
+			  && CpuId(0x80000001, cpuid8))
+			  g_hasAVX2 = (cpuid8[2] & (1<<5)) != 0;
+	  }
+
 	  if ((cpuid1[3] & (1 << 25)) != 0)
 		  g_hasISSE = true;
 	  else
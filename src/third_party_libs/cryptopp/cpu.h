@@ -104,6 +104,8 @@ NAMESPACE_BEGIN(CryptoPP)
 extern CRYPTOPP_DLL bool g_hasSSSE3;
 extern CRYPTOPP_DLL bool g_hasAESNI;
 extern CRYPTOPP_DLL bool g_hasCLMUL;
+extern CRYPTOPP_DLL bool g_hasSSE42;
+extern CRYPTOPP_DLL bool g_hasAVX2;
 extern CRYPTOPP_DLL bool g_isP4;
 extern CRYPTOPP_DLL word32 g_cacheLineSize;
 CRYPTOPP_DLL void CRYPTOPP_API DetectX86Features();
@@ -157,6 +159,20 @@ inline bool HasCLMUL()
 	return g_hasCLMUL;
 }
 
+// true if the CPU supports all of x86-64-v2: SSE3, SSSE3, SSE4.1, SSE4.2, POPCNT and CMPXCHG16B
+inline bool HasSSE42()
+{
+	DetectX86Features();
+	return g_hasSSE42;
+}
+
+// true if the CPU and OS support all of x86-64-v3: AVX, AVX2, BMI1, BMI2, FMA, F16C, LZCNT and MOVBE
+inline bool HasAVX2()
+{
+	DetectX86Features();
+	return g_hasAVX2;
+}
+
 inline bool IsP4()
 {
 	DetectX86Features();
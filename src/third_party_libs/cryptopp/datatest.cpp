@@ -6,9 +6,20 @@
 #include "files.h"
 #include "trunhash.h"
 #include "queue.h"
+#include "aes.h"
+#include "modes.h"
+#include "cpu.h"
+#include "multiver.h"
+#include "trdlocal.h"
 #include "validate.h"
 #include <iostream>
+#include <sstream>
+#include <iomanip>
 #include <memory>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 USING_NAMESPACE(CryptoPP)
 USING_NAMESPACE(std)
@@ -22,26 +33,50 @@ public:
 	TestFailure() : Exception(OTHER_ERROR, "Validation test failed") {}
 };
 
-static const TestData *s_currentTestData = NULL;
+class TestError : public Exception
+{
+public:
+	TestError() : Exception(OTHER_ERROR, "Unexpected error during validation test") {}
+};
+
+// each thread running tests writes to its own buffer and draws from its own generator
+struct TestContext
+{
+	TestContext(std::ostream &out, RandomNumberGenerator &rng) : out(out), rng(rng) {}
+	std::ostream &out;
+	RandomNumberGenerator &rng;
+};
+
+static ThreadLocalStorage s_testContext;
+
+static std::ostream & TestOutput()
+{
+	TestContext *context = static_cast<TestContext *>(s_testContext.GetValue());
+	return context ? context->out : cout;
+}
+
+static RandomNumberGenerator & TestRNG()
+{
+	TestContext *context = static_cast<TestContext *>(s_testContext.GetValue());
+	return context ? context->rng : GlobalRNG();
+}
 
 static void OutputTestData(const TestData &v)
 {
 	for (TestData::const_iterator i = v.begin(); i != v.end(); ++i)
 	{
-		cerr << i->first << ": " << i->second << endl;
+		TestOutput() << i->first << ": " << i->second << endl;
 	}
 }
 
 static void SignalTestFailure()
 {
-	OutputTestData(*s_currentTestData);
 	throw TestFailure();
 }
 
 static void SignalTestError()
 {
-	OutputTestData(*s_currentTestData);
-	throw Exception(Exception::OTHER_ERROR, "Unexpected error during validation test");
+	throw TestError();
 }
 
 bool DataExists(const TestData &data, const char *name)
@@ -63,8 +98,8 @@ void RandomizedTransfer(BufferedTransformation &source, BufferedTransformation &
 	while (source.MaxRetrievable() > (finish ? 0 : 4096))
 	{
 		byte buf[4096+64];
-		size_t start = GlobalRNG().GenerateWord32(0, 63);
-		size_t len = GlobalRNG().GenerateWord32(1, UnsignedMin(4096U, 3*source.MaxRetrievable()/2));
+		size_t start = TestRNG().GenerateWord32(0, 63);
+		size_t len = TestRNG().GenerateWord32(1, UnsignedMin(4096U, 3*source.MaxRetrievable()/2));
 		len = source.Get(buf+start, len);
 		target.ChannelPut(channel, buf+start, len);
 	}
@@ -187,9 +222,9 @@ private:
 
 void TestKeyPairValidAndConsistent(CryptoMaterial &pub, const CryptoMaterial &priv)
 {
-	if (!pub.Validate(GlobalRNG(), 2+s_thorough))
+	if (!pub.Validate(TestRNG(), 2+s_thorough))
 		SignalTestFailure();
-	if (!priv.Validate(GlobalRNG(), 2+s_thorough))
+	if (!priv.Validate(TestRNG(), 2+s_thorough))
 		SignalTestFailure();
 
 	ByteQueue bq1, bq2;
@@ -212,7 +247,7 @@ void TestSignatureScheme(TestData &v)
 
 	if (test == "GenerateKey")
 	{
-		signer->AccessPrivateKey().GenerateRandom(GlobalRNG(), pairs);
+		signer->AccessPrivateKey().GenerateRandom(TestRNG(), pairs);
 		verifier->AccessPublicKey().AssignFrom(signer->AccessPrivateKey());
 	}
 	else
@@ -236,7 +271,7 @@ void TestSignatureScheme(TestData &v)
 		}
 		else if (test == "PublicKeyValid")
 		{
-			if (!verifier->GetMaterial().Validate(GlobalRNG(), 3))
+			if (!verifier->GetMaterial().Validate(TestRNG(), 3))
 				SignalTestFailure();
 			return;
 		}
@@ -252,11 +287,11 @@ void TestSignatureScheme(TestData &v)
 		TestKeyPairValidAndConsistent(verifier->AccessMaterial(), signer->GetMaterial());
 		VerifierFilter verifierFilter(*verifier, NULL, VerifierFilter::THROW_EXCEPTION);
 		verifierFilter.Put((const byte *)"abc", 3);
-		StringSource ss("abc", true, new SignerFilter(GlobalRNG(), *signer, new Redirector(verifierFilter)));
+		StringSource ss("abc", true, new SignerFilter(TestRNG(), *signer, new Redirector(verifierFilter)));
 	}
 	else if (test == "Sign")
 	{
-		SignerFilter f(GlobalRNG(), *signer, new HexEncoder(new FileSink(cout)));
+		SignerFilter f(TestRNG(), *signer, new HexEncoder(new FileSink(TestOutput())));
 		StringSource ss(GetDecodedDatum(v, "Message"), true, new Redirector(f));
 		SignalTestFailure();
 	}
@@ -302,7 +337,7 @@ void TestAsymmetricCipher(TestData &v)
 	if (test == "DecryptMatch")
 	{
 		std::string decrypted, expected = GetDecodedDatum(v, "Plaintext");
-		StringSource ss(GetDecodedDatum(v, "Ciphertext"), true, new PK_DecryptorFilter(GlobalRNG(), *decryptor, new StringSink(decrypted)));
+		StringSource ss(GetDecodedDatum(v, "Ciphertext"), true, new PK_DecryptorFilter(TestRNG(), *decryptor, new StringSink(decrypted)));
 		if (decrypted != expected)
 			SignalTestFailure();
 	}
@@ -392,10 +427,10 @@ void TestSymmetricCipher(TestData &v, const NameValuePairs &overrideParameters)
 			ciphertext = GetDecodedDatum(v, test == "EncryptionMCT" ? "Ciphertext" : "Plaintext");
 			if (encrypted != ciphertext)
 			{
-				std::cout << "incorrectly encrypted: ";
-				StringSource xx(encrypted, false, new HexEncoder(new FileSink(std::cout)));
+				TestOutput() << "incorrectly encrypted: ";
+				StringSource xx(encrypted, false, new HexEncoder(new FileSink(TestOutput())));
 				xx.Pump(256); xx.Flush(false);
-				std::cout << "\n";
+				TestOutput() << "\n";
 				SignalTestFailure();
 			}
 			return;
@@ -424,10 +459,10 @@ void TestSymmetricCipher(TestData &v, const NameValuePairs &overrideParameters)
 		}
 		if (test != "EncryptXorDigest" ? encrypted != ciphertext : xorDigest != ciphertextXorDigest)
 		{
-			std::cout << "incorrectly encrypted: ";
-			StringSource xx(encrypted, false, new HexEncoder(new FileSink(std::cout)));
+			TestOutput() << "incorrectly encrypted: ";
+			StringSource xx(encrypted, false, new HexEncoder(new FileSink(TestOutput())));
 			xx.Pump(2048); xx.Flush(false);
-			std::cout << "\n";
+			TestOutput() << "\n";
 			SignalTestFailure();
 		}
 		std::string decrypted;
@@ -436,16 +471,16 @@ void TestSymmetricCipher(TestData &v, const NameValuePairs &overrideParameters)
 		decFilter.MessageEnd();
 		if (decrypted != plaintext)
 		{
-			std::cout << "incorrectly decrypted: ";
-			StringSource xx(decrypted, false, new HexEncoder(new FileSink(std::cout)));
+			TestOutput() << "incorrectly decrypted: ";
+			StringSource xx(decrypted, false, new HexEncoder(new FileSink(TestOutput())));
 			xx.Pump(256); xx.Flush(false);
-			std::cout << "\n";
+			TestOutput() << "\n";
 			SignalTestFailure();
 		}
 	}
 	else
 	{
-		std::cout << "unexpected test name\n";
+		TestOutput() << "unexpected test name\n";
 		SignalTestError();
 	}
 }
@@ -476,7 +511,7 @@ void TestAuthenticatedSymmetricCipher(TestData &v, const NameValuePairs &overrid
 
 		std::string encrypted, decrypted;
 		AuthenticatedEncryptionFilter ef(*asc1, new StringSink(encrypted));
-		bool macAtBegin = !mac.empty() && !GlobalRNG().GenerateBit();	// test both ways randomly
+		bool macAtBegin = !mac.empty() && !TestRNG().GenerateBit();	// test both ways randomly
 		AuthenticatedDecryptionFilter df(*asc2, new StringSink(decrypted), macAtBegin ? AuthenticatedDecryptionFilter::MAC_AT_BEGIN : 0);
 
 		if (asc1->NeedsPrespecifiedDataLengths())
@@ -503,35 +538,35 @@ void TestAuthenticatedSymmetricCipher(TestData &v, const NameValuePairs &overrid
 
 		if (test == "Encrypt" && encrypted != ciphertext+mac)
 		{
-			std::cout << "incorrectly encrypted: ";
-			StringSource xx(encrypted, false, new HexEncoder(new FileSink(std::cout)));
+			TestOutput() << "incorrectly encrypted: ";
+			StringSource xx(encrypted, false, new HexEncoder(new FileSink(TestOutput())));
 			xx.Pump(2048); xx.Flush(false);
-			std::cout << "\n";
+			TestOutput() << "\n";
 			SignalTestFailure();
 		}
 		if (test == "Encrypt" && decrypted != plaintext)
 		{
-			std::cout << "incorrectly decrypted: ";
-			StringSource xx(decrypted, false, new HexEncoder(new FileSink(std::cout)));
+			TestOutput() << "incorrectly decrypted: ";
+			StringSource xx(decrypted, false, new HexEncoder(new FileSink(TestOutput())));
 			xx.Pump(256); xx.Flush(false);
-			std::cout << "\n";
+			TestOutput() << "\n";
 			SignalTestFailure();
 		}
 
 		if (ciphertext.size()+mac.size()-plaintext.size() != asc1->DigestSize())
 		{
-			std::cout << "bad MAC size\n";
+			TestOutput() << "bad MAC size\n";
 			SignalTestFailure();
 		}
 		if (df.GetLastResult() != (test == "Encrypt"))
 		{
-			std::cout << "MAC incorrectly verified\n";
+			TestOutput() << "MAC incorrectly verified\n";
 			SignalTestFailure();
 		}
 	}
 	else
 	{
-		std::cout << "unexpected test name\n";
+		TestOutput() << "unexpected test name\n";
 		SignalTestError();
 	}
 }
@@ -641,9 +676,9 @@ void OutputPair(const NameValuePairs &v, const char *name)
 	Integer x;
 	bool b = v.GetValue(name, x);
 	assert(b);
-	cout << name << ": \\\n    ";
-	x.Encode(HexEncoder(new FileSink(cout), false, 64, "\\\n    ").Ref(), x.MinEncodedSize());
-	cout << endl;
+	TestOutput() << name << ": \\\n    ";
+	x.Encode(HexEncoder(new FileSink(TestOutput()), false, 64, "\\\n    ").Ref(), x.MinEncodedSize());
+	TestOutput() << endl;
 }
 
 void OutputNameValuePairs(const NameValuePairs &v)
@@ -667,14 +702,33 @@ void OutputNameValuePairs(const NameValuePairs &v)
 	}
 }
 
-void TestDataFile(const std::string &filename, const NameValuePairs &overrideParameters, unsigned int &totalTests, unsigned int &failedTests)
+//! consecutive tests of one algorithm, which run in order on one thread
+struct TestGroup
+{
+	std::string algType, name;
+	const NameValuePairs *overrideParameters;
+	std::vector<TestData> tests;
+	//! for a FileList entry whose file couldn't be read, which then runs as one failing test
+	std::string error;
+};
+
+//! what running a TestGroup under one CPU dispatch variant produced
+struct TestGroupResult
+{
+	TestGroupResult() : totalTests(0), failedTests(0), milliseconds(0) {}
+	std::string output;
+	unsigned int totalTests, failedTests;
+	double milliseconds;
+};
+
+static void ParseTestDataFile(const std::string &filename, const NameValuePairs &overrideParameters, std::vector<TestGroup> &groups)
 {
 	std::ifstream file(filename.c_str());
 	if (!file.good())
 		throw Exception(Exception::OTHER_ERROR, "Can not open file " + filename + " for reading");
 	TestData v;
-	s_currentTestData = &v;
-	std::string name, value, lastAlgName;
+	std::string name, value;
+	TestGroup *group = NULL;
 
 	while (file)
 	{
@@ -690,66 +744,243 @@ void TestDataFile(const std::string &filename, const NameValuePairs &overridePar
 
 		if (name == "Test" && (s_thorough || v["SlowTest"] != "1"))
 		{
-			bool failed = true;
-			std::string algType = GetRequiredDatum(v, "AlgorithmType");
+			std::string algType = GetRequiredDatum(v, "AlgorithmType"), error;
 
-			if (lastAlgName != GetRequiredDatum(v, "Name"))
+			if (algType == "FileList")
 			{
-				lastAlgName = GetRequiredDatum(v, "Name");
-				cout << "\nTesting " << algType.c_str() << " algorithm " << lastAlgName.c_str() << ".\n";
+				group = NULL;
+				try
+				{
+					ParseTestDataFile(GetRequiredDatum(v, "Test"), g_nullNameValuePairs, groups);
+					continue;
+				}
+				catch (CryptoPP::Exception &e)
+				{
+					error = e.what();
+				}
 			}
 
-			try
-			{
-				if (algType == "Signature")
-					TestSignatureScheme(v);
-				else if (algType == "SymmetricCipher")
-					TestSymmetricCipher(v, overrideParameters);
-				else if (algType == "AuthenticatedSymmetricCipher")
-					TestAuthenticatedSymmetricCipher(v, overrideParameters);
-				else if (algType == "AsymmetricCipher")
-					TestAsymmetricCipher(v);
-				else if (algType == "MessageDigest")
-					TestDigestOrMAC(v, true);
-				else if (algType == "MAC")
-					TestDigestOrMAC(v, false);
-				else if (algType == "FileList")
-					TestDataFile(GetRequiredDatum(v, "Test"), g_nullNameValuePairs, totalTests, failedTests);
-				else
-					SignalTestError();
-				failed = false;
-			}
-			catch (TestFailure &)
-			{
-				cout << "\nTest failed.\n";
-			}
-			catch (CryptoPP::Exception &e)
+			if (!group || group->name != GetRequiredDatum(v, "Name"))
 			{
-				cout << "\nCryptoPP::Exception caught: " << e.what() << endl;
+				groups.push_back(TestGroup());
+				group = &groups.back();
+				group->algType = algType;
+				group->name = GetRequiredDatum(v, "Name");
+				group->overrideParameters = &overrideParameters;
 			}
-			catch (std::exception &e)
+			group->tests.push_back(v);
+			if (algType == "FileList")
 			{
-				cout << "\nstd::exception caught: " << e.what() << endl;
+				group->error = error;
+				group = NULL;
 			}
+		}
+	}
+}
 
-			if (failed)
-			{
-				cout << "Skipping to next test.\n";
-				failedTests++;
-			}
+static void RunTestGroup(const TestGroup &group, const std::string &seed, TestGroupResult &result)
+{
+	std::ostringstream out;
+	OFB_Mode<AES>::Encryption rng((const byte *)seed.data(), 16, (const byte *)seed.data());
+	TestContext context(out, rng);
+	s_testContext.SetValue(&context);
+
+	out << "\nTesting " << group.algType << " algorithm " << group.name << ".\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::vector<TestData>::const_iterator i = group.tests.begin(); i != group.tests.end(); ++i)
+	{
+		TestData v = *i;
+		bool failed = true;
+
+		try
+		{
+			if (group.algType == "Signature")
+				TestSignatureScheme(v);
+			else if (group.algType == "SymmetricCipher")
+				TestSymmetricCipher(v, *group.overrideParameters);
+			else if (group.algType == "AuthenticatedSymmetricCipher")
+				TestAuthenticatedSymmetricCipher(v, *group.overrideParameters);
+			else if (group.algType == "AsymmetricCipher")
+				TestAsymmetricCipher(v);
+			else if (group.algType == "MessageDigest")
+				TestDigestOrMAC(v, true);
+			else if (group.algType == "MAC")
+				TestDigestOrMAC(v, false);
+			else if (group.algType == "FileList")
+				throw Exception(Exception::IO_ERROR, group.error);
 			else
-				cout << "." << flush;
+				SignalTestError();
+			failed = false;
+		}
+		catch (TestFailure &)
+		{
+			OutputTestData(v);
+			out << "\nTest failed.\n";
+		}
+		catch (TestError &e)
+		{
+			OutputTestData(v);
+			out << "\nCryptoPP::Exception caught: " << e.what() << endl;
+		}
+		catch (CryptoPP::Exception &e)
+		{
+			out << "\nCryptoPP::Exception caught: " << e.what() << endl;
+		}
+		catch (std::exception &e)
+		{
+			out << "\nstd::exception caught: " << e.what() << endl;
+		}
 
-			totalTests++;
+		if (failed)
+		{
+			out << "Skipping to next test.\n";
+			result.failedTests++;
 		}
+		else
+			out << ".";
+
+		result.totalTests++;
 	}
+
+	result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	result.output = out.str();
+	s_testContext.SetValue(NULL);
+}
+
+//! runs every group on a pool of threads, each group seeded from its own entry in seeds
+static void RunTestGroups(const std::vector<TestGroup> &groups, const std::vector<std::string> &seeds, std::vector<TestGroupResult> &results)
+{
+	results.assign(groups.size(), TestGroupResult());
+	std::atomic<size_t> next(0);
+
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < groups.size(); i = next++)
+			RunTestGroup(groups[i], seeds[i], results[i]);
+	};
+
+	unsigned int threadCount = STDMAX(1U, std::thread::hardware_concurrency());
+	threadCount = (unsigned int)STDMIN((size_t)threadCount, groups.size());
+	std::vector<std::thread> threads;
+	for (unsigned int i=1; i<threadCount; i++)
+		threads.push_back(std::thread(worker));
+	worker();
+	for (unsigned int i=0; i<threads.size(); i++)
+		threads[i].join();
+}
+
+//! a set of the instruction set extensions in cpu.h that the ciphers and hashes dispatch on,
+//! and the level of the kernels in multiver.h to go with them
+struct DispatchVariant
+{
+	const char *name;
+	bool ssse3, sse42, aesni, clmul, avx2;
+	MultiVersionLevel level;
+};
+
+//! the variants this CPU can run, from plain C++ up to everything it supports
+/*! The test vectors are run once under each, with the other flags in cpu.h
+	cleared, so that every code path a caller could be dispatched to is checked.
+	Levels whose kernels weren't built for this compiler are left out. */
+static std::vector<DispatchVariant> GetDispatchVariants()
+{
+	static const DispatchVariant all[] = {
+		{"baseline", false, false, false, false, false, MULTIVERSION_BASELINE},
+		{"x86-64-v2", true, true, false, false, false, MULTIVERSION_X86_64_V2},
+		{"x86-64-v2 with AES-NI and PCLMULQDQ", true, true, true, true, false, MULTIVERSION_X86_64_V2},
+		{"x86-64-v3 with AES-NI and PCLMULQDQ", true, true, true, true, true, MULTIVERSION_X86_64_V3},
+	};
+
+	std::vector<DispatchVariant> variants;
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+	DetectX86Features();
+	for (unsigned int i=0; i<sizeof(all)/sizeof(all[0]); i++)
+	{
+		const DispatchVariant &v = all[i];
+		if ((!v.ssse3 || g_hasSSSE3) && (!v.sse42 || g_hasSSE42) && (!v.aesni || g_hasAESNI) && (!v.clmul || g_hasCLMUL) && (!v.avx2 || g_hasAVX2)
+			&& GetMultiVersionKernels(v.level) != NULL)
+			variants.push_back(v);
+	}
+#else
+	variants.push_back(all[0]);
+	variants.back().name = "native";
+	variants.back().level = GetMultiVersionKernels().level;
+#endif
+	return variants;
+}
+
+//! returns false if the kernels for the variant's level aren't available
+static bool SelectDispatchVariant(const DispatchVariant &v)
+{
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+	g_hasSSSE3 = v.ssse3;
+	g_hasSSE42 = v.sse42;
+	g_hasAESNI = v.aesni;
+	g_hasCLMUL = v.clmul;
+	g_hasAVX2 = v.avx2;
+#endif
+	return SetMultiVersionLevelForTesting(v.level);
 }
 
 bool RunTestDataFile(const char *filename, const NameValuePairs &overrideParameters, bool thorough)
 {
 	s_thorough = thorough;
+	std::vector<TestGroup> groups;
+	ParseTestDataFile(filename, overrideParameters, groups);
+
+	std::vector<std::string> seeds(groups.size());
+	for (size_t i=0; i<groups.size(); i++)
+	{
+		seeds[i].resize(16);
+		GlobalRNG().GenerateBlock((byte *)&seeds[i][0], 16);
+	}
+
+	std::vector<DispatchVariant> variants = GetDispatchVariants();
+	std::vector<std::vector<TestGroupResult> > results(variants.size());
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+	const DispatchVariant native = {"native", g_hasSSSE3, g_hasSSE42, g_hasAESNI, g_hasCLMUL, g_hasAVX2, GetMultiVersionKernels().level};
+#else
+	const DispatchVariant native = {"native", false, false, false, false, false, GetMultiVersionKernels().level};
+#endif
+
 	unsigned int totalTests = 0, failedTests = 0;
-	TestDataFile(filename, overrideParameters, totalTests, failedTests);
+	for (size_t i=0; i<variants.size(); i++)
+	{
+		cout << "\nRunning with " << variants[i].name << " code paths.";
+		if (!SelectDispatchVariant(variants[i]))
+		{
+			// Running the previous variant's kernels under this name would check nothing.
+			cout << "\nFAILED: the kernels for these code paths are not available." << endl;
+			results[i].resize(groups.size());
+			failedTests++;
+			continue;
+		}
+		RunTestGroups(groups, seeds, results[i]);
+
+		for (size_t j=0; j<groups.size(); j++)
+		{
+			cout << results[i][j].output;
+			totalTests += results[i][j].totalTests;
+			failedTests += results[i][j].failedTests;
+		}
+		cout << endl;
+	}
+	SelectDispatchVariant(native);
+
+	std::ios_base::fmtflags flags = cout.flags();
+	std::streamsize precision = cout.precision();
+	cout << "\nMilliseconds per algorithm, under each set of code paths in turn:\n";
+	for (size_t j=0; j<groups.size(); j++)
+	{
+		cout << "  " << groups[j].name << ":";
+		for (size_t i=0; i<variants.size(); i++)
+			cout << " " << std::fixed << std::setprecision(1) << results[i][j].milliseconds;
+		cout << endl;
+	}
+	cout.flags(flags);
+	cout.precision(precision);
+
 	cout << dec << "\nTests complete. Total tests = " << totalTests << ". Failed tests = " << failedTests << ".\n";
 	if (failedTests != 0)
 		cout << "SOME TESTS FAILED!\n";
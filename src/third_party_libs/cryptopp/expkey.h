@@ -0,0 +1,157 @@
+#ifndef CRYPTOPP_EXPKEY_H
+#define CRYPTOPP_EXPKEY_H
+
+/*! \file
+	Immutable key schedules that can be shared between threads, and the per-operation
+	mode contexts that borrow them.
+*/
+
+#include "modes.h"
+#include "gcm.h"
+#include <memory>
+
+NAMESPACE_BEGIN(CryptoPP)
+
+//! immutable, reference-counted key schedule of a block cipher
+/*! An ExpandedKey runs key expansion for both directions of T_BlockCipher once, and for
+	16-byte block ciphers also derives the GHASH multiplication table used by GCM.
+	Copies share the same schedule, which is never modified after construction, so any
+	number of threads may create per-operation contexts (CTR_Mode_SharedKey, GCM_SharedKey
+	etc.) from one ExpandedKey at the same time without locking or repeating key setup.
+	The per-operation contexts only hold mode state (registers, counters, GHASH
+	accumulators) and keep the schedule alive for as long as they exist.
+*/
+template <class T_BlockCipher>
+class ExpandedKey
+{
+public:
+	ExpandedKey() {}
+	//! Name::TableSize() in params selects the GCM table size, as for GCM<T_BlockCipher>
+	ExpandedKey(const byte *key, size_t length, const NameValuePairs &params = g_nullNameValuePairs)
+		: m_schedule(new Schedule(key, length, params)) {}
+
+	bool IsNull() const {return !m_schedule;}
+
+	const BlockCipher & GetEncryption() const {return m_schedule->m_encryption;}
+	const BlockCipher & GetDecryption() const {return m_schedule->m_decryption;}
+	const byte * GetGCMTable() const {return m_schedule->m_gcmTable.begin();}
+	size_t GetGCMTableSize() const {return m_schedule->m_gcmTable.size();}
+
+private:
+	struct Schedule
+	{
+		Schedule(const byte *key, size_t length, const NameValuePairs &params)
+		{
+			m_encryption.SetKey(key, length, params);
+			m_decryption.SetKey(key, length, params);
+			if (m_encryption.BlockSize() == 16)
+			{
+				m_gcmTable.New(GCM_Base::MulTableSize(params, GCM_2K_Tables));
+				GCM_Base::BuildMulTable(m_encryption, m_gcmTable, m_gcmTable.size());
+			}
+		}
+
+		typename T_BlockCipher::Encryption m_encryption;
+		typename T_BlockCipher::Decryption m_decryption;
+		AlignedSecByteBlock m_gcmTable;
+	};
+
+	std::shared_ptr<const Schedule> m_schedule;
+};
+
+//! _
+template <class CIPHER, class BASE, CipherDir DIR>
+class CipherModeFinalTemplate_SharedKey : public CipherModeFinalTemplate_ExternalCipher<BASE>
+{
+public:
+	CipherModeFinalTemplate_SharedKey(const ExpandedKey<CIPHER> &key)
+		: m_key(key) {this->SetCipher(AccessSharedCipher());}
+	CipherModeFinalTemplate_SharedKey(const ExpandedKey<CIPHER> &key, const byte *iv, int feedbackSize = 0)
+		: m_key(key) {this->SetCipherWithIV(AccessSharedCipher(), iv, feedbackSize);}
+
+	void SetKey(const byte *, size_t, const NameValuePairs & = g_nullNameValuePairs)
+		{throw NotImplemented(this->AlgorithmName() + ": the key of a shared-key context is fixed by its ExpandedKey");}
+
+	static std::string CRYPTOPP_API StaticAlgorithmName()
+		{return CIPHER::StaticAlgorithmName() + "/" + BASE::StaticAlgorithmName();}
+
+private:
+	BlockCipher & AccessSharedCipher()
+	{
+		// cipher modes only call const members of the block cipher, so the schedule is never written
+		return const_cast<BlockCipher &>(DIR == ENCRYPTION ? m_key.GetEncryption() : m_key.GetDecryption());
+	}
+
+	ExpandedKey<CIPHER> m_key;
+};
+
+//! CFB mode, key schedule borrowed from an ExpandedKey
+template <class CIPHER>
+struct CFB_Mode_SharedKey : public CipherModeDocumentation
+{
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, ConcretePolicyHolder<Empty, CFB_EncryptionTemplate<AbstractPolicyHolder<CFB_CipherAbstractPolicy, CFB_ModePolicy> > >, ENCRYPTION> Encryption;
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, ConcretePolicyHolder<Empty, CFB_DecryptionTemplate<AbstractPolicyHolder<CFB_CipherAbstractPolicy, CFB_ModePolicy> > >, ENCRYPTION> Decryption;
+};
+
+//! OFB mode, key schedule borrowed from an ExpandedKey
+template <class CIPHER>
+struct OFB_Mode_SharedKey : public CipherModeDocumentation
+{
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, ConcretePolicyHolder<Empty, AdditiveCipherTemplate<AbstractPolicyHolder<AdditiveCipherAbstractPolicy, OFB_ModePolicy> > >, ENCRYPTION> Encryption;
+	typedef Encryption Decryption;
+};
+
+//! CTR mode, key schedule borrowed from an ExpandedKey
+template <class CIPHER>
+struct CTR_Mode_SharedKey : public CipherModeDocumentation
+{
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, ConcretePolicyHolder<Empty, AdditiveCipherTemplate<AbstractPolicyHolder<AdditiveCipherAbstractPolicy, CTR_ModePolicy> > >, ENCRYPTION> Encryption;
+	typedef Encryption Decryption;
+};
+
+//! ECB mode, key schedule borrowed from an ExpandedKey
+template <class CIPHER>
+struct ECB_Mode_SharedKey : public CipherModeDocumentation
+{
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, ECB_OneWay, ENCRYPTION> Encryption;
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, ECB_OneWay, DECRYPTION> Decryption;
+};
+
+//! CBC mode, key schedule borrowed from an ExpandedKey
+template <class CIPHER>
+struct CBC_Mode_SharedKey : public CipherModeDocumentation
+{
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, CBC_Encryption, ENCRYPTION> Encryption;
+	typedef CipherModeFinalTemplate_SharedKey<CIPHER, CBC_Decryption, DECRYPTION> Decryption;
+};
+
+//! _
+template <class T_BlockCipher, bool T_IsEncryption>
+class GCM_SharedKeyFinal : public GCM_SharedKeyBase
+{
+public:
+	GCM_SharedKeyFinal(const ExpandedKey<T_BlockCipher> &key)
+		: m_key(key) {SetSharedKey(key.GetEncryption(), key.GetGCMTable(), key.GetGCMTableSize());}
+	GCM_SharedKeyFinal(const ExpandedKey<T_BlockCipher> &key, const byte *iv, size_t ivLength)
+		: m_key(key) {SetSharedKey(key.GetEncryption(), key.GetGCMTable(), key.GetGCMTableSize()); Resynchronize(iv, (int)ivLength);}
+
+	static std::string StaticAlgorithmName()
+		{return T_BlockCipher::StaticAlgorithmName() + std::string("/GCM");}
+	bool IsForwardTransformation() const
+		{return T_IsEncryption;}
+
+private:
+	ExpandedKey<T_BlockCipher> m_key;
+};
+
+//! <a href="http://www.cryptolounge.org/wiki/GCM">GCM</a>, key schedule and hash table borrowed from an ExpandedKey
+template <class T_BlockCipher>
+struct GCM_SharedKey : public AuthenticatedSymmetricCipherDocumentation
+{
+	typedef GCM_SharedKeyFinal<T_BlockCipher, true> Encryption;
+	typedef GCM_SharedKeyFinal<T_BlockCipher, false> Decryption;
+};
+
+NAMESPACE_END
+
+#endif
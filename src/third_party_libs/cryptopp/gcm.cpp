@@ -129,39 +129,49 @@ inline __m128i CLMUL_GF_Mul(const __m128i &x, const __m128i &h, const __m128i &r
 }
 #endif
 
-void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
+size_t GCM_Base::MulTableSize(const NameValuePairs &params, GCM_TablesOption option)
 {
-	BlockCipher &blockCipher = AccessBlockCipher();
-	blockCipher.SetKey(userKey, keylength, params);
-
-	if (blockCipher.BlockSize() != REQUIRED_BLOCKSIZE)
-		throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
-
-	int tableSize, i, j, k;
+	int tableSize;
 
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
 	if (HasCLMUL())
 	{
 		params.GetIntValue(Name::TableSize(), tableSize);	// avoid "parameter not used" error
-		tableSize = s_clmulTableSizeInBlocks * REQUIRED_BLOCKSIZE;
+		return s_clmulTableSizeInBlocks * REQUIRED_BLOCKSIZE;
 	}
-	else
 #endif
-	{
-		if (params.GetIntValue(Name::TableSize(), tableSize))
-			tableSize = (tableSize >= 64*1024) ? 64*1024 : 2*1024;
-		else
-			tableSize = (GetTablesOption() == GCM_64K_Tables) ? 64*1024 : 2*1024;
+
+	if (params.GetIntValue(Name::TableSize(), tableSize))
+		tableSize = (tableSize >= 64*1024) ? 64*1024 : 2*1024;
+	else
+		tableSize = (option == GCM_64K_Tables) ? 64*1024 : 2*1024;
 
 #if defined(_MSC_VER) && (_MSC_VER >= 1300 && _MSC_VER < 1400)
-		// VC 2003 workaround: compiler generates bad code for 64K tables
-		tableSize = 2*1024;
+	// VC 2003 workaround: compiler generates bad code for 64K tables
+	tableSize = 2*1024;
 #endif
-	}
 
-	m_buffer.resize(3*REQUIRED_BLOCKSIZE + tableSize);
-	byte *table = MulTable();
-	byte *hashKey = HashKey();
+	return tableSize;
+}
+
+void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
+{
+	BlockCipher &blockCipher = AccessBlockCipher();
+	blockCipher.SetKey(userKey, keylength, params);
+
+	if (blockCipher.BlockSize() != REQUIRED_BLOCKSIZE)
+		throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
+
+	size_t tableSize = MulTableSize(params, GetTablesOption());
+	m_buffer.resize(2*REQUIRED_BLOCKSIZE + tableSize);
+	BuildMulTable(blockCipher, MulTable(), tableSize);
+}
+
+void GCM_Base::BuildMulTable(const BlockCipher &blockCipher, byte *table, size_t tableSize)
+{
+	int i, j, k;
+
+	FixedSizeAlignedSecBlock<byte, REQUIRED_BLOCKSIZE> hashKey;
 	memset(hashKey, 0, REQUIRED_BLOCKSIZE);
 	blockCipher.ProcessBlock(hashKey);
 
@@ -169,10 +179,10 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
 	if (HasCLMUL())
 	{
 		const __m128i r = s_clmulConstants[0];
-		__m128i h0 = _mm_shuffle_epi8(_mm_load_si128((__m128i *)hashKey), s_clmulConstants[1]);
+		__m128i h0 = _mm_shuffle_epi8(_mm_load_si128((__m128i *)hashKey.begin()), s_clmulConstants[1]);
 		__m128i h = h0;
 
-		for (i=0; i<tableSize; i+=32)
+		for (i=0; i<(int)tableSize; i+=32)
 		{
 			__m128i h1 = CLMUL_GF_Mul(h, h0, r);
 			_mm_storel_epi64((__m128i *)(table+i), h);
@@ -188,7 +198,7 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
 
 	word64 V0, V1;
 	typedef BlockGetAndPut<word64, BigEndian> Block;
-	Block::Get(hashKey)(V0)(V1);
+	Block::Get(hashKey.begin())(V0)(V1);
 
 	if (tableSize == 64*1024)
 	{
@@ -354,7 +364,7 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
 	if (HasCLMUL())
 	{
-		const __m128i *table = (const __m128i *)MulTable();
+		const __m128i *table = (const __m128i *)GetMulTable();
 		__m128i x = _mm_load_si128((__m128i *)HashBuffer());
 		const __m128i r = s_clmulConstants[0], bswapMask = s_clmulConstants[1], bswapMask2 = s_clmulConstants[2];
 
@@ -421,15 +431,16 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 	typedef BlockGetAndPut<word64, NativeByteOrder> Block;
 	word64 *hashBuffer = (word64 *)HashBuffer();
 
-	switch (2*(m_buffer.size()>=64*1024)
+	// the SSE2 assembly expects the table right behind the hash buffer, so a shared table takes the C++ path
+	switch (2*(GetMulTableSize()>=64*1024)
 #if CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)
-		+ HasSSE2()
+		+ (HasSSE2() && !m_sharedTable)
 #endif
 		)
 	{
 	case 0:		// non-SSE2 and 2K tables
 		{
-		byte *table = MulTable();
+		const byte *table = GetMulTable();
 		word64 x0 = hashBuffer[0], x1 = hashBuffer[1];
 
 		do
@@ -497,7 +508,7 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 
 	case 2:		// non-SSE2 and 64K tables
 		{
-		byte *table = MulTable();
+		const byte *table = GetMulTable();
 		word64 x0 = hashBuffer[0], x1 = hashBuffer[1];
 
 		do
@@ -602,8 +613,8 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 
 		AS2(	movdqa	xmm0, [WORD_REG(si)]			)
 
-		#define MUL_TABLE_0 WORD_REG(si) + 32
-		#define MUL_TABLE_1 WORD_REG(si) + 32 + 1024
+		#define MUL_TABLE_0 WORD_REG(si) + 16
+		#define MUL_TABLE_1 WORD_REG(si) + 16 + 1024
 		#define RED_TABLE AS_REG_7
 
 		ASL(0)
@@ -743,7 +754,7 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 		AS2(	movdqa	xmm0, [WORD_REG(si)]				)
 
 		#undef MUL_TABLE
-		#define MUL_TABLE(i,j) WORD_REG(si) + 32 + (i*4+j)*256*16
+		#define MUL_TABLE(i,j) WORD_REG(si) + 16 + (i*4+j)*256*16
 
 		ASL(1)
 		AS2(	movdqu	xmm1, [WORD_REG(cx)]				)
@@ -824,6 +835,28 @@ void GCM_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
 	m_ctr.ProcessData(mac, HashBuffer(), macSize);
 }
 
+void GCM_SharedKeyBase::SetSharedKey(const BlockCipher &blockCipher, const byte *table, size_t tableSize)
+{
+	if (blockCipher.BlockSize() != REQUIRED_BLOCKSIZE)
+		throw InvalidArgument(blockCipher.AlgorithmName() + "/GCM: block size of underlying block cipher is not 16");
+	if (!table || tableSize != MulTableSize(g_nullNameValuePairs, tableSize >= 64*1024 ? GCM_64K_Tables : GCM_2K_Tables))
+		throw InvalidArgument(blockCipher.AlgorithmName() + "/GCM: shared multiplication table is missing or has the wrong size");
+
+	// GCM only calls const members of the block cipher, so the schedule is never written through this pointer
+	m_sharedCipher = const_cast<BlockCipher *>(&blockCipher);
+	m_sharedTable = table;
+	m_sharedTableSize = tableSize;
+	m_buffer.resize(2*REQUIRED_BLOCKSIZE);
+
+	m_bufferedDataLength = 0;
+	m_state = State_KeySet;
+}
+
+void GCM_SharedKeyBase::SetKeyWithoutResync(const byte *, size_t, const NameValuePairs &)
+{
+	throw NotImplemented(AlgorithmName() + ": the key of a shared-key context is fixed by its ExpandedKey");
+}
+
 NAMESPACE_END
 
 #endif	// #ifndef CRYPTOPP_GENERATE_X64_MASM
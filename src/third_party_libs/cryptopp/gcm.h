@@ -42,7 +42,14 @@ public:
 	lword MaxMessageLength() const
 		{return ((W64LIT(1)<<39)-256)/8;}
 
+	//! size in bytes of the multiplication table selected by params (Name::TableSize()) or option
+	static size_t MulTableSize(const NameValuePairs &params, GCM_TablesOption option);
+	//! derive the hash key from a keyed block cipher and fill a table of MulTableSize() bytes
+	static void BuildMulTable(const BlockCipher &blockCipher, byte *table, size_t tableSize);
+
 protected:
+	GCM_Base() : m_sharedTable(NULL), m_sharedTableSize(0) {}
+
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
 		{return false;}
@@ -61,8 +68,11 @@ protected:
 
 	const BlockCipher & GetBlockCipher() const {return const_cast<GCM_Base *>(this)->AccessBlockCipher();};
 	byte *HashBuffer() {return m_buffer+REQUIRED_BLOCKSIZE;}
-	byte *HashKey() {return m_buffer+2*REQUIRED_BLOCKSIZE;}
-	byte *MulTable() {return m_buffer+3*REQUIRED_BLOCKSIZE;}
+	byte *MulTable() {return m_buffer+2*REQUIRED_BLOCKSIZE;}
+	const byte *GetMulTable() const
+		{return m_sharedTable ? m_sharedTable : m_buffer+2*REQUIRED_BLOCKSIZE;}
+	size_t GetMulTableSize() const
+		{return m_sharedTable ? m_sharedTableSize : m_buffer.size()-2*REQUIRED_BLOCKSIZE;}
 	inline void ReverseHashBufferIfNeeded();
 
 	class CRYPTOPP_DLL GCTR : public CTR_Mode_ExternalCipher::Encryption
@@ -72,11 +82,29 @@ protected:
 	};
 
 	GCTR m_ctr;
+	// multiplication table owned by someone else (see GCM_SharedKeyBase), used instead of MulTable()
+	const byte *m_sharedTable;
+	size_t m_sharedTableSize;
 	static word16 s_reductionTable[256];
 	static volatile bool s_reductionTableInitialized;
 	enum {REQUIRED_BLOCKSIZE = 16, HASH_BLOCKSIZE = 16};
 };
 
+//! GCM that borrows a keyed block cipher and multiplication table owned elsewhere (see ExpandedKey)
+class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE GCM_SharedKeyBase : public GCM_Base
+{
+protected:
+	GCM_SharedKeyBase() : m_sharedCipher(NULL) {}
+
+	void SetSharedKey(const BlockCipher &blockCipher, const byte *table, size_t tableSize);
+	void SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params);
+	GCM_TablesOption GetTablesOption() const
+		{return m_sharedTableSize >= 64*1024 ? GCM_64K_Tables : GCM_2K_Tables;}
+	BlockCipher & AccessBlockCipher() {return *m_sharedCipher;}
+
+	BlockCipher *m_sharedCipher;
+};
+
 //! .
 template <class T_BlockCipher, GCM_TablesOption T_TablesOption, bool T_IsEncryption>
 class GCM_Final : public GCM_Base
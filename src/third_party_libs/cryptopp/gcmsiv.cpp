@@ -0,0 +1,305 @@
+// gcmsiv.cpp - placed in the public domain
+
+#include "pch.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "gcmsiv.h"
+#include "cpu.h"
+#include "misc.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+/*
+POLYVAL works in GF(2^128) modulo P = x^128 + x^127 + x^126 + x^121 + 1, with blocks read as
+little-endian polynomials, and its multiplication is dot(a, b) = a * b * x^-128. The portable
+code folds the x^-128 factor into the stored hash key once per message, while the CLMUL code
+keeps H, dot(H,H), ... and uses a Montgomery style reduction that supplies x^-128 itself.
+*/
+
+// multiply by x
+inline static void PolyvalMulX(word64 &lo, word64 &hi)
+{
+	word64 carry = 0 - (hi >> 63);
+	hi = (hi << 1) | (lo >> 63);
+	lo = (lo << 1) ^ (carry & 1);
+	hi ^= carry & W64LIT(0xc200000000000000);
+}
+
+// multiply by x^-1: if v is odd, v+P is divisible by x
+inline static void PolyvalDivX(word64 &lo, word64 &hi)
+{
+	word64 odd = 0 - (lo & 1);
+	lo ^= odd & 1;
+	hi ^= odd & W64LIT(0xc200000000000000);
+	lo = (lo >> 1) | (hi << 63);
+	hi = (hi >> 1) | (odd & W64LIT(0x8000000000000000));
+}
+
+static void PolyvalMultiply(word64 &lo, word64 &hi, word64 hlo, word64 hhi)
+{
+	word64 zlo = 0, zhi = 0;
+	for (int i=0; i<128; i++)
+	{
+		word64 bit = 0 - (((i < 64) ? (lo >> i) : (hi >> (i-64))) & 1);
+		zlo ^= bit & hlo;
+		zhi ^= bit & hhi;
+		PolyvalMulX(hlo, hhi);
+	}
+	lo = zlo;
+	hi = zhi;
+}
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+static CRYPTOPP_ALIGN_DATA(16) const word64 s_polyvalConstant64[] = {
+	W64LIT(0x0000000000000001), W64LIT(0xc200000000000000)};
+static const __m128i *s_polyvalConstant = (const __m128i *)s_polyvalConstant64;
+
+#include "dirtyHackForGcc49.h"
+
+inline static void POLYVAL_MultiplyAccumulate(const __m128i &a, const __m128i &b, __m128i &lo, __m128i &mid, __m128i &hi)
+{
+	lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(a, b, 0x00));
+	hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(a, b, 0x11));
+	mid = _mm_xor_si128(mid, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01)));
+}
+
+// returns (hi * x^128 + mid * x^64 + lo) * x^-128 mod P
+inline static __m128i POLYVAL_Reduce(__m128i lo, __m128i mid, __m128i hi)
+{
+	const __m128i p = *s_polyvalConstant;
+	lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+	hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+	lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4e), _mm_clmulepi64_si128(lo, p, 0x10));
+	lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4e), _mm_clmulepi64_si128(lo, p, 0x10));
+	return _mm_xor_si128(hi, lo);
+}
+
+inline static __m128i POLYVAL_Dot(const __m128i &a, const __m128i &b)
+{
+	__m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+	POLYVAL_MultiplyAccumulate(a, b, lo, mid, hi);
+	return POLYVAL_Reduce(lo, mid, hi);
+}
+
+// hashKeys holds H^4, H^3, H^2, H in POLYVAL's dot product sense, so four blocks share one reduction
+static void POLYVAL_CLMUL(byte *accumulator, const byte *hashKeys, const byte *data, size_t length)
+{
+	const __m128i *h = (const __m128i *)hashKeys;
+	__m128i x = _mm_load_si128((const __m128i *)accumulator);
+
+	while (length >= 64)
+	{
+		__m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+		POLYVAL_MultiplyAccumulate(_mm_xor_si128(x, _mm_loadu_si128((const __m128i *)data)), h[0], lo, mid, hi);
+		POLYVAL_MultiplyAccumulate(_mm_loadu_si128((const __m128i *)(data+16)), h[1], lo, mid, hi);
+		POLYVAL_MultiplyAccumulate(_mm_loadu_si128((const __m128i *)(data+32)), h[2], lo, mid, hi);
+		POLYVAL_MultiplyAccumulate(_mm_loadu_si128((const __m128i *)(data+48)), h[3], lo, mid, hi);
+		x = POLYVAL_Reduce(lo, mid, hi);
+		data += 64;
+		length -= 64;
+	}
+
+	while (length >= 16)
+	{
+		x = POLYVAL_Dot(_mm_xor_si128(x, _mm_loadu_si128((const __m128i *)data)), h[3]);
+		data += 16;
+		length -= 16;
+	}
+
+	_mm_store_si128((__m128i *)accumulator, x);
+}
+#endif
+
+void GCM_SIV_Base::ThrowOneShotOnly() const
+{
+	throw NotImplemented(AlgorithmName() + ": only EncryptAndAuthenticate() and DecryptAndVerify() are supported");
+}
+
+void GCM_SIV_Base::UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params)
+{
+	BlockCipher &cipher = AccessKeyGenerationCipher();
+	if (cipher.BlockSize() != 16)
+		throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
+
+	cipher.SetKey(key, length, params);
+	m_keyLength = length;
+	m_buffer.New(COUNTER_OFFSET + COUNTER_BUFFER_SIZE);
+}
+
+// the per-message keys are the first halves of E(LE32(i) || nonce)
+void GCM_SIV_Base::DeriveMessageKeys(const byte *nonce)
+{
+	byte *blocks = m_buffer + SCRATCH_OFFSET;
+	unsigned int count = (m_keyLength == 32) ? 6 : 4;
+	for (unsigned int i=0; i<count; i++)
+	{
+		PutWord(false, LITTLE_ENDIAN_ORDER, blocks+16*i, (word32)i);
+		memcpy(blocks+16*i+4, nonce, 12);
+	}
+	AccessKeyGenerationCipher().AdvancedProcessBlocks(blocks, NULL, blocks, 16*count, BlockTransformation::BT_AllowParallel);
+
+	for (unsigned int i=1; i<count; i++)
+		memmove(blocks+8*i, blocks+16*i, 8);
+	SetHashKey(blocks);
+	AccessMessageCipher().SetKey(blocks+16, m_keyLength);
+	memset(blocks, 0, 16*count);
+}
+
+void GCM_SIV_Base::SetHashKey(const byte *hashKey)
+{
+	byte *table = m_buffer + HASH_KEY_OFFSET;
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasCLMUL())
+	{
+		__m128i *h = (__m128i *)table;
+		h[3] = _mm_loadu_si128((const __m128i *)hashKey);
+		h[2] = POLYVAL_Dot(h[3], h[3]);
+		h[1] = POLYVAL_Dot(h[2], h[3]);
+		h[0] = POLYVAL_Dot(h[1], h[3]);
+		return;
+	}
+#endif
+
+	word64 lo = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, hashKey);
+	word64 hi = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, hashKey+8);
+	for (int i=0; i<128; i++)
+		PolyvalDivX(lo, hi);
+	PutWord(true, LITTLE_ENDIAN_ORDER, table, lo);
+	PutWord(true, LITTLE_ENDIAN_ORDER, table+8, hi);
+}
+
+// absorb length/16 blocks into the accumulator
+void GCM_SIV_Base::Polyval(const byte *data, size_t length)
+{
+	byte *accumulator = m_buffer + ACCUMULATOR_OFFSET;
+	const byte *table = m_buffer + HASH_KEY_OFFSET;
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasCLMUL())
+	{
+		POLYVAL_CLMUL(accumulator, table, data, length);
+		return;
+	}
+#endif
+
+	word64 hlo = GetWord<word64>(true, LITTLE_ENDIAN_ORDER, table);
+	word64 hhi = GetWord<word64>(true, LITTLE_ENDIAN_ORDER, table+8);
+	word64 lo = GetWord<word64>(true, LITTLE_ENDIAN_ORDER, accumulator);
+	word64 hi = GetWord<word64>(true, LITTLE_ENDIAN_ORDER, accumulator+8);
+	for (; length >= 16; data += 16, length -= 16)
+	{
+		lo ^= GetWord<word64>(false, LITTLE_ENDIAN_ORDER, data);
+		hi ^= GetWord<word64>(false, LITTLE_ENDIAN_ORDER, data+8);
+		PolyvalMultiply(lo, hi, hlo, hhi);
+	}
+	PutWord(true, LITTLE_ENDIAN_ORDER, accumulator, lo);
+	PutWord(true, LITTLE_ENDIAN_ORDER, accumulator+8, hi);
+}
+
+void GCM_SIV_Base::PolyvalPadded(const byte *data, size_t length)
+{
+	size_t fullLength = length - length%16;
+	Polyval(data, fullLength);
+	if (fullLength < length)
+	{
+		byte *block = m_buffer + SCRATCH_OFFSET;
+		memset(block, 0, 16);
+		memcpy(block, data+fullLength, length-fullLength);
+		Polyval(block, 16);
+	}
+}
+
+void GCM_SIV_Base::CalculateTag(byte *tag, const byte *nonce, const byte *header, size_t headerLength, const byte *message, size_t messageLength)
+{
+	byte *accumulator = m_buffer + ACCUMULATOR_OFFSET;
+	memset(accumulator, 0, 16);
+	PolyvalPadded(header, headerLength);
+	PolyvalPadded(message, messageLength);
+
+	byte *lengths = m_buffer + SCRATCH_OFFSET;
+	PutWord(true, LITTLE_ENDIAN_ORDER, lengths, word64(headerLength)*8);
+	PutWord(true, LITTLE_ENDIAN_ORDER, lengths+8, word64(messageLength)*8);
+	Polyval(lengths, 16);
+
+	xorbuf(accumulator, nonce, 12);
+	accumulator[15] &= 0x7f;
+	AccessMessageCipher().ProcessBlock(accumulator, tag);
+}
+
+// CTR mode with the tag as initial counter block, incrementing its first four bytes as a little-endian word
+void GCM_SIV_Base::ProcessCTR(byte *outString, const byte *inString, size_t length, const byte *tag)
+{
+	BlockCipher &cipher = AccessMessageCipher();
+	byte *counters = m_buffer + COUNTER_OFFSET;
+	word32 counter = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, tag);
+
+	memcpy(counters, tag, 16);
+	counters[15] |= 0x80;
+	for (unsigned int i=16; i<COUNTER_BUFFER_SIZE; i+=16)
+		memcpy(counters+i+4, counters+4, 12);
+
+	while (length > 0)
+	{
+		size_t len = STDMIN(length, (size_t)COUNTER_BUFFER_SIZE);
+		size_t blocksLength = len - len%16;
+
+		for (size_t i=0; i<len; i+=16)
+			PutWord(true, LITTLE_ENDIAN_ORDER, counters+i, counter++);
+
+		cipher.AdvancedProcessBlocks(counters, inString, outString, blocksLength, BlockTransformation::BT_AllowParallel);
+		if (blocksLength < len)
+		{
+			byte *keystream = counters + blocksLength;
+			cipher.ProcessBlock(keystream);
+			xorbuf(outString+blocksLength, inString+blocksLength, keystream, len-blocksLength);
+		}
+
+		inString += len;
+		outString += len;
+		length -= len;
+	}
+}
+
+void GCM_SIV_Base::EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *message, size_t messageLength)
+{
+	if (macSize != DigestSize())
+		throw InvalidArgument(AlgorithmName() + ": MAC size must be " + IntToString(DigestSize()));
+	if (ThrowIfInvalidIVLength(ivLength) != IVSize())
+		throw InvalidArgument(AlgorithmName() + ": IV length must be " + IntToString(IVSize()));
+	if (headerLength > MaxHeaderLength() || messageLength > MaxMessageLength())
+		throw InvalidArgument(AlgorithmName() + ": header or message length exceeds the maximum");
+
+	SecByteBlock tag(16);
+	DeriveMessageKeys(iv);
+	CalculateTag(tag, iv, header, headerLength, message, messageLength);
+	ProcessCTR(ciphertext, message, messageLength, tag);
+	memcpy(mac, tag, 16);
+}
+
+bool GCM_SIV_Base::DecryptAndVerify(byte *message, const byte *mac, size_t macLength, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *ciphertext, size_t ciphertextLength)
+{
+	if (macLength != DigestSize())
+		throw InvalidArgument(AlgorithmName() + ": MAC size must be " + IntToString(DigestSize()));
+	if (ThrowIfInvalidIVLength(ivLength) != IVSize())
+		throw InvalidArgument(AlgorithmName() + ": IV length must be " + IntToString(IVSize()));
+	if (headerLength > MaxHeaderLength() || ciphertextLength > MaxMessageLength())
+		throw InvalidArgument(AlgorithmName() + ": header or message length exceeds the maximum");
+
+	SecByteBlock tag(16), expected(16);
+	memcpy(tag, mac, 16);
+	DeriveMessageKeys(iv);
+	ProcessCTR(message, ciphertext, ciphertextLength, tag);
+	CalculateTag(expected, iv, header, headerLength, message, ciphertextLength);
+
+	if (VerifyBufsEqual(expected, tag, 16))
+		return true;
+
+	memset(message, 0, ciphertextLength);
+	return false;
+}
+
+NAMESPACE_END
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef CRYPTOPP_GCMSIV_H
+#define CRYPTOPP_GCMSIV_H
+
+/*! \file
+	GCM-SIV (RFC 8452), a nonce misuse-resistant authenticated encryption mode.
+*/
+
+#include "cryptlib.h"
+#include "secblock.h"
+#include "seckey.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+//! .
+class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE GCM_SIV_Base : public AuthenticatedSymmetricCipher
+{
+public:
+	// AuthenticatedSymmetricCipher
+	std::string AlgorithmName() const
+		{return GetBlockCipher().AlgorithmName() + std::string("/GCM-SIV");}
+	size_t MinKeyLength() const
+		{return 16;}
+	size_t MaxKeyLength() const
+		{return 32;}
+	size_t DefaultKeyLength() const
+		{return 16;}
+	size_t GetValidKeyLength(size_t n) const
+		{return n <= 16 ? 16 : 32;}
+	bool IsValidKeyLength(size_t n) const
+		{return n == 16 || n == 32;}
+	unsigned int OptimalDataAlignment() const
+		{return GetBlockCipher().OptimalDataAlignment();}
+	IV_Requirement IVRequirement() const
+		{return UNIQUE_IV;}
+	unsigned int IVSize() const
+		{return 12;}
+	unsigned int DigestSize() const
+		{return 16;}
+	lword MaxHeaderLength() const
+		{return W64LIT(1)<<36;}
+	lword MaxMessageLength() const
+		{return W64LIT(1)<<36;}
+	bool IsRandomAccess() const
+		{return false;}
+	bool IsSelfInverting() const
+		{return false;}
+
+	//! the tag doubles as the initial counter, so the whole message must be available at once
+	void EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *message, size_t messageLength);
+	bool DecryptAndVerify(byte *message, const byte *mac, size_t macLength, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *ciphertext, size_t ciphertextLength);
+
+	// incremental processing is not possible, see EncryptAndAuthenticate()
+	void Resynchronize(const byte *iv, int ivLength=-1)
+		{ThrowOneShotOnly();}
+	void Update(const byte *input, size_t length)
+		{ThrowOneShotOnly();}
+	void ProcessData(byte *outString, const byte *inString, size_t length)
+		{ThrowOneShotOnly();}
+	void TruncatedFinal(byte *mac, size_t macSize)
+		{ThrowOneShotOnly();}
+
+protected:
+	void UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params);
+
+	virtual BlockCipher & AccessKeyGenerationCipher() =0;
+	virtual BlockCipher & AccessMessageCipher() =0;
+	const BlockCipher & GetBlockCipher() const
+		{return const_cast<GCM_SIV_Base *>(this)->AccessKeyGenerationCipher();}
+
+private:
+	void ThrowOneShotOnly() const;
+	void DeriveMessageKeys(const byte *nonce);
+	void SetHashKey(const byte *hashKey);
+	void Polyval(const byte *data, size_t length);
+	void PolyvalPadded(const byte *data, size_t length);
+	void CalculateTag(byte *tag, const byte *nonce, const byte *header, size_t headerLength, const byte *message, size_t messageLength);
+	void ProcessCTR(byte *outString, const byte *inString, size_t length, const byte *tag);
+
+	// m_buffer holds the hash key powers, the POLYVAL accumulator and a scratch area,
+	// followed by counter blocks for up to COUNTER_BUFFER_SIZE bytes per AdvancedProcessBlocks() call
+	enum {HASH_KEY_OFFSET = 0, ACCUMULATOR_OFFSET = 64, SCRATCH_OFFSET = 80, COUNTER_OFFSET = 176, COUNTER_BUFFER_SIZE = 4096};
+
+	unsigned int m_keyLength;
+	AlignedSecByteBlock m_buffer;
+};
+
+//! .
+template <class T_BlockCipher, bool T_IsEncryption>
+class GCM_SIV_Final : public GCM_SIV_Base
+{
+public:
+	static std::string StaticAlgorithmName()
+		{return T_BlockCipher::StaticAlgorithmName() + std::string("/GCM-SIV");}
+	bool IsForwardTransformation() const
+		{return T_IsEncryption;}
+
+private:
+	BlockCipher & AccessKeyGenerationCipher() {return m_keyGenerationCipher;}
+	BlockCipher & AccessMessageCipher() {return m_messageCipher;}
+
+	typename T_BlockCipher::Encryption m_keyGenerationCipher, m_messageCipher;
+};
+
+//! <a href="http://tools.ietf.org/html/rfc8452">GCM-SIV</a>
+/*! Repeating a nonce only reveals whether the same message was encrypted twice. Since the
+	synthetic IV is computed over the whole message before encryption starts, only
+	EncryptAndAuthenticate() and DecryptAndVerify() are supported. */
+template <class T_BlockCipher>
+struct GCM_SIV : public AuthenticatedSymmetricCipherDocumentation
+{
+	typedef GCM_SIV_Final<T_BlockCipher, true> Encryption;
+	typedef GCM_SIV_Final<T_BlockCipher, false> Decryption;
+};
+
+NAMESPACE_END
+
+#endif
@@ -3,10 +3,128 @@
 #include "pch.h"
 #include "misc.h"
 #include "gf2_32.h"
+#include "cpu.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+#include "dirtyHackForGcc49.h"
+
+// k holds the reciprocal x^32 + r in its low half and the modulus x^32 + m in its high half
+inline static __m128i CLMUL_Constants(word32 m, word32 r)
+{
+	return _mm_set_epi32(1, (int)m, 1, (int)r);
+}
+
+// reduces the product in the low 64 bits of c: with q = ((c >> 32) * reciprocal) >> 32,
+// which is c / (x^32 + m) rounded down since c has degree < 64, c - q * (x^32 + m) is the remainder
+inline static word32 CLMUL_Reduce(const __m128i &c, const __m128i &k)
+{
+	__m128i q = _mm_srli_epi64(_mm_clmulepi64_si128(_mm_srli_epi64(c, 32), k, 0x00), 32);
+	return (word32)_mm_cvtsi128_si32(_mm_xor_si128(c, _mm_clmulepi64_si128(q, k, 0x10)));
+}
+
+inline static word32 CLMUL_Multiply(word32 a, word32 b, const __m128i &k)
+{
+	return CLMUL_Reduce(_mm_clmulepi64_si128(_mm_cvtsi32_si128((int)a), _mm_cvtsi32_si128((int)b), 0x00), k);
+}
+
+inline static word32 CLMUL_SquareN(word32 a, unsigned int n, const __m128i &k)
+{
+	while (n--)
+		a = CLMUL_Multiply(a, a, k);
+	return a;
+}
+
+// the products are added unreduced, since reduction is linear, and reduced once at the end
+static word32 CLMUL_InnerProduct(const word32 *a, const word32 *b, size_t n, const __m128i &k)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i c0 = zero, c1 = zero;
+
+	for (; n >= 4; a += 4, b += 4, n -= 4)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i *)a), y = _mm_loadu_si128((const __m128i *)b);
+		__m128i x01 = _mm_unpacklo_epi32(x, zero), y01 = _mm_unpacklo_epi32(y, zero);
+		__m128i x23 = _mm_unpackhi_epi32(x, zero), y23 = _mm_unpackhi_epi32(y, zero);
+		c0 = _mm_xor_si128(c0, _mm_clmulepi64_si128(x01, y01, 0x00));
+		c1 = _mm_xor_si128(c1, _mm_clmulepi64_si128(x01, y01, 0x11));
+		c0 = _mm_xor_si128(c0, _mm_clmulepi64_si128(x23, y23, 0x00));
+		c1 = _mm_xor_si128(c1, _mm_clmulepi64_si128(x23, y23, 0x11));
+	}
+
+	for (; n; a++, b++, n--)
+		c0 = _mm_xor_si128(c0, _mm_clmulepi64_si128(_mm_cvtsi32_si128((int)*a), _mm_cvtsi32_si128((int)*b), 0x00));
+
+	return CLMUL_Reduce(_mm_xor_si128(c0, c1), k);
+}
+
+// a^-1 = a^(2^32-2) = (a^(2^31-1))^2, building a^(2^i-1) for i = 1, 2, 3, 6, 7, 14, 15, 30, 31
+// from a^(2^(i+j)-1) = (a^(2^i-1))^(2^j) * a^(2^j-1)
+static word32 CLMUL_MultiplicativeInverse(word32 a, const __m128i &k)
+{
+	word32 b1 = a;
+	word32 b2 = CLMUL_Multiply(CLMUL_SquareN(b1, 1, k), b1, k);
+	word32 b3 = CLMUL_Multiply(CLMUL_SquareN(b2, 1, k), b1, k);
+	word32 b6 = CLMUL_Multiply(CLMUL_SquareN(b3, 3, k), b3, k);
+	word32 b7 = CLMUL_Multiply(CLMUL_SquareN(b6, 1, k), b1, k);
+	word32 b14 = CLMUL_Multiply(CLMUL_SquareN(b7, 7, k), b7, k);
+	word32 b15 = CLMUL_Multiply(CLMUL_SquareN(b14, 1, k), b1, k);
+	word32 b30 = CLMUL_Multiply(CLMUL_SquareN(b15, 15, k), b15, k);
+	word32 b31 = CLMUL_Multiply(CLMUL_SquareN(b30, 1, k), b1, k);
+	return CLMUL_SquareN(b31, 1, k);
+}
+#endif
+
+word32 GF2_32::BarrettReciprocal(word32 modulus)
+{
+	// long division of x^64 by x^32 + modulus, one bit of the dividend at a time
+	const word64 p = (W64LIT(1) << 32) | modulus;
+	word64 r = 0, q = 0;
+	for (int i=64; i>=0; --i)
+	{
+		r = (r << 1) | (i == 64);
+		q <<= 1;
+		if (r >> 32)
+		{
+			r ^= p;
+			q |= 1;
+		}
+	}
+	return (word32)q;
+}
+
 GF2_32::Element GF2_32::Multiply(Element a, Element b) const
+{
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasCLMUL())
+		return CLMUL_Multiply(a, b, CLMUL_Constants(m_modulus, m_reciprocal));
+#endif
+	return PortableMultiply(a, b);
+}
+
+GF2_32::Element GF2_32::InnerProduct(const Element *a, const Element *b, size_t n) const
+{
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasCLMUL())
+		return CLMUL_InnerProduct(a, b, n, CLMUL_Constants(m_modulus, m_reciprocal));
+#endif
+	Element result = 0;
+	for (size_t i=0; i<n; i++)
+		result ^= PortableMultiply(a[i], b[i]);
+	return result;
+}
+
+GF2_32::Element GF2_32::MultiplicativeInverse(Element a) const
+{
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasCLMUL())
+		return CLMUL_MultiplicativeInverse(a, CLMUL_Constants(m_modulus, m_reciprocal));
+#endif
+	return PortableMultiplicativeInverse(a);
+}
+
+GF2_32::Element GF2_32::PortableMultiply(Element a, Element b) const
 {
 	word32 table[4];
 	table[0] = 0;
@@ -43,7 +161,7 @@ GF2_32::Element GF2_32::Multiply(Element a, Element b) const
 #endif
 }
 
-GF2_32::Element GF2_32::MultiplicativeInverse(Element a) const
+GF2_32::Element GF2_32::PortableMultiplicativeInverse(Element a) const
 {
 	if (a <= 1)		// 1 is a special case
 		return a;
@@ -6,13 +6,17 @@
 NAMESPACE_BEGIN(CryptoPP)
 
 //! GF(2^32) with polynomial basis
+/*! The modulus is x^32 plus the given polynomial of lower degree. On CPUs
+	with PCLMULQDQ, Multiply() and InnerProduct() use carry-less multiplication
+	and a Barrett reduction, and MultiplicativeInverse() uses Itoh-Tsujii
+	exponentiation. The results are the same as the portable code's. */
 class GF2_32
 {
 public:
 	typedef word32 Element;
 	typedef int RandomizationParameter;
 
-	GF2_32(word32 modulus=0x0000008D) : m_modulus(modulus) {}
+	GF2_32(word32 modulus=0x0000008D) : m_modulus(modulus), m_reciprocal(BarrettReciprocal(modulus)) {}
 
 	Element RandomElement(RandomNumberGenerator &rng, int ignored = 0) const
 		{return rng.GenerateWord32();}
@@ -57,8 +61,17 @@ public:
 	Element Divide(Element a, Element b) const
 		{return Multiply(a, MultiplicativeInverse(b));}
 
+	//! returns the sum of a[i]*b[i] for i from 0 to n-1
+	Element InnerProduct(const Element *a, const Element *b, size_t n) const;
+
 private:
-	word32 m_modulus;
+	// the low 32 bits of x^64 / (x^32 + modulus), whose x^32 term is always set
+	static word32 BarrettReciprocal(word32 modulus);
+
+	Element PortableMultiply(Element a, Element b) const;
+	Element PortableMultiplicativeInverse(Element a) const;
+
+	word32 m_modulus, m_reciprocal;
 };
 
 NAMESPACE_END
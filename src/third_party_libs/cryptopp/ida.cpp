@@ -180,12 +180,12 @@ void RawIDA::ProcessInputQueues()
 			if (m_outputToInput[i] != m_threshold)
 				m_outputQueues[i].PutWord32(m_y[m_outputToInput[i]]);
 			else if (m_v[i].size() == m_threshold)
-				m_outputQueues[i].PutWord32(BulkPolynomialInterpolateAt(field, m_y.begin(), m_v[i].begin(), m_threshold));
+				m_outputQueues[i].PutWord32(field.InnerProduct(m_y.begin(), m_v[i].begin(), m_threshold));
 			else
 			{
 				m_u.resize(m_threshold);
 				PrepareBulkPolynomialInterpolationAt(field, m_u.begin(), m_outputChannelIds[i], &(m_inputChannelIds[0]), m_w.begin(), m_threshold);
-				m_outputQueues[i].PutWord32(BulkPolynomialInterpolateAt(field, m_y.begin(), m_u.begin(), m_threshold));
+				m_outputQueues[i].PutWord32(field.InnerProduct(m_y.begin(), m_u.begin(), m_threshold));
 			}
 		}
 	}
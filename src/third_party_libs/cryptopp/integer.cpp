@@ -2766,6 +2766,15 @@ Integer::Integer(const Integer& t)
 	CopyWords(reg, t.reg, reg.size());
 }
 
+#ifdef CRYPTOPP_RVALUE_REFERENCES_AVAILABLE
+Integer::Integer(Integer&& t)
+	: reg(2), sign(POSITIVE)
+{
+	reg[0] = reg[1] = 0;
+	TakeValue(t);
+}
+#endif
+
 Integer::Integer(Sign s, lword value)
 	: reg(2), sign(s)
 {
@@ -2879,6 +2888,16 @@ bool Integer::operator!() const
 	return IsNegative() ? false : (reg[0]==0 && WordCount()==0);
 }
 
+// take t's storage when it already has the size operator= would give it, otherwise copy,
+// so that reg never carries more leading zero words than the modular arithmetic expects
+void Integer::TakeValue(Integer &t)
+{
+	if (t.reg.size() == RoundupSize(t.WordCount()))
+		swap(t);
+	else
+		*this = t;
+}
+
 Integer& Integer::operator=(const Integer& t)
 {
 	if (this != &t)
@@ -3062,8 +3081,26 @@ unsigned int Integer::BitCount() const
 
 void Integer::Decode(const byte *input, size_t inputLen, Signedness s)
 {
-	StringStore store(input, inputLen);
-	Decode(store, inputLen, s);
+	// same as the BufferedTransformation version, but without going through a StringStore
+	sign = ((s==SIGNED) && inputLen>0 && (input[0] & 0x80)) ? NEGATIVE : POSITIVE;
+
+	while (inputLen>0 && (sign==POSITIVE ? input[0]==0 : input[0]==0xff))
+	{
+		input++;
+		inputLen--;
+	}
+
+	reg.CleanNew(RoundupSize(BytesToWords(inputLen)));
+
+	for (size_t i=inputLen; i > 0; i--)
+		reg[(i-1)/WORD_SIZE] |= word(*input++) << ((i-1)%WORD_SIZE)*8;
+
+	if (sign == NEGATIVE)
+	{
+		for (size_t i=inputLen; i<reg.size()*WORD_SIZE; i++)
+			reg[i/WORD_SIZE] |= word(0xff) << (i%WORD_SIZE)*8;
+		TwosComplement(reg, reg.size());
+	}
 }
 
 void Integer::Decode(BufferedTransformation &bt, size_t inputLen, Signedness s)
@@ -3680,6 +3717,14 @@ Integer Integer::Times(const Integer &b) const
 	return product;
 }
 
+Integer& Integer::MultiplyInPlace(const Integer &b)
+{
+	Integer product;
+	Multiply(product, *this, b);
+	TakeValue(product);
+	return *this;
+}
+
 /*
 void PositiveDivide(Integer &remainder, Integer &quotient,
 				   const Integer &dividend, const Integer &divisor)
@@ -3791,6 +3836,22 @@ Integer Integer::Modulo(const Integer &b) const
 	return remainder;
 }
 
+Integer& Integer::DivideInPlace(const Integer &b)
+{
+	Integer remainder, quotient;
+	Integer::Divide(remainder, quotient, *this, b);
+	TakeValue(quotient);
+	return *this;
+}
+
+Integer& Integer::ModuloInPlace(const Integer &b)
+{
+	Integer remainder, quotient;
+	Integer::Divide(remainder, quotient, *this, b);
+	TakeValue(remainder);
+	return *this;
+}
+
 void Integer::Divide(word &remainder, Integer &quotient, const Integer &dividend, word divisor)
 {
 	if (!divisor)
@@ -16,7 +16,11 @@ struct InitializeInteger	// used to initialize static variables
 	InitializeInteger();
 };
 
+#if CRYPTOPP_INTEGER_INLINE_BITS > 0
+typedef SecBlock<word, FixedSizeAllocatorWithCleanup<word, CRYPTOPP_INTEGER_INLINE_BITS/WORD_BITS, AllocatorWithCleanup<word, CRYPTOPP_BOOL_X86>, CRYPTOPP_BOOL_X86> > IntegerSecBlock;
+#else
 typedef SecBlock<word, AllocatorWithCleanup<word, CRYPTOPP_BOOL_X86> > IntegerSecBlock;
+#endif
 
 //! multiple precision integer and basic arithmetics
 /*! This class can represent positive and negative integers
@@ -68,6 +72,11 @@ public:
 		//! copy constructor
 		Integer(const Integer& t);
 
+#ifdef CRYPTOPP_RVALUE_REFERENCES_AVAILABLE
+		//! move constructor, t is left with an unspecified value
+		Integer(Integer&& t);
+#endif
+
 		//! convert from signed long
 		Integer(signed long value);
 
@@ -215,17 +224,21 @@ public:
 	//@{
 		//!
 		Integer&  operator=(const Integer& t);
+#ifdef CRYPTOPP_RVALUE_REFERENCES_AVAILABLE
+		//! move assignment, t is left with an unspecified value
+		Integer&  operator=(Integer&& t)	{if (this != &t) TakeValue(t); return *this;}
+#endif
 
 		//!
 		Integer&  operator+=(const Integer& t);
 		//!
 		Integer&  operator-=(const Integer& t);
 		//!
-		Integer&  operator*=(const Integer& t)	{return *this = Times(t);}
+		Integer&  operator*=(const Integer& t)	{return MultiplyInPlace(t);}
 		//!
-		Integer&  operator/=(const Integer& t)	{return *this = DividedBy(t);}
+		Integer&  operator/=(const Integer& t)	{return DivideInPlace(t);}
 		//!
-		Integer&  operator%=(const Integer& t)	{return *this = Modulo(t);}
+		Integer&  operator%=(const Integer& t)	{return ModuloInPlace(t);}
 		//!
 		Integer&  operator/=(word t)  {return *this = DividedBy(t);}
 		//!
@@ -236,6 +249,15 @@ public:
 		//!
 		Integer&  operator>>=(size_t);
 
+		//! set *this to *this * b without creating a temporary the size of the product
+		Integer&  MultiplyInPlace(const Integer &b);
+		//! set *this to *this * *this
+		Integer&  SquareInPlace()	{return MultiplyInPlace(*this);}
+		//! set *this to the quotient of *this / b, as in DividedBy()
+		Integer&  DivideInPlace(const Integer &b);
+		//! set *this to the remainder of *this / b, as in Modulo()
+		Integer&  ModuloInPlace(const Integer &b);
+
 		//!
 		void Randomize(RandomNumberGenerator &rng, size_t bitcount);
 		//!
@@ -369,6 +391,8 @@ private:
 
 	Integer(word value, size_t length);
 
+	void TakeValue(Integer &t);
+
 	int PositiveCompare(const Integer &t) const;
 	friend void PositiveAdd(Integer &sum, const Integer &a, const Integer &b);
 	friend void PositiveSubtract(Integer &diff, const Integer &a, const Integer &b);
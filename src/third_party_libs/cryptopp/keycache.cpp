@@ -0,0 +1,87 @@
+// keycache.cpp - placed in the public domain
+
+#include "pch.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "keycache.h"
+#include "sha.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+PublicKeyCache::PublicKeyCache(size_t maxEntries)
+	: m_maxEntries(maxEntries), m_hits(0), m_misses(0)
+{
+	if (maxEntries == 0)
+		throw InvalidArgument("PublicKeyCache: maxEntries must be at least 1");
+}
+
+PublicKeyCache::RSAFunctionPtr PublicKeyCache::GetRSAFunction(const byte *encodedKey, size_t length)
+{
+	std::string digest(SHA256::DIGESTSIZE, '\0');
+	SHA256().CalculateDigest((byte *)&digest[0], encodedKey, length);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		EntryMap::iterator it = m_index.find(digest);
+		if (it != m_index.end())
+		{
+			m_entries.splice(m_entries.begin(), m_entries, it->second);
+			m_hits++;
+			return it->second->second;
+		}
+		m_misses++;
+	}
+
+	// decode without holding the lock, so that misses on different keys don't wait for each other
+	std::shared_ptr<RSAFunction> key(new RSAFunction);
+	key->BERDecodeSubjectPublicKeyInfo(encodedKey, length);
+	key->Precompute();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	EntryMap::iterator it = m_index.find(digest);
+	if (it != m_index.end())
+	{
+		// another thread decoded the same key meanwhile
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return it->second->second;
+	}
+
+	m_entries.push_front(EntryList::value_type(digest, key));
+	m_index[digest] = m_entries.begin();
+	if (m_entries.size() > m_maxEntries)
+	{
+		m_index.erase(m_entries.back().first);
+		m_entries.pop_back();
+	}
+	return key;
+}
+
+size_t PublicKeyCache::GetSize() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries.size();
+}
+
+lword PublicKeyCache::GetHits() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hits;
+}
+
+lword PublicKeyCache::GetMisses() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_misses;
+}
+
+void PublicKeyCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_index.clear();
+}
+
+NAMESPACE_END
+
+#endif
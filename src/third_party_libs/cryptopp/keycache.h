@@ -0,0 +1,55 @@
+#ifndef CRYPTOPP_KEYCACHE_H
+#define CRYPTOPP_KEYCACHE_H
+
+/*! \file
+	Bounded cache of decoded public keys, for peers whose keys arrive over and over
+	in serialized form.
+*/
+
+#include "rsa.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(CryptoPP)
+
+//! LRU cache of decoded RSA public keys, keyed by the SHA-256 hash of their encoding
+/*! GetRSAFunction() decodes an X.509 SubjectPublicKeyInfo with
+	RSAFunction::BERDecodeSubjectPublicKeyInfo() and calls Precompute() on the result, so that
+	later lookups of the same bytes return a key whose Montgomery form is ready. Once more than
+	GetMaxEntries() keys are cached, the least recently used one is dropped. The cache locks
+	internally, and the keys it returns are never modified, so both may be shared between
+	threads. Verifiers can be built from a returned key as from any other RSAFunction.
+*/
+class CRYPTOPP_DLL PublicKeyCache
+{
+public:
+	typedef std::shared_ptr<const RSAFunction> RSAFunctionPtr;
+
+	explicit PublicKeyCache(size_t maxEntries = 1024);
+
+	//! return the key encoded in encodedKey, decoding it only if it isn't cached
+	/*! throws BERDecodeErr if encodedKey isn't exactly one RSA SubjectPublicKeyInfo */
+	RSAFunctionPtr GetRSAFunction(const byte *encodedKey, size_t length);
+
+	size_t GetMaxEntries() const {return m_maxEntries;}
+	size_t GetSize() const;
+	lword GetHits() const;
+	lword GetMisses() const;
+	void Clear();
+
+private:
+	typedef std::list<std::pair<std::string, RSAFunctionPtr> > EntryList;
+	typedef std::unordered_map<std::string, EntryList::iterator> EntryMap;
+
+	size_t m_maxEntries;
+	mutable std::mutex m_mutex;
+	EntryList m_entries;	// most recently used first
+	EntryMap m_index;
+	lword m_hits, m_misses;
+};
+
+NAMESPACE_END
+
+#endif
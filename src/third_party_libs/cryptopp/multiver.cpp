@@ -0,0 +1,66 @@
+// multiver.cpp - chooses which compilation of mvkernel.h to run
+
+#include "pch.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "multiver.h"
+#include "cpu.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+namespace MultiVersion_Baseline {const MultiVersionKernels * GetKernels();}
+namespace MultiVersion_X86_64_V2 {const MultiVersionKernels * GetKernels();}
+namespace MultiVersion_X86_64_V3 {const MultiVersionKernels * GetKernels();}
+
+const MultiVersionKernels * GetMultiVersionKernels(MultiVersionLevel level)
+{
+	switch (level)
+	{
+	case MULTIVERSION_BASELINE:
+		return MultiVersion_Baseline::GetKernels();
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+	case MULTIVERSION_X86_64_V2:
+		return HasSSE42() ? MultiVersion_X86_64_V2::GetKernels() : NULL;
+	case MULTIVERSION_X86_64_V3:
+		return HasAVX2() ? MultiVersion_X86_64_V3::GetKernels() : NULL;
+#endif
+	default:
+		return NULL;
+	}
+}
+
+static const MultiVersionKernels & SelectMultiVersionKernels()
+{
+	for (int level = MULTIVERSION_LEVEL_COUNT-1; level > MULTIVERSION_BASELINE; level--)
+	{
+		const MultiVersionKernels *kernels = GetMultiVersionKernels(MultiVersionLevel(level));
+		if (kernels)
+			return *kernels;
+	}
+	return *MultiVersion_Baseline::GetKernels();
+}
+
+static const MultiVersionKernels *& SelectedMultiVersionKernels()
+{
+	static const MultiVersionKernels *s_kernels = &SelectMultiVersionKernels();
+	return s_kernels;
+}
+
+const MultiVersionKernels & GetMultiVersionKernels()
+{
+	return *SelectedMultiVersionKernels();
+}
+
+bool SetMultiVersionLevelForTesting(MultiVersionLevel level)
+{
+	const MultiVersionKernels *kernels = GetMultiVersionKernels(level);
+	if (!kernels)
+		return false;
+	SelectedMultiVersionKernels() = kernels;
+	return true;
+}
+
+NAMESPACE_END
+
+#endif
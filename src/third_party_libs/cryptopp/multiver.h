@@ -0,0 +1,52 @@
+#ifndef CRYPTOPP_MULTIVER_H
+#define CRYPTOPP_MULTIVER_H
+
+#include "config.h"
+#include <stddef.h>
+
+NAMESPACE_BEGIN(CryptoPP)
+
+//! instruction set levels that the kernels in mvkernel.h are compiled for
+enum MultiVersionLevel
+{
+	//! the compiler's default target
+	MULTIVERSION_BASELINE,
+	//! x86-64-v2: SSE4.2, SSSE3 and POPCNT
+	MULTIVERSION_X86_64_V2,
+	//! x86-64-v3: AVX2, BMI1, BMI2, FMA and MOVBE
+	MULTIVERSION_X86_64_V3,
+	MULTIVERSION_LEVEL_COUNT
+};
+
+//! one compilation of the hot portable kernels
+/*! mvkernel.h is compiled once per MultiVersionLevel (mvbase.cpp, mvv2.cpp
+	and mvv3.cpp), each time with the compiler targeting that level and in
+	its own namespace. The members take the same arguments as the functions
+	that call them, so SHA1::Transform() simply forwards to SHA1_Transform. */
+struct MultiVersionKernels
+{
+	MultiVersionLevel level;
+	const char *name;
+	void (*SHA1_Transform)(word32 *state, const word32 *data);
+	void (*SHA256_Transform)(word32 *state, const word32 *data);
+	void (*SHA512_Transform)(word64 *state, const word64 *data);
+	//! s1 and s2 must be less than 65521 on entry, and are on return
+	void (*Adler32_Update)(word32 &s1, word32 &s2, const byte *input, size_t length);
+};
+
+//! returns the kernels for the best level this CPU supports
+/*! The choice is made once, from CPUID, on the first call. */
+CRYPTOPP_DLL const MultiVersionKernels & CRYPTOPP_API GetMultiVersionKernels();
+
+//! returns the kernels compiled for level, or NULL if they weren't built or this CPU can't run them
+/*! Intended for benchmarks and tests that compare the levels. */
+CRYPTOPP_DLL const MultiVersionKernels * CRYPTOPP_API GetMultiVersionKernels(MultiVersionLevel level);
+
+//! makes GetMultiVersionKernels() return the kernels for level, returning false if they aren't available
+/*! For test harnesses that run the same code at each level in turn. It must not
+	be called while other threads may be using the kernels. */
+CRYPTOPP_DLL bool CRYPTOPP_API SetMultiVersionLevelForTesting(MultiVersionLevel level);
+
+NAMESPACE_END
+
+#endif
@@ -0,0 +1,12 @@
+// mvbase.cpp - the kernels in mvkernel.h, compiled for the compiler's default target
+
+#include "pch.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#define CRYPTOPP_MULTIVERSION_NAMESPACE MultiVersion_Baseline
+#define CRYPTOPP_MULTIVERSION_LEVEL MULTIVERSION_BASELINE
+#define CRYPTOPP_MULTIVERSION_NAME "baseline"
+#include "mvkernel.h"
+
+#endif
@@ -0,0 +1,367 @@
+// mvkernel.h - the kernels behind MultiVersionKernels
+
+// This file has no include guard: mvbase.cpp, mvv2.cpp and mvv3.cpp each
+// define CRYPTOPP_MULTIVERSION_NAMESPACE, CRYPTOPP_MULTIVERSION_LEVEL and
+// CRYPTOPP_MULTIVERSION_NAME and then include it, and the build compiles
+// each of them for a different instruction set.
+
+// Only config.h may be included here. Inline functions from the other
+// headers (rotlFixed(), ByteReverse() and so on) would be emitted as weak
+// symbols when the compiler declines to inline them, and the linker could
+// then pick the AVX2 copy for callers on every CPU. The helpers below are
+// static for the same reason.
+
+#include "config.h"
+#include "multiver.h"
+#include <string.h>
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+NAMESPACE_BEGIN(CryptoPP)
+
+extern const word32 SHA256_K[64];
+extern const word64 SHA512_K[80];
+
+namespace CRYPTOPP_MULTIVERSION_NAMESPACE {
+
+static inline word32 rotl32(word32 x, unsigned int y) {return (x << y) | (x >> (32-y));}
+static inline word32 rotr32(word32 x, unsigned int y) {return (x >> y) | (x << (32-y));}
+static inline word64 rotr64(word64 x, unsigned int y) {return (x >> y) | (x << (64-y));}
+
+// *************************************************************
+// SHA-1, from Steve Reid's public domain sha1.c
+
+#define blk0(i) (W[i] = data[i])
+#define blk1(i) (W[i&15] = rotl32(W[(i+13)&15]^W[(i+8)&15]^W[(i+2)&15]^W[i&15],1))
+
+#define f1(x,y,z) (z^(x&(y^z)))
+#define f2(x,y,z) (x^y^z)
+#define f3(x,y,z) ((x&y)|(z&(x|y)))
+#define f4(x,y,z) (x^y^z)
+
+/* (R0+R1), R2, R3, R4 are the different operations used in SHA1 */
+#define R0(v,w,x,y,z,i) z+=f1(w,x,y)+blk0(i)+0x5A827999+rotl32(v,5);w=rotl32(w,30);
+#define R1(v,w,x,y,z,i) z+=f1(w,x,y)+blk1(i)+0x5A827999+rotl32(v,5);w=rotl32(w,30);
+#define R2(v,w,x,y,z,i) z+=f2(w,x,y)+blk1(i)+0x6ED9EBA1+rotl32(v,5);w=rotl32(w,30);
+#define R3(v,w,x,y,z,i) z+=f3(w,x,y)+blk1(i)+0x8F1BBCDC+rotl32(v,5);w=rotl32(w,30);
+#define R4(v,w,x,y,z,i) z+=f4(w,x,y)+blk1(i)+0xCA62C1D6+rotl32(v,5);w=rotl32(w,30);
+
+static void SHA1_Transform(word32 *state, const word32 *data)
+{
+	word32 W[16];
+    /* Copy context->state[] to working vars */
+    word32 a = state[0];
+    word32 b = state[1];
+    word32 c = state[2];
+    word32 d = state[3];
+    word32 e = state[4];
+    /* 4 rounds of 20 operations each. Loop unrolled. */
+    R0(a,b,c,d,e, 0); R0(e,a,b,c,d, 1); R0(d,e,a,b,c, 2); R0(c,d,e,a,b, 3);
+    R0(b,c,d,e,a, 4); R0(a,b,c,d,e, 5); R0(e,a,b,c,d, 6); R0(d,e,a,b,c, 7);
+    R0(c,d,e,a,b, 8); R0(b,c,d,e,a, 9); R0(a,b,c,d,e,10); R0(e,a,b,c,d,11);
+    R0(d,e,a,b,c,12); R0(c,d,e,a,b,13); R0(b,c,d,e,a,14); R0(a,b,c,d,e,15);
+    R1(e,a,b,c,d,16); R1(d,e,a,b,c,17); R1(c,d,e,a,b,18); R1(b,c,d,e,a,19);
+    R2(a,b,c,d,e,20); R2(e,a,b,c,d,21); R2(d,e,a,b,c,22); R2(c,d,e,a,b,23);
+    R2(b,c,d,e,a,24); R2(a,b,c,d,e,25); R2(e,a,b,c,d,26); R2(d,e,a,b,c,27);
+    R2(c,d,e,a,b,28); R2(b,c,d,e,a,29); R2(a,b,c,d,e,30); R2(e,a,b,c,d,31);
+    R2(d,e,a,b,c,32); R2(c,d,e,a,b,33); R2(b,c,d,e,a,34); R2(a,b,c,d,e,35);
+    R2(e,a,b,c,d,36); R2(d,e,a,b,c,37); R2(c,d,e,a,b,38); R2(b,c,d,e,a,39);
+    R3(a,b,c,d,e,40); R3(e,a,b,c,d,41); R3(d,e,a,b,c,42); R3(c,d,e,a,b,43);
+    R3(b,c,d,e,a,44); R3(a,b,c,d,e,45); R3(e,a,b,c,d,46); R3(d,e,a,b,c,47);
+    R3(c,d,e,a,b,48); R3(b,c,d,e,a,49); R3(a,b,c,d,e,50); R3(e,a,b,c,d,51);
+    R3(d,e,a,b,c,52); R3(c,d,e,a,b,53); R3(b,c,d,e,a,54); R3(a,b,c,d,e,55);
+    R3(e,a,b,c,d,56); R3(d,e,a,b,c,57); R3(c,d,e,a,b,58); R3(b,c,d,e,a,59);
+    R4(a,b,c,d,e,60); R4(e,a,b,c,d,61); R4(d,e,a,b,c,62); R4(c,d,e,a,b,63);
+    R4(b,c,d,e,a,64); R4(a,b,c,d,e,65); R4(e,a,b,c,d,66); R4(d,e,a,b,c,67);
+    R4(c,d,e,a,b,68); R4(b,c,d,e,a,69); R4(a,b,c,d,e,70); R4(e,a,b,c,d,71);
+    R4(d,e,a,b,c,72); R4(c,d,e,a,b,73); R4(b,c,d,e,a,74); R4(a,b,c,d,e,75);
+    R4(e,a,b,c,d,76); R4(d,e,a,b,c,77); R4(c,d,e,a,b,78); R4(b,c,d,e,a,79);
+    /* Add the working vars back into context.state[] */
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+#undef f1
+#undef f2
+#undef f3
+#undef f4
+#undef R0
+#undef R1
+#undef R2
+#undef R3
+#undef R4
+
+// *************************************************************
+// SHA-2
+
+#define blk2(i) (W[i&15]+=s1(W[(i-2)&15])+W[(i-7)&15]+s0(W[(i-15)&15]))
+
+#define Ch(x,y,z) (z^(x&(y^z)))
+#define Maj(x,y,z) (y^((x^y)&(y^z)))
+
+#define a(i) T[(0-i)&7]
+#define b(i) T[(1-i)&7]
+#define c(i) T[(2-i)&7]
+#define d(i) T[(3-i)&7]
+#define e(i) T[(4-i)&7]
+#define f(i) T[(5-i)&7]
+#define g(i) T[(6-i)&7]
+#define h(i) T[(7-i)&7]
+
+#define S0(x) (rotr32(x,2)^rotr32(x,13)^rotr32(x,22))
+#define S1(x) (rotr32(x,6)^rotr32(x,11)^rotr32(x,25))
+#define s0(x) (rotr32(x,7)^rotr32(x,18)^(x>>3))
+#define s1(x) (rotr32(x,17)^rotr32(x,19)^(x>>10))
+
+#define R(i) h(i)+=S1(e(i))+Ch(e(i),f(i),g(i))+SHA256_K[i+j]+(j?blk2(i):blk0(i));\
+	d(i)+=h(i);h(i)+=S0(a(i))+Maj(a(i),b(i),c(i))
+
+static void SHA256_Transform(word32 *state, const word32 *data)
+{
+	word32 W[16];
+	word32 T[8];
+    /* Copy context->state[] to working vars */
+	memcpy(T, state, sizeof(T));
+    /* 64 operations, partially loop unrolled */
+	for (unsigned int j=0; j<64; j+=16)
+	{
+		R( 0); R( 1); R( 2); R( 3);
+		R( 4); R( 5); R( 6); R( 7);
+		R( 8); R( 9); R(10); R(11);
+		R(12); R(13); R(14); R(15);
+	}
+    /* Add the working vars back into context.state[] */
+    state[0] += a(0);
+    state[1] += b(0);
+    state[2] += c(0);
+    state[3] += d(0);
+    state[4] += e(0);
+    state[5] += f(0);
+    state[6] += g(0);
+    state[7] += h(0);
+}
+
+#undef S0
+#undef S1
+#undef s0
+#undef s1
+#undef R
+
+#define S0(x) (rotr64(x,28)^rotr64(x,34)^rotr64(x,39))
+#define S1(x) (rotr64(x,14)^rotr64(x,18)^rotr64(x,41))
+#define s0(x) (rotr64(x,1)^rotr64(x,8)^(x>>7))
+#define s1(x) (rotr64(x,19)^rotr64(x,61)^(x>>6))
+
+#define R(i) h(i)+=S1(e(i))+Ch(e(i),f(i),g(i))+SHA512_K[i+j]+(j?blk2(i):blk0(i));\
+	d(i)+=h(i);h(i)+=S0(a(i))+Maj(a(i),b(i),c(i))
+
+static void SHA512_Transform(word64 *state, const word64 *data)
+{
+	word64 W[16];
+	word64 T[8];
+    /* Copy context->state[] to working vars */
+	memcpy(T, state, sizeof(T));
+    /* 80 operations, partially loop unrolled */
+	for (unsigned int j=0; j<80; j+=16)
+	{
+		R( 0); R( 1); R( 2); R( 3);
+		R( 4); R( 5); R( 6); R( 7);
+		R( 8); R( 9); R(10); R(11);
+		R(12); R(13); R(14); R(15);
+	}
+    /* Add the working vars back into context.state[] */
+    state[0] += a(0);
+    state[1] += b(0);
+    state[2] += c(0);
+    state[3] += d(0);
+    state[4] += e(0);
+    state[5] += f(0);
+    state[6] += g(0);
+    state[7] += h(0);
+}
+
+#undef S0
+#undef S1
+#undef s0
+#undef s1
+#undef R
+#undef a
+#undef b
+#undef c
+#undef d
+#undef e
+#undef f
+#undef g
+#undef h
+#undef Ch
+#undef Maj
+#undef blk0
+#undef blk1
+#undef blk2
+
+// *************************************************************
+// Adler-32
+
+static const unsigned long ADLER32_BASE = 65521;
+
+static void Adler32_UpdateScalar(word32 &m_s1, word32 &m_s2, const byte *input, size_t length)
+{
+	unsigned long s1 = m_s1;
+	unsigned long s2 = m_s2;
+
+	if (length % 8 != 0)
+	{
+		do
+		{
+			s1 += *input++;
+			s2 += s1;
+			length--;
+		} while (length % 8 != 0);
+
+		if (s1 >= ADLER32_BASE)
+			s1 -= ADLER32_BASE;
+		s2 %= ADLER32_BASE;
+	}
+
+	while (length > 0)
+	{
+		s1 += input[0]; s2 += s1;
+		s1 += input[1]; s2 += s1;
+		s1 += input[2]; s2 += s1;
+		s1 += input[3]; s2 += s1;
+		s1 += input[4]; s2 += s1;
+		s1 += input[5]; s2 += s1;
+		s1 += input[6]; s2 += s1;
+		s1 += input[7]; s2 += s1;
+
+		length -= 8;
+		input += 8;
+
+		if (s1 >= ADLER32_BASE)
+			s1 -= ADLER32_BASE;
+		if (length % 0x8000 == 0)
+			s2 %= ADLER32_BASE;
+	}
+
+	m_s1 = word32(s1);
+	m_s2 = word32(s2);
+}
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+
+// The vector loops take 32 bytes at a time. s1 gains the plain sum of the
+// bytes (psadbw), and s2 the sum weighted by each byte's distance from the
+// end of the block (pmaddubsw by 32..1) plus 32 times the s1 carried into
+// each block, which is kept in ps and scaled once at the end. The sums are
+// reduced modulo 65521 at least every 5552 bytes, as in zlib, so nothing
+// can overflow 32 bits.
+static const size_t ADLER32_NMAX_BLOCKS = 5552 / 32;
+
+#ifdef __AVX2__
+static word32 HorizontalSum(__m256i x)
+{
+	__m128i y = _mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+	y = _mm_add_epi32(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(1,0,3,2)));
+	y = _mm_add_epi32(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(2,3,0,1)));
+	return (word32)_mm_cvtsi128_si32(y);
+}
+#else
+static word32 HorizontalSum(__m128i y)
+{
+	y = _mm_add_epi32(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(1,0,3,2)));
+	y = _mm_add_epi32(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(2,3,0,1)));
+	return (word32)_mm_cvtsi128_si32(y);
+}
+#endif
+
+static void Adler32_Update(word32 &m_s1, word32 &m_s2, const byte *input, size_t length)
+{
+	word32 s1 = m_s1, s2 = m_s2;
+
+	while (length >= 32)
+	{
+		size_t blocks = length / 32 < ADLER32_NMAX_BLOCKS ? length / 32 : ADLER32_NMAX_BLOCKS;
+		length -= blocks * 32;
+
+#ifdef __AVX2__
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i ones = _mm256_set1_epi16(1);
+		const __m256i taps = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+			16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+		__m256i vs1 = zero, vs2 = zero;
+		__m256i ps = _mm256_setr_epi32(int(s1 * blocks), 0, 0, 0, 0, 0, 0, 0);
+
+		do
+		{
+			const __m256i bytes = _mm256_loadu_si256((const __m256i *)input);
+			ps = _mm256_add_epi32(ps, vs1);
+			vs1 = _mm256_add_epi32(vs1, _mm256_sad_epu8(bytes, zero));
+			vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, taps), ones));
+			input += 32;
+		} while (--blocks);
+
+		vs2 = _mm256_add_epi32(vs2, _mm256_slli_epi32(ps, 5));
+#else
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_set1_epi16(1);
+		const __m128i taps1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+		const __m128i taps2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+		__m128i vs1 = zero, vs2 = zero;
+		__m128i ps = _mm_setr_epi32(int(s1 * blocks), 0, 0, 0);
+
+		do
+		{
+			const __m128i bytes1 = _mm_loadu_si128((const __m128i *)input);
+			const __m128i bytes2 = _mm_loadu_si128((const __m128i *)(input + 16));
+			ps = _mm_add_epi32(ps, vs1);
+			vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes1, zero));
+			vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, taps1), ones));
+			vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes2, zero));
+			vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, taps2), ones));
+			input += 32;
+		} while (--blocks);
+
+		vs2 = _mm_add_epi32(vs2, _mm_slli_epi32(ps, 5));
+#endif
+
+		s1 = (s1 + HorizontalSum(vs1)) % ADLER32_BASE;
+		s2 = (s2 + HorizontalSum(vs2)) % ADLER32_BASE;
+	}
+
+	m_s1 = s1;
+	m_s2 = s2;
+	if (length)
+		Adler32_UpdateScalar(m_s1, m_s2, input, length);
+}
+
+#else
+
+static void Adler32_Update(word32 &m_s1, word32 &m_s2, const byte *input, size_t length)
+{
+	Adler32_UpdateScalar(m_s1, m_s2, input, length);
+}
+
+#endif
+
+static const MultiVersionKernels s_kernels = {
+	CRYPTOPP_MULTIVERSION_LEVEL,
+	CRYPTOPP_MULTIVERSION_NAME,
+	&SHA1_Transform,
+	&SHA256_Transform,
+	&SHA512_Transform,
+	&Adler32_Update
+};
+
+const MultiVersionKernels * GetKernels()
+{
+	return &s_kernels;
+}
+
+}	// namespace CRYPTOPP_MULTIVERSION_NAMESPACE
+
+NAMESPACE_END
@@ -0,0 +1,29 @@
+// mvv2.cpp - the kernels in mvkernel.h, compiled for x86-64-v2
+
+// The build compiles this file with -march=x86-64-v2. Compilers that were
+// not asked to, or can't, target it get an empty table instead.
+
+#include "config.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#if defined(__SSE4_2__) && defined(__POPCNT__)
+
+#define CRYPTOPP_MULTIVERSION_NAMESPACE MultiVersion_X86_64_V2
+#define CRYPTOPP_MULTIVERSION_LEVEL MULTIVERSION_X86_64_V2
+#define CRYPTOPP_MULTIVERSION_NAME "x86-64-v2"
+#include "mvkernel.h"
+
+#else
+
+#include "multiver.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+namespace MultiVersion_X86_64_V2 {
+const MultiVersionKernels * GetKernels() {return NULL;}
+}
+NAMESPACE_END
+
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+// mvv3.cpp - the kernels in mvkernel.h, compiled for x86-64-v3
+
+// The build compiles this file with -march=x86-64-v3, or /arch:AVX2 with
+// MSVC. Compilers that were not asked to, or can't, target it get an empty
+// table instead.
+
+#include "config.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#if defined(__AVX2__) && (defined(_MSC_VER) || defined(__BMI2__))
+
+#define CRYPTOPP_MULTIVERSION_NAMESPACE MultiVersion_X86_64_V3
+#define CRYPTOPP_MULTIVERSION_LEVEL MULTIVERSION_X86_64_V3
+#define CRYPTOPP_MULTIVERSION_NAME "x86-64-v3"
+#include "mvkernel.h"
+
+#else
+
+#include "multiver.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+namespace MultiVersion_X86_64_V3 {
+const MultiVersionKernels * GetKernels() {return NULL;}
+}
+NAMESPACE_END
+
+#endif
+
+#endif
@@ -61,9 +61,58 @@ void RSAFunction::DEREncodePublicKey(BufferedTransformation &bt) const
 	seq.MessageEnd();
 }
 
+void RSAFunction::BERDecodeSubjectPublicKeyInfo(const byte *encoded, size_t length)
+{
+	DERSpanDecoder input(encoded, length);
+	DERSpanDecoder subjectPublicKeyInfo(input, SEQUENCE | CONSTRUCTED);
+		DERSpanDecoder algorithm(subjectPublicKeyInfo, SEQUENCE | CONSTRUCTED);
+			algorithm.DecodeAndCheckOID(GetAlgorithmID());
+			if (!algorithm.EndReached())
+				algorithm.DecodeNull();
+		algorithm.MessageEnd();
+
+		DERSpanDecoder subjectPublicKey(subjectPublicKeyInfo, BIT_STRING);
+			subjectPublicKey.CheckByte(0);	// unused bits
+			DERSpanDecoder seq(subjectPublicKey, SEQUENCE | CONSTRUCTED);
+				seq.DecodeInteger(m_n);
+				seq.DecodeInteger(m_e);
+			seq.MessageEnd();
+		subjectPublicKey.MessageEnd();
+	subjectPublicKeyInfo.MessageEnd();
+	input.MessageEnd();
+}
+
+void RSAFunction::Precompute(unsigned int)
+{
+	DoQuickSanityCheck();
+	m_precomputedMR.reset(new MontgomeryRepresentation(m_n));
+	m_precomputedR2 = m_precomputedMR->ConvertIn(m_precomputedMR->MultiplicativeIdentity());
+}
+
 Integer RSAFunction::ApplyFunction(const Integer &x) const
 {
 	DoQuickSanityCheck();
+
+	if (m_precomputedMR.get() && x.NotNegative() && x < m_n && m_precomputedMR->GetModulus() == m_n)
+	{
+		// work on a copy, MontgomeryRepresentation keeps its scratch space in mutable members
+		MontgomeryRepresentation mr(*m_precomputedMR);
+		Integer xm = mr.Multiply(Integer(x), m_precomputedR2);	// copying x trims it to the modulus size
+
+		if (m_e.BitCount() > 64)
+			return mr.ConvertOut(mr.Exponentiate(xm, m_e));
+
+		// short public exponents: plain square-and-multiply skips the windowing setup
+		Integer y = xm;
+		for (unsigned int i = m_e.BitCount()-1; i-- > 0; )
+		{
+			y = mr.Square(y);
+			if (m_e.GetBit(i))
+				y = mr.Multiply(y, xm);
+		}
+		return mr.ConvertOut(y);
+	}
+
 	return a_exp_b_mod_c(x, m_e, m_n);
 }
 
@@ -32,6 +32,11 @@ public:
 	bool Validate(RandomNumberGenerator &rng, unsigned int level) const;
 	bool GetVoidValue(const char *name, const std::type_info &valueType, void *pValue) const;
 	void AssignFrom(const NameValuePairs &source);
+	bool SupportsPrecomputation() const {return true;}
+	//! keep the Montgomery form of the modulus for ApplyFunction(), the argument is ignored
+	void Precompute(unsigned int unused = 0);
+	void LoadPrecomputation(BufferedTransformation &storedPrecomputation) {Precompute();}
+	void SavePrecomputation(BufferedTransformation &storedPrecomputation) const {}
 
 	// TrapdoorFunction
 	Integer ApplyFunction(const Integer &x) const;
@@ -45,8 +50,15 @@ public:
 	void SetModulus(const Integer &n) {m_n = n;}
 	void SetPublicExponent(const Integer &e) {m_e = e;}
 
+	//! decode exactly one X.509 SubjectPublicKeyInfo from memory
+	/*! Equivalent to BERDecode() on a StringStore, but parses the buffer in place with DERSpanDecoder. */
+	void BERDecodeSubjectPublicKeyInfo(const byte *encoded, size_t length);
+
 protected:
 	Integer m_n, m_e;
+	// ignored by ApplyFunction() once m_n no longer matches its modulus
+	value_ptr<MontgomeryRepresentation> m_precomputedMR;
+	Integer m_precomputedR2;
 };
 
 //! _
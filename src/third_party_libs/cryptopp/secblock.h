@@ -6,6 +6,7 @@
 #include "config.h"
 #include "misc.h"
 #include <assert.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -221,7 +222,37 @@ public:
 
 	size_type max_size() const {return STDMAX(m_fallbackAllocator.max_size(), S);}
 
+	//! exchange block p allocated from *this with block q allocated from b
+	/*! Inline arrays can't change owner, so their contents are exchanged by value. */
+	void swap(FixedSizeAllocatorWithCleanup<T, S, A, T_Align16> &b, pointer &p, size_type pSize, pointer &q, size_type qSize)
+	{
+		bool pInline = (p == GetAlignedArray()), qInline = (q == b.GetAlignedArray());
+
+		if (pInline && qInline)
+			std::swap_ranges(p, p+STDMAX(pSize, qSize), q);
+		else if (pInline)
+			b.TakeInline(*this, p, pSize, q);
+		else if (qInline)
+			TakeInline(b, q, qSize, p);
+		else
+			std::swap(p, q);
+
+		std::swap(m_fallbackAllocator, b.m_fallbackAllocator);
+	}
+
 private:
+	// move the inline block p of other into our own array, and hand our heap block q to other
+	void TakeInline(FixedSizeAllocatorWithCleanup<T, S, A, T_Align16> &other, pointer &p, size_type pSize, pointer &q)
+	{
+		assert(!m_allocated);
+		memcpy_s(GetAlignedArray(), S*sizeof(T), p, pSize*sizeof(T));
+		SecureWipeArray(p, pSize);
+		other.m_allocated = false;
+		m_allocated = true;
+		p = q;
+		q = GetAlignedArray();
+	}
+
 #ifdef __BORLANDC__
 	T* GetAlignedArray() {return m_array;}
 	T m_array[S];
@@ -233,6 +264,19 @@ private:
 	bool m_allocated;
 };
 
+template <class A>
+inline void SwapSecBlockStorage(A &a, A &b, typename A::pointer &p, size_t, typename A::pointer &q, size_t)
+{
+	std::swap(a, b);
+	std::swap(p, q);
+}
+
+template <class T, size_t S, class A, bool T_Align16>
+inline void SwapSecBlockStorage(FixedSizeAllocatorWithCleanup<T, S, A, T_Align16> &a, FixedSizeAllocatorWithCleanup<T, S, A, T_Align16> &b, T *&p, size_t pSize, T *&q, size_t qSize)
+{
+	a.swap(b, p, pSize, q, qSize);
+}
+
 //! a block of memory allocated using A
 template <class T, class A = AllocatorWithCleanup<T> >
 class SecBlock
@@ -402,9 +446,8 @@ public:
 	//! swap contents and size with another SecBlock
 	void swap(SecBlock<T, A> &b)
 	{
-		std::swap(m_alloc, b.m_alloc);
+		SwapSecBlockStorage(m_alloc, b.m_alloc, m_ptr, m_size, b.m_ptr, b.m_size);
 		std::swap(m_size, b.m_size);
-		std::swap(m_ptr, b.m_ptr);
 	}
 
 //private:
@@ -13,14 +13,10 @@
 #include "sha.h"
 #include "misc.h"
 #include "cpu.h"
+#include "multiver.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
-// start of Steve Reid's code
-
-#define blk0(i) (W[i] = data[i])
-#define blk1(i) (W[i&15] = rotlFixed(W[(i+13)&15]^W[(i+8)&15]^W[(i+2)&15]^W[i&15],1))
-
 void SHA1::InitState(HashWordType *state)
 {
 	state[0] = 0x67452301L;
@@ -30,58 +26,11 @@ void SHA1::InitState(HashWordType *state)
 	state[4] = 0xC3D2E1F0L;
 }
 
-#define f1(x,y,z) (z^(x&(y^z)))
-#define f2(x,y,z) (x^y^z)
-#define f3(x,y,z) ((x&y)|(z&(x|y)))
-#define f4(x,y,z) (x^y^z)
-
-/* (R0+R1), R2, R3, R4 are the different operations used in SHA1 */
-#define R0(v,w,x,y,z,i) z+=f1(w,x,y)+blk0(i)+0x5A827999+rotlFixed(v,5);w=rotlFixed(w,30);
-#define R1(v,w,x,y,z,i) z+=f1(w,x,y)+blk1(i)+0x5A827999+rotlFixed(v,5);w=rotlFixed(w,30);
-#define R2(v,w,x,y,z,i) z+=f2(w,x,y)+blk1(i)+0x6ED9EBA1+rotlFixed(v,5);w=rotlFixed(w,30);
-#define R3(v,w,x,y,z,i) z+=f3(w,x,y)+blk1(i)+0x8F1BBCDC+rotlFixed(v,5);w=rotlFixed(w,30);
-#define R4(v,w,x,y,z,i) z+=f4(w,x,y)+blk1(i)+0xCA62C1D6+rotlFixed(v,5);w=rotlFixed(w,30);
-
 void SHA1::Transform(word32 *state, const word32 *data)
 {
-	word32 W[16];
-    /* Copy context->state[] to working vars */
-    word32 a = state[0];
-    word32 b = state[1];
-    word32 c = state[2];
-    word32 d = state[3];
-    word32 e = state[4];
-    /* 4 rounds of 20 operations each. Loop unrolled. */
-    R0(a,b,c,d,e, 0); R0(e,a,b,c,d, 1); R0(d,e,a,b,c, 2); R0(c,d,e,a,b, 3);
-    R0(b,c,d,e,a, 4); R0(a,b,c,d,e, 5); R0(e,a,b,c,d, 6); R0(d,e,a,b,c, 7);
-    R0(c,d,e,a,b, 8); R0(b,c,d,e,a, 9); R0(a,b,c,d,e,10); R0(e,a,b,c,d,11);
-    R0(d,e,a,b,c,12); R0(c,d,e,a,b,13); R0(b,c,d,e,a,14); R0(a,b,c,d,e,15);
-    R1(e,a,b,c,d,16); R1(d,e,a,b,c,17); R1(c,d,e,a,b,18); R1(b,c,d,e,a,19);
-    R2(a,b,c,d,e,20); R2(e,a,b,c,d,21); R2(d,e,a,b,c,22); R2(c,d,e,a,b,23);
-    R2(b,c,d,e,a,24); R2(a,b,c,d,e,25); R2(e,a,b,c,d,26); R2(d,e,a,b,c,27);
-    R2(c,d,e,a,b,28); R2(b,c,d,e,a,29); R2(a,b,c,d,e,30); R2(e,a,b,c,d,31);
-    R2(d,e,a,b,c,32); R2(c,d,e,a,b,33); R2(b,c,d,e,a,34); R2(a,b,c,d,e,35);
-    R2(e,a,b,c,d,36); R2(d,e,a,b,c,37); R2(c,d,e,a,b,38); R2(b,c,d,e,a,39);
-    R3(a,b,c,d,e,40); R3(e,a,b,c,d,41); R3(d,e,a,b,c,42); R3(c,d,e,a,b,43);
-    R3(b,c,d,e,a,44); R3(a,b,c,d,e,45); R3(e,a,b,c,d,46); R3(d,e,a,b,c,47);
-    R3(c,d,e,a,b,48); R3(b,c,d,e,a,49); R3(a,b,c,d,e,50); R3(e,a,b,c,d,51);
-    R3(d,e,a,b,c,52); R3(c,d,e,a,b,53); R3(b,c,d,e,a,54); R3(a,b,c,d,e,55);
-    R3(e,a,b,c,d,56); R3(d,e,a,b,c,57); R3(c,d,e,a,b,58); R3(b,c,d,e,a,59);
-    R4(a,b,c,d,e,60); R4(e,a,b,c,d,61); R4(d,e,a,b,c,62); R4(c,d,e,a,b,63);
-    R4(b,c,d,e,a,64); R4(a,b,c,d,e,65); R4(e,a,b,c,d,66); R4(d,e,a,b,c,67);
-    R4(c,d,e,a,b,68); R4(b,c,d,e,a,69); R4(a,b,c,d,e,70); R4(e,a,b,c,d,71);
-    R4(d,e,a,b,c,72); R4(c,d,e,a,b,73); R4(b,c,d,e,a,74); R4(a,b,c,d,e,75);
-    R4(e,a,b,c,d,76); R4(d,e,a,b,c,77); R4(c,d,e,a,b,78); R4(b,c,d,e,a,79);
-    /* Add the working vars back into context.state[] */
-    state[0] += a;
-    state[1] += b;
-    state[2] += c;
-    state[3] += d;
-    state[4] += e;
+	GetMultiVersionKernels().SHA1_Transform(state, data);
 }
 
-// end of Steve Reid's code
-
 // *************************************************************
 
 void SHA224::InitState(HashWordType *state)
@@ -448,155 +397,45 @@ void CRYPTOPP_FASTCALL X86_SHA256_HashBlocks(word32 *state, const word32 *data,
 
 #if defined(CRYPTOPP_X86_ASM_AVAILABLE) || defined(CRYPTOPP_X64_MASM_AVAILABLE)
 
+// the C code compiled for x86-64-v3 (with RORX and BMI) beats the SSE2 assembly
+static inline bool UseSHA256Kernel()
+{
+	return GetMultiVersionKernels().level >= MULTIVERSION_X86_64_V3;
+}
+
 size_t SHA256::HashMultipleBlocks(const word32 *input, size_t length)
 {
+	if (UseSHA256Kernel())
+		return IteratedHashWithStaticTransform<word32, BigEndian, 64, 32, SHA256, 32, true>::HashMultipleBlocks(input, length);
 	X86_SHA256_HashBlocks(m_state, input, (length&(size_t(0)-BLOCKSIZE)) - !HasSSE2());
 	return length % BLOCKSIZE;
 }
 
 size_t SHA224::HashMultipleBlocks(const word32 *input, size_t length)
 {
+	if (UseSHA256Kernel())
+		return IteratedHashWithStaticTransform<word32, BigEndian, 64, 32, SHA224, 28, true>::HashMultipleBlocks(input, length);
 	X86_SHA256_HashBlocks(m_state, input, (length&(size_t(0)-BLOCKSIZE)) - !HasSSE2());
 	return length % BLOCKSIZE;
 }
 
 #endif
 
-#define blk2(i) (W[i&15]+=s1(W[(i-2)&15])+W[(i-7)&15]+s0(W[(i-15)&15]))
-
-#define Ch(x,y,z) (z^(x&(y^z)))
-#define Maj(x,y,z) (y^((x^y)&(y^z)))
-
-#define a(i) T[(0-i)&7]
-#define b(i) T[(1-i)&7]
-#define c(i) T[(2-i)&7]
-#define d(i) T[(3-i)&7]
-#define e(i) T[(4-i)&7]
-#define f(i) T[(5-i)&7]
-#define g(i) T[(6-i)&7]
-#define h(i) T[(7-i)&7]
-
-#define R(i) h(i)+=S1(e(i))+Ch(e(i),f(i),g(i))+SHA256_K[i+j]+(j?blk2(i):blk0(i));\
-	d(i)+=h(i);h(i)+=S0(a(i))+Maj(a(i),b(i),c(i))
-
-// for SHA256
-#define S0(x) (rotrFixed(x,2)^rotrFixed(x,13)^rotrFixed(x,22))
-#define S1(x) (rotrFixed(x,6)^rotrFixed(x,11)^rotrFixed(x,25))
-#define s0(x) (rotrFixed(x,7)^rotrFixed(x,18)^(x>>3))
-#define s1(x) (rotrFixed(x,17)^rotrFixed(x,19)^(x>>10))
-
 void SHA256::Transform(word32 *state, const word32 *data)
 {
-	word32 W[16];
 #if defined(CRYPTOPP_X86_ASM_AVAILABLE) || defined(CRYPTOPP_X64_MASM_AVAILABLE)
-	// this byte reverse is a waste of time, but this function is only called by MDC
-	ByteReverse(W, data, BLOCKSIZE);
-	X86_SHA256_HashBlocks(state, W, BLOCKSIZE - !HasSSE2());
-#else
-	word32 T[8];
-    /* Copy context->state[] to working vars */
-	memcpy(T, state, sizeof(T));
-    /* 64 operations, partially loop unrolled */
-	for (unsigned int j=0; j<64; j+=16)
+	if (!UseSHA256Kernel())
 	{
-		R( 0); R( 1); R( 2); R( 3);
-		R( 4); R( 5); R( 6); R( 7);
-		R( 8); R( 9); R(10); R(11);
-		R(12); R(13); R(14); R(15);
+		word32 W[16];
+		// this byte reverse is a waste of time, but this function is only called by MDC
+		ByteReverse(W, data, BLOCKSIZE);
+		X86_SHA256_HashBlocks(state, W, BLOCKSIZE - !HasSSE2());
+		return;
 	}
-    /* Add the working vars back into context.state[] */
-    state[0] += a(0);
-    state[1] += b(0);
-    state[2] += c(0);
-    state[3] += d(0);
-    state[4] += e(0);
-    state[5] += f(0);
-    state[6] += g(0);
-    state[7] += h(0);
 #endif
+	GetMultiVersionKernels().SHA256_Transform(state, data);
 }
 
-/* 
-// smaller but slower
-void SHA256::Transform(word32 *state, const word32 *data)
-{
-	word32 T[20];
-	word32 W[32];
-	unsigned int i = 0, j = 0;
-	word32 *t = T+8;
-
-	memcpy(t, state, 8*4);
-	word32 e = t[4], a = t[0];
-
-	do 
-	{
-		word32 w = data[j];
-		W[j] = w;
-		w += SHA256_K[j];
-		w += t[7];
-		w += S1(e);
-		w += Ch(e, t[5], t[6]);
-		e = t[3] + w;
-		t[3] = t[3+8] = e;
-		w += S0(t[0]);
-		a = w + Maj(a, t[1], t[2]);
-		t[-1] = t[7] = a;
-		--t;
-		++j;
-		if (j%8 == 0)
-			t += 8;
-	} while (j<16);
-
-	do
-	{
-		i = j&0xf;
-		word32 w = s1(W[i+16-2]) + s0(W[i+16-15]) + W[i] + W[i+16-7];
-		W[i+16] = W[i] = w;
-		w += SHA256_K[j];
-		w += t[7];
-		w += S1(e);
-		w += Ch(e, t[5], t[6]);
-		e = t[3] + w;
-		t[3] = t[3+8] = e;
-		w += S0(t[0]);
-		a = w + Maj(a, t[1], t[2]);
-		t[-1] = t[7] = a;
-
-		w = s1(W[(i+1)+16-2]) + s0(W[(i+1)+16-15]) + W[(i+1)] + W[(i+1)+16-7];
-		W[(i+1)+16] = W[(i+1)] = w;
-		w += SHA256_K[j+1];
-		w += (t-1)[7];
-		w += S1(e);
-		w += Ch(e, (t-1)[5], (t-1)[6]);
-		e = (t-1)[3] + w;
-		(t-1)[3] = (t-1)[3+8] = e;
-		w += S0((t-1)[0]);
-		a = w + Maj(a, (t-1)[1], (t-1)[2]);
-		(t-1)[-1] = (t-1)[7] = a;
-
-		t-=2;
-		j+=2;
-		if (j%8 == 0)
-			t += 8;
-	} while (j<64);
-
-    state[0] += a;
-    state[1] += t[1];
-    state[2] += t[2];
-    state[3] += t[3];
-    state[4] += e;
-    state[5] += t[5];
-    state[6] += t[6];
-    state[7] += t[7];
-}
-*/
-
-#undef S0
-#undef S1
-#undef s0
-#undef s1
-#undef R
-
 // *************************************************************
 
 void SHA384::InitState(HashWordType *state)
@@ -620,9 +459,9 @@ void SHA512::InitState(HashWordType *state)
 }
 
 #if CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE && CRYPTOPP_BOOL_X86
-CRYPTOPP_ALIGN_DATA(16) static const word64 SHA512_K[80] CRYPTOPP_SECTION_ALIGN16 = {
+CRYPTOPP_ALIGN_DATA(16) extern const word64 SHA512_K[80] CRYPTOPP_SECTION_ALIGN16 = {
 #else
-static const word64 SHA512_K[80] = {
+extern const word64 SHA512_K[80] = {
 #endif
 	W64LIT(0x428a2f98d728ae22), W64LIT(0x7137449123ef65cd),
 	W64LIT(0xb5c0fbcfec4d3b2f), W64LIT(0xe9b5dba58189dbbc),
@@ -863,35 +702,7 @@ void SHA512::Transform(word64 *state, const word64 *data)
 	}
 #endif
 
-#define S0(x) (rotrFixed(x,28)^rotrFixed(x,34)^rotrFixed(x,39))
-#define S1(x) (rotrFixed(x,14)^rotrFixed(x,18)^rotrFixed(x,41))
-#define s0(x) (rotrFixed(x,1)^rotrFixed(x,8)^(x>>7))
-#define s1(x) (rotrFixed(x,19)^rotrFixed(x,61)^(x>>6))
-
-#define R(i) h(i)+=S1(e(i))+Ch(e(i),f(i),g(i))+SHA512_K[i+j]+(j?blk2(i):blk0(i));\
-	d(i)+=h(i);h(i)+=S0(a(i))+Maj(a(i),b(i),c(i))
-
-	word64 W[16];
-	word64 T[8];
-    /* Copy context->state[] to working vars */
-	memcpy(T, state, sizeof(T));
-    /* 80 operations, partially loop unrolled */
-	for (unsigned int j=0; j<80; j+=16)
-	{
-		R( 0); R( 1); R( 2); R( 3);
-		R( 4); R( 5); R( 6); R( 7);
-		R( 8); R( 9); R(10); R(11);
-		R(12); R(13); R(14); R(15);
-	}
-    /* Add the working vars back into context.state[] */
-    state[0] += a(0);
-    state[1] += b(0);
-    state[2] += c(0);
-    state[3] += d(0);
-    state[4] += e(0);
-    state[5] += f(0);
-    state[6] += g(0);
-    state[7] += h(0);
+	GetMultiVersionKernels().SHA512_Transform(state, data);
 }
 
 NAMESPACE_END
@@ -841,6 +841,12 @@ bool Validate(int alg, bool thorough, const char *seedInput)
 	case 67: result = ValidateCCM(); break;
 	case 68: result = ValidateGCM(); break;
 	case 69: result = ValidateCMAC(); break;
+	case 70: result = ValidateSharedKey(); break;
+	case 71: result = ValidatePublicKeyCache(); break;
+	case 72: result = ValidateXTS(); break;
+	case 73: result = ValidateGCMSIV(); break;
+	case 74: result = ValidateMultiVersionKernels(); break;
+	case 75: result = ValidateGF2_32(); break;
 	default: return false;
 	}
 
@@ -34,11 +34,21 @@
 #include "osrng.h"
 #include "zdeflate.h"
 #include "cpu.h"
+#include "aes.h"
+#include "gcm.h"
+#include "expkey.h"
+#include "xts.h"
+#include "gcmsiv.h"
+#include "sha.h"
+#include "multiver.h"
+#include "gf2_32.h"
 
 #include <time.h>
 #include <memory>
 #include <iostream>
 #include <iomanip>
+#include <thread>
+#include <vector>
 
 #include "validate.h"
 
@@ -93,6 +103,11 @@ bool ValidateAll(bool thorough)
 	pass=ValidateCCM() && pass;
 	pass=ValidateGCM() && pass;
 	pass=ValidateCMAC() && pass;
+	pass=ValidateSharedKey() && pass;
+	pass=ValidateXTS() && pass;
+	pass=ValidateGCMSIV() && pass;
+	pass=ValidateMultiVersionKernels() && pass;
+	pass=ValidateGF2_32() && pass;
 	pass=RunTestDataFile("TestVectors/eax.txt") && pass;
 	pass=RunTestDataFile("TestVectors/seed.txt") && pass;
 
@@ -100,6 +115,7 @@ bool ValidateAll(bool thorough)
 	pass=ValidateDH() && pass;
 	pass=ValidateMQV() && pass;
 	pass=ValidateRSA() && pass;
+	pass=ValidatePublicKeyCache() && pass;
 	pass=ValidateElGamal() && pass;
 	pass=ValidateDLIES() && pass;
 	pass=ValidateNR() && pass;
@@ -1406,3 +1422,405 @@ bool ValidateCMAC()
 	cout << "\nCMAC validation suite running...\n";
 	return RunTestDataFile("TestVectors/cmac.txt");
 }
+
+static bool SharedKeyRoundTrip(const ExpandedKey<AES> &key, const byte *iv, const SecByteBlock &plain,
+							   const SecByteBlock &cbcExpected, const SecByteBlock &ctrExpected, const SecByteBlock &gcmExpected)
+{
+	SecByteBlock out(plain.size()), back(plain.size());
+	byte mac[16];
+	bool pass = true;
+
+	CBC_Mode_SharedKey<AES>::Encryption cbcEnc(key, iv);
+	CBC_Mode_SharedKey<AES>::Decryption cbcDec(key, iv);
+	cbcEnc.ProcessData(out, plain, plain.size());
+	cbcDec.ProcessData(back, out, out.size());
+	pass = out == cbcExpected && back == plain && pass;
+
+	CTR_Mode_SharedKey<AES>::Encryption ctr(key, iv);
+	ctr.ProcessData(out, plain, plain.size());
+	pass = out == ctrExpected && pass;
+
+	GCM_SharedKey<AES>::Encryption gcmEnc(key, iv, 12);
+	gcmEnc.EncryptAndAuthenticate(out, mac, sizeof(mac), iv, 12, NULL, 0, plain, plain.size());
+	pass = out == gcmExpected && pass;
+	GCM_SharedKey<AES>::Decryption gcmDec(key);
+	pass = gcmDec.DecryptAndVerify(back, mac, sizeof(mac), iv, 12, NULL, 0, out, out.size()) && back == plain && pass;
+
+	return pass;
+}
+
+bool ValidateSharedKey()
+{
+	cout << "\nShared key schedule validation suite running...\n\n";
+
+	bool pass = true, fail;
+	SecByteBlock key(16), plain(4096), cbcExpected(4096), ctrExpected(4096), gcmExpected(4096);
+	byte iv[16], mac[16];
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	GlobalRNG().GenerateBlock(plain, plain.size());
+
+	CBC_Mode<AES>::Encryption(key, key.size(), iv).ProcessData(cbcExpected, plain, plain.size());
+	CTR_Mode<AES>::Encryption(key, key.size(), iv).ProcessData(ctrExpected, plain, plain.size());
+	GCM<AES>::Encryption gcm;
+	gcm.SetKeyWithIV(key, key.size(), iv, 12);
+	gcm.EncryptAndAuthenticate(gcmExpected, mac, sizeof(mac), iv, 12, NULL, 0, plain, plain.size());
+
+	ExpandedKey<AES> expandedKey(key, key.size());
+	fail = !SharedKeyRoundTrip(expandedKey, iv, plain, cbcExpected, ctrExpected, gcmExpected);
+	cout << (fail ? "FAILED    " : "passed    ") << "CBC, CTR and GCM contexts sharing one AES key schedule\n";
+	pass = pass && !fail;
+
+	const unsigned int threadCount = 4;
+	bool threadPassed[threadCount];
+	std::vector<std::thread> threads;
+	for (unsigned int i=0; i<threadCount; i++)
+		threads.push_back(std::thread([&, i]()
+		{
+			threadPassed[i] = true;
+			for (int j=0; j<64; j++)
+				threadPassed[i] = SharedKeyRoundTrip(expandedKey, iv, plain, cbcExpected, ctrExpected, gcmExpected) && threadPassed[i];
+		}));
+	fail = false;
+	for (unsigned int i=0; i<threadCount; i++)
+	{
+		threads[i].join();
+		fail = fail || !threadPassed[i];
+	}
+	cout << (fail ? "FAILED    " : "passed    ") << threadCount << " threads encrypting concurrently under one key schedule\n";
+	pass = pass && !fail;
+
+	try
+	{
+		CTR_Mode_SharedKey<AES>::Encryption(expandedKey, iv).SetKey(key, key.size());
+		fail = true;
+	}
+	catch (const NotImplemented &)
+	{
+		fail = false;
+	}
+	cout << (fail ? "FAILED    " : "passed    ") << "rekeying a shared-key context is refused\n";
+	pass = pass && !fail;
+
+	return pass;
+}
+
+struct XTSTestVector
+{
+	const char *key, *tweak, *plaintext, *ciphertext;
+};
+
+bool ValidateXTS()
+{
+	cout << "\nXTS validation suite running...\n\n";
+
+	// IEEE P1619 vectors 1, 2 and 15, and an AES-256 sector that ends in a partial block
+	static const XTSTestVector vectors[] = {
+		{"0000000000000000000000000000000000000000000000000000000000000000", "00000000000000000000000000000000",
+			"0000000000000000000000000000000000000000000000000000000000000000",
+			"917cf69ebd68b2ec9b9fe9a3eadda692cd43d2f59598ed858c02c2652fbf922e"},
+		{"1111111111111111111111111111111122222222222222222222222222222222", "33333333330000000000000000000000",
+			"4444444444444444444444444444444444444444444444444444444444444444",
+			"c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0"},
+		{"fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0", "9a785634120000000000000000000000",
+			"000102030405060708090a0b0c0d0e0f10",
+			"6c1625db4671522d3d7599601de7ca09ed"},
+		{"27182818284590452353602874713526624977572470936999595749669676273141592653589793238462643383279502884197169399375105820974944592", "ff000000000000000000000000000000",
+			"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f30313233343536",
+			"1c3b3a102f770386e4836c99e370cf9bea00803f5e482357a4ae12d414a3e63b5515ea7c66030422d8c85ba0dbc8bac55d31e276f8fe4a"}
+	};
+
+	bool pass = true, fail;
+	for (unsigned int i=0; i<sizeof(vectors)/sizeof(vectors[0]); i++)
+	{
+		std::string key, tweak, plaintext, ciphertext;
+		StringSource(vectors[i].key, true, new HexDecoder(new StringSink(key)));
+		StringSource(vectors[i].tweak, true, new HexDecoder(new StringSink(tweak)));
+		StringSource(vectors[i].plaintext, true, new HexDecoder(new StringSink(plaintext)));
+		StringSource(vectors[i].ciphertext, true, new HexDecoder(new StringSink(ciphertext)));
+
+		XTS_Mode<AES>::Encryption enc((const byte *)key.data(), key.size());
+		XTS_Mode<AES>::Decryption dec((const byte *)key.data(), key.size());
+		std::string out = plaintext;
+		enc.ProcessSector((const byte *)tweak.data(), (byte *)&out[0], (const byte *)out.data(), out.size());
+		fail = out != ciphertext;
+		dec.ProcessSector((const byte *)tweak.data(), (byte *)&out[0], (const byte *)out.data(), out.size());
+		fail = fail || out != plaintext;
+		pass = pass && !fail;
+
+		cout << (fail ? "FAILED    " : "passed    ") << enc.AlgorithmName() << " (" << key.size()*8 << "-bit key), " << plaintext.size() << "-byte sector\n";
+	}
+
+	// a sector longer than the tweak buffer, addressed by index, checked against another implementation
+	{
+		const byte key[] = "\x11\x11\x11\x11\x11\x11\x11\x11\x11\x11\x11\x11\x11\x11\x11\x11"
+			"\x22\x22\x22\x22\x22\x22\x22\x22\x22\x22\x22\x22\x22\x22\x22\x22";
+		SecByteBlock plain(5000), cipher(5000), digest(32);
+		for (unsigned int i=0; i<plain.size(); i++)
+			plain[i] = byte(i*7%251);
+
+		XTS_Mode<AES>::Encryption enc(key, 32);
+		XTS_Mode<AES>::Decryption dec(key, 32);
+		enc.ProcessSector(W64LIT(0x0123456789), cipher, plain, plain.size());
+		SHA256().CalculateDigest(digest, cipher, cipher.size());
+		fail = memcmp(digest, "\xa5\xce\xcc\xd8\xc6\xeb\x33\xf1\x2a\xbd\xca\xb6\x12\x01\x66\x76"
+			"\x48\x79\xc5\xe2\x62\x5c\xd0\x2d\x98\xeb\xde\x69\x65\x90\xe5\x15", 32) != 0;
+		dec.ProcessSector(W64LIT(0x0123456789), cipher, cipher.size());
+		fail = fail || cipher != plain;
+		pass = pass && !fail;
+
+		cout << (fail ? "FAILED    " : "passed    ") << "5000-byte sector encrypted and decrypted in place\n";
+	}
+
+	try
+	{
+		byte key[32] = {0}, sector[15] = {0};
+		XTS_Mode<AES>::Encryption(key, 32).ProcessSector(0, sector, sizeof(sector));
+		fail = true;
+	}
+	catch (const InvalidArgument &)
+	{
+		fail = false;
+	}
+	fail = fail || XTS_Mode<AES>::Encryption().IsValidKeyLength(16) || !XTS_Mode<AES>::Encryption().IsValidKeyLength(64);
+	pass = pass && !fail;
+	cout << (fail ? "FAILED    " : "passed    ") << "short sectors and single AES keys rejected\n";
+
+	return pass;
+}
+
+struct GCMSIVTestVector
+{
+	const char *key, *nonce, *header, *plaintext, *result;
+};
+
+bool ValidateGCMSIV()
+{
+	cout << "\nAES/GCM-SIV validation suite running...\n\n";
+
+	// RFC 8452 appendix C vectors; the last one wraps the 32-bit block counter
+	static const GCMSIVTestVector vectors[] = {
+		{"01000000000000000000000000000000", "030000000000000000000000", "", "",
+			"dc20e2d83f25705bb49e439eca56de25"},
+		{"01000000000000000000000000000000", "030000000000000000000000", "", "0100000000000000",
+			"b5d839330ac7b786578782fff6013b815b287c22493a364c"},
+		{"01000000000000000000000000000000", "030000000000000000000000", "", "010000000000000000000000",
+			"7323ea61d05932260047d942a4978db357391a0bc4fdec8b0d106639"},
+		{"01000000000000000000000000000000", "030000000000000000000000", "01", "",
+			"a14ee37fc6011f0967f3c0115ebd2e13"},
+		{"01000000000000000000000000000000", "030000000000000000000000", "010000000000000000000000", "02000000",
+			"a8fe3e8707eb1f84fb28f8cb73de8e99e2f48a14"},
+		{"0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "", "",
+			"07f5f4169bbf55a8400cd47ea6fd400f"},
+		{"0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "01",
+			"0100000000000000020000000000000003000000000000000400000000000000",
+			"05f6dd83fd52b7591168bd4702ea9e6dad9b5962bf270a72ca507be4f3c04cb403917bc912d2ee1d554f31af47bc6015"},
+		{"0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "",
+			"000000000000000000000000000000004db923dc793ee6497c76dcc03a98e108",
+			"f3f80f2cf0cb2dd9c5984fcda908456cc537703b5ba70324a6793a7bf218d3eaffffffff000000000000000000000000"}
+	};
+
+	bool pass = true, fail;
+	for (unsigned int i=0; i<sizeof(vectors)/sizeof(vectors[0]); i++)
+	{
+		std::string key, nonce, header, plaintext, result;
+		StringSource(vectors[i].key, true, new HexDecoder(new StringSink(key)));
+		StringSource(vectors[i].nonce, true, new HexDecoder(new StringSink(nonce)));
+		StringSource(vectors[i].header, true, new HexDecoder(new StringSink(header)));
+		StringSource(vectors[i].plaintext, true, new HexDecoder(new StringSink(plaintext)));
+		StringSource(vectors[i].result, true, new HexDecoder(new StringSink(result)));
+
+		GCM_SIV<AES>::Encryption enc;
+		GCM_SIV<AES>::Decryption dec;
+		enc.SetKey((const byte *)key.data(), key.size());
+		dec.SetKey((const byte *)key.data(), key.size());
+
+		std::string out(plaintext.size() + 16, '\0');
+		enc.EncryptAndAuthenticate((byte *)&out[0], (byte *)&out[plaintext.size()], 16, (const byte *)nonce.data(), (int)nonce.size(),
+			(const byte *)header.data(), header.size(), (const byte *)plaintext.data(), plaintext.size());
+		fail = out != result;
+
+		std::string recovered(plaintext.size(), '\0');
+		fail = !dec.DecryptAndVerify((byte *)recovered.data(), (const byte *)&result[plaintext.size()], 16, (const byte *)nonce.data(), (int)nonce.size(),
+			(const byte *)header.data(), header.size(), (const byte *)result.data(), plaintext.size()) || fail;
+		fail = fail || recovered != plaintext;
+		pass = pass && !fail;
+
+		cout << (fail ? "FAILED    " : "passed    ") << enc.AlgorithmName() << " (" << key.size()*8 << "-bit key), "
+			<< header.size() << "-byte header, " << plaintext.size() << "-byte message\n";
+	}
+
+	// a message longer than the counter buffer, checked against another implementation, and tampering
+	{
+		const byte key[] = "\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f";
+		const byte nonce[12] = {0};
+		SecByteBlock header(37), plain(5000), cipher(5000+16), digest(32);
+		for (unsigned int i=0; i<header.size(); i++)
+			header[i] = byte(i%7);
+		for (unsigned int i=0; i<plain.size(); i++)
+			plain[i] = byte(i);
+
+		GCM_SIV<AES>::Encryption enc;
+		GCM_SIV<AES>::Decryption dec;
+		enc.SetKey(key, 16);
+		dec.SetKey(key, 16);
+		enc.EncryptAndAuthenticate(cipher, cipher+5000, 16, nonce, 12, header, header.size(), plain, plain.size());
+		SHA256().CalculateDigest(digest, cipher, cipher.size());
+		fail = memcmp(digest, "\xd1\x45\x31\xdc\x14\xe1\xa8\xe1\x9c\x82\xa0\xbb\x35\x3d\x7b\x00"
+			"\xe4\x64\xf5\xe8\x39\xd3\xd4\x9f\x8e\x88\x4e\xe1\xc1\x8e\x3f\x82", 32) != 0;
+
+		SecByteBlock recovered(5000);
+		fail = !dec.DecryptAndVerify(recovered, cipher+5000, 16, nonce, 12, header, header.size(), cipher, 5000) || fail;
+		fail = fail || recovered != plain;
+		pass = pass && !fail;
+		cout << (fail ? "FAILED    " : "passed    ") << "5000-byte message with 37-byte header\n";
+
+		cipher[4321] ^= 1;
+		fail = dec.DecryptAndVerify(recovered, cipher+5000, 16, nonce, 12, header, header.size(), cipher, 5000);
+		cipher[4321] ^= 1;
+		header[0] ^= 1;
+		fail = fail || dec.DecryptAndVerify(recovered, cipher+5000, 16, nonce, 12, header, header.size(), cipher, 5000);
+		fail = fail || std::count(recovered.begin(), recovered.end(), 0) != 5000;
+		pass = pass && !fail;
+		cout << (fail ? "FAILED    " : "passed    ") << "modified ciphertext and header rejected\n";
+	}
+
+	try
+	{
+		byte key[16] = {0}, buf[16];
+		GCM_SIV<AES>::Encryption enc;
+		enc.SetKey(key, 16);
+		enc.Update(buf, sizeof(buf));
+		fail = true;
+	}
+	catch (const NotImplemented &)
+	{
+		fail = false;
+	}
+	pass = pass && !fail;
+	cout << (fail ? "FAILED    " : "passed    ") << "incremental processing rejected\n";
+
+	return pass;
+}
+
+bool ValidateMultiVersionKernels()
+{
+	cout << "\nMultiVersionKernels validation suite running...\n\n";
+
+	const MultiVersionKernels &baseline = *GetMultiVersionKernels(MULTIVERSION_BASELINE);
+	cout << "selected  " << GetMultiVersionKernels().name << " kernels\n";
+
+	// Adler32 needs more than 5552 bytes to reach its modular reductions, and all 0xff bytes to get near overflow
+	const size_t size = 3*5552 + 100;
+	SecByteBlock buf(size + 128);
+	GlobalRNG().GenerateBlock(buf, buf.size());
+
+	bool pass = true;
+	for (int level = MULTIVERSION_BASELINE+1; level < MULTIVERSION_LEVEL_COUNT; level++)
+	{
+		const MultiVersionKernels *kernels = GetMultiVersionKernels(MultiVersionLevel(level));
+		if (!kernels)
+			continue;
+
+		bool fail = false;
+		for (unsigned int i=0; i<32 && !fail; i++)
+		{
+			word32 state[8], expected[8];
+			word64 state64[8], expected64[8];
+			GlobalRNG().GenerateBlock((byte *)state, sizeof(state));
+			GlobalRNG().GenerateBlock((byte *)state64, sizeof(state64));
+			memcpy(expected, state, sizeof(state));
+			memcpy(expected64, state64, sizeof(state64));
+			const word32 *data = (const word32 *)(buf.BytePtr() + 128*i);
+
+			baseline.SHA1_Transform(expected, data);
+			kernels->SHA1_Transform(state, data);
+			fail = fail || memcmp(state, expected, sizeof(state)) != 0;
+			baseline.SHA256_Transform(expected, data);
+			kernels->SHA256_Transform(state, data);
+			fail = fail || memcmp(state, expected, sizeof(state)) != 0;
+			baseline.SHA512_Transform(expected64, (const word64 *)data);
+			kernels->SHA512_Transform(state64, (const word64 *)data);
+			fail = fail || memcmp(state64, expected64, sizeof(state64)) != 0;
+		}
+		pass = pass && !fail;
+		cout << (fail ? "FAILED    " : "passed    ") << kernels->name << " SHA-1, SHA-256 and SHA-512 transforms\n";
+
+		fail = false;
+		for (int fill = 0; fill < 2; fill++)
+		{
+			if (fill)
+				memset(buf, 0xff, buf.size());
+			const size_t lengths[] = {0, 1, 31, 32, 33, 5552, 5553, size};
+			for (unsigned int i=0; i<sizeof(lengths)/sizeof(lengths[0]); i++)
+				for (unsigned int offset=0; offset<3; offset++)
+				{
+					word32 s1 = 65520, s2 = 65520, t1 = 65520, t2 = 65520;
+					baseline.Adler32_Update(t1, t2, buf+offset, lengths[i]);
+					kernels->Adler32_Update(s1, s2, buf+offset, lengths[i]);
+					fail = fail || s1 != t1 || s2 != t2;
+				}
+		}
+		GlobalRNG().GenerateBlock(buf, buf.size());
+		pass = pass && !fail;
+		cout << (fail ? "FAILED    " : "passed    ") << kernels->name << " Adler32\n";
+	}
+
+	return pass;
+}
+
+bool ValidateGF2_32()
+{
+	cout << "\nGF2_32 validation suite running...\n\n";
+
+	const GF2_32 field, other(0x00400007);
+	bool pass = true, fail;
+
+	// x^31 * x = x^32 = the modulus, and the inverse of x is x^31 + (the modulus >> 1)
+	fail = field.Multiply(0x80000000, 2) != 0x8D || other.Multiply(0x80000000, 2) != 0x00400007;
+	fail = fail || field.MultiplicativeInverse(2) != (0x80000000 | (0x8D >> 1));
+	pass = pass && !fail;
+	cout << (fail ? "FAILED    " : "passed    ") << "known answers\n";
+
+	const unsigned int count = 1000;
+	SecBlock<word32> a(count), b(count);
+	GlobalRNG().GenerateBlock((byte *)a.begin(), a.SizeInBytes());
+	GlobalRNG().GenerateBlock((byte *)b.begin(), b.SizeInBytes());
+	a[0] = 0; a[1] = 1; a[2] = 0xffffffff;
+
+	fail = false;
+	for (unsigned int i=0; i<count && !fail; i++)
+		fail = field.IsUnit(a[i]) && field.Multiply(a[i], field.MultiplicativeInverse(a[i])) != 1;
+	pass = pass && !fail;
+	cout << (fail ? "FAILED    " : "passed    ") << "multiplicative inverses\n";
+
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+	// the CLMUL code must agree with the portable code, which is run by clearing the flag it depends on
+	if (HasCLMUL())
+	{
+		std::vector<word32> results[2];
+		for (int portable=0; portable<2; portable++)
+		{
+			g_hasCLMUL = !portable;
+			for (unsigned int i=0; i<count; i++)
+			{
+				results[portable].push_back(field.Multiply(a[i], b[i]));
+				results[portable].push_back(other.Multiply(a[i], b[i]));
+				results[portable].push_back(field.MultiplicativeInverse(a[i]));
+			}
+			for (unsigned int n=0; n<=count; n += (n < 20) ? 1 : 97)
+			{
+				results[portable].push_back(field.InnerProduct(a, b, n));
+				results[portable].push_back(other.InnerProduct(a+1, b+3, n/2));
+			}
+		}
+		g_hasCLMUL = true;
+
+		fail = results[0] != results[1];
+		pass = pass && !fail;
+		cout << (fail ? "FAILED    " : "passed    ") << "PCLMULQDQ products, inner products and inverses match the portable code\n";
+	}
+#endif
+
+	return pass;
+}
@@ -25,6 +25,7 @@
 #include "oids.h"
 #include "esign.h"
 #include "osrng.h"
+#include "keycache.h"
 
 #include <iostream>
 #include <iomanip>
@@ -340,6 +341,109 @@ bool ValidateRSA()
 	return pass;
 }
 
+static std::string EncodeRSAPublicKey(const char *filename)
+{
+	FileSource keys(filename, true, new HexDecoder);
+	InvertibleRSAFunction priv;
+	priv.BERDecode(keys);
+
+	std::string encoded;
+	StringSink sink(encoded);
+	RSAFunction(priv).DEREncode(sink);
+	return encoded;
+}
+
+static bool DecodeSubjectPublicKeyInfoFails(const std::string &encoded)
+{
+	try
+	{
+		RSAFunction key;
+		key.BERDecodeSubjectPublicKeyInfo((const byte *)encoded.data(), encoded.size());
+		return false;
+	}
+	catch (BERDecodeErr &)
+	{
+		return true;
+	}
+}
+
+bool ValidatePublicKeyCache()
+{
+	cout << "\nRSA public key cache validation suite running...\n\n";
+
+	bool pass = true, fail;
+	std::string encoded1024 = EncodeRSAPublicKey("TestData/rsa1024.dat");
+	std::string encoded2048 = EncodeRSAPublicKey("TestData/rsa2048.dat");
+	std::string encoded512 = EncodeRSAPublicKey("TestData/rsa512a.dat");
+
+	RSAFunction pub;
+	{
+		StringStore store(encoded1024);
+		pub.BERDecode(store);
+		RSAFunction decoded;
+		decoded.BERDecodeSubjectPublicKeyInfo((const byte *)encoded1024.data(), encoded1024.size());
+		fail = decoded.GetModulus() != pub.GetModulus() || decoded.GetPublicExponent() != pub.GetPublicExponent();
+		pass = pass && !fail;
+
+		cout << (fail ? "FAILED    " : "passed    ");
+		cout << "in-place DER decoding\n";
+	}
+	{
+		std::string badOID = encoded1024, badTag = encoded1024;
+		badOID[badOID.find("\x2a\x86\x48\x86\xf7\x0d\x01\x01\x01") + 8] = 0x05;
+		badTag[0] = SEQUENCE;
+
+		fail = !DecodeSubjectPublicKeyInfoFails(encoded1024.substr(0, encoded1024.size()-1))
+			|| !DecodeSubjectPublicKeyInfoFails(encoded1024 + '\0')
+			|| !DecodeSubjectPublicKeyInfoFails(badOID)
+			|| !DecodeSubjectPublicKeyInfoFails(badTag);
+		pass = pass && !fail;
+
+		cout << (fail ? "FAILED    " : "passed    ");
+		cout << "malformed keys rejected\n";
+	}
+	{
+		RSAFunction precomputed(pub), stale;
+		precomputed.Precompute();
+		stale = precomputed;
+		stale.SetModulus(stale.GetModulus() + 2);
+
+		fail = false;
+		for (unsigned int i=0; i<16; i++)
+		{
+			Integer x(GlobalRNG(), Integer::Zero(), pub.GetModulus()-1);
+			fail = fail || precomputed.ApplyFunction(x) != pub.ApplyFunction(x)
+				|| stale.ApplyFunction(x) != a_exp_b_mod_c(x, stale.GetPublicExponent(), stale.GetModulus());
+		}
+		pass = pass && !fail;
+
+		cout << (fail ? "FAILED    " : "passed    ");
+		cout << "precomputed Montgomery representation\n";
+	}
+	{
+		PublicKeyCache cache(2);
+		PublicKeyCache::RSAFunctionPtr k1 = cache.GetRSAFunction((const byte *)encoded1024.data(), encoded1024.size());
+		PublicKeyCache::RSAFunctionPtr k2 = cache.GetRSAFunction((const byte *)encoded2048.data(), encoded2048.size());
+		fail = cache.GetRSAFunction((const byte *)encoded1024.data(), encoded1024.size()) != k1;
+		cache.GetRSAFunction((const byte *)encoded512.data(), encoded512.size());	// evicts k2
+		fail = fail || cache.GetSize() != 2 || cache.GetHits() != 1 || cache.GetMisses() != 3
+			|| cache.GetRSAFunction((const byte *)encoded1024.data(), encoded1024.size()) != k1
+			|| cache.GetRSAFunction((const byte *)encoded2048.data(), encoded2048.size()) == k2
+			|| k1->GetModulus() != pub.GetModulus();
+		pass = pass && !fail;
+
+		cout << (fail ? "FAILED    " : "passed    ");
+		cout << "LRU lookups and eviction\n";
+
+		FileSource keys("TestData/rsa1024.dat", true, new HexDecoder);
+		RSASS<PKCS1v15, SHA>::Signer signer(keys);
+		RSASS<PKCS1v15, SHA>::Verifier verifier(*k1);
+		pass = SignatureValidate(signer, verifier) && pass;
+	}
+
+	return pass;
+}
+
 bool ValidateDH()
 {
 	cout << "\nDH validation suite running...\n\n";
@@ -54,11 +54,17 @@ bool ValidateVMAC();
 bool ValidateCCM();
 bool ValidateGCM();
 bool ValidateCMAC();
+bool ValidateSharedKey();
+bool ValidateXTS();
+bool ValidateGCMSIV();
+bool ValidateMultiVersionKernels();
+bool ValidateGF2_32();
 
 bool ValidateBBS();
 bool ValidateDH();
 bool ValidateMQV();
 bool ValidateRSA();
+bool ValidatePublicKeyCache();
 bool ValidateElGamal();
 bool ValidateDLIES();
 bool ValidateNR();
@@ -474,95 +474,95 @@ and eax, ebx
 shl ebx, 4
 and ebx, 0f0f0f0f0h
 movzx edi, ah
-movdqa xmm5, XMMWORD PTR [rsi + 32 + 1024 + rdi]
+movdqa xmm5, XMMWORD PTR [rsi + 16 + 1024 + rdi]
 movzx edi, al
-movdqa xmm4, XMMWORD PTR [rsi + 32 + 1024 + rdi]
+movdqa xmm4, XMMWORD PTR [rsi + 16 + 1024 + rdi]
 shr eax, 16
 movzx edi, ah
-movdqa xmm3, XMMWORD PTR [rsi + 32 + 1024 + rdi]
+movdqa xmm3, XMMWORD PTR [rsi + 16 + 1024 + rdi]
 movzx edi, al
-movdqa xmm2, XMMWORD PTR [rsi + 32 + 1024 + rdi]
+movdqa xmm2, XMMWORD PTR [rsi + 16 + 1024 + rdi]
 psrldq xmm0, 4
 movd eax, xmm0
 and eax, 0f0f0f0f0h
 movzx edi, bh
-pxor xmm5, XMMWORD PTR [rsi + 32 + (1-1)*256 + rdi]
+pxor xmm5, XMMWORD PTR [rsi + 16 + (1-1)*256 + rdi]
 movzx edi, bl
-pxor xmm4, XMMWORD PTR [rsi + 32 + (1-1)*256 + rdi]
+pxor xmm4, XMMWORD PTR [rsi + 16 + (1-1)*256 + rdi]
 shr ebx, 16
 movzx edi, bh
-pxor xmm3, XMMWORD PTR [rsi + 32 + (1-1)*256 + rdi]
+pxor xmm3, XMMWORD PTR [rsi + 16 + (1-1)*256 + rdi]
 movzx edi, bl
-pxor xmm2, XMMWORD PTR [rsi + 32 + (1-1)*256 + rdi]
+pxor xmm2, XMMWORD PTR [rsi + 16 + (1-1)*256 + rdi]
 movd ebx, xmm0
 shl ebx, 4
 and ebx, 0f0f0f0f0h
 movzx edi, ah
-pxor xmm5, XMMWORD PTR [rsi + 32 + 1024 + 1*256 + rdi]
+pxor xmm5, XMMWORD PTR [rsi + 16 + 1024 + 1*256 + rdi]
 movzx edi, al
-pxor xmm4, XMMWORD PTR [rsi + 32 + 1024 + 1*256 + rdi]
+pxor xmm4, XMMWORD PTR [rsi + 16 + 1024 + 1*256 + rdi]
 shr eax, 16
 movzx edi, ah
-pxor xmm3, XMMWORD PTR [rsi + 32 + 1024 + 1*256 + rdi]
+pxor xmm3, XMMWORD PTR [rsi + 16 + 1024 + 1*256 + rdi]
 movzx edi, al
-pxor xmm2, XMMWORD PTR [rsi + 32 + 1024 + 1*256 + rdi]
+pxor xmm2, XMMWORD PTR [rsi + 16 + 1024 + 1*256 + rdi]
 psrldq xmm0, 4
 movd eax, xmm0
 and eax, 0f0f0f0f0h
 movzx edi, bh
-pxor xmm5, XMMWORD PTR [rsi + 32 + (2-1)*256 + rdi]
+pxor xmm5, XMMWORD PTR [rsi + 16 + (2-1)*256 + rdi]
 movzx edi, bl
-pxor xmm4, XMMWORD PTR [rsi + 32 + (2-1)*256 + rdi]
+pxor xmm4, XMMWORD PTR [rsi + 16 + (2-1)*256 + rdi]
 shr ebx, 16
 movzx edi, bh
-pxor xmm3, XMMWORD PTR [rsi + 32 + (2-1)*256 + rdi]
+pxor xmm3, XMMWORD PTR [rsi + 16 + (2-1)*256 + rdi]
 movzx edi, bl
-pxor xmm2, XMMWORD PTR [rsi + 32 + (2-1)*256 + rdi]
+pxor xmm2, XMMWORD PTR [rsi + 16 + (2-1)*256 + rdi]
 movd ebx, xmm0
 shl ebx, 4
 and ebx, 0f0f0f0f0h
 movzx edi, ah
-pxor xmm5, XMMWORD PTR [rsi + 32 + 1024 + 2*256 + rdi]
+pxor xmm5, XMMWORD PTR [rsi + 16 + 1024 + 2*256 + rdi]
 movzx edi, al
-pxor xmm4, XMMWORD PTR [rsi + 32 + 1024 + 2*256 + rdi]
+pxor xmm4, XMMWORD PTR [rsi + 16 + 1024 + 2*256 + rdi]
 shr eax, 16
 movzx edi, ah
-pxor xmm3, XMMWORD PTR [rsi + 32 + 1024 + 2*256 + rdi]
+pxor xmm3, XMMWORD PTR [rsi + 16 + 1024 + 2*256 + rdi]
 movzx edi, al
-pxor xmm2, XMMWORD PTR [rsi + 32 + 1024 + 2*256 + rdi]
+pxor xmm2, XMMWORD PTR [rsi + 16 + 1024 + 2*256 + rdi]
 psrldq xmm0, 4
 movd eax, xmm0
 and eax, 0f0f0f0f0h
 movzx edi, bh
-pxor xmm5, XMMWORD PTR [rsi + 32 + (3-1)*256 + rdi]
+pxor xmm5, XMMWORD PTR [rsi + 16 + (3-1)*256 + rdi]
 movzx edi, bl
-pxor xmm4, XMMWORD PTR [rsi + 32 + (3-1)*256 + rdi]
+pxor xmm4, XMMWORD PTR [rsi + 16 + (3-1)*256 + rdi]
 shr ebx, 16
 movzx edi, bh
-pxor xmm3, XMMWORD PTR [rsi + 32 + (3-1)*256 + rdi]
+pxor xmm3, XMMWORD PTR [rsi + 16 + (3-1)*256 + rdi]
 movzx edi, bl
-pxor xmm2, XMMWORD PTR [rsi + 32 + (3-1)*256 + rdi]
+pxor xmm2, XMMWORD PTR [rsi + 16 + (3-1)*256 + rdi]
 movd ebx, xmm0
 shl ebx, 4
 and ebx, 0f0f0f0f0h
 movzx edi, ah
-pxor xmm5, XMMWORD PTR [rsi + 32 + 1024 + 3*256 + rdi]
+pxor xmm5, XMMWORD PTR [rsi + 16 + 1024 + 3*256 + rdi]
 movzx edi, al
-pxor xmm4, XMMWORD PTR [rsi + 32 + 1024 + 3*256 + rdi]
+pxor xmm4, XMMWORD PTR [rsi + 16 + 1024 + 3*256 + rdi]
 shr eax, 16
 movzx edi, ah
-pxor xmm3, XMMWORD PTR [rsi + 32 + 1024 + 3*256 + rdi]
+pxor xmm3, XMMWORD PTR [rsi + 16 + 1024 + 3*256 + rdi]
 movzx edi, al
-pxor xmm2, XMMWORD PTR [rsi + 32 + 1024 + 3*256 + rdi]
+pxor xmm2, XMMWORD PTR [rsi + 16 + 1024 + 3*256 + rdi]
 movzx edi, bh
-pxor xmm5, XMMWORD PTR [rsi + 32 + 3*256 + rdi]
+pxor xmm5, XMMWORD PTR [rsi + 16 + 3*256 + rdi]
 movzx edi, bl
-pxor xmm4, XMMWORD PTR [rsi + 32 + 3*256 + rdi]
+pxor xmm4, XMMWORD PTR [rsi + 16 + 3*256 + rdi]
 shr ebx, 16
 movzx edi, bh
-pxor xmm3, XMMWORD PTR [rsi + 32 + 3*256 + rdi]
+pxor xmm3, XMMWORD PTR [rsi + 16 + 3*256 + rdi]
 movzx edi, bl
-pxor xmm2, XMMWORD PTR [rsi + 32 + 3*256 + rdi]
+pxor xmm2, XMMWORD PTR [rsi + 16 + 3*256 + rdi]
 movdqa xmm0, xmm3
 pslldq xmm3, 1
 pxor xmm2, xmm3
@@ -610,62 +610,62 @@ movd eax, xmm1
 psrldq xmm1, 4
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (0*4+0)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (0*4+0)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (0*4+1)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (0*4+1)*256*16 + rdi*8]
 shr eax, 16
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (0*4+2)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (0*4+2)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (0*4+3)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (0*4+3)*256*16 + rdi*8]
 movd eax, xmm1
 psrldq xmm1, 4
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (1*4+0)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (1*4+0)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (1*4+1)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (1*4+1)*256*16 + rdi*8]
 shr eax, 16
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (1*4+2)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (1*4+2)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (1*4+3)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (1*4+3)*256*16 + rdi*8]
 movd eax, xmm1
 psrldq xmm1, 4
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (2*4+0)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (2*4+0)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (2*4+1)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (2*4+1)*256*16 + rdi*8]
 shr eax, 16
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (2*4+2)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (2*4+2)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (2*4+3)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (2*4+3)*256*16 + rdi*8]
 movd eax, xmm1
 psrldq xmm1, 4
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (3*4+0)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (3*4+0)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (3*4+1)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (3*4+1)*256*16 + rdi*8]
 shr eax, 16
 movzx edi, al
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (3*4+2)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (3*4+2)*256*16 + rdi*8]
 movzx edi, ah
 add rdi, rdi
-pxor xmm0, [rsi + 32 + (3*4+3)*256*16 + rdi*8]
+pxor xmm0, [rsi + 16 + (3*4+3)*256*16 + rdi*8]
 add rcx, 16
 sub rdx, 1
 jnz label1
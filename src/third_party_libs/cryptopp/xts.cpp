@@ -0,0 +1,94 @@
+// xts.cpp - placed in the public domain
+
+#include "pch.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "xts.h"
+#include "misc.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+void XTS_ModeBase::UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params)
+{
+	BlockCipher &dataCipher = AccessDataCipher(), &tweakCipher = AccessTweakCipher();
+	if (dataCipher.BlockSize() != BlockSize() || tweakCipher.BlockSize() != BlockSize())
+		throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
+
+	dataCipher.SetKey(key, length/2, params);
+	tweakCipher.SetKey(key+length/2, length/2, params);
+	m_buffer.New(TWEAK_BUFFER_SIZE);
+}
+
+// write the tweaks for the next length/16 blocks, multiplying m_tweak by x in GF(2^128) for each
+void XTS_ModeBase::GenerateTweaks(byte *tweaks, size_t length)
+{
+	word64 lo = m_tweak[0], hi = m_tweak[1];
+	for (size_t i=0; i<length; i+=16)
+	{
+		PutWord(true, LITTLE_ENDIAN_ORDER, tweaks+i, lo);
+		PutWord(true, LITTLE_ENDIAN_ORDER, tweaks+i+8, hi);
+		word64 carry = 0 - (hi >> 63);
+		hi = (hi << 1) | (lo >> 63);
+		lo = (lo << 1) ^ (carry & 0x87);
+	}
+	m_tweak[0] = lo;
+	m_tweak[1] = hi;
+}
+
+void XTS_ModeBase::ProcessSector(lword sectorIndex, byte *outString, const byte *inString, size_t length)
+{
+	byte tweak[16] = {0};
+	PutWord(false, LITTLE_ENDIAN_ORDER, tweak, word64(sectorIndex));
+	ProcessSector(tweak, outString, inString, length);
+}
+
+void XTS_ModeBase::ProcessSector(const byte *tweak, byte *outString, const byte *inString, size_t length)
+{
+	if (m_buffer.empty())
+		throw InvalidArgument(AlgorithmName() + ": key has not been set");
+	if (length < BlockSize())
+		throw InvalidArgument(AlgorithmName() + ": sector length must be at least " + IntToString(BlockSize()) + " bytes");
+
+	BlockCipher &cipher = AccessDataCipher();
+	byte *buffer = m_buffer;
+
+	AccessTweakCipher().ProcessBlock(tweak, buffer);
+	m_tweak[0] = GetWord<word64>(true, LITTLE_ENDIAN_ORDER, buffer);
+	m_tweak[1] = GetWord<word64>(true, LITTLE_ENDIAN_ORDER, buffer+8);
+
+	size_t tail = length % 16;
+	size_t bulk = length - tail - (tail ? 16 : 0);
+
+	while (bulk > 0)
+	{
+		size_t len = STDMIN(bulk, m_buffer.size());
+		GenerateTweaks(buffer, len);
+		xorbuf(outString, inString, buffer, len);
+		cipher.AdvancedProcessBlocks(outString, buffer, outString, len, BlockTransformation::BT_AllowParallel);
+		inString += len;
+		outString += len;
+		bulk -= len;
+	}
+
+	if (tail)
+	{
+		// ciphertext stealing: the last full block is processed with the tweak after it when decrypting
+		GenerateTweaks(buffer, 32);
+		const byte *t1 = buffer + (IsForwardTransformation() ? 0 : 16);
+		const byte *t2 = buffer + (IsForwardTransformation() ? 16 : 0);
+		byte *b1 = buffer+32, *b2 = buffer+48;
+
+		xorbuf(b1, inString, t1, 16);
+		cipher.ProcessAndXorBlock(b1, t1, b1);
+		memcpy(b2, inString+16, tail);
+		memcpy(b2+tail, b1+tail, 16-tail);
+		memcpy(outString+16, b1, tail);
+		xorbuf(b2, t2, 16);
+		cipher.ProcessAndXorBlock(b2, t2, outString);
+	}
+}
+
+NAMESPACE_END
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef CRYPTOPP_XTS_H
+#define CRYPTOPP_XTS_H
+
+/*! \file
+	XTS mode (IEEE P1619) for random-access encryption of fixed-size sectors.
+*/
+
+#include "cryptlib.h"
+#include "secblock.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+//! .
+class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE XTS_ModeBase : public Algorithm, public SimpleKeyingInterface
+{
+public:
+	std::string AlgorithmName() const
+		{return GetDataCipher().AlgorithmName() + std::string("/XTS");}
+
+	//! the key is the data key followed by the tweak key, each a valid key of the block cipher
+	size_t MinKeyLength() const
+		{return 2*GetDataCipher().MinKeyLength();}
+	size_t MaxKeyLength() const
+		{return 2*GetDataCipher().MaxKeyLength();}
+	size_t DefaultKeyLength() const
+		{return 2*GetDataCipher().DefaultKeyLength();}
+	size_t GetValidKeyLength(size_t n) const
+		{return 2*GetDataCipher().GetValidKeyLength(n/2);}
+	bool IsValidKeyLength(size_t n) const
+		{return n%2 == 0 && GetDataCipher().IsValidKeyLength(n/2);}
+	IV_Requirement IVRequirement() const
+		{return NOT_RESYNCHRONIZABLE;}
+
+	unsigned int BlockSize() const
+		{return 16;}
+	virtual bool IsForwardTransformation() const =0;
+
+	//! encrypt or decrypt a sector in place, using its index as the tweak
+	/*! length must be at least BlockSize(), but need not be a multiple of it (ciphertext stealing is used). */
+	void ProcessSector(lword sectorIndex, byte *data, size_t length)
+		{ProcessSector(sectorIndex, data, data, length);}
+	//! encrypt or decrypt a sector, using its index in little-endian order as the tweak
+	void ProcessSector(lword sectorIndex, byte *outString, const byte *inString, size_t length);
+	//! encrypt or decrypt a sector with an arbitrary 16-byte tweak
+	void ProcessSector(const byte *tweak, byte *outString, const byte *inString, size_t length);
+
+protected:
+	const Algorithm & GetAlgorithm() const
+		{return *this;}
+	void UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params);
+
+	virtual BlockCipher & AccessDataCipher() =0;
+	virtual BlockCipher & AccessTweakCipher() =0;
+	const BlockCipher & GetDataCipher() const
+		{return const_cast<XTS_ModeBase *>(this)->AccessDataCipher();}
+
+private:
+	void GenerateTweaks(byte *tweaks, size_t length);
+
+	// tweaks for up to this many bytes are computed ahead of each AdvancedProcessBlocks() call
+	enum {TWEAK_BUFFER_SIZE = 4096};
+
+	FixedSizeSecBlock<word64, 2> m_tweak;
+	AlignedSecByteBlock m_buffer;
+};
+
+//! .
+template <class T_DataCipher, class T_TweakCipher>
+class XTS_Final : public XTS_ModeBase
+{
+public:
+	XTS_Final() {}
+	XTS_Final(const byte *key, size_t length)
+		{SetKey(key, length);}
+
+	static std::string StaticAlgorithmName()
+		{return T_DataCipher::StaticAlgorithmName() + std::string("/XTS");}
+	bool IsForwardTransformation() const
+		{return m_dataCipher.IsForwardTransformation();}
+
+private:
+	BlockCipher & AccessDataCipher() {return m_dataCipher;}
+	BlockCipher & AccessTweakCipher() {return m_tweakCipher;}
+
+	T_DataCipher m_dataCipher;
+	T_TweakCipher m_tweakCipher;
+};
+
+//! <a href="http://en.wikipedia.org/wiki/Disk_encryption_theory#XEX-based_tweaked-codebook_mode_with_ciphertext_stealing_.28XTS.29">XTS</a> mode, for 128-bit block ciphers
+/*! Each sector is encrypted independently under a tweak derived from its index, so any sector
+	can be rewritten in place and the ciphertext is exactly as long as the plaintext.
+	XTS provides no authentication. */
+template <class CIPHER>
+struct XTS_Mode
+{
+	typedef XTS_Final<typename CIPHER::Encryption, typename CIPHER::Encryption> Encryption;
+	typedef XTS_Final<typename CIPHER::Decryption, typename CIPHER::Encryption> Decryption;
+};
+
+NAMESPACE_END
+
+#endif
@@ -261,6 +261,9 @@ void Deflator::IsolatedInitialize(const NameValuePairs &parameters)
 	m_head.New(HSIZE);
 	m_prev.New(DSIZE);
 	m_matchBuffer.New(DSIZE/2);
+	ConstByteArrayParameter dictionary;
+	if (parameters.GetValue("PresetDictionary", dictionary))
+		m_presetDictionary.Assign(dictionary.begin(), dictionary.size());
 	Reset(true);
 
 	SetDeflateLevel(parameters.GetIntValueWithDefault("DeflateLevel", DEFAULT_DEFLATE_LEVEL));
@@ -293,6 +296,20 @@ void Deflator::Reset(bool forceReset)
 
 	fill(m_literalCounts.begin(), m_literalCounts.end(), 0);
 	fill(m_distanceCounts.begin(), m_distanceCounts.end(), 0);
+
+	// the dictionary sits in the window ahead of the data, so it can be matched but is never output
+	if (!m_presetDictionary.empty())
+	{
+		unsigned int length = (unsigned int)STDMIN(m_presetDictionary.size(), size_t(DSIZE));
+		memcpy(m_byteBuffer, m_presetDictionary + m_presetDictionary.size() - length, length);
+		m_stringStart = m_blockStart = length;
+	}
+}
+
+void Deflator::SetPresetDictionary(const byte *dictionary, size_t length)
+{
+	m_presetDictionary.Assign(dictionary, length);
+	Reset(true);
 }
 
 void Deflator::SetDeflateLevel(int deflateLevel)
@@ -61,13 +61,16 @@ public:
 		if a file has both compressible and uncompressible parts, it may fail to compress some of the
 		compressible parts. */
 	Deflator(BufferedTransformation *attachment=NULL, int deflateLevel=DEFAULT_DEFLATE_LEVEL, int log2WindowSize=DEFAULT_LOG2_WINDOW_SIZE, bool detectUncompressible=true);
-	//! possible parameter names: Log2WindowSize, DeflateLevel, DetectUncompressible
+	//! possible parameter names: Log2WindowSize, DeflateLevel, DetectUncompressible, PresetDictionary
 	Deflator(const NameValuePairs &parameters, BufferedTransformation *attachment=NULL);
 
 	//! this function can be used to set the deflate level in the middle of compression
 	void SetDeflateLevel(int deflateLevel);
 	int GetDeflateLevel() const {return m_deflateLevel;}
 	int GetLog2WindowSize() const {return m_log2WindowSize;}
+	//! preset dictionary for each following message, as in zlib's deflateSetDictionary(); the Inflator needs the same one
+	/*! \note call between messages */
+	void SetPresetDictionary(const byte *dictionary, size_t length);
 
 	void IsolatedInitialize(const NameValuePairs &parameters);
 	size_t Put2(const byte *inString, size_t length, int messageEnd, bool blocking);
@@ -108,7 +111,7 @@ protected:
 	bool m_headerWritten, m_matchAvailable;
 	unsigned int m_dictionaryEnd, m_stringStart, m_lookahead, m_minLookahead, m_previousMatch, m_previousLength;
 	HuffmanEncoder m_staticLiteralEncoder, m_staticDistanceEncoder, m_dynamicLiteralEncoder, m_dynamicDistanceEncoder;
-	SecByteBlock m_byteBuffer;
+	SecByteBlock m_byteBuffer, m_presetDictionary;
 	SecBlock<word16> m_head, m_prev;
 	FixedSizeSecBlock<unsigned int, 286> m_literalCounts;
 	FixedSizeSecBlock<unsigned int, 30> m_distanceCounts;
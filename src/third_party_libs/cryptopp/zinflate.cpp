@@ -222,6 +222,9 @@ void Inflator::IsolatedInitialize(const NameValuePairs &parameters)
 {
 	m_state = PRE_STREAM;
 	parameters.GetValue("Repeat", m_repeat);
+	ConstByteArrayParameter dictionary;
+	if (parameters.GetValue("PresetDictionary", dictionary))
+		m_presetDictionary.Assign(dictionary.begin(), dictionary.size());
 	m_inQueue.Clear();
 	m_reader.SkipBits(m_reader.BitsBuffered());
 }
@@ -329,6 +332,14 @@ void Inflator::ProcessInput(bool flush)
 			m_current = 0;
 			m_lastFlush = 0;
 			m_window.New(1 << GetLog2WindowSize());
+			if (!m_presetDictionary.empty())
+			{
+				// distances may reach back into the dictionary, which is not output
+				size_t length = STDMIN(m_presetDictionary.size(), m_window.size());
+				memcpy(m_window, m_presetDictionary + m_presetDictionary.size() - length, length);
+				m_current = m_lastFlush = length % m_window.size();
+				m_wrappedAround = (length == m_window.size());
+			}
 			break;
 		case WAIT_HEADER:
 			{
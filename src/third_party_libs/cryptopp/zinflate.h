@@ -99,10 +99,15 @@ public:
 	*/
 	Inflator(BufferedTransformation *attachment = NULL, bool repeat = false, int autoSignalPropagation = -1);
 
+	//! possible parameter names: Repeat, PresetDictionary
 	void IsolatedInitialize(const NameValuePairs &parameters);
 	size_t Put2(const byte *inString, size_t length, int messageEnd, bool blocking);
 	bool IsolatedFlush(bool hardFlush, bool blocking);
 
+	//! the dictionary the Deflator was given; takes effect from the next compressed stream
+	void SetPresetDictionary(const byte *dictionary, size_t length)
+		{m_presetDictionary.Assign(dictionary, length);}
+
 	virtual unsigned int GetLog2WindowSize() const {return 15;}
 
 protected:
@@ -140,7 +145,7 @@ private:
 	unsigned int m_literal, m_distance;	// for LENGTH_BITS or DISTANCE_BITS
 	HuffmanDecoder m_dynamicLiteralDecoder, m_dynamicDistanceDecoder;
 	LowFirstBitReader m_reader;
-	SecByteBlock m_window;
+	SecByteBlock m_window, m_presetDictionary;
 	size_t m_current, m_lastFlush;
 };
 
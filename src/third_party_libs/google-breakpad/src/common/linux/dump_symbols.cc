@@ -729,7 +729,8 @@ bool WriteSymbolFileInternal(uint8_t* obj_file,
                              const std::string &obj_filename,
                              const std::string &debug_dir,
                              bool cfi,
-                             std::ostream &sym_stream) {
+                             std::ostream &sym_stream,
+                             std::ostream *index_stream) {
   ElfW(Ehdr) *elf_header = reinterpret_cast<ElfW(Ehdr) *>(obj_file);
 
   if (!IsValidElf(elf_header)) {
@@ -806,6 +807,8 @@ bool WriteSymbolFileInternal(uint8_t* obj_file,
   }
   if (!module.Write(sym_stream, cfi))
     return false;
+  if (index_stream && !module.WriteIndex(*index_stream))
+    return false;
 
   return true;
 }
@@ -814,13 +817,22 @@ bool WriteSymbolFile(const std::string &obj_file,
                      const std::string &debug_dir,
                      bool cfi,
                      std::ostream &sym_stream) {
+  return WriteSymbolFile(obj_file, debug_dir, cfi, sym_stream, NULL);
+}
+
+bool WriteSymbolFile(const std::string &obj_file,
+                     const std::string &debug_dir,
+                     bool cfi,
+                     std::ostream &sym_stream,
+                     std::ostream *index_stream) {
   MmapWrapper map_wrapper;
   ElfW(Ehdr) *elf_header = NULL;
   if (!LoadELF(obj_file, &map_wrapper, &elf_header))
     return false;
 
   return WriteSymbolFileInternal(reinterpret_cast<uint8_t*>(elf_header),
-                                 obj_file, debug_dir, cfi, sym_stream);
+                                 obj_file, debug_dir, cfi, sym_stream,
+                                 index_stream);
 }
 
 }  // namespace google_breakpad
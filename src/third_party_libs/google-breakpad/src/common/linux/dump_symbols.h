@@ -51,6 +51,14 @@ bool WriteSymbolFile(const std::string &obj_file,
                      bool cfi,
                      std::ostream &sym_stream);
 
+// As above, and if INDEX_STREAM is not NULL, also write a symbol index
+// for the same module to it; see common/symbol_index_format.h.
+bool WriteSymbolFile(const std::string &obj_file,
+                     const std::string &debug_dir,
+                     bool cfi,
+                     std::ostream &sym_stream,
+                     std::ostream *index_stream);
+
 }  // namespace google_breakpad
 
 #endif  // COMMON_LINUX_DUMP_SYMBOLS_H__
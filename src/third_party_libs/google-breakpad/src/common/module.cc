@@ -38,15 +38,72 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <iostream>
 #include <utility>
 
+#include "common/symbol_index_format.h"
+
 namespace google_breakpad {
 
 using std::dec;
 using std::endl;
 using std::hex;
 
+namespace {
+
+// The string table of a symbol index under construction. Each distinct
+// string is stored once.
+class IndexStringTable {
+ public:
+  IndexStringTable() : data_(1, '\0') { }
+
+  // Return the offset of STR in the table, adding it if necessary.
+  u_int32_t Add(const string &str) {
+    if (str.empty())
+      return 0;
+    map<string, u_int32_t>::iterator it = offsets_.lower_bound(str);
+    if (it != offsets_.end() && it->first == str)
+      return it->second;
+    u_int32_t offset = data_.size();
+    data_.insert(data_.end(), str.begin(), str.end());
+    data_.push_back('\0');
+    offsets_.insert(it, std::make_pair(str, offset));
+    return offset;
+  }
+
+  const vector<char> &data() const { return data_; }
+
+ private:
+  vector<char> data_;
+  map<string, u_int32_t> offsets_;
+};
+
+// Return the offset at which a table of SIZE bytes placed after
+// *END should start, and advance *END past it.
+u_int64_t PlaceIndexTable(u_int64_t size, u_int64_t *end) {
+  u_int64_t offset = (*end + 7) & ~static_cast<u_int64_t>(7);
+  *end = offset + size;
+  return offset;
+}
+
+// Write SIZE bytes at DATA to STREAM at OFFSET, padding from *POSITION.
+bool WriteIndexTable(std::ostream &stream, u_int64_t offset,
+                     const void *data, size_t size, u_int64_t *position) {
+  static const char padding[8] = { 0 };
+  assert(offset >= *position && offset - *position < sizeof(padding));
+  stream.write(padding, offset - *position);
+  stream.write(static_cast<const char *>(data), size);
+  *position = offset + size;
+  return stream.good();
+}
+
+bool CompareIndexLines(const SymbolIndexLine &x, const SymbolIndexLine &y) {
+  return x.address < y.address;
+}
+
+}  // namespace
+
 
 Module::Module(const string &name, const string &os,
                const string &architecture, const string &id) :
@@ -291,4 +348,123 @@ bool Module::Write(std::ostream &stream, bool cfi) {
   return true;
 }
 
+bool Module::WriteIndex(std::ostream &stream) {
+  AssignSourceIds();
+
+  IndexStringTable strings;
+  SymbolIndexHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kSymbolIndexMagic, sizeof(header.magic));
+  header.version = kSymbolIndexVersion;
+  header.byte_order = kSymbolIndexByteOrder;
+  header.os = strings.Add(os_);
+  header.architecture = strings.Add(architecture_);
+  header.id = strings.Add(id_);
+  header.name = strings.Add(name_);
+
+  // Files, indexed by source id. AssignSourceIds numbers them in the
+  // map's order.
+  vector<u_int32_t> files;
+  for (FileByNameMap::iterator file_it = files_.begin();
+       file_it != files_.end(); ++file_it) {
+    File *file = file_it->second;
+    if (file->source_id >= 0) {
+      assert(static_cast<size_t>(file->source_id) == files.size());
+      files.push_back(strings.Add(file->name));
+    }
+  }
+
+  // Functions, and their lines.
+  vector<SymbolIndexFunction> functions;
+  vector<SymbolIndexLine> lines;
+  functions.reserve(functions_.size());
+  for (FunctionSet::const_iterator func_it = functions_.begin();
+       func_it != functions_.end(); ++func_it) {
+    Function *func = *func_it;
+    SymbolIndexFunction record;
+    record.address = func->address - load_address_;
+    record.size = func->size;
+    record.parameter_size = func->parameter_size;
+    record.name = strings.Add(func->name);
+    size_t first_line = lines.size();
+
+    // Line addresses are stored as offsets from the function's, so
+    // drop any lines that cannot be.
+    for (vector<Line>::iterator line_it = func->lines.begin();
+         line_it != func->lines.end(); ++line_it) {
+      if (line_it->address < func->address
+          || line_it->address - func->address > 0xffffffff)
+        continue;
+      SymbolIndexLine line;
+      line.address = line_it->address - func->address;
+      line.size = std::min<Address>(line_it->size, 0xffffffff);
+      line.number = line_it->number;
+      line.file = line_it->file->source_id;
+      lines.push_back(line);
+    }
+
+    // The reader searches each function's lines, so make sure they
+    // are in order even if whoever built them did not.
+    std::stable_sort(lines.begin() + first_line, lines.end(),
+                     CompareIndexLines);
+    record.first_line = lines.size() == first_line ? kSymbolIndexNoLines
+                                                   : first_line;
+    record.line_count = lines.size() - first_line;
+    functions.push_back(record);
+  }
+
+  // Public records.
+  vector<SymbolIndexPublic> publics;
+  publics.reserve(externs_.size());
+  for (ExternSet::const_iterator extern_it = externs_.begin();
+       extern_it != externs_.end(); ++extern_it) {
+    SymbolIndexPublic record;
+    record.address = (*extern_it)->address - load_address_;
+    record.name = strings.Add((*extern_it)->name);
+    record.reserved = 0;
+    publics.push_back(record);
+  }
+
+  // Lay the tables out after the header.
+  u_int64_t end = sizeof(header);
+  header.functions.count = functions.size();
+  header.functions.offset =
+      PlaceIndexTable(functions.size() * sizeof(SymbolIndexFunction), &end);
+  header.lines.count = lines.size();
+  header.lines.offset =
+      PlaceIndexTable(lines.size() * sizeof(SymbolIndexLine), &end);
+  header.publics.count = publics.size();
+  header.publics.offset =
+      PlaceIndexTable(publics.size() * sizeof(SymbolIndexPublic), &end);
+  header.files.count = files.size();
+  header.files.offset =
+      PlaceIndexTable(files.size() * sizeof(u_int32_t), &end);
+  header.strings.count = strings.data().size();
+  header.strings.offset = PlaceIndexTable(strings.data().size(), &end);
+
+  u_int64_t position = 0;
+  if (!WriteIndexTable(stream, 0, &header, sizeof(header), &position)
+      || !WriteIndexTable(stream, header.functions.offset,
+                          functions.empty() ? NULL : &functions[0],
+                          functions.size() * sizeof(SymbolIndexFunction),
+                          &position)
+      || !WriteIndexTable(stream, header.lines.offset,
+                          lines.empty() ? NULL : &lines[0],
+                          lines.size() * sizeof(SymbolIndexLine),
+                          &position)
+      || !WriteIndexTable(stream, header.publics.offset,
+                          publics.empty() ? NULL : &publics[0],
+                          publics.size() * sizeof(SymbolIndexPublic),
+                          &position)
+      || !WriteIndexTable(stream, header.files.offset,
+                          files.empty() ? NULL : &files[0],
+                          files.size() * sizeof(u_int32_t), &position)
+      || !WriteIndexTable(stream, header.strings.offset,
+                          &strings.data()[0], strings.data().size(),
+                          &position))
+    return ReportError();
+
+  return true;
+}
+
 }  // namespace google_breakpad
@@ -267,6 +267,14 @@ class Module {
   // established by SetLoadAddress.
   bool Write(std::ostream &stream, bool cfi);
 
+  // Call AssignSourceIds, and write this module's files, functions,
+  // lines and public records to STREAM as a symbol index, which can be
+  // searched in place once mapped into memory; see
+  // common/symbol_index_format.h. Return true if all goes well, or
+  // false if an error occurs. As with Write, addresses in the output
+  // are relative to the load address.
+  bool WriteIndex(std::ostream &stream);
+
  private:
   // Report an error that has occurred writing the symbol file, using
   // errno to find the appropriate cause.  Return false.
@@ -0,0 +1,127 @@
+// Copyright (c) 2026 MaidSafe.net limited
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of MaidSafe.net limited nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_index_format.h: Define the layout of a Breakpad symbol index.
+//
+// A symbol index holds the FUNC, line and PUBLIC records of a Breakpad
+// symbol file in a form that can be mapped into memory and searched in
+// place, without parsing. It is written by Module::WriteIndex alongside
+// the textual symbol file, and read by google_breakpad::SymbolIndex.
+//
+// The file is a SymbolIndexHeader followed by the tables it describes.
+// Each table is an array of fixed-size records starting at an 8-byte
+// aligned offset from the start of the file:
+//
+// - functions: SymbolIndexFunction records, sorted by address. Each
+//   function's lines are a contiguous run of the line table.
+// - lines: SymbolIndexLine records, sorted by address within each
+//   function. A line's address is an offset from its function's, which
+//   halves the size of the largest table.
+// - publics: SymbolIndexPublic records, sorted by address.
+// - files: u_int32_t string offsets, indexed by source id.
+// - strings: NUL-terminated strings, referred to by their offset from
+//   the start of the string table. Offset zero is the empty string.
+//
+// Addresses are relative to the module's load address, as in the
+// textual symbol file. All integers are in the byte order of the
+// machine that wrote the file; a reader on a machine of the other byte
+// order sees a bad byte_order field and rejects the file. STACK CFI
+// records are not included.
+
+#ifndef COMMON_SYMBOL_INDEX_FORMAT_H__
+#define COMMON_SYMBOL_INDEX_FORMAT_H__
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+// The first eight bytes of every symbol index.
+static const char kSymbolIndexMagic[8] = { 'B', 'P', 'S', 'Y', 'M', 'I', 'D',
+                                           'X' };
+
+// The format version described by this file. A reader rejects files
+// with any other version.
+static const u_int32_t kSymbolIndexVersion = 1;
+
+// Written as-is, and so read back as this value only by a machine of
+// the same byte order.
+static const u_int32_t kSymbolIndexByteOrder = 0x01020304;
+
+// Stored in SymbolIndexFunction::first_line when a function has no
+// lines.
+static const u_int32_t kSymbolIndexNoLines = 0xffffffff;
+
+struct SymbolIndexTable {
+  u_int64_t offset;   // From the start of the file.
+  u_int64_t count;    // Number of records; bytes for the string table.
+};
+
+struct SymbolIndexHeader {
+  char magic[8];                // kSymbolIndexMagic.
+  u_int32_t version;            // kSymbolIndexVersion.
+  u_int32_t byte_order;         // kSymbolIndexByteOrder.
+
+  // The MODULE record, as string table offsets.
+  u_int32_t os;
+  u_int32_t architecture;
+  u_int32_t id;
+  u_int32_t name;
+
+  SymbolIndexTable functions;
+  SymbolIndexTable lines;
+  SymbolIndexTable publics;
+  SymbolIndexTable files;
+  SymbolIndexTable strings;
+};
+
+struct SymbolIndexFunction {
+  u_int64_t address;
+  u_int64_t size;
+  u_int32_t parameter_size;
+  u_int32_t name;               // String table offset.
+  u_int32_t first_line;         // Line table index, or kSymbolIndexNoLines.
+  u_int32_t line_count;
+};
+
+struct SymbolIndexLine {
+  u_int32_t address;            // Relative to the function's address.
+  u_int32_t size;
+  u_int32_t number;
+  u_int32_t file;               // Source id: an index into the file table.
+};
+
+struct SymbolIndexPublic {
+  u_int64_t address;
+  u_int32_t name;               // String table offset.
+  u_int32_t reserved;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_SYMBOL_INDEX_FORMAT_H__
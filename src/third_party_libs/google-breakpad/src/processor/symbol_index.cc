@@ -0,0 +1,341 @@
+// Copyright (c) 2026 MaidSafe.net limited
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of MaidSafe.net limited nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_index.cc: Implement google_breakpad::SymbolIndex. See
+// symbol_index.h.
+
+#include "processor/symbol_index.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace google_breakpad {
+
+namespace {
+
+// Splitting a batch of lookups between threads only pays off once each
+// thread has at least this many addresses to look up.
+const size_t kMinAddressesPerThread = 16384;
+
+// Return true if the table TABLE, of records RECORD_SIZE bytes long,
+// lies within an index of SIZE bytes. Report the problem and return
+// false if not.
+bool CheckTable(const SymbolIndexTable &table, size_t record_size,
+                size_t size, const char *what) {
+  if (table.offset % 8 != 0
+      || table.offset > size
+      || table.count > (size - table.offset) / record_size) {
+    fprintf(stderr, "symbol index %s table is out of bounds\n", what);
+    return false;
+  }
+  return true;
+}
+
+// Return the last record in [BEGIN, END) whose address is not greater
+// than ADDRESS, or NULL if there is none. The records must be sorted by
+// address.
+template <typename Record>
+const Record *FindPreceding(const Record *begin, const Record *end,
+                            u_int64_t address) {
+  size_t count = end - begin;
+  if (count == 0 || address < begin->address)
+    return NULL;
+  // The branch-free form of upper_bound - 1: the loop always runs
+  // log2(count) times, and the compiler turns the step into a
+  // conditional move.
+  const Record *base = begin;
+  while (count > 1) {
+    size_t half = count / 2;
+    base = (base[half].address <= address) ? base + half : base;
+    count -= half;
+  }
+  return base;
+}
+
+// Like FindPreceding, but for the kLookupBatch addresses at ADDRESSES
+// at once, storing the results in RESULTS. The searches run in lockstep
+// so that their cache misses overlap, rather than each waiting on the
+// last.
+const size_t kLookupBatch = 8;
+
+template <typename Record>
+void FindPrecedingBatch(const Record *begin, const Record *end,
+                        const u_int64_t *addresses, const Record **results) {
+  size_t count = end - begin;
+  const Record *base[kLookupBatch];
+  for (size_t i = 0; i < kLookupBatch; ++i)
+    base[i] = begin;
+  while (count > 1) {
+    size_t half = count / 2;
+    for (size_t i = 0; i < kLookupBatch; ++i)
+      base[i] = (base[i][half].address <= addresses[i]) ? base[i] + half
+                                                        : base[i];
+    count -= half;
+  }
+  for (size_t i = 0; i < kLookupBatch; ++i) {
+    results[i] = (count == 0 || addresses[i] < base[i]->address) ? NULL
+                                                                 : base[i];
+  }
+}
+
+}  // namespace
+
+SymbolIndex::SymbolIndex()
+    : mapping_(NULL),
+      mapping_size_(0),
+      header_(NULL),
+      functions_(NULL),
+      function_count_(0),
+      lines_(NULL),
+      line_count_(0),
+      publics_(NULL),
+      public_count_(0),
+      files_(NULL),
+      file_count_(0),
+      strings_(NULL),
+      strings_size_(0) { }
+
+SymbolIndex::~SymbolIndex() {
+  Close();
+}
+
+bool SymbolIndex::Open(const std::string &path) {
+  Close();
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open symbol index %s: %s\n",
+            path.c_str(), strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    fprintf(stderr, "Failed to stat symbol index %s: %s\n",
+            path.c_str(), strerror(errno));
+    close(fd);
+    return false;
+  }
+  if (st.st_size < static_cast<off_t>(sizeof(SymbolIndexHeader))) {
+    fprintf(stderr, "Symbol index %s is too short\n", path.c_str());
+    close(fd);
+    return false;
+  }
+  void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    fprintf(stderr, "Failed to map symbol index %s: %s\n",
+            path.c_str(), strerror(errno));
+    return false;
+  }
+
+  if (!Load(mapping, st.st_size)) {
+    fprintf(stderr, "%s is not a usable symbol index\n", path.c_str());
+    munmap(mapping, st.st_size);
+    return false;
+  }
+  mapping_ = mapping;
+  mapping_size_ = st.st_size;
+  return true;
+}
+
+bool SymbolIndex::Load(const void *data, size_t size) {
+  Close();
+
+  if (size < sizeof(SymbolIndexHeader)) {
+    fprintf(stderr, "symbol index is too short\n");
+    return false;
+  }
+  const SymbolIndexHeader *header =
+      static_cast<const SymbolIndexHeader *>(data);
+  if (memcmp(header->magic, kSymbolIndexMagic, sizeof(header->magic)) != 0) {
+    fprintf(stderr, "symbol index has a bad magic number\n");
+    return false;
+  }
+  if (header->byte_order != kSymbolIndexByteOrder) {
+    fprintf(stderr, "symbol index was written with the other byte order\n");
+    return false;
+  }
+  if (header->version != kSymbolIndexVersion) {
+    fprintf(stderr, "symbol index has unsupported version %u\n",
+            header->version);
+    return false;
+  }
+  if (!CheckTable(header->functions, sizeof(SymbolIndexFunction), size,
+                  "function")
+      || !CheckTable(header->lines, sizeof(SymbolIndexLine), size, "line")
+      || !CheckTable(header->publics, sizeof(SymbolIndexPublic), size,
+                     "public")
+      || !CheckTable(header->files, sizeof(u_int32_t), size, "file")
+      || !CheckTable(header->strings, 1, size, "string"))
+    return false;
+
+  // Every string must be terminated within the table, which is so if
+  // the last one is.
+  const char *base = static_cast<const char *>(data);
+  const char *strings = base + header->strings.offset;
+  if (header->strings.count == 0
+      || strings[header->strings.count - 1] != '\0') {
+    fprintf(stderr, "symbol index string table is not terminated\n");
+    return false;
+  }
+
+  header_ = header;
+  functions_ = reinterpret_cast<const SymbolIndexFunction *>(
+      base + header->functions.offset);
+  function_count_ = header->functions.count;
+  lines_ = reinterpret_cast<const SymbolIndexLine *>(
+      base + header->lines.offset);
+  line_count_ = header->lines.count;
+  publics_ = reinterpret_cast<const SymbolIndexPublic *>(
+      base + header->publics.offset);
+  public_count_ = header->publics.count;
+  files_ = reinterpret_cast<const u_int32_t *>(base + header->files.offset);
+  file_count_ = header->files.count;
+  strings_ = strings;
+  strings_size_ = header->strings.count;
+  return true;
+}
+
+void SymbolIndex::Close() {
+  if (mapping_)
+    munmap(mapping_, mapping_size_);
+  mapping_ = NULL;
+  mapping_size_ = 0;
+  header_ = NULL;
+  functions_ = NULL;
+  function_count_ = 0;
+  lines_ = NULL;
+  line_count_ = 0;
+  publics_ = NULL;
+  public_count_ = 0;
+  files_ = NULL;
+  file_count_ = 0;
+  strings_ = NULL;
+  strings_size_ = 0;
+}
+
+bool SymbolIndex::Lookup(u_int64_t address, Frame *frame) const {
+  // The index holds no overlapping functions, so only the last one
+  // starting at or before ADDRESS can contain it.
+  return Resolve(address,
+                 FindPreceding(functions_, functions_ + function_count_,
+                               address),
+                 frame);
+}
+
+bool SymbolIndex::Resolve(u_int64_t address,
+                          const SymbolIndexFunction *function,
+                          Frame *frame) const {
+  frame->function = NULL;
+  frame->function_address = 0;
+  frame->file = NULL;
+  frame->line = 0;
+
+  if (function && address - function->address < function->size) {
+    frame->function = String(function->name);
+    frame->function_address = function->address;
+
+    if (function->first_line != kSymbolIndexNoLines
+        && function->first_line <= line_count_
+        && function->line_count <= line_count_ - function->first_line) {
+      u_int64_t offset = address - function->address;
+      const SymbolIndexLine *first = lines_ + function->first_line;
+      const SymbolIndexLine *line =
+          FindPreceding(first, first + function->line_count, offset);
+      if (line && offset - line->address < line->size) {
+        frame->file = line->file < file_count_ ? String(files_[line->file])
+                                               : "";
+        frame->line = line->number;
+      }
+    }
+    return true;
+  }
+
+  // Public symbols have no size: an address belongs to the last one
+  // before it, unless a function lies between them.
+  const SymbolIndexPublic *symbol =
+      FindPreceding(publics_, publics_ + public_count_, address);
+  if (symbol
+      && !(function && function->address > symbol->address)) {
+    frame->function = String(symbol->name);
+    frame->function_address = symbol->address;
+    return true;
+  }
+  return false;
+}
+
+void SymbolIndex::LookupRange(const u_int64_t *addresses, size_t count,
+                              Frame *frames) const {
+  size_t i = 0;
+  for (; i + kLookupBatch <= count; i += kLookupBatch) {
+    const SymbolIndexFunction *functions[kLookupBatch];
+    FindPrecedingBatch(functions_, functions_ + function_count_,
+                       addresses + i, functions);
+    for (size_t j = 0; j < kLookupBatch; ++j)
+      Resolve(addresses[i + j], functions[j], &frames[i + j]);
+  }
+  for (; i < count; ++i)
+    Lookup(addresses[i], &frames[i]);
+}
+
+void SymbolIndex::LookupAll(const u_int64_t *addresses, size_t count,
+                            Frame *frames, int threads) const {
+  size_t thread_count = std::max(threads, 1);
+  thread_count = std::min(thread_count,
+                          std::max<size_t>(count / kMinAddressesPerThread, 1));
+  if (thread_count == 1) {
+    LookupRange(addresses, count, frames);
+    return;
+  }
+
+  // Give each thread a contiguous slice, and do the last slice on this
+  // thread.
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count - 1);
+  size_t slice = (count + thread_count - 1) / thread_count;
+  size_t begin = 0;
+  for (size_t i = 0; i + 1 < thread_count; ++i, begin += slice) {
+    workers.push_back(std::thread(&SymbolIndex::LookupRange, this,
+                                  addresses + begin, slice, frames + begin));
+  }
+  LookupRange(addresses + begin, count - begin, frames + begin);
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,148 @@
+// Copyright (c) 2026 MaidSafe.net limited
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of MaidSafe.net limited nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_index.h: Define google_breakpad::SymbolIndex, which maps a
+// symbol index written by Module::WriteIndex into memory and looks
+// addresses up in it.
+//
+// Looking up an address is a pair of binary searches over the mapped
+// tables, with no parsing and no allocation, so an index is ready as
+// soon as it is opened, and any number of threads may look addresses
+// up in it at once.
+
+#ifndef PROCESSOR_SYMBOL_INDEX_H__
+#define PROCESSOR_SYMBOL_INDEX_H__
+
+#include <stddef.h>
+
+#include <string>
+
+#include "common/symbol_index_format.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class SymbolIndex {
+ public:
+  // What is known about one address. The strings point into the index,
+  // and are valid until it is closed.
+  struct Frame {
+    // The name of the function or public symbol containing the address,
+    // or NULL if there is none.
+    const char *function;
+
+    // The address at which that function or public symbol starts.
+    u_int64_t function_address;
+
+    // The source file and line of the address, or NULL and zero if it
+    // has no line information.
+    const char *file;
+    int line;
+  };
+
+  SymbolIndex();
+  ~SymbolIndex();
+
+  // Map the symbol index at PATH into memory, closing any index opened
+  // before. Return true on success. On failure, report the problem to
+  // stderr and return false.
+  bool Open(const std::string &path);
+
+  // Use the SIZE bytes at DATA as the symbol index, closing any index
+  // opened before. The memory must stay valid, and unchanged, until
+  // this index is closed; it must be aligned to 8 bytes. Return true on
+  // success. On failure, report the problem to stderr and return false.
+  bool Load(const void *data, size_t size);
+
+  // Release the index. Frames it has filled in become invalid.
+  void Close();
+
+  // Fill in FRAME with what is known about ADDRESS, which is relative to
+  // the module's load address, as in the symbol file. Return true if
+  // ADDRESS is in a function or follows a public symbol. Otherwise
+  // clear FRAME and return false.
+  bool Lookup(u_int64_t address, Frame *frame) const;
+
+  // Look up each of the COUNT addresses at ADDRESSES, storing the
+  // results in FRAMES, and using up to THREADS threads at once.
+  void LookupAll(const u_int64_t *addresses, size_t count, Frame *frames,
+                 int threads) const;
+
+  // The fields of the module's MODULE record. Empty if no index is
+  // open.
+  const char *os() const { return String(header_ ? header_->os : 0); }
+  const char *architecture() const {
+    return String(header_ ? header_->architecture : 0);
+  }
+  const char *id() const { return String(header_ ? header_->id : 0); }
+  const char *name() const { return String(header_ ? header_->name : 0); }
+
+ private:
+  // Return the string at OFFSET in the string table, or the empty
+  // string if OFFSET is out of range.
+  const char *String(u_int32_t offset) const {
+    return offset < strings_size_ ? strings_ + offset : "";
+  }
+
+  // Fill in FRAME for ADDRESS, given FUNCTION, the last function
+  // starting at or before it, or NULL if there is none. Return as for
+  // Lookup.
+  bool Resolve(u_int64_t address, const SymbolIndexFunction *function,
+               Frame *frame) const;
+
+  // Look up the COUNT addresses at ADDRESSES, storing the results in
+  // FRAMES.
+  void LookupRange(const u_int64_t *addresses, size_t count,
+                   Frame *frames) const;
+
+  // The mapping made by Open, if any.
+  void *mapping_;
+  size_t mapping_size_;
+
+  // The tables of the index, or NULL if no index is open.
+  const SymbolIndexHeader *header_;
+  const SymbolIndexFunction *functions_;
+  size_t function_count_;
+  const SymbolIndexLine *lines_;
+  size_t line_count_;
+  const SymbolIndexPublic *publics_;
+  size_t public_count_;
+  const u_int32_t *files_;
+  size_t file_count_;
+  const char *strings_;
+  size_t strings_size_;
+
+  // Disallow copying and assignment.
+  SymbolIndex(const SymbolIndex &);
+  void operator=(const SymbolIndex &);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_INDEX_H__
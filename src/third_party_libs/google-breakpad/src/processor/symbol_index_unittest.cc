@@ -0,0 +1,228 @@
+// Copyright (c) 2026 MaidSafe.net limited
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of MaidSafe.net limited nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_index_unittest.cc: Unit tests for google_breakpad::SymbolIndex,
+// reading back indexes written by Module::WriteIndex.
+
+#include <string.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "common/module.h"
+#include "processor/symbol_index.h"
+
+using google_breakpad::Module;
+using google_breakpad::SymbolIndex;
+using std::string;
+using std::stringstream;
+using std::vector;
+
+namespace {
+
+// Write MODULE as a symbol index, and load it into INDEX. BUFFER holds
+// the index, and must outlive INDEX's use of it; it is a vector of
+// u_int64_t so that the index is suitably aligned.
+void WriteAndLoad(Module *module, vector<u_int64_t> *buffer,
+                  SymbolIndex *index) {
+  stringstream s;
+  ASSERT_TRUE(module->WriteIndex(s));
+  string contents = s.str();
+  buffer->assign((contents.size() + 7) / 8, 0);
+  memcpy(&(*buffer)[0], contents.data(), contents.size());
+  ASSERT_TRUE(index->Load(&(*buffer)[0], contents.size()));
+}
+
+// Add a function named NAME to MODULE, with a single line of NUMBER in
+// FILE covering all of it.
+Module::Function *AddFunction(Module *module, const string &name,
+                              Module::Address address, Module::Address size,
+                              Module::File *file, int number) {
+  Module::Function *function = new Module::Function;
+  function->name = name;
+  function->address = address;
+  function->size = size;
+  function->parameter_size = 0;
+  Module::Line line = { address, size, file, number };
+  function->lines.push_back(line);
+  module->AddFunction(function);
+  return function;
+}
+
+}  // namespace
+
+TEST(SymbolIndex, Header) {
+  Module m("name with spaces", "os-name", "architecture", "id-string");
+  vector<u_int64_t> buffer;
+  SymbolIndex index;
+  WriteAndLoad(&m, &buffer, &index);
+  EXPECT_STREQ("name with spaces", index.name());
+  EXPECT_STREQ("os-name", index.os());
+  EXPECT_STREQ("architecture", index.architecture());
+  EXPECT_STREQ("id-string", index.id());
+
+  SymbolIndex::Frame frame;
+  EXPECT_FALSE(index.Lookup(0x1000, &frame));
+  EXPECT_TRUE(frame.function == NULL);
+}
+
+TEST(SymbolIndex, FunctionsAndLines) {
+  Module m("name", "os", "arch", "id");
+  Module::File *file1 = m.FindFile("file1.cc");
+  Module::File *file2 = m.FindFile("file2.cc");
+
+  Module::Function *function = new Module::Function;
+  function->name = "function_1";
+  function->address = 0x1000;
+  function->size = 0x100;
+  function->parameter_size = 8;
+  Module::Line line1 = { 0x1000, 0x10, file1, 67 };
+  Module::Line line2 = { 0x1020, 0x20, file2, 68 };
+  function->lines.push_back(line1);
+  function->lines.push_back(line2);
+  m.AddFunction(function);
+  AddFunction(&m, "function_2", 0x2000, 0x10, file1, 99);
+
+  vector<u_int64_t> buffer;
+  SymbolIndex index;
+  WriteAndLoad(&m, &buffer, &index);
+
+  SymbolIndex::Frame frame;
+  ASSERT_TRUE(index.Lookup(0x1008, &frame));
+  EXPECT_STREQ("function_1", frame.function);
+  EXPECT_EQ(0x1000U, frame.function_address);
+  EXPECT_STREQ("file1.cc", frame.file);
+  EXPECT_EQ(67, frame.line);
+
+  ASSERT_TRUE(index.Lookup(0x103f, &frame));
+  EXPECT_STREQ("function_1", frame.function);
+  EXPECT_STREQ("file2.cc", frame.file);
+  EXPECT_EQ(68, frame.line);
+
+  // Inside the function, but between its lines.
+  ASSERT_TRUE(index.Lookup(0x1010, &frame));
+  EXPECT_STREQ("function_1", frame.function);
+  EXPECT_TRUE(frame.file == NULL);
+  EXPECT_EQ(0, frame.line);
+
+  ASSERT_TRUE(index.Lookup(0x2000, &frame));
+  EXPECT_STREQ("function_2", frame.function);
+  EXPECT_EQ(99, frame.line);
+
+  EXPECT_FALSE(index.Lookup(0x0fff, &frame));
+  EXPECT_FALSE(index.Lookup(0x1100, &frame));
+  EXPECT_FALSE(index.Lookup(0x2010, &frame));
+}
+
+TEST(SymbolIndex, Publics) {
+  Module m("name", "os", "arch", "id");
+  Module::Extern *ext = new Module::Extern;
+  ext->address = 0x3000;
+  ext->name = "public_1";
+  m.AddExtern(ext);
+  AddFunction(&m, "function", 0x4000, 0x100, m.FindFile("file.cc"), 1);
+
+  vector<u_int64_t> buffer;
+  SymbolIndex index;
+  WriteAndLoad(&m, &buffer, &index);
+
+  SymbolIndex::Frame frame;
+  ASSERT_TRUE(index.Lookup(0x3abc, &frame));
+  EXPECT_STREQ("public_1", frame.function);
+  EXPECT_EQ(0x3000U, frame.function_address);
+  EXPECT_TRUE(frame.file == NULL);
+
+  // A function after the public symbol ends its range.
+  EXPECT_FALSE(index.Lookup(0x4100, &frame));
+  EXPECT_FALSE(index.Lookup(0x2fff, &frame));
+}
+
+TEST(SymbolIndex, LoadAddress) {
+  Module m("name", "os", "arch", "id");
+  m.SetLoadAddress(0x10000);
+  AddFunction(&m, "function", 0x11000, 0x100, m.FindFile("file.cc"), 7);
+
+  vector<u_int64_t> buffer;
+  SymbolIndex index;
+  WriteAndLoad(&m, &buffer, &index);
+
+  SymbolIndex::Frame frame;
+  ASSERT_TRUE(index.Lookup(0x1010, &frame));
+  EXPECT_STREQ("function", frame.function);
+  EXPECT_EQ(0x1000U, frame.function_address);
+  EXPECT_EQ(7, frame.line);
+}
+
+TEST(SymbolIndex, LookupAllMatchesLookup) {
+  Module m("name", "os", "arch", "id");
+  Module::File *file = m.FindFile("file.cc");
+  for (int i = 0; i < 1000; ++i) {
+    std::ostringstream name;
+    name << "function_" << i;
+    AddFunction(&m, name.str(), 0x1000 + i * 0x40, 0x30, file, i + 1);
+  }
+
+  vector<u_int64_t> buffer;
+  SymbolIndex index;
+  WriteAndLoad(&m, &buffer, &index);
+
+  // Enough addresses to be split across threads, in no particular order,
+  // including some that fall in the gaps between functions.
+  vector<u_int64_t> addresses;
+  for (u_int64_t i = 0; i < 40000; ++i)
+    addresses.push_back(0x800 + (i * 7919) % (1000 * 0x40 + 0x1000));
+  vector<SymbolIndex::Frame> frames(addresses.size());
+  index.LookupAll(&addresses[0], addresses.size(), &frames[0], 4);
+
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    SymbolIndex::Frame expected;
+    index.Lookup(addresses[i], &expected);
+    ASSERT_EQ(expected.function, frames[i].function) << i;
+    ASSERT_EQ(expected.function_address, frames[i].function_address) << i;
+    ASSERT_EQ(expected.file, frames[i].file) << i;
+    ASSERT_EQ(expected.line, frames[i].line) << i;
+  }
+}
+
+TEST(SymbolIndex, RejectsBadData) {
+  Module m("name", "os", "arch", "id");
+  stringstream s;
+  ASSERT_TRUE(m.WriteIndex(s));
+  string contents = s.str();
+  vector<u_int64_t> buffer((contents.size() + 7) / 8);
+  memcpy(&buffer[0], contents.data(), contents.size());
+
+  SymbolIndex index;
+  EXPECT_FALSE(index.Load(&buffer[0], sizeof(buffer[0])));
+  reinterpret_cast<char *>(&buffer[0])[0] ^= 1;
+  EXPECT_FALSE(index.Load(&buffer[0], contents.size()));
+  EXPECT_STREQ("", index.name());
+}
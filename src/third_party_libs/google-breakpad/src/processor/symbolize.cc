@@ -0,0 +1,130 @@
+// Copyright (c) 2026 MaidSafe.net limited
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of MaidSafe.net limited nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbolize.cc: Look addresses up in a symbol index written by
+// Module::WriteIndex, or by the WriteSymbolFile overload in
+// common/linux/dump_symbols.h that takes an index stream, printing the
+// function, source file and line of each.
+//
+// Addresses are hexadecimal, relative to the module's load address as
+// in the symbol file, and are taken from the command line or, if there
+// are none there, from stdin, one per line. Output is one line per
+// address, in the order given.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "processor/symbol_index.h"
+
+using google_breakpad::SymbolIndex;
+
+static void Usage(const char *program) {
+  fprintf(stderr, "Usage: %s [-j <threads>] <index-file> [address...]\n\n"
+          "  -j  Look addresses up on this many threads. Defaults to the\n"
+          "      number of processors.\n",
+          program);
+}
+
+static bool ParseAddress(const char *text, u_int64_t *address) {
+  char *end;
+  *address = strtoull(text, &end, 16);
+  return end != text && (*end == '\0' || *end == '\n' || *end == '\r');
+}
+
+int main(int argc, char **argv) {
+  int threads = std::thread::hardware_concurrency();
+  int opt;
+  while ((opt = getopt(argc, argv, "j:")) != -1) {
+    switch (opt) {
+      case 'j':
+        threads = atoi(optarg);
+        break;
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind >= argc) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  SymbolIndex index;
+  if (!index.Open(argv[optind]))
+    return 1;
+
+  std::vector<u_int64_t> addresses;
+  if (optind + 1 < argc) {
+    for (int i = optind + 1; i < argc; ++i) {
+      u_int64_t address;
+      if (!ParseAddress(argv[i], &address)) {
+        fprintf(stderr, "Bad address: %s\n", argv[i]);
+        return 1;
+      }
+      addresses.push_back(address);
+    }
+  } else {
+    char line[256];
+    while (fgets(line, sizeof(line), stdin)) {
+      u_int64_t address;
+      if (!ParseAddress(line, &address)) {
+        fprintf(stderr, "Bad address: %s", line);
+        return 1;
+      }
+      addresses.push_back(address);
+    }
+  }
+
+  std::vector<SymbolIndex::Frame> frames(addresses.size());
+  if (!addresses.empty())
+    index.LookupAll(&addresses[0], addresses.size(), &frames[0], threads);
+
+  static char buffer[1 << 16];
+  setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    const SymbolIndex::Frame &frame = frames[i];
+    if (!frame.function) {
+      printf("0x%" PRIx64 " ??\n", addresses[i]);
+    } else if (!frame.file) {
+      printf("0x%" PRIx64 " %s+0x%" PRIx64 "\n", addresses[i],
+             frame.function, addresses[i] - frame.function_address);
+    } else {
+      printf("0x%" PRIx64 " %s+0x%" PRIx64 " %s:%d\n", addresses[i],
+             frame.function, addresses[i] - frame.function_address,
+             frame.file, frame.line);
+    }
+  }
+  return ferror(stdout) ? 1 : 0;
+}
@@ -18,6 +18,7 @@
 #include "asio/associated_allocator.hpp"
 #include "asio/associated_executor.hpp"
 #include "asio/async_result.hpp"
+#include "asio/awaitable.hpp"
 #include "asio/basic_datagram_socket.hpp"
 #include "asio/basic_deadline_timer.hpp"
 #include "asio/basic_io_object.hpp"
@@ -32,6 +33,7 @@
 #include "asio/basic_streambuf.hpp"
 #include "asio/basic_waitable_timer.hpp"
 #include "asio/buffer.hpp"
+#include "asio/buffer_pool.hpp"
 #include "asio/buffered_read_stream_fwd.hpp"
 #include "asio/buffered_read_stream.hpp"
 #include "asio/buffered_stream_fwd.hpp"
@@ -39,6 +41,7 @@
 #include "asio/buffered_write_stream_fwd.hpp"
 #include "asio/buffered_write_stream.hpp"
 #include "asio/buffers_iterator.hpp"
+#include "asio/co_spawn.hpp"
 #include "asio/completion_condition.hpp"
 #include "asio/connect.hpp"
 #include "asio/coroutine.hpp"
@@ -46,6 +49,7 @@
 #include "asio/deadline_timer_service.hpp"
 #include "asio/deadline_timer.hpp"
 #include "asio/defer.hpp"
+#include "asio/detached.hpp"
 #include "asio/dispatch.hpp"
 #include "asio/error.hpp"
 #include "asio/error_code.hpp"
@@ -99,6 +103,7 @@
 #include "asio/posix/stream_descriptor.hpp"
 #include "asio/posix/stream_descriptor_service.hpp"
 #include "asio/post.hpp"
+#include "asio/priority_executor.hpp"
 #include "asio/raw_socket_service.hpp"
 #include "asio/read.hpp"
 #include "asio/read_at.hpp"
@@ -116,9 +121,12 @@
 #include "asio/streambuf.hpp"
 #include "asio/system_error.hpp"
 #include "asio/system_executor.hpp"
+#include "asio/this_coro.hpp"
 #include "asio/thread.hpp"
 #include "asio/thread_pool.hpp"
 #include "asio/time_traits.hpp"
+#include "asio/traffic_shaper.hpp"
+#include "asio/use_awaitable.hpp"
 #include "asio/uses_executor.hpp"
 #include "asio/version.hpp"
 #include "asio/wait_traits.hpp"
@@ -0,0 +1,155 @@
+//
+// awaitable.hpp
+// ~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_AWAITABLE_HPP
+#define ASIO_AWAITABLE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CO_AWAIT) || defined(GENERATING_DOCUMENTATION)
+
+#include <coroutine>
+#include "asio/executor.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename Executor> class awaitable_thread;
+template <typename T, typename Executor> class awaitable_frame;
+
+} // namespace detail
+
+/// The return type of a coroutine or asynchronous operation.
+/**
+ * An awaitable is the result of calling a coroutine. The coroutine does not
+ * start until the awaitable is awaited with @c co_await from another
+ * coroutine, or is launched with asio::co_spawn(). Inside the coroutine,
+ * asynchronous operations are awaited by passing asio::use_awaitable as
+ * their completion token:
+ *
+ * @code asio::awaitable<void> echo(asio::ip::tcp::socket socket)
+ * {
+ *   char data[1024];
+ *   for (;;)
+ *   {
+ *     std::size_t n = co_await socket.async_read_some(
+ *         asio::buffer(data), asio::use_awaitable);
+ *     co_await asio::async_write(socket,
+ *         asio::buffer(data, n), asio::use_awaitable);
+ *   }
+ * } @endcode
+ *
+ * A coroutine, and the coroutines it awaits, run on the executor given to
+ * co_spawn(). Their frames are allocated from the same per-thread cache that
+ * is used for completion handlers.
+ *
+ * The polymorphic asio::executor accepts any executor. Naming a concrete
+ * type, such as io_service::executor_type, avoids its type erasure on every
+ * completion; the coroutine then awaits with
+ * <tt>use_awaitable_t<io_service::executor_type>()</tt>.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+template <typename T, typename Executor = executor>
+class awaitable
+{
+public:
+  /// The type of the awaited value.
+  typedef T value_type;
+
+  /// The executor type that will be used for the coroutine.
+  typedef Executor executor_type;
+
+  /// Default constructor.
+  ASIO_CONSTEXPR awaitable() ASIO_NOEXCEPT
+    : frame_(0)
+  {
+  }
+
+  /// Move constructor.
+  awaitable(awaitable&& other) ASIO_NOEXCEPT
+    : frame_(other.frame_)
+  {
+    other.frame_ = 0;
+  }
+
+  /// Destructor. Destroys a coroutine that has not been awaited.
+  ~awaitable()
+  {
+    if (frame_)
+      frame_->destroy();
+  }
+
+  /// Checks if the awaitable refers to a coroutine.
+  bool valid() const ASIO_NOEXCEPT
+  {
+    return !!frame_;
+  }
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+  typedef detail::awaitable_frame<T, Executor> promise_type;
+
+  // Support for co_await keyword.
+  bool await_ready() const ASIO_NOEXCEPT
+  {
+    return false;
+  }
+
+  // Support for co_await keyword.
+  template <typename U>
+  void await_suspend(
+      std::coroutine_handle<detail::awaitable_frame<U, Executor> > h)
+  {
+    frame_->push_frame(h.promise());
+  }
+
+  // Support for co_await keyword.
+  T await_resume()
+  {
+    awaitable tmp(static_cast<awaitable&&>(*this));
+    return tmp.frame_->get();
+  }
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+private:
+  template <typename> friend class detail::awaitable_thread;
+  template <typename, typename> friend class detail::awaitable_frame;
+
+  // Disallow copying and assignment.
+  awaitable(const awaitable&) ASIO_DELETED;
+  awaitable& operator=(const awaitable&) ASIO_DELETED;
+
+  explicit awaitable(detail::awaitable_frame<T, Executor>* f)
+    : frame_(f)
+  {
+  }
+
+  detail::awaitable_frame<T, Executor>* frame_;
+};
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/awaitable.hpp"
+
+#endif // defined(ASIO_HAS_CO_AWAIT) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_AWAITABLE_HPP
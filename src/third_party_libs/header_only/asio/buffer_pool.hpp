@@ -0,0 +1,291 @@
+//
+// buffer_pool.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_BUFFER_POOL_HPP
+#define ASIO_BUFFER_POOL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include "asio/async_result.hpp"
+#include "asio/buffer.hpp"
+#include "asio/error.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/throw_error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+class buffer_pool;
+
+/// A buffer borrowed from a buffer_pool.
+/**
+ * The memory is returned to the pool when the pooled_buffer is destroyed or
+ * release() is called. A pooled_buffer is movable but not copyable.
+ */
+class pooled_buffer
+{
+public:
+  /// Constructs an empty buffer.
+  pooled_buffer() ASIO_NOEXCEPT
+    : pool_(0), data_(0), size_class_(0), capacity_(0), size_(0)
+  {
+  }
+
+  /// Move constructor.
+  pooled_buffer(pooled_buffer&& other) ASIO_NOEXCEPT
+    : pool_(other.pool_), data_(other.data_), size_class_(other.size_class_),
+      capacity_(other.capacity_), size_(other.size_)
+  {
+    other.pool_ = 0;
+    other.data_ = 0;
+    other.capacity_ = other.size_ = 0;
+  }
+
+  /// Move assignment.
+  pooled_buffer& operator=(pooled_buffer&& other) ASIO_NOEXCEPT
+  {
+    if (this != &other)
+    {
+      release();
+      pool_ = other.pool_;
+      data_ = other.data_;
+      size_class_ = other.size_class_;
+      capacity_ = other.capacity_;
+      size_ = other.size_;
+      other.pool_ = 0;
+      other.data_ = 0;
+      other.capacity_ = other.size_ = 0;
+    }
+    return *this;
+  }
+
+  /// Returns the memory to the pool.
+  ~pooled_buffer()
+  {
+    release();
+  }
+
+  /// Returns the memory to the pool, leaving the buffer empty.
+  inline void release() ASIO_NOEXCEPT;
+
+  /// Pointer to the start of the buffer.
+  char* data() const ASIO_NOEXCEPT
+  {
+    return data_;
+  }
+
+  /// Number of bytes of valid data.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// Sets the number of bytes of valid data, which must not exceed capacity().
+  void resize(std::size_t n) ASIO_NOEXCEPT
+  {
+    size_ = n < capacity_ ? n : capacity_;
+  }
+
+  /// Total size of the memory block.
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return capacity_;
+  }
+
+  /// Whether the buffer holds any memory.
+  bool empty() const ASIO_NOEXCEPT
+  {
+    return data_ == 0;
+  }
+
+private:
+  friend class buffer_pool;
+  pooled_buffer(const pooled_buffer&) ASIO_DELETED;
+  pooled_buffer& operator=(const pooled_buffer&) ASIO_DELETED;
+
+  buffer_pool* pool_;
+  char* data_;
+  std::size_t size_class_;
+  std::size_t capacity_;
+  std::size_t size_;
+};
+
+/// A pool of receive buffers shared by many connections.
+/**
+ * Memory is handed out in power-of-two size classes from min_buffer_size to
+ * max_buffer_size. Returned blocks are kept in a number of caches, each with
+ * its own lock, so that threads running on different processors rarely
+ * contend; a thread uses the cache for the processor it is running on where
+ * that can be determined.
+ *
+ * Combined with async_read_some_pooled(), which borrows a buffer only once a
+ * socket is readable, a process can hold many idle connections without a
+ * receive buffer per connection. One pool is typically shared by the whole
+ * process.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ */
+class buffer_pool
+  : private noncopyable
+{
+public:
+  /// The smallest size class.
+  static const std::size_t min_buffer_size = 512;
+
+  /// The largest size class. Larger requests are given a buffer of this size.
+  static const std::size_t max_buffer_size = 65536;
+
+  /// Constructs a pool.
+  /**
+   * @param max_bytes The most memory the pool may hold, whether lent out or
+   * cached. Zero means no limit.
+   *
+   * @param caches The number of caches. Zero means one per hardware thread.
+   *
+   * @param max_cached_bytes The most idle memory each cache keeps for reuse;
+   * blocks returned beyond that are freed.
+   */
+  ASIO_DECL explicit buffer_pool(std::size_t max_bytes = 0,
+      std::size_t caches = 0, std::size_t max_cached_bytes = 1024 * 1024);
+
+  /// Destroys the pool. All buffers must have been returned.
+  ASIO_DECL ~buffer_pool();
+
+  /// Borrows a buffer with a capacity of at least @c size bytes.
+  /**
+   * The returned buffer's size() is set to its capacity.
+   *
+   * @throws asio::system_error Thrown with asio::error::no_buffer_space if
+   * the pool is at its memory limit.
+   */
+  pooled_buffer allocate(std::size_t size)
+  {
+    asio::error_code ec;
+    pooled_buffer b = allocate(size, ec);
+    asio::detail::throw_error(ec, "allocate");
+    return b;
+  }
+
+  /// Borrows a buffer with a capacity of at least @c size bytes.
+  /**
+   * @returns An empty buffer, with @c ec set to asio::error::no_buffer_space,
+   * if the pool is at its memory limit.
+   */
+  ASIO_DECL pooled_buffer allocate(std::size_t size, asio::error_code& ec);
+
+  /// The memory currently held by the pool, whether lent out or cached.
+  ASIO_DECL std::size_t bytes_allocated() const;
+
+  /// The memory currently lent out.
+  ASIO_DECL std::size_t bytes_in_use() const;
+
+private:
+  friend class pooled_buffer;
+  enum { size_classes = 8 };
+  struct cache;
+
+  // Returns a block to the current thread's cache, or frees it.
+  ASIO_DECL void deallocate(char* data, std::size_t size_class);
+
+  // Picks the cache for the calling thread.
+  ASIO_DECL cache& current_cache();
+
+  // Frees cached blocks from any cache, to make room under the limit.
+  ASIO_DECL void reclaim(std::size_t bytes);
+
+  std::size_t max_bytes_;
+  std::size_t max_cached_bytes_;
+  std::size_t num_caches_;
+  cache* caches_;
+  mutable detail::mutex mutex_;
+  std::size_t bytes_allocated_;
+};
+
+inline void pooled_buffer::release() ASIO_NOEXCEPT
+{
+  if (data_)
+    pool_->deallocate(data_, size_class_);
+  pool_ = 0;
+  data_ = 0;
+  capacity_ = size_ = 0;
+}
+
+/** @defgroup buffer_pool_buffer asio::buffer (pooled_buffer overloads)
+ * Create a buffer over the valid data of a pooled_buffer.
+ */
+/*@{*/
+
+inline mutable_buffers_1 buffer(pooled_buffer& b) ASIO_NOEXCEPT
+{
+  return mutable_buffers_1(b.data(), b.size());
+}
+
+inline const_buffers_1 buffer(const pooled_buffer& b) ASIO_NOEXCEPT
+{
+  return const_buffers_1(b.data(), b.size());
+}
+
+/*@}*/
+
+/// Start an asynchronous read that only takes a buffer once data arrives.
+/**
+ * This function waits for the socket to become readable without any buffer
+ * posted, then borrows a buffer from @c pool large enough for the data
+ * available (but no larger than @c max_size) and reads into it. Idle
+ * connections therefore hold no receive memory. When readiness is reported
+ * with nothing available, as for a close, the buffer is @c max_size bytes.
+ *
+ * @param s The socket. It must support async_wait(), available() and
+ * async_read_some().
+ *
+ * @param pool The pool to borrow from. It must outlive the operation.
+ *
+ * @param max_size The largest buffer to borrow for a single read.
+ *
+ * @param handler The handler to be called when the read completes. Copies will
+ * be made of the handler as required. The function signature of the handler
+ * must be:
+ * @code void handler(
+ *   const asio::error_code& error, // Result of operation.
+ *   asio::pooled_buffer buffer     // The data read. Its memory goes back
+ *                                  // to the pool when it is destroyed.
+ * ); @endcode
+ * If the pool is at its memory limit the handler receives
+ * asio::error::no_buffer_space and the data stays in the socket.
+ */
+template <typename Socket, typename ReadHandler>
+ASIO_INITFN_RESULT_TYPE(ReadHandler,
+    void (asio::error_code, pooled_buffer))
+async_read_some_pooled(Socket& s, buffer_pool& pool, std::size_t max_size,
+    ASIO_MOVE_ARG(ReadHandler) handler);
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/buffer_pool.hpp"
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/buffer_pool.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_BUFFER_POOL_HPP
@@ -0,0 +1,170 @@
+//
+// co_spawn.hpp
+// ~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_CO_SPAWN_HPP
+#define ASIO_CO_SPAWN_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CO_AWAIT) || defined(GENERATING_DOCUMENTATION)
+
+#include <exception>
+#include <type_traits>
+#include "asio/async_result.hpp"
+#include "asio/awaitable.hpp"
+#include "asio/execution_context.hpp"
+#include "asio/is_executor.hpp"
+#include "asio/detail/type_traits.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename T>
+struct awaitable_signature
+{
+  typedef void type(std::exception_ptr, T);
+};
+
+template <>
+struct awaitable_signature<void>
+{
+  typedef void type(std::exception_ptr);
+};
+
+template <typename T>
+struct awaitable_traits
+{
+};
+
+template <typename T, typename Executor>
+struct awaitable_traits<awaitable<T, Executor> >
+{
+  typedef T value_type;
+  typedef Executor executor_type;
+  typedef typename awaitable_signature<T>::type signature;
+};
+
+// The traits of the awaitable returned by a function object, if it returns
+// one.
+template <typename F, typename = void>
+struct awaitable_function_result
+{
+};
+
+template <typename F>
+struct awaitable_function_result<F, std::void_t<std::invoke_result_t<F&> > >
+  : awaitable_traits<typename decay<std::invoke_result_t<F&> >::type>
+{
+};
+
+} // namespace detail
+
+/// Start a new thread of coroutines.
+/**
+ * The coroutine is run on the executor @c ex, starting as if by
+ * <tt>post(ex, ...)</tt>. When it finishes, the completion handler is called
+ * with any exception that escaped it and, unless @c T is @c void, its
+ * result. The function signature of the completion handler must be:
+ * @code void handler(std::exception_ptr, T); @endcode
+ *
+ * The coroutine's frame is kept alive until it finishes, but the arguments
+ * of the call that created it are not: parameters the coroutine takes by
+ * reference must outlive it. Use the overload taking a function object when
+ * the coroutine needs state of its own.
+ *
+ * @par Example
+ * @code asio::co_spawn(io_service, listener(std::move(acceptor)),
+ *     asio::detached); @endcode
+ */
+template <typename Executor, typename T, typename AwaitableExecutor,
+    typename CompletionToken>
+ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_signature<T>::type)
+co_spawn(const Executor& ex, awaitable<T, AwaitableExecutor> a,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_executor<Executor>::value
+        && is_convertible<Executor, AwaitableExecutor>::value
+    >::type* = 0);
+
+/// Start a new thread of coroutines.
+/**
+ * @returns <tt>co_spawn(ctx.get_executor(), std::move(a),
+ * forward<CompletionToken>(token))</tt>.
+ */
+template <typename ExecutionContext, typename T, typename AwaitableExecutor,
+    typename CompletionToken>
+ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_signature<T>::type)
+co_spawn(ExecutionContext& ctx, awaitable<T, AwaitableExecutor> a,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_convertible<ExecutionContext&, execution_context&>::value
+        && is_convertible<typename ExecutionContext::executor_type,
+          AwaitableExecutor>::value
+    >::type* = 0);
+
+/// Start a new thread of coroutines from a function object.
+/**
+ * The function object @c f is moved into the new thread and called there,
+ * and must return an asio::awaitable. Since the function object lives as
+ * long as the coroutine, a lambda's captures are safe to use from it:
+ *
+ * @code asio::co_spawn(io_service,
+ *     [s = std::move(socket)]() mutable -> asio::awaitable<void>
+ *     {
+ *       co_await echo(s);
+ *     }, asio::detached); @endcode
+ */
+template <typename Executor, typename F, typename CompletionToken>
+ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_function_result<
+      typename decay<F>::type>::signature)
+co_spawn(const Executor& ex, F&& f,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_executor<Executor>::value
+        && is_convertible<Executor, typename detail::awaitable_function_result<
+          typename decay<F>::type>::executor_type>::value
+    >::type* = 0);
+
+/// Start a new thread of coroutines from a function object.
+/**
+ * @returns <tt>co_spawn(ctx.get_executor(), forward<F>(f),
+ * forward<CompletionToken>(token))</tt>.
+ */
+template <typename ExecutionContext, typename F, typename CompletionToken>
+ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_function_result<
+      typename decay<F>::type>::signature)
+co_spawn(ExecutionContext& ctx, F&& f,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_convertible<ExecutionContext&, execution_context&>::value
+        && is_convertible<typename ExecutionContext::executor_type,
+          typename detail::awaitable_function_result<
+            typename decay<F>::type>::executor_type>::value
+    >::type* = 0);
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/co_spawn.hpp"
+
+#endif // defined(ASIO_HAS_CO_AWAIT) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_CO_SPAWN_HPP
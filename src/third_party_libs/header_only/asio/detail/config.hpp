@@ -441,6 +441,24 @@
 # endif // !defined(ASIO_DISABLE_STD_CHRONO)
 #endif // !defined(ASIO_HAS_STD_CHRONO)
 
+// Compiler support for C++20 coroutines.
+#if !defined(ASIO_HAS_CO_AWAIT)
+# if !defined(ASIO_DISABLE_CO_AWAIT)
+#  if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902)
+#   if defined(__has_include)
+#    if __has_include(<coroutine>)
+#     define ASIO_HAS_CO_AWAIT 1
+#    endif // __has_include(<coroutine>)
+#   endif // defined(__has_include)
+#  endif // defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902)
+#  if defined(ASIO_MSVC) && !defined(ASIO_HAS_CO_AWAIT)
+#   if (_MSC_VER >= 1928) && (_MSVC_LANG >= 201705)
+#    define ASIO_HAS_CO_AWAIT 1
+#   endif // (_MSC_VER >= 1928) && (_MSVC_LANG >= 201705)
+#  endif // defined(ASIO_MSVC) && !defined(ASIO_HAS_CO_AWAIT)
+# endif // !defined(ASIO_DISABLE_CO_AWAIT)
+#endif // !defined(ASIO_HAS_CO_AWAIT)
+
 // Boost support for chrono.
 #if !defined(ASIO_HAS_BOOST_CHRONO)
 # if !defined(ASIO_DISABLE_BOOST_CHRONO)
@@ -0,0 +1,175 @@
+//
+// detail/impl/priority_executor_impl.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_PRIORITY_EXECUTOR_IMPL_HPP
+#define ASIO_DETAIL_IMPL_PRIORITY_EXECUTOR_IMPL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/call_stack.hpp"
+#include "asio/detail/fenced_block.hpp"
+#include "asio/detail/handler_invoke_helpers.hpp"
+#include "asio/detail/recycling_allocator.hpp"
+#include "asio/executor_work.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename Executor>
+class priority_executor_impl::invoker
+{
+public:
+  invoker(const implementation_type& impl, Executor& ex)
+    : impl_(impl),
+      work_(ex)
+  {
+  }
+
+  invoker(const invoker& other)
+    : impl_(other.impl_),
+      work_(other.work_)
+  {
+  }
+
+#if defined(ASIO_HAS_MOVE)
+  invoker(invoker&& other)
+    : impl_(ASIO_MOVE_CAST(implementation_type)(other.impl_)),
+      work_(ASIO_MOVE_CAST(executor_work<Executor>)(other.work_))
+  {
+  }
+#endif // defined(ASIO_HAS_MOVE)
+
+  struct on_invoker_exit
+  {
+    invoker* this_;
+
+    ~on_invoker_exit()
+    {
+      // Go to the back of the underlying executor's queue, so that its other
+      // work is not held up by ours.
+      if (this_->impl_->reschedule())
+      {
+        Executor ex(this_->work_.get_executor());
+        recycling_allocator<void> allocator;
+        ex.post(ASIO_MOVE_CAST(invoker)(*this_), allocator);
+      }
+    }
+  };
+
+  void operator()()
+  {
+    // Indicate that these queues are executing on the current thread.
+    call_stack<priority_executor_impl>::context ctx(impl_.get());
+
+    // Ensure the next function, if any, is scheduled on block exit.
+    on_invoker_exit on_exit = { this };
+    (void)on_exit;
+
+    // Run only the most urgent function, so that anything more urgent
+    // arriving meanwhile is chosen next time.
+    if (scheduler_operation* o = impl_->dequeue())
+    {
+      asio::error_code ec;
+      o->complete(impl_.get(), ec, 0);
+    }
+  }
+
+private:
+  implementation_type impl_;
+  executor_work<Executor> work_;
+};
+
+template <typename Function, typename Allocator>
+scheduler_operation* priority_executor_impl::allocate_op(
+    ASIO_MOVE_ARG(Function) function, const Allocator& a)
+{
+  // Make a local, non-const copy of the function.
+  typedef typename decay<Function>::type function_type;
+  function_type tmp(ASIO_MOVE_CAST(Function)(function));
+
+  // Construct an allocator to be used for the operation.
+  typedef typename detail::get_recycling_allocator<Allocator>::type alloc_type;
+  alloc_type allocator(detail::get_recycling_allocator<Allocator>::get(a));
+
+  // Allocate and construct an operation to wrap the function.
+  typedef executor_op<function_type, alloc_type> op;
+  typename op::ptr p = { allocator, 0, 0 };
+  p.v = p.a.allocate(1);
+  p.p = new (p.v) op(tmp, allocator);
+
+  scheduler_operation* o = p.p;
+  p.v = p.p = 0;
+  return o;
+}
+
+template <typename Executor, typename Function, typename Allocator>
+void priority_executor_impl::dispatch(const implementation_type& impl,
+    std::size_t level, Executor& ex, ASIO_MOVE_ARG(Function) function,
+    const Allocator& a)
+{
+  // A function submitted from within these queues may run immediately, as
+  // long as nothing queued is more urgent.
+  if (call_stack<priority_executor_impl>::contains(impl.get())
+      && impl->may_run_now(level))
+  {
+    typedef typename decay<Function>::type function_type;
+    function_type tmp(ASIO_MOVE_CAST(Function)(function));
+
+    fenced_block b(fenced_block::full);
+    asio_handler_invoke_helpers::invoke(tmp, tmp);
+    return;
+  }
+
+  // Completion handlers for operations on the underlying context arrive
+  // here, so they must be queued rather than dispatched through to it.
+  if (impl->enqueue(level,
+        allocate_op(ASIO_MOVE_CAST(Function)(function), a)))
+  {
+    recycling_allocator<void> allocator;
+    ex.post(invoker<Executor>(impl, ex), allocator);
+  }
+}
+
+template <typename Executor, typename Function, typename Allocator>
+void priority_executor_impl::post(const implementation_type& impl,
+    std::size_t level, Executor& ex, ASIO_MOVE_ARG(Function) function,
+    const Allocator& a)
+{
+  if (impl->enqueue(level,
+        allocate_op(ASIO_MOVE_CAST(Function)(function), a)))
+  {
+    recycling_allocator<void> allocator;
+    ex.post(invoker<Executor>(impl, ex), allocator);
+  }
+}
+
+template <typename Executor, typename Function, typename Allocator>
+void priority_executor_impl::defer(const implementation_type& impl,
+    std::size_t level, Executor& ex, ASIO_MOVE_ARG(Function) function,
+    const Allocator& a)
+{
+  if (impl->enqueue(level,
+        allocate_op(ASIO_MOVE_CAST(Function)(function), a)))
+  {
+    recycling_allocator<void> allocator;
+    ex.defer(invoker<Executor>(impl, ex), allocator);
+  }
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_IMPL_PRIORITY_EXECUTOR_IMPL_HPP
@@ -0,0 +1,178 @@
+//
+// detail/impl/priority_executor_impl.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_PRIORITY_EXECUTOR_IMPL_IPP
+#define ASIO_DETAIL_IMPL_PRIORITY_EXECUTOR_IMPL_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/detail/priority_executor_impl.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+priority_executor_impl::priority_executor_impl(
+    std::size_t levels, std::size_t starvation_limit,
+    std::size_t concurrency)
+  : mutex_(),
+    weighted_(false),
+    starvation_limit_(starvation_limit),
+    concurrency_(concurrency ? concurrency : 1),
+    scheduled_(0),
+    queued_(0),
+    num_levels_(levels ? levels : 1),
+    levels_(new level[num_levels_])
+{
+}
+
+priority_executor_impl::priority_executor_impl(
+    const std::vector<std::size_t>& weights, std::size_t concurrency)
+  : mutex_(),
+    weighted_(true),
+    starvation_limit_(0),
+    concurrency_(concurrency ? concurrency : 1),
+    scheduled_(0),
+    queued_(0),
+    num_levels_(weights.empty() ? 1 : weights.size()),
+    levels_(new level[num_levels_])
+{
+  for (std::size_t i = 0; i < weights.size(); ++i)
+    levels_[i].weight_ = weights[i] ? weights[i] : 1;
+}
+
+priority_executor_impl::~priority_executor_impl()
+{
+  delete[] levels_;
+}
+
+bool priority_executor_impl::running_in_this_thread(
+    const implementation_type& impl)
+{
+  return !!call_stack<priority_executor_impl>::contains(impl.get());
+}
+
+bool priority_executor_impl::enqueue(std::size_t level,
+    scheduler_operation* op)
+{
+  if (level >= num_levels_)
+    level = num_levels_ - 1;
+
+  mutex::scoped_lock lock(mutex_);
+  levels_[level].queue_.push(op);
+  ++queued_;
+  if (scheduled_ < concurrency_ && scheduled_ < queued_)
+  {
+    ++scheduled_;
+    return true;
+  }
+  return false;
+}
+
+scheduler_operation* priority_executor_impl::dequeue()
+{
+  mutex::scoped_lock lock(mutex_);
+
+  std::size_t chosen = num_levels_;
+  if (weighted_)
+  {
+    // Smooth weighted round-robin over the levels with work: every waiting
+    // level earns its weight, and the richest pays the total.
+    long total = 0;
+    for (std::size_t i = 0; i < num_levels_; ++i)
+    {
+      level& l = levels_[i];
+      if (l.queue_.empty())
+        continue;
+      l.current_ += static_cast<long>(l.weight_);
+      total += static_cast<long>(l.weight_);
+      if (chosen == num_levels_ || l.current_ > levels_[chosen].current_)
+        chosen = i;
+    }
+    if (chosen == num_levels_)
+      return 0;
+    levels_[chosen].current_ -= total;
+  }
+  else
+  {
+    // The most urgent level wins, unless a lower one has waited too long.
+    std::size_t starved = num_levels_;
+    for (std::size_t i = 0; i < num_levels_; ++i)
+    {
+      level& l = levels_[i];
+      if (l.queue_.empty())
+        continue;
+      if (chosen == num_levels_)
+        chosen = i;
+      else if (starvation_limit_ && ++l.passed_over_ > starvation_limit_
+          && (starved == num_levels_
+            || l.passed_over_ > levels_[starved].passed_over_))
+        starved = i;
+    }
+    if (chosen == num_levels_)
+      return 0;
+    if (starved != num_levels_)
+    {
+      ++levels_[chosen].passed_over_;
+      chosen = starved;
+    }
+    levels_[chosen].passed_over_ = 0;
+  }
+
+  scheduler_operation* op = levels_[chosen].queue_.front();
+  levels_[chosen].queue_.pop();
+  --queued_;
+  if (levels_[chosen].queue_.empty())
+  {
+    levels_[chosen].current_ = 0;
+    levels_[chosen].passed_over_ = 0;
+  }
+  return op;
+}
+
+bool priority_executor_impl::reschedule()
+{
+  mutex::scoped_lock lock(mutex_);
+  if (queued_ >= scheduled_)
+    return true;
+  --scheduled_;
+  return false;
+}
+
+bool priority_executor_impl::may_run_now(std::size_t level)
+{
+  if (level >= num_levels_)
+    level = num_levels_ - 1;
+
+  mutex::scoped_lock lock(mutex_);
+  if (weighted_)
+  {
+    for (std::size_t i = 0; i < num_levels_; ++i)
+      if (!levels_[i].queue_.empty())
+        return false;
+    return true;
+  }
+
+  for (std::size_t i = 0; i <= level; ++i)
+    if (!levels_[i].queue_.empty())
+      return false;
+  return true;
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_IMPL_PRIORITY_EXECUTOR_IMPL_IPP
@@ -0,0 +1,160 @@
+//
+// detail/priority_executor_impl.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_PRIORITY_EXECUTOR_IMPL_HPP
+#define ASIO_DETAIL_PRIORITY_EXECUTOR_IMPL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <vector>
+#include "asio/detail/executor_op.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/op_queue.hpp"
+#include "asio/detail/scheduler_operation.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// The queues shared by all priority executors created from one another.
+//
+// Every function submitted through a priority executor is queued here at its
+// level. At most a few invokers at a time are posted to the underlying
+// executor, each running the one function that should run next at that moment
+// and then posting itself again. The underlying executor's queue therefore
+// holds only those invokers, and a late high-priority function, including a
+// completion handler that has just come off that queue, waits for no more than
+// one lower-priority function per invoker.
+class priority_executor_impl
+  : private noncopyable
+{
+public:
+  typedef shared_ptr<priority_executor_impl> implementation_type;
+
+  // Construct for strict priority order. A function left waiting while
+  // starvation_limit others run ahead of it is run next. Zero disables this.
+  // At most concurrency functions run at once.
+  ASIO_DECL priority_executor_impl(std::size_t levels,
+      std::size_t starvation_limit, std::size_t concurrency);
+
+  // Construct for weighted order, giving each level a share of the functions
+  // run in proportion to its weight.
+  ASIO_DECL priority_executor_impl(const std::vector<std::size_t>& weights,
+      std::size_t concurrency);
+
+  // Destroy all functions that have not been run.
+  ASIO_DECL ~priority_executor_impl();
+
+  // The number of levels.
+  std::size_t levels() const
+  {
+    return num_levels_;
+  }
+
+  // Request invocation of the given function.
+  template <typename Executor, typename Function, typename Allocator>
+  static void dispatch(const implementation_type& impl, std::size_t level,
+      Executor& ex, ASIO_MOVE_ARG(Function) function, const Allocator& a);
+
+  // Request invocation of the given function and return immediately.
+  template <typename Executor, typename Function, typename Allocator>
+  static void post(const implementation_type& impl, std::size_t level,
+      Executor& ex, ASIO_MOVE_ARG(Function) function, const Allocator& a);
+
+  // Request invocation of the given function and return immediately.
+  template <typename Executor, typename Function, typename Allocator>
+  static void defer(const implementation_type& impl, std::size_t level,
+      Executor& ex, ASIO_MOVE_ARG(Function) function, const Allocator& a);
+
+  // Determine whether a function from these queues is running in the current
+  // thread.
+  ASIO_DECL static bool running_in_this_thread(
+      const implementation_type& impl);
+
+private:
+  template <typename Executor> class invoker;
+
+  struct level
+  {
+    level()
+      : weight_(1),
+        current_(0),
+        passed_over_(0)
+    {
+    }
+
+    // The functions waiting at this level.
+    op_queue<scheduler_operation> queue_;
+
+    // The level's share in weighted order.
+    std::size_t weight_;
+
+    // The running credit used by smooth weighted round-robin.
+    long current_;
+
+    // The number of functions run while this level was waiting.
+    std::size_t passed_over_;
+  };
+
+  // Allocate and wrap a function, ready for enqueueing.
+  template <typename Function, typename Allocator>
+  static scheduler_operation* allocate_op(
+      ASIO_MOVE_ARG(Function) function, const Allocator& a);
+
+  // Add a function at a level. Returns true if another invoker is needed.
+  ASIO_DECL bool enqueue(std::size_t level, scheduler_operation* op);
+
+  // Remove the function that should run next, if any.
+  ASIO_DECL scheduler_operation* dequeue();
+
+  // Called as an invoker finishes. Returns true if it should run again.
+  ASIO_DECL bool reschedule();
+
+  // Whether a function at this level may run ahead of those queued.
+  ASIO_DECL bool may_run_now(std::size_t level);
+
+  // Mutex to protect access to the queues.
+  mutex mutex_;
+
+  // Whether levels are served by weight rather than strictly.
+  bool weighted_;
+
+  // See the strict order constructor.
+  std::size_t starvation_limit_;
+
+  // The most invokers posted at once, and the number posted now.
+  std::size_t concurrency_;
+  std::size_t scheduled_;
+
+  // The number of functions queued across all levels.
+  std::size_t queued_;
+
+  std::size_t num_levels_;
+  level* levels_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/detail/impl/priority_executor_impl.hpp"
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/detail/impl/priority_executor_impl.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DETAIL_PRIORITY_EXECUTOR_IMPL_HPP
@@ -0,0 +1,97 @@
+//
+// detail/shaper_op.hpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_SHAPER_OP_HPP
+#define ASIO_DETAIL_SHAPER_OP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/fenced_block.hpp"
+#include "asio/detail/handler_alloc_helpers.hpp"
+#include "asio/detail/handler_invoke_helpers.hpp"
+#include "asio/detail/handler_work.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/operation.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A request for permission to send, queued in a traffic_shaper.
+class shaper_op
+  : public operation
+{
+public:
+  // The error code to be passed to the completion handler.
+  asio::error_code ec_;
+
+  // The number of bytes requested and, on completion, granted.
+  std::size_t bytes_;
+
+protected:
+  shaper_op(func_type func, std::size_t bytes)
+    : operation(func),
+      bytes_(bytes)
+  {
+  }
+};
+
+template <typename Handler>
+class shaper_handler : public shaper_op
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(shaper_handler);
+
+  shaper_handler(Handler& h, std::size_t bytes)
+    : shaper_op(&shaper_handler::do_complete, bytes),
+      handler_(ASIO_MOVE_CAST(Handler)(h))
+  {
+    handler_work<Handler>::start(handler_);
+  }
+
+  static void do_complete(void* owner, operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    shaper_handler* h(static_cast<shaper_handler*>(base));
+    ptr p = { asio::detail::addressof(h->handler_), h, h };
+    handler_work<Handler> w(h->handler_);
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    detail::binder2<Handler, asio::error_code, std::size_t>
+      handler(h->handler_, h->ec_, h->bytes_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      fenced_block b(fenced_block::half);
+      w.complete(handler, handler.handler_);
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_SHAPER_OP_HPP
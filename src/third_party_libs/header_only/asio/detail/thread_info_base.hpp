@@ -28,51 +28,113 @@ class thread_info_base
   : private noncopyable
 {
 public:
+  // Memory for handlers and executor functions.
+  struct default_tag
+  {
+    enum { mem_index = 0, cache_size = 1 };
+  };
+
+  // Memory for coroutine frames and the state of operations they await.
+  // Several blocks are kept, since a coroutine, the coroutines it awaits and
+  // its pending operations are all alive at once.
+  struct awaitable_frame_tag
+  {
+    enum { mem_index = 1, cache_size = 6 };
+  };
+
+  enum { max_mem_index = 7 };
+
   thread_info_base()
-    : reusable_memory_(0)
   {
+    for (int i = 0; i < max_mem_index; ++i)
+      reusable_memory_[i] = 0;
   }
 
   ~thread_info_base()
   {
-    if (reusable_memory_)
-      ::operator delete(reusable_memory_);
+    for (int i = 0; i < max_mem_index; ++i)
+      if (reusable_memory_[i])
+        ::operator delete(reusable_memory_[i]);
   }
 
   static void* allocate(thread_info_base* this_thread, std::size_t size)
   {
-    if (this_thread && this_thread->reusable_memory_)
-    {
-      void* const pointer = this_thread->reusable_memory_;
-      this_thread->reusable_memory_ = 0;
+    return allocate(default_tag(), this_thread, size);
+  }
+
+  static void deallocate(thread_info_base* this_thread,
+      void* pointer, std::size_t size)
+  {
+    deallocate(default_tag(), this_thread, pointer, size);
+  }
+
+  // Blocks are sized in chunks, and the number of chunks is kept in the byte
+  // after the requested size, so that blocks of up to UCHAR_MAX chunks can be
+  // reused.
+  template <typename Purpose>
+  static void* allocate(Purpose, thread_info_base* this_thread,
+      std::size_t size)
+  {
+    std::size_t chunks = (size + chunk_size - 1) / chunk_size;
 
-      unsigned char* const mem = static_cast<unsigned char*>(pointer);
-      if (static_cast<std::size_t>(mem[0]) >= size)
+    if (this_thread)
+    {
+      for (int i = Purpose::mem_index;
+          i < Purpose::mem_index + Purpose::cache_size; ++i)
       {
-        mem[size] = mem[0];
-        return pointer;
+        if (this_thread->reusable_memory_[i])
+        {
+          void* const pointer = this_thread->reusable_memory_[i];
+          unsigned char* const mem = static_cast<unsigned char*>(pointer);
+          if (static_cast<std::size_t>(mem[0]) >= chunks)
+          {
+            this_thread->reusable_memory_[i] = 0;
+            mem[size] = mem[0];
+            return pointer;
+          }
+        }
       }
 
-      ::operator delete(pointer);
+      // Nothing cached is big enough. Drop a block so that the cache fills
+      // with blocks of the sizes now in use.
+      for (int i = Purpose::mem_index;
+          i < Purpose::mem_index + Purpose::cache_size; ++i)
+      {
+        if (this_thread->reusable_memory_[i])
+        {
+          void* const pointer = this_thread->reusable_memory_[i];
+          this_thread->reusable_memory_[i] = 0;
+          ::operator delete(pointer);
+          break;
+        }
+      }
     }
 
-    void* const pointer = ::operator new(size + 1);
+    void* const pointer = ::operator new(chunks * chunk_size + 1);
     unsigned char* const mem = static_cast<unsigned char*>(pointer);
-    mem[size] = (size <= UCHAR_MAX) ? static_cast<unsigned char>(size) : 0;
+    mem[size] = (chunks <= UCHAR_MAX) ? static_cast<unsigned char>(chunks) : 0;
     return pointer;
   }
 
-  static void deallocate(thread_info_base* this_thread,
+  template <typename Purpose>
+  static void deallocate(Purpose, thread_info_base* this_thread,
       void* pointer, std::size_t size)
   {
-    if (size <= UCHAR_MAX)
+    if (size <= chunk_size * UCHAR_MAX)
     {
-      if (this_thread && this_thread->reusable_memory_ == 0)
+      if (this_thread)
       {
-        unsigned char* const mem = static_cast<unsigned char*>(pointer);
-        mem[0] = mem[size];
-        this_thread->reusable_memory_ = pointer;
-        return;
+        for (int i = Purpose::mem_index;
+            i < Purpose::mem_index + Purpose::cache_size; ++i)
+        {
+          if (this_thread->reusable_memory_[i] == 0)
+          {
+            unsigned char* const mem = static_cast<unsigned char*>(pointer);
+            mem[0] = mem[size];
+            this_thread->reusable_memory_[i] = pointer;
+            return;
+          }
+        }
       }
     }
 
@@ -80,7 +142,8 @@ public:
   }
 
 private:
-  void* reusable_memory_;
+  enum { chunk_size = 4 };
+  void* reusable_memory_[max_mem_index];
 };
 
 } // namespace detail
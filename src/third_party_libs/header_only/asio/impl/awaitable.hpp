@@ -0,0 +1,332 @@
+//
+// impl/awaitable.hpp
+// ~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_AWAITABLE_HPP
+#define ASIO_IMPL_AWAITABLE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <utility>
+#include "asio/detail/call_stack.hpp"
+#include "asio/detail/thread_context.hpp"
+#include "asio/detail/thread_info_base.hpp"
+#include "asio/this_coro.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// The coroutines started by one call to co_spawn form a stack of frames, with
+// each frame awaiting the one above it. The awaitable_thread owns the bottom
+// frame and tracks the top one, which is the frame to resume when an
+// operation it awaits completes.
+//
+// Frames are linked when they are awaited: the awaited frame records its
+// caller and becomes the top of the stack. Control does not pass between
+// frames by symmetric transfer, which only keeps the stack flat when the
+// compiler makes it a tail call, and not at -O0. Instead a frame that awaits
+// another, or finishes, suspends back to awaitable_thread::pump(), which
+// resumes the next frame from a loop. Awaiting a coroutine costs no scheduler
+// round trip, and any number of coroutines that finish without suspending
+// can be awaited in a row.
+
+template <typename Executor>
+class awaitable_frame_base
+{
+public:
+#if !defined(ASIO_DISABLE_SMALL_BLOCK_RECYCLING)
+  void* operator new(std::size_t size)
+  {
+    return asio::detail::thread_info_base::allocate(
+        thread_info_base::awaitable_frame_tag(),
+        thread_context::thread_call_stack::top(), size);
+  }
+
+  void operator delete(void* pointer, std::size_t size)
+  {
+    asio::detail::thread_info_base::deallocate(
+        thread_info_base::awaitable_frame_tag(),
+        thread_context::thread_call_stack::top(), pointer, size);
+  }
+#endif // !defined(ASIO_DISABLE_SMALL_BLOCK_RECYCLING)
+
+  awaitable_frame_base()
+    : thread_(0),
+      caller_(0)
+  {
+  }
+
+  // A coroutine starts when it is awaited, not when it is called.
+  std::suspend_always initial_suspend() ASIO_NOEXCEPT
+  {
+    return std::suspend_always();
+  }
+
+  // On completion, control passes back to the awaiting frame.
+  auto final_suspend() ASIO_NOEXCEPT
+  {
+    struct result
+    {
+      awaitable_frame_base* this_;
+
+      bool await_ready() const ASIO_NOEXCEPT
+      {
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<>) ASIO_NOEXCEPT
+      {
+        this_->pop_frame();
+      }
+
+      void await_resume() const ASIO_NOEXCEPT
+      {
+      }
+    };
+
+    return result{this};
+  }
+
+  void unhandled_exception()
+  {
+    pending_exception_ = std::current_exception();
+  }
+
+  void rethrow_exception()
+  {
+    if (pending_exception_)
+    {
+      std::exception_ptr ex = pending_exception_;
+      pending_exception_ = std::exception_ptr();
+      std::rethrow_exception(ex);
+    }
+  }
+
+  template <typename T>
+  T&& await_transform(T&& t) const ASIO_NOEXCEPT
+  {
+    return static_cast<T&&>(t);
+  }
+
+  // Obtain the executor of the thread.
+  auto await_transform(this_coro::executor_t) ASIO_NOEXCEPT
+  {
+    struct result
+    {
+      awaitable_frame_base* this_;
+
+      bool await_ready() const ASIO_NOEXCEPT
+      {
+        return true;
+      }
+
+      void await_suspend(std::coroutine_handle<>) ASIO_NOEXCEPT
+      {
+      }
+
+      Executor await_resume() const ASIO_NOEXCEPT
+      {
+        return this_->thread_->get_executor();
+      }
+    };
+
+    return result{this};
+  }
+
+  // Put this frame on top of the caller's, and have the pump resume it once
+  // the caller has suspended.
+  void push_frame(awaitable_frame_base& caller) ASIO_NOEXCEPT
+  {
+    thread_ = caller.thread_;
+    caller_ = &caller;
+    thread_->top_of_stack_ = this;
+    *thread_->resume_next_ = coro_;
+  }
+
+  // Remove this finished frame, and have the pump resume its caller. When the
+  // bottom frame finishes, the thread and all of its frames are destroyed.
+  void pop_frame() ASIO_NOEXCEPT
+  {
+    if (caller_)
+    {
+      thread_->top_of_stack_ = caller_;
+      *thread_->resume_next_ = caller_->coro_;
+      return;
+    }
+
+    delete thread_;
+  }
+
+  void destroy()
+  {
+    coro_.destroy();
+  }
+
+protected:
+  template <typename> friend class awaitable_thread;
+
+  std::coroutine_handle<> coro_;
+  awaitable_thread<Executor>* thread_;
+  awaitable_frame_base* caller_;
+  std::exception_ptr pending_exception_;
+};
+
+template <typename T, typename Executor>
+class awaitable_frame
+  : public awaitable_frame_base<Executor>
+{
+public:
+  awaitable_frame()
+    : has_result_(false)
+  {
+  }
+
+  ~awaitable_frame()
+  {
+    if (has_result_)
+      static_cast<T*>(static_cast<void*>(result_))->~T();
+  }
+
+  awaitable<T, Executor> get_return_object() ASIO_NOEXCEPT
+  {
+    this->coro_ = std::coroutine_handle<awaitable_frame>::from_promise(*this);
+    return awaitable<T, Executor>(this);
+  }
+
+  template <typename U>
+  void return_value(U&& u)
+  {
+    new (&result_) T(static_cast<U&&>(u));
+    has_result_ = true;
+  }
+
+  T get()
+  {
+    this->rethrow_exception();
+    return static_cast<T&&>(*static_cast<T*>(static_cast<void*>(result_)));
+  }
+
+private:
+  alignas(T) unsigned char result_[sizeof(T)];
+  bool has_result_;
+};
+
+template <typename Executor>
+class awaitable_frame<void, Executor>
+  : public awaitable_frame_base<Executor>
+{
+public:
+  awaitable<void, Executor> get_return_object() ASIO_NOEXCEPT
+  {
+    this->coro_ = std::coroutine_handle<awaitable_frame>::from_promise(*this);
+    return awaitable<void, Executor>(this);
+  }
+
+  void return_void()
+  {
+  }
+
+  void get()
+  {
+    this->rethrow_exception();
+  }
+};
+
+template <typename Executor>
+class awaitable_thread
+{
+public:
+  typedef Executor executor_type;
+
+#if !defined(ASIO_DISABLE_SMALL_BLOCK_RECYCLING)
+  void* operator new(std::size_t size)
+  {
+    return asio::detail::thread_info_base::allocate(
+        thread_info_base::awaitable_frame_tag(),
+        thread_context::thread_call_stack::top(), size);
+  }
+
+  void operator delete(void* pointer, std::size_t size)
+  {
+    asio::detail::thread_info_base::deallocate(
+        thread_info_base::awaitable_frame_tag(),
+        thread_context::thread_call_stack::top(), pointer, size);
+  }
+#endif // !defined(ASIO_DISABLE_SMALL_BLOCK_RECYCLING)
+
+  // Take ownership of the bottom frame.
+  awaitable_thread(awaitable<void, Executor> bottom, const Executor& ex)
+    : bottom_of_stack_(static_cast<awaitable<void, Executor>&&>(bottom)),
+      top_of_stack_(bottom_of_stack_.frame_),
+      resume_next_(0),
+      executor_(ex)
+  {
+    bottom_of_stack_.frame_->thread_ = this;
+  }
+
+  executor_type get_executor() const ASIO_NOEXCEPT
+  {
+    return executor_;
+  }
+
+  // The thread whose frames are running on the calling thread, if any.
+  static awaitable_thread* current()
+  {
+    return call_stack<awaitable_thread, awaitable_thread>::top();
+  }
+
+  // Resume the top frame, and then each frame it passes control to, until
+  // one suspends waiting for an operation or the bottom frame finishes.
+  // Either way another thread may then resume or destroy this one, so once a
+  // frame has run, the only state consulted here is the local handle the
+  // frames fill in through resume_next_.
+  void pump()
+  {
+    typename call_stack<awaitable_thread, awaitable_thread>::context
+      ctx(this, *this);
+    std::coroutine_handle<> next = top_of_stack_->coro_;
+    resume_next_ = &next;
+    do
+    {
+      std::coroutine_handle<> h = next;
+      next = std::coroutine_handle<>();
+      h.resume();
+    } while (next);
+  }
+
+private:
+  template <typename> friend class awaitable_frame_base;
+
+  // Disallow copying and assignment.
+  awaitable_thread(const awaitable_thread&) ASIO_DELETED;
+  awaitable_thread& operator=(const awaitable_thread&) ASIO_DELETED;
+
+  awaitable<void, Executor> bottom_of_stack_;
+  awaitable_frame_base<Executor>* top_of_stack_;
+
+  // Where a frame records the coroutine the running pump resumes next.
+  std::coroutine_handle<>* resume_next_;
+
+  Executor executor_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_AWAITABLE_HPP
@@ -0,0 +1,216 @@
+//
+// impl/buffer_pool.hpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_BUFFER_POOL_HPP
+#define ASIO_IMPL_BUFFER_POOL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/associated_allocator.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/socket_base.hpp"
+#include "asio/detail/handler_alloc_helpers.hpp"
+#include "asio/detail/handler_cont_helpers.hpp"
+#include "asio/detail/handler_invoke_helpers.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail
+{
+  // Waits for readability with no buffer posted, then borrows a buffer sized
+  // to the data waiting in the socket and reads it.
+  template <typename Socket, typename ReadHandler>
+  class pooled_read_op
+  {
+  public:
+    enum phase_type { waiting, reading };
+
+    pooled_read_op(Socket& socket, buffer_pool& pool,
+        std::size_t max_size, ReadHandler& handler)
+      : socket_(socket),
+        pool_(pool),
+        max_size_(max_size),
+        phase_(waiting),
+        start_(0),
+        buffer_(),
+        handler_(ASIO_MOVE_CAST(ReadHandler)(handler))
+    {
+    }
+
+    pooled_read_op(pooled_read_op&& other)
+      : socket_(other.socket_),
+        pool_(other.pool_),
+        max_size_(other.max_size_),
+        phase_(other.phase_),
+        start_(other.start_),
+        buffer_(ASIO_MOVE_CAST(pooled_buffer)(other.buffer_)),
+        handler_(ASIO_MOVE_CAST(ReadHandler)(other.handler_))
+    {
+    }
+
+    void operator()(asio::error_code ec,
+        std::size_t bytes_transferred = 0, int start = 0)
+    {
+      if ((start_ = start) != 0)
+      {
+        // The reactor re-arms the descriptor when a wait is started, so data
+        // that arrived earlier is reported straight away.
+        phase_ = waiting;
+        socket_.async_wait(socket_base::wait_read,
+            ASIO_MOVE_CAST(pooled_read_op)(*this));
+        return;
+      }
+
+      if (phase_ == reading)
+      {
+        buffer_.resize(bytes_transferred);
+        if (ec)
+          buffer_.release();
+        handler_(ec, ASIO_MOVE_CAST(pooled_buffer)(buffer_));
+        return;
+      }
+
+      if (!ec)
+      {
+        std::size_t available = socket_.available(ec);
+        if (!ec)
+        {
+          buffer_ = pool_.allocate(available != 0 && available < max_size_
+              ? available : max_size_, ec);
+          if (!ec && available != 0)
+          {
+            // The data is already there, so this read cannot block.
+            buffer_.resize(socket_.read_some(asio::buffer(buffer_), ec));
+            if (ec)
+              buffer_.release();
+            handler_(ec, ASIO_MOVE_CAST(pooled_buffer)(buffer_));
+            return;
+          }
+          if (!ec)
+          {
+            // Nothing available means a close, or an error for the read to
+            // report.
+            phase_ = reading;
+            socket_.async_read_some(asio::buffer(buffer_),
+                ASIO_MOVE_CAST(pooled_read_op)(*this));
+            return;
+          }
+        }
+      }
+
+      handler_(ec, pooled_buffer());
+    }
+
+  //private:
+    Socket& socket_;
+    buffer_pool& pool_;
+    std::size_t max_size_;
+    phase_type phase_;
+    int start_;
+    pooled_buffer buffer_;
+    ReadHandler handler_;
+  };
+
+  template <typename Socket, typename ReadHandler>
+  inline void* asio_handler_allocate(std::size_t size,
+      pooled_read_op<Socket, ReadHandler>* this_handler)
+  {
+    return asio_handler_alloc_helpers::allocate(
+        size, this_handler->handler_);
+  }
+
+  template <typename Socket, typename ReadHandler>
+  inline void asio_handler_deallocate(void* pointer, std::size_t size,
+      pooled_read_op<Socket, ReadHandler>* this_handler)
+  {
+    asio_handler_alloc_helpers::deallocate(
+        pointer, size, this_handler->handler_);
+  }
+
+  template <typename Socket, typename ReadHandler>
+  inline bool asio_handler_is_continuation(
+      pooled_read_op<Socket, ReadHandler>* this_handler)
+  {
+    return this_handler->start_ == 0 ? true
+      : asio_handler_cont_helpers::is_continuation(
+          this_handler->handler_);
+  }
+
+  template <typename Function, typename Socket, typename ReadHandler>
+  inline void asio_handler_invoke(Function& function,
+      pooled_read_op<Socket, ReadHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+  }
+
+  template <typename Function, typename Socket, typename ReadHandler>
+  inline void asio_handler_invoke(const Function& function,
+      pooled_read_op<Socket, ReadHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+  }
+} // namespace detail
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <typename Socket, typename ReadHandler, typename Allocator>
+struct associated_allocator<
+    detail::pooled_read_op<Socket, ReadHandler>, Allocator>
+{
+  typedef typename associated_allocator<ReadHandler, Allocator>::type type;
+
+  static type get(const detail::pooled_read_op<Socket, ReadHandler>& h,
+      const Allocator& a = Allocator()) ASIO_NOEXCEPT
+  {
+    return associated_allocator<ReadHandler, Allocator>::get(h.handler_, a);
+  }
+};
+
+template <typename Socket, typename ReadHandler, typename Executor>
+struct associated_executor<
+    detail::pooled_read_op<Socket, ReadHandler>, Executor>
+{
+  typedef typename associated_executor<ReadHandler, Executor>::type type;
+
+  static type get(const detail::pooled_read_op<Socket, ReadHandler>& h,
+      const Executor& ex = Executor()) ASIO_NOEXCEPT
+  {
+    return associated_executor<ReadHandler, Executor>::get(h.handler_, ex);
+  }
+};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+template <typename Socket, typename ReadHandler>
+inline ASIO_INITFN_RESULT_TYPE(ReadHandler,
+    void (asio::error_code, pooled_buffer))
+async_read_some_pooled(Socket& s, buffer_pool& pool, std::size_t max_size,
+    ASIO_MOVE_ARG(ReadHandler) handler)
+{
+  async_completion<ReadHandler,
+    void (asio::error_code, pooled_buffer)> init(handler);
+
+  detail::pooled_read_op<Socket, ASIO_HANDLER_TYPE(
+    ReadHandler, void (asio::error_code, pooled_buffer))>(
+      s, pool, max_size, init.handler)(asio::error_code(), 0, 1);
+
+  return init.result.get();
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_BUFFER_POOL_HPP
@@ -0,0 +1,213 @@
+//
+// impl/buffer_pool.ipp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_BUFFER_POOL_IPP
+#define ASIO_IMPL_BUFFER_POOL_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_MOVE)
+
+#include <vector>
+#include "asio/buffer_pool.hpp"
+#include "asio/detail/thread.hpp"
+
+#if defined(__linux__) && defined(__GLIBC__)
+# include <sched.h>
+#elif defined(ASIO_HAS_STD_THREAD)
+# include <functional>
+# include <thread>
+#endif
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+// Each cache is padded out to its own cache lines so that processors working
+// on neighbouring caches do not contend for them.
+struct buffer_pool::cache
+{
+  detail::mutex mutex_;
+  std::vector<char*> free_[size_classes];
+  std::size_t cached_bytes_;
+  char padding_[64];
+
+  cache() : cached_bytes_(0) {}
+};
+
+namespace detail {
+
+inline std::size_t buffer_pool_class_size(std::size_t size_class)
+{
+  return buffer_pool::min_buffer_size << size_class;
+}
+
+} // namespace detail
+
+buffer_pool::buffer_pool(std::size_t max_bytes,
+    std::size_t caches, std::size_t max_cached_bytes)
+  : max_bytes_(max_bytes),
+    max_cached_bytes_(max_cached_bytes),
+    num_caches_(caches ? caches : detail::thread::hardware_concurrency()),
+    caches_(0),
+    bytes_allocated_(0)
+{
+  if (num_caches_ == 0)
+    num_caches_ = 1;
+  caches_ = new cache[num_caches_];
+}
+
+buffer_pool::~buffer_pool()
+{
+  for (std::size_t i = 0; i < num_caches_; ++i)
+    for (std::size_t c = 0; c < size_classes; ++c)
+      for (std::size_t j = 0; j < caches_[i].free_[c].size(); ++j)
+        delete[] caches_[i].free_[c][j];
+  delete[] caches_;
+}
+
+pooled_buffer buffer_pool::allocate(std::size_t size, asio::error_code& ec)
+{
+  std::size_t size_class = 0;
+  while (size_class + 1 < size_classes
+      && detail::buffer_pool_class_size(size_class) < size)
+    ++size_class;
+  std::size_t class_size = detail::buffer_pool_class_size(size_class);
+
+  pooled_buffer b;
+  {
+    cache& c = current_cache();
+    detail::mutex::scoped_lock lock(c.mutex_);
+    if (!c.free_[size_class].empty())
+    {
+      b.data_ = c.free_[size_class].back();
+      c.free_[size_class].pop_back();
+      c.cached_bytes_ -= class_size;
+    }
+  }
+
+  if (!b.data_)
+  {
+    if (max_bytes_)
+    {
+      detail::mutex::scoped_lock lock(mutex_);
+      bool over_limit = bytes_allocated_ + class_size > max_bytes_;
+      lock.unlock();
+      if (over_limit)
+        reclaim(class_size);
+      lock.lock();
+      if (bytes_allocated_ + class_size > max_bytes_)
+      {
+        ec = asio::error::no_buffer_space;
+        return b;
+      }
+      bytes_allocated_ += class_size;
+    }
+    else
+    {
+      detail::mutex::scoped_lock lock(mutex_);
+      bytes_allocated_ += class_size;
+    }
+    b.data_ = new char[class_size];
+  }
+
+  b.pool_ = this;
+  b.size_class_ = size_class;
+  b.capacity_ = b.size_ = class_size;
+  ec = asio::error_code();
+  return b;
+}
+
+std::size_t buffer_pool::bytes_allocated() const
+{
+  detail::mutex::scoped_lock lock(mutex_);
+  return bytes_allocated_;
+}
+
+std::size_t buffer_pool::bytes_in_use() const
+{
+  std::size_t cached = 0;
+  for (std::size_t i = 0; i < num_caches_; ++i)
+  {
+    detail::mutex::scoped_lock lock(caches_[i].mutex_);
+    cached += caches_[i].cached_bytes_;
+  }
+  std::size_t allocated = bytes_allocated();
+  return allocated > cached ? allocated - cached : 0;
+}
+
+void buffer_pool::deallocate(char* data, std::size_t size_class)
+{
+  std::size_t class_size = detail::buffer_pool_class_size(size_class);
+  {
+    cache& c = current_cache();
+    detail::mutex::scoped_lock lock(c.mutex_);
+    if (c.cached_bytes_ + class_size <= max_cached_bytes_)
+    {
+      c.free_[size_class].push_back(data);
+      c.cached_bytes_ += class_size;
+      return;
+    }
+  }
+
+  delete[] data;
+  detail::mutex::scoped_lock lock(mutex_);
+  bytes_allocated_ -= class_size;
+}
+
+buffer_pool::cache& buffer_pool::current_cache()
+{
+#if defined(__linux__) && defined(__GLIBC__)
+  int cpu = ::sched_getcpu();
+  std::size_t index = cpu < 0 ? 0 : static_cast<std::size_t>(cpu);
+#elif defined(ASIO_HAS_STD_THREAD)
+  std::size_t index = std::hash<std::thread::id>()(std::this_thread::get_id());
+#else
+  std::size_t index = 0;
+#endif
+  return caches_[index % num_caches_];
+}
+
+void buffer_pool::reclaim(std::size_t bytes)
+{
+  std::size_t freed = 0;
+  for (std::size_t i = 0; i < num_caches_ && freed < bytes; ++i)
+  {
+    cache& c = caches_[i];
+    detail::mutex::scoped_lock lock(c.mutex_);
+    for (std::size_t size_class = size_classes;
+        size_class-- > 0 && freed < bytes; )
+    {
+      std::size_t class_size = detail::buffer_pool_class_size(size_class);
+      while (!c.free_[size_class].empty() && freed < bytes)
+      {
+        delete[] c.free_[size_class].back();
+        c.free_[size_class].pop_back();
+        c.cached_bytes_ -= class_size;
+        freed += class_size;
+      }
+    }
+  }
+
+  detail::mutex::scoped_lock lock(mutex_);
+  bytes_allocated_ -= freed;
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_MOVE)
+
+#endif // ASIO_IMPL_BUFFER_POOL_IPP
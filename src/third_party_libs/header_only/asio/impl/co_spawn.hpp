@@ -0,0 +1,253 @@
+//
+// impl/co_spawn.hpp
+// ~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_CO_SPAWN_HPP
+#define ASIO_IMPL_CO_SPAWN_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/executor_work.hpp"
+#include "asio/post.hpp"
+#include "asio/this_coro.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// The bottom frame of a thread: runs the user's coroutine, then posts the
+// completion handler to its associated executor, which defaults to the
+// coroutine's. Posting rather than dispatching lets exceptions thrown by the
+// handler escape from run() as they would for any other handler.
+template <typename T, typename Executor, typename F, typename Handler>
+awaitable<void, Executor> co_spawn_entry_point(
+    awaitable<T, Executor>*, F f, Handler handler)
+{
+  Executor ex = co_await this_coro::executor;
+  executor_work<typename associated_executor<Handler, Executor>::type>
+    work((get_associated_executor)(handler, ex));
+
+  std::exception_ptr e;
+  bool done = false;
+  try
+  {
+    T t = co_await f();
+    done = true;
+    (post)(work.get_executor(),
+        [handler = static_cast<Handler&&>(handler),
+          t = static_cast<T&&>(t)]() mutable
+        {
+          handler(std::exception_ptr(), static_cast<T&&>(t));
+        });
+    co_return;
+  }
+  catch (...)
+  {
+    if (done)
+      throw;
+    e = std::current_exception();
+  }
+
+  (post)(work.get_executor(),
+      [handler = static_cast<Handler&&>(handler), e]() mutable
+      {
+        handler(e, T());
+      });
+}
+
+template <typename Executor, typename F, typename Handler>
+awaitable<void, Executor> co_spawn_entry_point(
+    awaitable<void, Executor>*, F f, Handler handler)
+{
+  Executor ex = co_await this_coro::executor;
+  executor_work<typename associated_executor<Handler, Executor>::type>
+    work((get_associated_executor)(handler, ex));
+
+  std::exception_ptr e;
+  try
+  {
+    co_await f();
+  }
+  catch (...)
+  {
+    e = std::current_exception();
+  }
+
+  (post)(work.get_executor(),
+      [handler = static_cast<Handler&&>(handler), e]() mutable
+      {
+        handler(e);
+      });
+}
+
+// Adapts an awaitable to the function object form.
+template <typename T, typename Executor>
+class awaitable_as_function
+{
+public:
+  explicit awaitable_as_function(awaitable<T, Executor>&& a)
+    : awaitable_(static_cast<awaitable<T, Executor>&&>(a))
+  {
+  }
+
+  awaitable<T, Executor> operator()()
+  {
+    return static_cast<awaitable<T, Executor>&&>(awaitable_);
+  }
+
+private:
+  awaitable<T, Executor> awaitable_;
+};
+
+// Owns a new thread until it first runs. If the io_service is destroyed
+// first, the thread is destroyed without running.
+template <typename Executor>
+class awaitable_thread_starter
+{
+public:
+  explicit awaitable_thread_starter(awaitable_thread<Executor>* thread)
+    : thread_(thread)
+  {
+  }
+
+  awaitable_thread_starter(awaitable_thread_starter&& other) ASIO_NOEXCEPT
+    : thread_(other.thread_)
+  {
+    other.thread_ = 0;
+  }
+
+  ~awaitable_thread_starter()
+  {
+    delete thread_;
+  }
+
+  void operator()()
+  {
+    awaitable_thread<Executor>* thread = thread_;
+    thread_ = 0;
+    thread->pump();
+  }
+
+private:
+  // Disallow copying and assignment.
+  awaitable_thread_starter(const awaitable_thread_starter&) ASIO_DELETED;
+  awaitable_thread_starter& operator=(
+      const awaitable_thread_starter&) ASIO_DELETED;
+
+  awaitable_thread<Executor>* thread_;
+};
+
+template <typename Executor, typename F, typename CompletionToken>
+inline ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename awaitable_function_result<F>::signature)
+co_spawn_function(const Executor& ex, F&& f,
+    ASIO_MOVE_ARG(CompletionToken) token)
+{
+  typedef typename awaitable_function_result<F>::value_type value_type;
+  typedef typename awaitable_function_result<F>::executor_type
+    executor_type;
+  typedef typename awaitable_function_result<F>::signature signature;
+
+  async_completion<CompletionToken, signature> init(token);
+
+  awaitable_thread<executor_type>* thread =
+    new awaitable_thread<executor_type>(
+        co_spawn_entry_point(
+          static_cast<awaitable<value_type, executor_type>*>(0),
+          static_cast<F&&>(f),
+          static_cast<ASIO_HANDLER_TYPE(CompletionToken, signature)&&>(
+            init.handler)),
+        executor_type(ex));
+
+  asio::post(executor_type(ex),
+      awaitable_thread_starter<executor_type>(thread));
+
+  return init.result.get();
+}
+
+} // namespace detail
+
+template <typename Executor, typename T, typename AwaitableExecutor,
+    typename CompletionToken>
+inline ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_signature<T>::type)
+co_spawn(const Executor& ex, awaitable<T, AwaitableExecutor> a,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_executor<Executor>::value
+        && is_convertible<Executor, AwaitableExecutor>::value
+    >::type*)
+{
+  return detail::co_spawn_function(ex,
+      detail::awaitable_as_function<T, AwaitableExecutor>(
+        static_cast<awaitable<T, AwaitableExecutor>&&>(a)),
+      ASIO_MOVE_CAST(CompletionToken)(token));
+}
+
+template <typename ExecutionContext, typename T, typename AwaitableExecutor,
+    typename CompletionToken>
+inline ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_signature<T>::type)
+co_spawn(ExecutionContext& ctx, awaitable<T, AwaitableExecutor> a,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_convertible<ExecutionContext&, execution_context&>::value
+        && is_convertible<typename ExecutionContext::executor_type,
+          AwaitableExecutor>::value
+    >::type*)
+{
+  return (co_spawn)(ctx.get_executor(),
+      static_cast<awaitable<T, AwaitableExecutor>&&>(a),
+      ASIO_MOVE_CAST(CompletionToken)(token));
+}
+
+template <typename Executor, typename F, typename CompletionToken>
+inline ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_function_result<
+      typename decay<F>::type>::signature)
+co_spawn(const Executor& ex, F&& f,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_executor<Executor>::value
+        && is_convertible<Executor, typename detail::awaitable_function_result<
+          typename decay<F>::type>::executor_type>::value
+    >::type*)
+{
+  return detail::co_spawn_function(ex,
+      typename decay<F>::type(static_cast<F&&>(f)),
+      ASIO_MOVE_CAST(CompletionToken)(token));
+}
+
+template <typename ExecutionContext, typename F, typename CompletionToken>
+inline ASIO_INITFN_RESULT_TYPE(CompletionToken,
+    typename detail::awaitable_function_result<
+      typename decay<F>::type>::signature)
+co_spawn(ExecutionContext& ctx, F&& f,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename enable_if<
+      is_convertible<ExecutionContext&, execution_context&>::value
+        && is_convertible<typename ExecutionContext::executor_type,
+          typename detail::awaitable_function_result<
+            typename decay<F>::type>::executor_type>::value
+    >::type*)
+{
+  return (co_spawn)(ctx.get_executor(), static_cast<F&&>(f),
+      ASIO_MOVE_CAST(CompletionToken)(token));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_CO_SPAWN_HPP
@@ -132,7 +132,12 @@ class executor::impl
   : public executor::impl_base
 {
 public:
+#if defined(ASIO_HAS_STD_ALLOCATOR_ARG)
+  typedef typename std::allocator_traits<
+    Allocator>::template rebind_alloc<impl> allocator_type;
+#else // defined(ASIO_HAS_STD_ALLOCATOR_ARG)
   typedef typename Allocator::template rebind<impl>::other allocator_type;
+#endif // defined(ASIO_HAS_STD_ALLOCATOR_ARG)
 
   static impl_base* create(const Executor& e, Allocator a = Allocator())
   {
@@ -19,6 +19,7 @@
 # error Do not compile Asio library source with ASIO_HEADER_ONLY defined
 #endif
 
+#include "asio/impl/buffer_pool.ipp"
 #include "asio/impl/error.ipp"
 #include "asio/impl/error_code.ipp"
 #include "asio/impl/execution_context.ipp"
@@ -28,6 +29,7 @@
 #include "asio/impl/serial_port_base.ipp"
 #include "asio/impl/system_executor.ipp"
 #include "asio/impl/thread_pool.ipp"
+#include "asio/impl/traffic_shaper.ipp"
 #include "asio/detail/impl/buffer_sequence_adapter.ipp"
 #include "asio/detail/impl/descriptor_ops.ipp"
 #include "asio/detail/impl/dev_poll_reactor.ipp"
@@ -40,6 +42,7 @@
 #include "asio/detail/impl/posix_mutex.ipp"
 #include "asio/detail/impl/posix_thread.ipp"
 #include "asio/detail/impl/posix_tss_ptr.ipp"
+#include "asio/detail/impl/priority_executor_impl.ipp"
 #include "asio/detail/impl/reactive_descriptor_service.ipp"
 #include "asio/detail/impl/reactive_serial_port_service.ipp"
 #include "asio/detail/impl/reactive_socket_service_base.ipp"
@@ -0,0 +1,261 @@
+//
+// impl/traffic_shaper.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_TRAFFIC_SHAPER_HPP
+#define ASIO_IMPL_TRAFFIC_SHAPER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/associated_allocator.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/buffer.hpp"
+#include "asio/write.hpp"
+#include "asio/detail/consuming_buffers.hpp"
+#include "asio/detail/handler_alloc_helpers.hpp"
+#include "asio/detail/handler_cont_helpers.hpp"
+#include "asio/detail/handler_invoke_helpers.hpp"
+#include "asio/detail/handler_type_requirements.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+template <typename AcquireHandler>
+ASIO_INITFN_RESULT_TYPE(AcquireHandler,
+    void (asio::error_code, std::size_t))
+traffic_shaper::peer::async_acquire(std::size_t max_bytes,
+    ASIO_MOVE_ARG(AcquireHandler) handler)
+{
+  async_completion<AcquireHandler,
+    void (asio::error_code, std::size_t)> init(handler);
+
+  typedef detail::shaper_handler<ASIO_HANDLER_TYPE(AcquireHandler,
+    void (asio::error_code, std::size_t))> op;
+  typename op::ptr p = { asio::detail::addressof(init.handler),
+    op::ptr::allocate(init.handler), 0 };
+  p.p = new (p.v) op(init.handler, max_bytes);
+
+  start_acquire(p.p);
+  p.v = p.p = 0;
+
+  return init.result.get();
+}
+
+namespace detail
+{
+  template <typename AsyncWriteStream, typename ConstBufferSequence,
+      typename WriteHandler>
+  class shaped_write_op
+  {
+  public:
+    shaped_write_op(AsyncWriteStream& stream, traffic_shaper::peer& peer,
+        const ConstBufferSequence& buffers, WriteHandler& handler)
+      : stream_(stream),
+        peer_(peer),
+        buffers_(buffers),
+        writing_(false),
+        start_(0),
+        total_transferred_(0),
+        total_size_(asio::buffer_size(buffers)),
+        handler_(ASIO_MOVE_CAST(WriteHandler)(handler))
+    {
+    }
+
+#if defined(ASIO_HAS_MOVE)
+    shaped_write_op(const shaped_write_op& other)
+      : stream_(other.stream_),
+        peer_(other.peer_),
+        buffers_(other.buffers_),
+        writing_(other.writing_),
+        start_(other.start_),
+        total_transferred_(other.total_transferred_),
+        total_size_(other.total_size_),
+        handler_(other.handler_)
+    {
+    }
+
+    shaped_write_op(shaped_write_op&& other)
+      : stream_(other.stream_),
+        peer_(other.peer_),
+        buffers_(other.buffers_),
+        writing_(other.writing_),
+        start_(other.start_),
+        total_transferred_(other.total_transferred_),
+        total_size_(other.total_size_),
+        handler_(ASIO_MOVE_CAST(WriteHandler)(other.handler_))
+    {
+    }
+#endif // defined(ASIO_HAS_MOVE)
+
+    void operator()(const asio::error_code& ec,
+        std::size_t bytes_transferred, int start = 0)
+    {
+      switch (start_ = start)
+      {
+        case 1:
+        for (;;)
+        {
+          writing_ = false;
+          peer_.async_acquire(total_size_ - total_transferred_,
+              ASIO_MOVE_CAST(shaped_write_op)(*this));
+          return; default:
+          if (ec)
+            break;
+          if (!writing_)
+          {
+            writing_ = true;
+            buffers_.prepare(bytes_transferred);
+            asio::async_write(stream_, buffers_,
+                ASIO_MOVE_CAST(shaped_write_op)(*this));
+            return;
+          }
+          total_transferred_ += bytes_transferred;
+          buffers_.consume(bytes_transferred);
+          if (total_transferred_ == total_size_)
+            break;
+        }
+
+        handler_(ec, static_cast<const std::size_t&>(total_transferred_));
+      }
+    }
+
+  //private:
+    AsyncWriteStream& stream_;
+    traffic_shaper::peer& peer_;
+    asio::detail::consuming_buffers<
+      const_buffer, ConstBufferSequence> buffers_;
+    bool writing_;
+    int start_;
+    std::size_t total_transferred_;
+    std::size_t total_size_;
+    WriteHandler handler_;
+  };
+
+  template <typename AsyncWriteStream, typename ConstBufferSequence,
+      typename WriteHandler>
+  inline void* asio_handler_allocate(std::size_t size,
+      shaped_write_op<AsyncWriteStream, ConstBufferSequence,
+        WriteHandler>* this_handler)
+  {
+    return asio_handler_alloc_helpers::allocate(
+        size, this_handler->handler_);
+  }
+
+  template <typename AsyncWriteStream, typename ConstBufferSequence,
+      typename WriteHandler>
+  inline void asio_handler_deallocate(void* pointer, std::size_t size,
+      shaped_write_op<AsyncWriteStream, ConstBufferSequence,
+        WriteHandler>* this_handler)
+  {
+    asio_handler_alloc_helpers::deallocate(
+        pointer, size, this_handler->handler_);
+  }
+
+  template <typename AsyncWriteStream, typename ConstBufferSequence,
+      typename WriteHandler>
+  inline bool asio_handler_is_continuation(
+      shaped_write_op<AsyncWriteStream, ConstBufferSequence,
+        WriteHandler>* this_handler)
+  {
+    return this_handler->start_ == 0 ? true
+      : asio_handler_cont_helpers::is_continuation(
+          this_handler->handler_);
+  }
+
+  template <typename Function, typename AsyncWriteStream,
+      typename ConstBufferSequence, typename WriteHandler>
+  inline void asio_handler_invoke(Function& function,
+      shaped_write_op<AsyncWriteStream, ConstBufferSequence,
+        WriteHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+  }
+
+  template <typename Function, typename AsyncWriteStream,
+      typename ConstBufferSequence, typename WriteHandler>
+  inline void asio_handler_invoke(const Function& function,
+      shaped_write_op<AsyncWriteStream, ConstBufferSequence,
+        WriteHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+  }
+} // namespace detail
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <typename AsyncWriteStream, typename ConstBufferSequence,
+    typename WriteHandler, typename Allocator>
+struct associated_allocator<
+    detail::shaped_write_op<AsyncWriteStream,
+      ConstBufferSequence, WriteHandler>,
+    Allocator>
+{
+  typedef typename associated_allocator<WriteHandler, Allocator>::type type;
+
+  static type get(
+      const detail::shaped_write_op<AsyncWriteStream,
+        ConstBufferSequence, WriteHandler>& h,
+      const Allocator& a = Allocator()) ASIO_NOEXCEPT
+  {
+    return associated_allocator<WriteHandler, Allocator>::get(h.handler_, a);
+  }
+};
+
+template <typename AsyncWriteStream, typename ConstBufferSequence,
+    typename WriteHandler, typename Executor>
+struct associated_executor<
+    detail::shaped_write_op<AsyncWriteStream,
+      ConstBufferSequence, WriteHandler>,
+    Executor>
+{
+  typedef typename associated_executor<WriteHandler, Executor>::type type;
+
+  static type get(
+      const detail::shaped_write_op<AsyncWriteStream,
+        ConstBufferSequence, WriteHandler>& h,
+      const Executor& ex = Executor()) ASIO_NOEXCEPT
+  {
+    return associated_executor<WriteHandler, Executor>::get(h.handler_, ex);
+  }
+};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+template <typename AsyncWriteStream, typename ConstBufferSequence,
+    typename WriteHandler>
+inline ASIO_INITFN_RESULT_TYPE(WriteHandler,
+    void (asio::error_code, std::size_t))
+async_write_shaped(AsyncWriteStream& s, traffic_shaper::peer& p,
+    const ConstBufferSequence& buffers,
+    ASIO_MOVE_ARG(WriteHandler) handler)
+{
+  // If you get an error on the following line it means that your handler does
+  // not meet the documented type requirements for a WriteHandler.
+  ASIO_WRITE_HANDLER_CHECK(WriteHandler, handler) type_check;
+
+  async_completion<WriteHandler,
+    void (asio::error_code, std::size_t)> init(handler);
+
+  detail::shaped_write_op<AsyncWriteStream, ConstBufferSequence,
+    ASIO_HANDLER_TYPE(WriteHandler, void (asio::error_code, std::size_t))>(
+      s, p, buffers, init.handler)(asio::error_code(), 0, 1);
+
+  return init.result.get();
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_TRAFFIC_SHAPER_HPP
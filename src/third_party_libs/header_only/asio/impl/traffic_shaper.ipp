@@ -0,0 +1,344 @@
+//
+// impl/traffic_shaper.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_TRAFFIC_SHAPER_IPP
+#define ASIO_IMPL_TRAFFIC_SHAPER_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO)
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include "asio/error.hpp"
+#include "asio/traffic_shaper.hpp"
+#include "asio/detail/mutex.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+struct traffic_shaper::core
+{
+  typedef detail::token_bucket::clock_type clock_type;
+  typedef detail::token_bucket::time_point time_point;
+  typedef detail::token_bucket::duration duration;
+
+  struct traffic_class
+  {
+    traffic_class(std::size_t rate, std::size_t ceiling,
+        std::size_t burst, int priority, const time_point& now)
+      : guaranteed_(rate, burst, now),
+        ceiling_(ceiling, burst, now),
+        priority_(priority)
+    {
+    }
+
+    detail::token_bucket guaranteed_;
+    detail::token_bucket ceiling_;
+    int priority_;
+
+    // Peers with outstanding requests, in round-robin order.
+    std::deque<peer*> active_;
+  };
+
+  core(asio::io_service& io_service, std::size_t rate,
+      std::size_t burst, std::size_t quantum)
+    : scheduler_(asio::use_service<detail::io_service_impl>(io_service)),
+      quantum_(quantum ? quantum : 1),
+      burst_(burst ? burst : (std::max)(quantum_, rate / 50)),
+      link_(rate, burst_, clock_type::now()),
+      timer_(io_service),
+      timer_armed_(false),
+      shutdown_(false)
+  {
+  }
+
+  // Runs the scheduler when the timer expires.
+  struct timer_handler
+  {
+    detail::shared_ptr<core> core_;
+
+    void operator()(const asio::error_code& ec);
+  };
+
+  // Grant every request that can go now, and arm the timer for the next one.
+  void schedule(const detail::shared_ptr<core>& self,
+      detail::op_queue<detail::operation>& ready);
+
+  // Complete a peer's requests with operation_aborted.
+  std::size_t abort(peer& p, detail::op_queue<detail::operation>& ready);
+
+  // Remove a peer from its class's round-robin.
+  void deactivate(peer& p);
+
+  detail::io_service_impl& scheduler_;
+  detail::mutex mutex_;
+  std::size_t quantum_;
+  std::size_t burst_;
+  detail::token_bucket link_;
+  std::vector<traffic_class> classes_;
+  std::vector<class_type> order_;
+  steady_timer timer_;
+  bool timer_armed_;
+  bool shutdown_;
+};
+
+void traffic_shaper::core::schedule(const detail::shared_ptr<core>& self,
+    detail::op_queue<detail::operation>& ready)
+{
+  time_point now = clock_type::now();
+  link_.refill(now);
+  for (std::size_t i = 0; i < classes_.size(); ++i)
+  {
+    classes_[i].guaranteed_.refill(now);
+    classes_[i].ceiling_.refill(now);
+  }
+
+  duration wait = duration::max();
+  for (;;)
+  {
+    if (!link_.ready())
+    {
+      wait = (std::min)(wait, link_.time_until_ready());
+      break;
+    }
+
+    // First serve classes within their guaranteed rates, then let them
+    // borrow up to their ceilings, each time in priority order.
+    peer* chosen = 0;
+    for (int borrowing = 0; borrowing < 2 && !chosen; ++borrowing)
+    {
+      for (std::size_t i = 0; i < order_.size() && !chosen; ++i)
+      {
+        traffic_class& c = classes_[order_[i]];
+        if (c.active_.empty())
+          continue;
+
+        const detail::token_bucket& bucket
+          = borrowing ? c.ceiling_ : c.guaranteed_;
+        if (!borrowing && !bucket.limited())
+          continue;
+        if (!bucket.ready())
+        {
+          wait = (std::min)(wait, bucket.time_until_ready());
+          continue;
+        }
+
+        // Deficit round-robin: each turn adds a quantum to the peer's
+        // allowance, and a peer over its own rate loses its turn.
+        for (std::size_t n = c.active_.size(); n > 0 && !chosen; --n)
+        {
+          peer* p = c.active_.front();
+          c.active_.pop_front();
+          p->bucket_.refill(now);
+          if (p->bucket_.ready())
+            chosen = p;
+          else
+          {
+            wait = (std::min)(wait, p->bucket_.time_until_ready());
+            c.active_.push_back(p);
+          }
+        }
+      }
+    }
+    if (!chosen)
+      break;
+
+    traffic_class& c = classes_[chosen->class_];
+    detail::shaper_op* op = chosen->ops_.front();
+    chosen->ops_.pop();
+    chosen->deficit_ += quantum_;
+    std::size_t bytes = (std::min)(op->bytes_, chosen->deficit_);
+    chosen->deficit_ -= bytes;
+    op->bytes_ = bytes;
+    op->ec_ = asio::error_code();
+    ready.push(op);
+
+    link_.consume(bytes);
+    c.guaranteed_.consume(bytes);
+    c.ceiling_.consume(bytes);
+    chosen->bucket_.consume(bytes);
+
+    if (chosen->ops_.empty())
+    {
+      chosen->active_ = false;
+      chosen->deficit_ = 0;
+    }
+    else
+      c.active_.push_back(chosen);
+  }
+
+  bool pending = false;
+  for (std::size_t i = 0; i < classes_.size() && !pending; ++i)
+    pending = !classes_[i].active_.empty();
+
+  // Re-arming cancels the earlier wait, whose handler then does nothing.
+  if (pending && wait != duration::max()
+      && (!timer_armed_ || now + wait < timer_.expires_at()))
+  {
+    timer_armed_ = true;
+    timer_.expires_at(now + wait);
+    timer_handler handler = { self };
+    timer_.async_wait(handler);
+  }
+}
+
+std::size_t traffic_shaper::core::abort(peer& p,
+    detail::op_queue<detail::operation>& ready)
+{
+  std::size_t n = 0;
+  while (detail::shaper_op* op = p.ops_.front())
+  {
+    p.ops_.pop();
+    op->ec_ = asio::error::operation_aborted;
+    op->bytes_ = 0;
+    ready.push(op);
+    ++n;
+  }
+  deactivate(p);
+  return n;
+}
+
+void traffic_shaper::core::deactivate(peer& p)
+{
+  if (p.active_)
+  {
+    std::deque<peer*>& active = classes_[p.class_].active_;
+    active.erase(std::remove(active.begin(), active.end(), &p),
+        active.end());
+    p.active_ = false;
+    p.deficit_ = 0;
+  }
+}
+
+void traffic_shaper::core::timer_handler::operator()(
+    const asio::error_code& ec)
+{
+  if (ec == asio::error::operation_aborted)
+    return;
+
+  detail::op_queue<detail::operation> ready;
+  {
+    detail::mutex::scoped_lock lock(core_->mutex_);
+    core_->timer_armed_ = false;
+    if (!core_->shutdown_)
+      core_->schedule(core_, ready);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+traffic_shaper::traffic_shaper(asio::io_service& io_service,
+    std::size_t bytes_per_second, std::size_t burst, std::size_t quantum)
+  : core_(new core(io_service, bytes_per_second, burst, quantum))
+{
+}
+
+traffic_shaper::~traffic_shaper()
+{
+  detail::op_queue<detail::operation> ready;
+  {
+    detail::mutex::scoped_lock lock(core_->mutex_);
+    core_->shutdown_ = true;
+    for (std::size_t i = 0; i < core_->classes_.size(); ++i)
+      while (!core_->classes_[i].active_.empty())
+        core_->abort(*core_->classes_[i].active_.front(), ready);
+    asio::error_code ec;
+    core_->timer_.cancel(ec);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+traffic_shaper::class_type traffic_shaper::add_class(
+    std::size_t guaranteed_rate, std::size_t ceiling, int priority)
+{
+  detail::mutex::scoped_lock lock(core_->mutex_);
+  class_type id = core_->classes_.size();
+  core_->classes_.push_back(core::traffic_class(guaranteed_rate, ceiling,
+        core_->burst_, priority, core::clock_type::now()));
+
+  // Keep classes of equal priority in the order they were added.
+  std::vector<class_type>::iterator pos = core_->order_.begin();
+  while (pos != core_->order_.end()
+      && core_->classes_[*pos].priority_ <= priority)
+    ++pos;
+  core_->order_.insert(pos, id);
+  return id;
+}
+
+traffic_shaper::peer::peer(traffic_shaper& shaper,
+    class_type traffic_class, std::size_t bytes_per_second)
+  : core_(shaper.core_),
+    class_(traffic_class),
+    bucket_(bytes_per_second, shaper.core_->burst_,
+        core::clock_type::now()),
+    ops_(),
+    deficit_(0),
+    active_(false)
+{
+}
+
+traffic_shaper::peer::~peer()
+{
+  cancel();
+}
+
+std::size_t traffic_shaper::peer::cancel()
+{
+  detail::op_queue<detail::operation> ready;
+  std::size_t n;
+  {
+    detail::mutex::scoped_lock lock(core_->mutex_);
+    n = core_->abort(*this, ready);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+  return n;
+}
+
+void traffic_shaper::peer::start_acquire(detail::shaper_op* op)
+{
+  core_->scheduler_.work_started();
+
+  detail::op_queue<detail::operation> ready;
+  {
+    detail::mutex::scoped_lock lock(core_->mutex_);
+    if (core_->shutdown_ || class_ >= core_->classes_.size())
+    {
+      op->ec_ = core_->shutdown_ ? asio::error::operation_aborted
+        : asio::error::invalid_argument;
+      op->bytes_ = 0;
+      ready.push(op);
+    }
+    else
+    {
+      ops_.push(op);
+      if (!active_)
+      {
+        active_ = true;
+        core_->classes_[class_].active_.push_back(this);
+      }
+      core_->schedule(core_, ready);
+    }
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_STD_CHRONO)
+
+#endif // ASIO_IMPL_TRAFFIC_SHAPER_IPP
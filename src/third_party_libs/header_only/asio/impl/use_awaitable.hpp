@@ -0,0 +1,394 @@
+//
+// impl/use_awaitable.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_USE_AWAITABLE_HPP
+#define ASIO_IMPL_USE_AWAITABLE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include "asio/async_result.hpp"
+#include "asio/error.hpp"
+#include "asio/error_code.hpp"
+#include "asio/handler_type.hpp"
+#include "asio/detail/thread_context.hpp"
+#include "asio/detail/thread_info_base.hpp"
+#include "asio/detail/throw_error.hpp"
+#include "asio/detail/throw_exception.hpp"
+#include "asio/detail/type_traits.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Maps the arguments of a completion handler to the result of co_await. A
+// leading error_code or exception_ptr is thrown rather than returned.
+template <typename... Args>
+struct awaitable_result_traits
+{
+  typedef std::tuple<Args...> type;
+
+  static type get(std::tuple<Args...>& args)
+  {
+    return static_cast<std::tuple<Args...>&&>(args);
+  }
+};
+
+template <>
+struct awaitable_result_traits<>
+{
+  typedef void type;
+
+  static void get(std::tuple<>&)
+  {
+  }
+};
+
+template <typename T>
+struct awaitable_result_traits<T>
+{
+  typedef T type;
+
+  static type get(std::tuple<T>& args)
+  {
+    return static_cast<T&&>(std::get<0>(args));
+  }
+};
+
+template <>
+struct awaitable_result_traits<asio::error_code>
+{
+  typedef void type;
+
+  static void get(std::tuple<asio::error_code>& args)
+  {
+    asio::detail::throw_error(std::get<0>(args));
+  }
+};
+
+template <>
+struct awaitable_result_traits<std::exception_ptr>
+{
+  typedef void type;
+
+  static void get(std::tuple<std::exception_ptr>& args)
+  {
+    if (std::get<0>(args))
+      std::rethrow_exception(std::get<0>(args));
+  }
+};
+
+template <typename T>
+struct awaitable_result_traits<asio::error_code, T>
+{
+  typedef T type;
+
+  static type get(std::tuple<asio::error_code, T>& args)
+  {
+    asio::detail::throw_error(std::get<0>(args));
+    return static_cast<T&&>(std::get<1>(args));
+  }
+};
+
+template <typename T>
+struct awaitable_result_traits<std::exception_ptr, T>
+{
+  typedef T type;
+
+  static type get(std::tuple<std::exception_ptr, T>& args)
+  {
+    if (std::get<0>(args))
+      std::rethrow_exception(std::get<0>(args));
+    return static_cast<T&&>(std::get<1>(args));
+  }
+};
+
+// The result of one operation, shared by its completion handler and the
+// object the coroutine awaits. Either may go first: the handler may run
+// before the coroutine suspends, or on another thread while it does, and the
+// coroutine may never await the result at all. Whichever side finishes last
+// frees the state.
+template <typename Executor, typename... Args>
+class awaitable_async_state
+{
+public:
+  typedef awaitable_result_traits<Args...> traits_type;
+
+#if !defined(ASIO_DISABLE_SMALL_BLOCK_RECYCLING)
+  void* operator new(std::size_t size)
+  {
+    return asio::detail::thread_info_base::allocate(
+        thread_info_base::awaitable_frame_tag(),
+        thread_context::thread_call_stack::top(), size);
+  }
+
+  void operator delete(void* pointer, std::size_t size)
+  {
+    asio::detail::thread_info_base::deallocate(
+        thread_info_base::awaitable_frame_tag(),
+        thread_context::thread_call_stack::top(), pointer, size);
+  }
+#endif // !defined(ASIO_DISABLE_SMALL_BLOCK_RECYCLING)
+
+  explicit awaitable_async_state(awaitable_thread<Executor>* thread)
+    : state_(pending),
+      thread_(thread)
+  {
+  }
+
+  Executor get_executor() const ASIO_NOEXCEPT
+  {
+    return thread_->get_executor();
+  }
+
+  // Called by the handler when the operation completes. Resumes the
+  // coroutine if it is waiting.
+  template <typename... T>
+  void complete(T&&... args)
+  {
+    result_.emplace(static_cast<T&&>(args)...);
+    awaitable_thread<Executor>* thread = thread_;
+    switch (state_.exchange(completed, std::memory_order_acq_rel))
+    {
+    case waiting:
+      thread->pump();
+      break;
+    case released:
+      delete this;
+      break;
+    default:
+      break;
+    }
+  }
+
+  // Called when the handler is destroyed without being invoked, which
+  // happens when its io_service is destroyed. A waiting coroutine can never
+  // resume, so its thread is destroyed.
+  void abandon()
+  {
+    awaitable_thread<Executor>* thread = thread_;
+    switch (state_.exchange(abandoned, std::memory_order_acq_rel))
+    {
+    case waiting:
+      delete thread;
+      break;
+    case released:
+      delete this;
+      break;
+    default:
+      break;
+    }
+  }
+
+  bool ready() const ASIO_NOEXCEPT
+  {
+    return state_.load(std::memory_order_acquire) != pending;
+  }
+
+  // Returns false if the operation finished first, in which case the
+  // coroutine continues without suspending.
+  bool suspend() ASIO_NOEXCEPT
+  {
+    int expected = pending;
+    return state_.compare_exchange_strong(expected, waiting,
+        std::memory_order_acq_rel, std::memory_order_acquire);
+  }
+
+  typename traits_type::type get()
+  {
+    if (!result_)
+    {
+      asio::error_code ec(asio::error::operation_aborted);
+      asio::detail::throw_error(ec);
+    }
+    return traits_type::get(*result_);
+  }
+
+  // Called when the coroutine no longer needs the result.
+  void release()
+  {
+    int expected = pending;
+    if (!state_.compare_exchange_strong(expected, released,
+          std::memory_order_acq_rel, std::memory_order_acquire))
+      delete this;
+  }
+
+private:
+  enum { pending, waiting, completed, abandoned, released };
+
+  std::atomic<int> state_;
+  awaitable_thread<Executor>* thread_;
+  std::optional<std::tuple<Args...> > result_;
+};
+
+// Completion handler that resumes a coroutine. It is movable but not
+// copyable, since only one copy may complete the operation.
+template <typename Executor, typename... Args>
+class awaitable_handler
+{
+public:
+  typedef Executor executor_type;
+
+  explicit awaitable_handler(use_awaitable_t<Executor>)
+    : state_(new awaitable_async_state<Executor, Args...>(current_thread()))
+  {
+  }
+
+  awaitable_handler(awaitable_handler&& other) ASIO_NOEXCEPT
+    : state_(other.state_)
+  {
+    other.state_ = 0;
+  }
+
+  ~awaitable_handler()
+  {
+    if (state_)
+      state_->abandon();
+  }
+
+  executor_type get_executor() const ASIO_NOEXCEPT
+  {
+    return state_->get_executor();
+  }
+
+  template <typename... T>
+  void operator()(T&&... args)
+  {
+    awaitable_async_state<Executor, Args...>* state = state_;
+    state_ = 0;
+    state->complete(static_cast<T&&>(args)...);
+  }
+
+private:
+  template <typename> friend class asio::async_result;
+
+  // Disallow copying and assignment.
+  awaitable_handler(const awaitable_handler&) ASIO_DELETED;
+  awaitable_handler& operator=(const awaitable_handler&) ASIO_DELETED;
+
+  static awaitable_thread<Executor>* current_thread()
+  {
+    awaitable_thread<Executor>* thread =
+      awaitable_thread<Executor>::current();
+    if (!thread)
+    {
+      std::logic_error ex("use_awaitable used outside an awaitable");
+      asio::detail::throw_exception(ex);
+    }
+    return thread;
+  }
+
+  awaitable_async_state<Executor, Args...>* state_;
+};
+
+// The object returned by an initiating function, to be awaited.
+template <typename Executor, typename... Args>
+class awaitable_async_op
+{
+public:
+  explicit awaitable_async_op(
+      awaitable_async_state<Executor, Args...>* state) ASIO_NOEXCEPT
+    : state_(state)
+  {
+  }
+
+  awaitable_async_op(awaitable_async_op&& other) ASIO_NOEXCEPT
+    : state_(other.state_)
+  {
+    other.state_ = 0;
+  }
+
+  ~awaitable_async_op()
+  {
+    if (state_)
+      state_->release();
+  }
+
+  bool await_ready() const ASIO_NOEXCEPT
+  {
+    return state_->ready();
+  }
+
+  bool await_suspend(std::coroutine_handle<>) ASIO_NOEXCEPT
+  {
+    return state_->suspend();
+  }
+
+  typename awaitable_result_traits<Args...>::type await_resume()
+  {
+    return state_->get();
+  }
+
+private:
+  // Disallow copying and assignment.
+  awaitable_async_op(const awaitable_async_op&) ASIO_DELETED;
+  awaitable_async_op& operator=(const awaitable_async_op&) ASIO_DELETED;
+
+  awaitable_async_state<Executor, Args...>* state_;
+};
+
+} // namespace detail
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <typename Executor, typename... Args>
+class async_result<detail::awaitable_handler<Executor, Args...> >
+{
+public:
+  typedef detail::awaitable_async_op<Executor, Args...> type;
+
+  explicit async_result(detail::awaitable_handler<Executor, Args...>& h)
+    : state_(h.state_)
+  {
+  }
+
+  ~async_result()
+  {
+    if (state_)
+      state_->release();
+  }
+
+  type get()
+  {
+    detail::awaitable_async_state<Executor, Args...>* state = state_;
+    state_ = 0;
+    return type(state);
+  }
+
+private:
+  // Disallow copying and assignment.
+  async_result(const async_result&) ASIO_DELETED;
+  async_result& operator=(const async_result&) ASIO_DELETED;
+
+  detail::awaitable_async_state<Executor, Args...>* state_;
+};
+
+template <typename Executor, typename R, typename... Args>
+struct handler_type<use_awaitable_t<Executor>, R(Args...)>
+{
+  typedef detail::awaitable_handler<Executor,
+    typename decay<Args>::type...> type;
+};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_USE_AWAITABLE_HPP
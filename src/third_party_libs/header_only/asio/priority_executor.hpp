@@ -0,0 +1,316 @@
+//
+// priority_executor.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_PRIORITY_EXECUTOR_HPP
+#define ASIO_PRIORITY_EXECUTOR_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <vector>
+#include "asio/detail/priority_executor_impl.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/is_executor.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+/// Runs function objects in priority order on any executor.
+/**
+ * A priority_executor keeps one queue per priority level in front of an
+ * underlying executor. Level 0 is the most urgent. Rather than passing each
+ * function on, it keeps only a few invokers in the underlying executor's
+ * queue, each of which runs whichever function is most urgent at that moment.
+ * A handler at a high level therefore waits for at most one lower-level
+ * handler per invoker, rather than for everything queued before it.
+ *
+ * All executors obtained from one another with at() share the same queues.
+ * Levels are drained either:
+ *
+ * @li strictly, always running the most urgent waiting function, except that
+ * a function passed over @c starvation_limit times runs next; or
+ *
+ * @li by weight, with each waiting level receiving a share of the turns in
+ * proportion to its weight.
+ *
+ * Priorities only apply among functions submitted through these executors.
+ * To prioritise the completion handlers of asynchronous operations, associate
+ * each handler with an executor at the appropriate level using asio::wrap().
+ *
+ * @par Example
+ * @code
+ * asio::priority_executor<asio::io_service::executor_type> ex(
+ *     io_service.get_executor(), 3);
+ *
+ * asio::post(ex.at(0), keepalive_handler);
+ * socket.async_read_some(buffer, asio::wrap(ex.at(2), bulk_handler));
+ * @endcode
+ */
+template <typename Executor>
+class priority_executor
+{
+public:
+  /// The type of the underlying executor.
+  typedef Executor inner_executor_type;
+
+  /// Construct with strict priority order.
+  /**
+   * @param e The underlying executor.
+   *
+   * @param levels The number of priority levels.
+   *
+   * @param starvation_limit How many functions may run ahead of a waiting one
+   * before it runs regardless of level. Zero means no limit.
+   *
+   * @param concurrency The most functions to run at once, which should match
+   * the number of threads running the underlying executor.
+   *
+   * The constructed executor submits at level 0.
+   */
+  explicit priority_executor(const Executor& e, std::size_t levels = 3,
+      std::size_t starvation_limit = 64, std::size_t concurrency = 1)
+    : executor_(e),
+      impl_(new detail::priority_executor_impl(
+            levels, starvation_limit, concurrency)),
+      level_(0)
+  {
+  }
+
+  /// Construct with weighted order.
+  /**
+   * @param e The underlying executor.
+   *
+   * @param weights The relative share of each level, one per level.
+   *
+   * @param concurrency The most functions to run at once, which should match
+   * the number of threads running the underlying executor.
+   *
+   * The constructed executor submits at level 0.
+   */
+  priority_executor(const Executor& e,
+      const std::vector<std::size_t>& weights, std::size_t concurrency = 1)
+    : executor_(e),
+      impl_(new detail::priority_executor_impl(weights, concurrency)),
+      level_(0)
+  {
+  }
+
+  /// Copy constructor.
+  priority_executor(const priority_executor& other) ASIO_NOEXCEPT
+    : executor_(other.executor_),
+      impl_(other.impl_),
+      level_(other.level_)
+  {
+  }
+
+  /// Assignment operator.
+  priority_executor& operator=(const priority_executor& other) ASIO_NOEXCEPT
+  {
+    executor_ = other.executor_;
+    impl_ = other.impl_;
+    level_ = other.level_;
+    return *this;
+  }
+
+#if defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+  /// Move constructor.
+  priority_executor(priority_executor&& other) ASIO_NOEXCEPT
+    : executor_(ASIO_MOVE_CAST(Executor)(other.executor_)),
+      impl_(ASIO_MOVE_CAST(implementation_type)(other.impl_)),
+      level_(other.level_)
+  {
+  }
+
+  /// Move assignment operator.
+  priority_executor& operator=(priority_executor&& other) ASIO_NOEXCEPT
+  {
+    executor_ = ASIO_MOVE_CAST(Executor)(other.executor_);
+    impl_ = ASIO_MOVE_CAST(implementation_type)(other.impl_);
+    level_ = other.level_;
+    return *this;
+  }
+#endif // defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+
+  /// Destructor.
+  ~priority_executor()
+  {
+  }
+
+  /// Obtain an executor sharing these queues that submits at another level.
+  /**
+   * Levels beyond the last are treated as the last.
+   */
+  priority_executor at(std::size_t level) const ASIO_NOEXCEPT
+  {
+    priority_executor tmp(*this);
+    tmp.level_ = level < impl_->levels() ? level : impl_->levels() - 1;
+    return tmp;
+  }
+
+  /// The level at which this executor submits.
+  std::size_t level() const ASIO_NOEXCEPT
+  {
+    return level_;
+  }
+
+  /// The number of priority levels.
+  std::size_t levels() const ASIO_NOEXCEPT
+  {
+    return impl_->levels();
+  }
+
+  /// Obtain the underlying executor.
+  inner_executor_type get_inner_executor() const ASIO_NOEXCEPT
+  {
+    return executor_;
+  }
+
+  /// Obtain the underlying execution context.
+  execution_context& context() ASIO_NOEXCEPT
+  {
+    return executor_.context();
+  }
+
+  /// Inform the executor that it has some outstanding work to do.
+  /**
+   * The executor delegates this call to its underlying executor.
+   */
+  void on_work_started() ASIO_NOEXCEPT
+  {
+    executor_.on_work_started();
+  }
+
+  /// Inform the executor that some work is no longer outstanding.
+  /**
+   * The executor delegates this call to its underlying executor.
+   */
+  void on_work_finished() ASIO_NOEXCEPT
+  {
+    executor_.on_work_finished();
+  }
+
+  /// Request the executor to invoke the given function object.
+  /**
+   * The function object is executed inside this function only if called
+   * from a function that is itself running through these queues, and no
+   * queued function is at least as urgent. Otherwise it is queued, as by
+   * post(). In particular, completion handlers of operations on the
+   * underlying execution context are always queued.
+   *
+   * @param f The function object to be called. The executor will make
+   * a copy of the handler object as required. The function signature of the
+   * function object must be: @code void function(); @endcode
+   *
+   * @param a An allocator that may be used by the executor to allocate the
+   * internal storage needed for function invocation.
+   */
+  template <typename Function, typename Allocator>
+  void dispatch(ASIO_MOVE_ARG(Function) f, const Allocator& a)
+  {
+    detail::priority_executor_impl::dispatch(impl_, level_,
+        executor_, ASIO_MOVE_CAST(Function)(f), a);
+  }
+
+  /// Request the executor to invoke the given function object.
+  /**
+   * The function object is queued at this executor's level and will never be
+   * executed inside this function. It will be run by the underlying
+   * executor, after any more urgent functions.
+   *
+   * @param f The function object to be called. The executor will make
+   * a copy of the handler object as required. The function signature of the
+   * function object must be: @code void function(); @endcode
+   *
+   * @param a An allocator that may be used by the executor to allocate the
+   * internal storage needed for function invocation.
+   */
+  template <typename Function, typename Allocator>
+  void post(ASIO_MOVE_ARG(Function) f, const Allocator& a)
+  {
+    detail::priority_executor_impl::post(impl_, level_,
+        executor_, ASIO_MOVE_CAST(Function)(f), a);
+  }
+
+  /// Request the executor to invoke the given function object.
+  /**
+   * The function object is queued at this executor's level and will never be
+   * executed inside this function. It will be run by the underlying
+   * executor's defer function, after any more urgent functions.
+   *
+   * @param f The function object to be called. The executor will make
+   * a copy of the handler object as required. The function signature of the
+   * function object must be: @code void function(); @endcode
+   *
+   * @param a An allocator that may be used by the executor to allocate the
+   * internal storage needed for function invocation.
+   */
+  template <typename Function, typename Allocator>
+  void defer(ASIO_MOVE_ARG(Function) f, const Allocator& a)
+  {
+    detail::priority_executor_impl::defer(impl_, level_,
+        executor_, ASIO_MOVE_CAST(Function)(f), a);
+  }
+
+  /// Determine whether the executor is running in the current thread.
+  /**
+   * @return @c true if the current thread is executing a function that was
+   * submitted through these queues, at any level. Otherwise returns
+   * @c false.
+   */
+  bool running_in_this_thread() const ASIO_NOEXCEPT
+  {
+    return detail::priority_executor_impl::running_in_this_thread(impl_);
+  }
+
+  /// Compare two executors for equality.
+  /**
+   * Two priority executors are equal if they share the same queues and
+   * submit at the same level.
+   */
+  friend bool operator==(const priority_executor& a,
+      const priority_executor& b) ASIO_NOEXCEPT
+  {
+    return a.impl_ == b.impl_ && a.level_ == b.level_;
+  }
+
+  /// Compare two executors for inequality.
+  /**
+   * Two priority executors are equal if they share the same queues and
+   * submit at the same level.
+   */
+  friend bool operator!=(const priority_executor& a,
+      const priority_executor& b) ASIO_NOEXCEPT
+  {
+    return a.impl_ != b.impl_ || a.level_ != b.level_;
+  }
+
+private:
+  Executor executor_;
+  typedef detail::priority_executor_impl::implementation_type
+    implementation_type;
+  implementation_type impl_;
+  std::size_t level_;
+};
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <typename Executor>
+struct is_executor<priority_executor<Executor> > : true_type {};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_PRIORITY_EXECUTOR_HPP
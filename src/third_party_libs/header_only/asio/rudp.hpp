@@ -0,0 +1,25 @@
+//
+// rudp.hpp
+// ~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_HPP
+#define ASIO_RUDP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/rudp/basic_multiplexer.hpp"
+#include "asio/rudp/basic_stream.hpp"
+#include "asio/rudp/multiplexer.hpp"
+#include "asio/rudp/simulated_network.hpp"
+#include "asio/rudp/stream.hpp"
+#include "asio/rudp/stream_base.hpp"
+
+#endif // ASIO_RUDP_HPP
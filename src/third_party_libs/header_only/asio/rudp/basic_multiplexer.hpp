@@ -0,0 +1,205 @@
+//
+// rudp/basic_multiplexer.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_BASIC_MULTIPLEXER_HPP
+#define ASIO_RUDP_BASIC_MULTIPLEXER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include "asio/async_result.hpp"
+#include "asio/io_service.hpp"
+#include "asio/detail/handler_type_requirements.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/rudp/detail/multiplexer_core.hpp"
+#include "asio/rudp/detail/stream_ops.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+
+template <typename DatagramSocket>
+class basic_stream;
+
+/// Carries reliable stream connections over a single datagram socket.
+/**
+ * The multiplexer owns a datagram socket, normally an asio::ip::udp::socket,
+ * and runs every asio::rudp::basic_stream created on it. Incoming
+ * connections are held in a backlog until accepted with async_accept().
+ *
+ * The multiplexer must be destroyed before the io_service. Destroying it
+ * closes the socket and aborts the operations of every stream on it.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ *
+ * @par Example
+ * @code
+ * asio::rudp::multiplexer mux(io_service,
+ *     asio::ip::udp::endpoint(asio::ip::udp::v4(), 5483));
+ * asio::rudp::stream stream(mux);
+ * mux.async_accept(stream, accept_handler);
+ * @endcode
+ */
+template <typename DatagramSocket>
+class basic_multiplexer
+  : private asio::detail::noncopyable
+{
+public:
+  /// The type of the datagram socket.
+  typedef DatagramSocket next_layer_type;
+
+  /// The endpoint type.
+  typedef typename next_layer_type::endpoint_type endpoint_type;
+
+  /// The type of the executor associated with the object.
+  typedef asio::io_service::executor_type executor_type;
+
+  /// Construct a multiplexer on a new socket.
+  /**
+   * @param arg The argument to be passed to initialise the socket, such as
+   * an io_service.
+   *
+   * @param local_endpoint The endpoint the socket is bound to.
+   *
+   * @param send_buffer_size The data each stream may have written but not
+   * yet had acknowledged.
+   *
+   * @param receive_buffer_size The data each stream may have received but
+   * not yet read. It bounds the sender's window.
+   *
+   * @throws asio::system_error Thrown on failure.
+   */
+  template <typename Arg>
+  basic_multiplexer(Arg& arg, const endpoint_type& local_endpoint,
+      std::size_t send_buffer_size = 262144,
+      std::size_t receive_buffer_size = 262144)
+    : core_(new core_type(arg, local_endpoint,
+          send_buffer_size, receive_buffer_size))
+  {
+    core_->start(core_);
+  }
+
+  /// Destructor.
+  ~basic_multiplexer()
+  {
+    core_->shutdown();
+  }
+
+  /// (Deprecated: Use get_executor().) Get the io_service associated with
+  /// the object.
+  asio::io_service& get_io_service()
+  {
+    return core_->get_io_service();
+  }
+
+  /// Get the executor associated with the object.
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return core_->get_io_service().get_executor();
+  }
+
+  /// Get a reference to the datagram socket.
+  /**
+   * Sending or receiving on the socket directly interferes with the
+   * multiplexer. It is provided for setting options.
+   */
+  next_layer_type& next_layer()
+  {
+    return core_->socket();
+  }
+
+  /// Get the local endpoint of the socket.
+  /**
+   * @throws asio::system_error Thrown on failure.
+   */
+  endpoint_type local_endpoint() const
+  {
+    return core_->socket().local_endpoint();
+  }
+
+  /// Start an asynchronous accept.
+  /**
+   * This function is used to asynchronously accept a new connection into a
+   * stream. The function call always returns immediately.
+   *
+   * Accepted streams use asio::rudp::stream_base::reno until changed with
+   * basic_stream::set_congestion_control().
+   *
+   * @param peer The stream into which the new connection will be accepted.
+   * Ownership of the peer object is retained by the caller, which must
+   * guarantee that it is valid until the handler is called.
+   *
+   * @param handler The handler to be called when the accept operation
+   * completes. Copies will be made of the handler as required. The function
+   * signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error // Result of operation.
+   * ); @endcode
+   */
+  template <typename AcceptHandler>
+  ASIO_INITFN_RESULT_TYPE(AcceptHandler,
+      void (asio::error_code))
+  async_accept(basic_stream<DatagramSocket>& peer,
+      ASIO_MOVE_ARG(AcceptHandler) handler)
+  {
+    // If you get an error on the following line it means that your handler
+    // does not meet the documented type requirements for a AcceptHandler.
+    ASIO_ACCEPT_HANDLER_CHECK(AcceptHandler, handler) type_check;
+
+    async_completion<AcceptHandler,
+      void (asio::error_code)> init(handler);
+
+    typedef detail::stream_accept_op<typename core_type::stream_state,
+      ASIO_HANDLER_TYPE(AcceptHandler, void (asio::error_code))> op;
+    typename op::ptr p = { asio::detail::addressof(init.handler),
+      op::ptr::allocate(init.handler), 0 };
+    p.p = new (p.v) op(peer.state_, init.handler);
+
+    core_->start_accept(core_, p.p);
+    p.v = p.p = 0;
+
+    return init.result.get();
+  }
+
+  /// Cancel outstanding accept operations, which complete with
+  /// asio::error::operation_aborted.
+  /**
+   * @returns The number of operations cancelled.
+   */
+  std::size_t cancel()
+  {
+    return core_->cancel_accept();
+  }
+
+private:
+  friend class basic_stream<DatagramSocket>;
+
+  typedef detail::multiplexer_core<DatagramSocket> core_type;
+  asio::detail::shared_ptr<core_type> core_;
+};
+
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RUDP_BASIC_MULTIPLEXER_HPP
@@ -0,0 +1,362 @@
+//
+// rudp/basic_stream.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_BASIC_STREAM_HPP
+#define ASIO_RUDP_BASIC_STREAM_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include "asio/async_result.hpp"
+#include "asio/error.hpp"
+#include "asio/io_service.hpp"
+#include "asio/detail/handler_type_requirements.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/throw_error.hpp"
+#include "asio/rudp/basic_multiplexer.hpp"
+#include "asio/rudp/detail/stream_ops.hpp"
+#include "asio/rudp/stream_base.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+
+/// A reliable, ordered byte stream carried over a datagram socket.
+/**
+ * Streams share their multiplexer's socket and are told apart by connection
+ * ids, so one UDP port serves any number of peers. Lost datagrams are found
+ * from selective acknowledgements and retransmitted, sends are paced over
+ * the round trip, and the congestion controller is chosen per stream: Reno
+ * for traffic that should compete like TCP, or LEDBAT for background
+ * transfers that should give way to it.
+ *
+ * The class meets the AsyncReadStream and AsyncWriteStream requirements, so
+ * it works with asio::async_read(), asio::async_write() and friends.
+ *
+ * Closing a stream, or destroying it, sends a FIN after any data already
+ * written; the multiplexer keeps the connection until that data has been
+ * delivered or a timeout passes.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ *
+ * @par Example
+ * @code
+ * asio::rudp::stream stream(mux);
+ * stream.set_congestion_control(asio::rudp::stream::ledbat);
+ * stream.async_connect(peer_endpoint, connect_handler);
+ * @endcode
+ */
+template <typename DatagramSocket>
+class basic_stream
+  : public stream_base,
+    private asio::detail::noncopyable
+{
+public:
+  /// The type of the multiplexer streams run on.
+  typedef basic_multiplexer<DatagramSocket> multiplexer_type;
+
+  /// The endpoint type.
+  typedef typename multiplexer_type::endpoint_type endpoint_type;
+
+  /// The type of the executor associated with the object.
+  typedef asio::io_service::executor_type executor_type;
+
+  /// Construct a stream that is not yet connected.
+  /**
+   * @param multiplexer The multiplexer the stream will use. The stream may
+   * outlive it, but its operations then fail.
+   */
+  explicit basic_stream(multiplexer_type& multiplexer)
+    : core_(multiplexer.core_),
+      congestion_control_(reno)
+  {
+  }
+
+  /// Destructor. Closes the stream.
+  ~basic_stream()
+  {
+    close();
+  }
+
+  /// (Deprecated: Use get_executor().) Get the io_service associated with
+  /// the object.
+  asio::io_service& get_io_service()
+  {
+    return core_->get_io_service();
+  }
+
+  /// Get the executor associated with the object.
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return core_->get_io_service().get_executor();
+  }
+
+  /// Determine whether the stream has a connection, or is making one.
+  bool is_open() const
+  {
+    return !!state_;
+  }
+
+  /// Get the remote endpoint.
+  /**
+   * @throws asio::system_error Thrown if the stream is not open.
+   */
+  endpoint_type remote_endpoint() const
+  {
+    if (!state_)
+      asio::detail::throw_error(asio::error::not_connected,
+          "remote_endpoint");
+    return state_->peer_;
+  }
+
+  /// Choose the congestion controller.
+  /**
+   * A stream that is already connected starts again from the initial
+   * window.
+   */
+  void set_congestion_control(congestion_control_type type)
+  {
+    congestion_control_ = type;
+    if (state_)
+      core_->set_congestion_control(state_, type);
+  }
+
+  /// Get the transport counters. All are zero if the stream is not open.
+  stream_base::statistics statistics() const
+  {
+    if (state_)
+      return core_->statistics(state_);
+    return stream_base::statistics();
+  }
+
+  /// Start an asynchronous connect.
+  /**
+   * @param peer_endpoint The endpoint of the remote multiplexer.
+   *
+   * @param handler The handler to be called when the connection is
+   * established or fails. Copies will be made of the handler as required.
+   * The function signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error // Result of operation.
+   * ); @endcode
+   */
+  template <typename ConnectHandler>
+  ASIO_INITFN_RESULT_TYPE(ConnectHandler,
+      void (asio::error_code))
+  async_connect(const endpoint_type& peer_endpoint,
+      ASIO_MOVE_ARG(ConnectHandler) handler)
+  {
+    // If you get an error on the following line it means that your handler
+    // does not meet the documented type requirements for a ConnectHandler.
+    ASIO_CONNECT_HANDLER_CHECK(ConnectHandler, handler) type_check;
+
+    async_completion<ConnectHandler,
+      void (asio::error_code)> init(handler);
+
+    typedef detail::stream_wait_op<ASIO_HANDLER_TYPE(ConnectHandler,
+      void (asio::error_code))> op;
+    typename op::ptr p = { asio::detail::addressof(init.handler),
+      op::ptr::allocate(init.handler), 0 };
+    p.p = new (p.v) op(op::wait_connected, init.handler);
+
+    core_->start_connect(core_, state_, peer_endpoint,
+        congestion_control_, p.p);
+    p.v = p.p = 0;
+
+    return init.result.get();
+  }
+
+  /// Start an asynchronous read.
+  /**
+   * This function is used to asynchronously read data from the stream. The
+   * function call always returns immediately.
+   *
+   * @param buffers One or more buffers into which the data will be read.
+   * Although the buffers object may be copied as necessary, ownership of the
+   * underlying memory blocks is retained by the caller, which must guarantee
+   * that they remain valid until the handler is called.
+   *
+   * @param handler The handler to be called when the read operation
+   * completes. Copies will be made of the handler as required. The function
+   * signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   std::size_t bytes_transferred  // Number of bytes read.
+   * ); @endcode
+   *
+   * @note The read operation may not read all of the requested number of
+   * bytes. Consider using the @ref async_read function if you need to ensure
+   * that the requested amount of data is read before the asynchronous
+   * operation completes.
+   */
+  template <typename MutableBufferSequence, typename ReadHandler>
+  ASIO_INITFN_RESULT_TYPE(ReadHandler,
+      void (asio::error_code, std::size_t))
+  async_read_some(const MutableBufferSequence& buffers,
+      ASIO_MOVE_ARG(ReadHandler) handler)
+  {
+    // If you get an error on the following line it means that your handler
+    // does not meet the documented type requirements for a ReadHandler.
+    ASIO_READ_HANDLER_CHECK(ReadHandler, handler) type_check;
+
+    async_completion<ReadHandler,
+      void (asio::error_code, std::size_t)> init(handler);
+
+    typedef detail::stream_read_op<MutableBufferSequence,
+      ASIO_HANDLER_TYPE(ReadHandler,
+        void (asio::error_code, std::size_t))> op;
+    typename op::ptr p = { asio::detail::addressof(init.handler),
+      op::ptr::allocate(init.handler), 0 };
+    p.p = new (p.v) op(buffers, init.handler);
+
+    core_->start_op(core_, state_, &core_type::stream_state::read_ops_, p.p);
+    p.v = p.p = 0;
+
+    return init.result.get();
+  }
+
+  /// Start an asynchronous write.
+  /**
+   * This function is used to asynchronously write data to the stream. The
+   * function call always returns immediately. It completes once the data is
+   * queued for sending, which may be long before the peer has it.
+   *
+   * @param buffers One or more data buffers to be written to the stream.
+   * Although the buffers object may be copied as necessary, ownership of the
+   * underlying memory blocks is retained by the caller, which must guarantee
+   * that they remain valid until the handler is called.
+   *
+   * @param handler The handler to be called when the write operation
+   * completes. Copies will be made of the handler as required. The function
+   * signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   std::size_t bytes_transferred  // Number of bytes written.
+   * ); @endcode
+   *
+   * @note The write operation may not transmit all of the data to the peer.
+   * Consider using the @ref async_write function if you need to ensure that
+   * all data is written before the asynchronous operation completes.
+   */
+  template <typename ConstBufferSequence, typename WriteHandler>
+  ASIO_INITFN_RESULT_TYPE(WriteHandler,
+      void (asio::error_code, std::size_t))
+  async_write_some(const ConstBufferSequence& buffers,
+      ASIO_MOVE_ARG(WriteHandler) handler)
+  {
+    // If you get an error on the following line it means that your handler
+    // does not meet the documented type requirements for a WriteHandler.
+    ASIO_WRITE_HANDLER_CHECK(WriteHandler, handler) type_check;
+
+    async_completion<WriteHandler,
+      void (asio::error_code, std::size_t)> init(handler);
+
+    typedef detail::stream_write_op<ConstBufferSequence,
+      ASIO_HANDLER_TYPE(WriteHandler,
+        void (asio::error_code, std::size_t))> op;
+    typename op::ptr p = { asio::detail::addressof(init.handler),
+      op::ptr::allocate(init.handler), 0 };
+    p.p = new (p.v) op(buffers, init.handler);
+
+    core_->start_op(core_, state_, &core_type::stream_state::write_ops_, p.p);
+    p.v = p.p = 0;
+
+    return init.result.get();
+  }
+
+  /// Start an asynchronous shutdown of the sending direction.
+  /**
+   * A FIN is sent after the data already written, and the handler is called
+   * once the peer has acknowledged it. Reading may continue until the peer
+   * shuts down its side, which reads report as asio::error::eof.
+   *
+   * @param handler The handler to be called when the shutdown operation
+   * completes. Copies will be made of the handler as required. The function
+   * signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error // Result of operation.
+   * ); @endcode
+   */
+  template <typename ShutdownHandler>
+  ASIO_INITFN_RESULT_TYPE(ShutdownHandler,
+      void (asio::error_code))
+  async_shutdown(ASIO_MOVE_ARG(ShutdownHandler) handler)
+  {
+    // If you get an error on the following line it means that your handler
+    // does not meet the documented type requirements for a ShutdownHandler.
+    ASIO_SHUTDOWN_HANDLER_CHECK(ShutdownHandler, handler) type_check;
+
+    async_completion<ShutdownHandler,
+      void (asio::error_code)> init(handler);
+
+    typedef detail::stream_wait_op<ASIO_HANDLER_TYPE(ShutdownHandler,
+      void (asio::error_code))> op;
+    typename op::ptr p = { asio::detail::addressof(init.handler),
+      op::ptr::allocate(init.handler), 0 };
+    p.p = new (p.v) op(op::wait_shutdown, init.handler);
+
+    core_->start_shutdown(core_, state_, p.p);
+    p.v = p.p = 0;
+
+    return init.result.get();
+  }
+
+  /// Cancel outstanding operations, which complete with
+  /// asio::error::operation_aborted.
+  /**
+   * @returns The number of operations cancelled.
+   */
+  std::size_t cancel()
+  {
+    return state_ ? core_->cancel(state_) : 0;
+  }
+
+  /// Close the stream.
+  /**
+   * Outstanding operations complete with asio::error::operation_aborted.
+   * Data already written is still delivered, in the background, unless the
+   * connection was not yet established.
+   */
+  void close()
+  {
+    if (state_)
+    {
+      core_->close_stream(core_, state_);
+      state_.reset();
+    }
+  }
+
+private:
+  friend class basic_multiplexer<DatagramSocket>;
+
+  typedef typename multiplexer_type::core_type core_type;
+  asio::detail::shared_ptr<core_type> core_;
+  asio::detail::shared_ptr<typename core_type::stream_state> state_;
+  congestion_control_type congestion_control_;
+};
+
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RUDP_BASIC_STREAM_HPP
@@ -0,0 +1,99 @@
+//
+// rudp/detail/byte_ring.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_BYTE_RING_HPP
+#define ASIO_RUDP_DETAIL_BYTE_RING_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+// A fixed-capacity FIFO of bytes.
+class byte_ring
+{
+public:
+  explicit byte_ring(std::size_t capacity)
+    : data_(capacity ? capacity : 1),
+      head_(0),
+      size_(0)
+  {
+  }
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  std::size_t capacity() const
+  {
+    return data_.size();
+  }
+
+  std::size_t space() const
+  {
+    return data_.size() - size_;
+  }
+
+  // Append up to n bytes. Returns the number appended.
+  std::size_t push(const void* p, std::size_t n)
+  {
+    n = (std::min)(n, space());
+    const unsigned char* in = static_cast<const unsigned char*>(p);
+    std::size_t tail = (head_ + size_) % data_.size();
+    std::size_t first = (std::min)(n, data_.size() - tail);
+    std::memcpy(&data_[tail], in, first);
+    std::memcpy(&data_[0], in + first, n - first);
+    size_ += n;
+    return n;
+  }
+
+  // Copy n bytes starting pos bytes from the front, without removing them.
+  void peek(std::size_t pos, void* p, std::size_t n) const
+  {
+    unsigned char* out = static_cast<unsigned char*>(p);
+    std::size_t start = (head_ + pos) % data_.size();
+    std::size_t first = (std::min)(n, data_.size() - start);
+    std::memcpy(out, &data_[start], first);
+    std::memcpy(out + first, &data_[0], n - first);
+  }
+
+  // Remove n bytes from the front.
+  void consume(std::size_t n)
+  {
+    n = (std::min)(n, size_);
+    head_ = (head_ + n) % data_.size();
+    size_ -= n;
+  }
+
+private:
+  std::vector<unsigned char> data_;
+  std::size_t head_;
+  std::size_t size_;
+};
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_DETAIL_BYTE_RING_HPP
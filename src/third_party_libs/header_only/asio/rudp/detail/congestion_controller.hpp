@@ -0,0 +1,110 @@
+//
+// rudp/detail/congestion_controller.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_CONGESTION_CONTROLLER_HPP
+#define ASIO_RUDP_DETAIL_CONGESTION_CONTROLLER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/detail/cstdint.hpp"
+#include "asio/rudp/stream_base.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+// Decides how many bytes a connection may have in flight. Times are in
+// microseconds.
+//
+// Reno follows RFC 5681. LEDBAT follows RFC 6817 with the slow start of
+// LEDBAT++: it grows the window in proportion to how far the queueing delay,
+// measured as one-way delay above the smallest seen, is below a 25ms target,
+// and shrinks it as the delay rises above.
+class congestion_controller
+{
+public:
+  ASIO_DECL congestion_controller(stream_base::congestion_control_type type,
+      std::size_t mss);
+
+  // The congestion window, in bytes.
+  std::size_t window() const
+  {
+    return static_cast<std::size_t>(cwnd_);
+  }
+
+  // Whether the window is still growing exponentially.
+  bool in_slow_start() const
+  {
+    return cwnd_ < ssthresh_;
+  }
+
+  // Newly delivered data has been acknowledged. The one-way delay is only
+  // meaningful relative to other samples from the same peer.
+  ASIO_DECL void on_ack(std::size_t bytes_acked, std::size_t bytes_in_flight,
+      uint32_t one_way_delay, uint64_t now);
+
+  // Loss was detected, once per round trip at most.
+  ASIO_DECL void on_congestion_event();
+
+  // The retransmission timer expired.
+  ASIO_DECL void on_timeout();
+
+private:
+  // Track the base and current one-way delay.
+  ASIO_DECL void add_delay_sample(uint32_t one_way_delay, uint64_t now);
+
+  // The current one-way delay above the base, in microseconds.
+  ASIO_DECL int64_t queueing_delay() const;
+
+  enum
+  {
+    // Base delay history: the minimum over each of the last ten minutes.
+    base_history = 10,
+
+    // Current delay filter: the minimum of the last few samples.
+    current_history = 4
+  };
+
+  // The queueing delay LEDBAT aims for, in microseconds.
+  static const int64_t target_delay = 25000;
+
+  stream_base::congestion_control_type type_;
+  double mss_;
+  double cwnd_;
+  double ssthresh_;
+
+  // Delays are kept relative to the first sample, since the two hosts'
+  // clocks are unrelated.
+  bool have_delay_;
+  uint32_t delay_origin_;
+  int64_t base_delays_[base_history];
+  uint64_t base_minute_;
+  std::size_t base_count_;
+  int64_t current_delays_[current_history];
+  std::size_t current_count_;
+};
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/rudp/detail/impl/congestion_controller.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_RUDP_DETAIL_CONGESTION_CONTROLLER_HPP
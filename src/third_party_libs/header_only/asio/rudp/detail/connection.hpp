@@ -0,0 +1,321 @@
+//
+// rudp/detail/connection.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_CONNECTION_HPP
+#define ASIO_RUDP_DETAIL_CONNECTION_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <vector>
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/error_code.hpp"
+#include "asio/rudp/detail/byte_ring.hpp"
+#include "asio/rudp/detail/congestion_controller.hpp"
+#include "asio/rudp/detail/packet.hpp"
+#include "asio/rudp/stream_base.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+// The protocol state of one connection, without any I/O. The owner feeds it
+// datagrams and timer expiries, and sends whatever poll_send() produces.
+// Times are in microseconds on a monotonic clock.
+//
+// Data is numbered by stream offset, and the FIN occupies one offset after
+// the last byte. The receiver acknowledges the next offset it expects and
+// reports up to max_sack_blocks ranges received beyond it, the newest first.
+// ACKs echo the latest DATA packet's timestamp for RTT. The sender declares
+// a segment lost once a segment sent after it has been delivered and a quarter
+// of the minimum RTT has passed (RACK), or when the retransmission timer
+// expires, and retransmits lost segments ahead of new data. Sends are paced at
+// a little over the congestion window per round trip.
+class connection
+  : private asio::detail::noncopyable
+{
+public:
+  enum state_type
+  {
+    // Waiting for the peer to answer our SYN.
+    syn_sent,
+
+    // Data may flow in both directions.
+    established,
+
+    // Finished, either gracefully or with an error.
+    closed
+  };
+
+  ASIO_DECL connection(uint32_t local_id,
+      stream_base::congestion_control_type congestion_control,
+      std::size_t send_buffer_size, std::size_t receive_buffer_size);
+
+  uint32_t local_id() const
+  {
+    return local_id_;
+  }
+
+  uint32_t peer_id() const
+  {
+    return peer_id_;
+  }
+
+  state_type state() const
+  {
+    return state_;
+  }
+
+  // The error that closed the connection, if any.
+  const asio::error_code& error() const
+  {
+    return error_;
+  }
+
+  // Start an active open.
+  ASIO_DECL void connect(uint64_t now);
+
+  // Answer a peer's SYN.
+  ASIO_DECL void accept(uint32_t peer_id, uint64_t now);
+
+  // Process a datagram addressed to this connection.
+  ASIO_DECL void on_packet(const packet_header& h,
+      const unsigned char* body, std::size_t n, uint64_t now);
+
+  // Process timer expiries.
+  ASIO_DECL void on_timer(uint64_t now);
+
+  // Write the next datagram that may be sent now into buf, which must hold
+  // max_datagram_size bytes. Returns its size, or 0 if there is none.
+  ASIO_DECL std::size_t poll_send(unsigned char* buf, uint64_t now);
+
+  // When poll_send() or on_timer() next has something to do, or the maximum
+  // value if nothing is scheduled. Returns now or earlier if that is now.
+  ASIO_DECL uint64_t next_event(uint64_t now) const;
+
+  // Queue up to n bytes for sending. Returns the number queued.
+  ASIO_DECL std::size_t write(const void* data, std::size_t n);
+
+  // Take up to n received bytes. Returns the number taken.
+  ASIO_DECL std::size_t read(void* data, std::size_t n, uint64_t now);
+
+  // Whether read() would return data, or there will never be more.
+  bool readable() const
+  {
+    return receive_buffer_.size() > 0 || peer_finished_ || state_ == closed;
+  }
+
+  // Whether every byte the peer sent has been read.
+  bool at_eof() const
+  {
+    return peer_finished_ && receive_buffer_.size() == 0;
+  }
+
+  // Whether write() would accept data.
+  bool writable() const
+  {
+    return state_ == established && !fin_requested_
+      && send_buffer_.space() > 0;
+  }
+
+  // Send a FIN once all queued data has been sent.
+  ASIO_DECL void shutdown();
+
+  // Whether shutdown() has been called.
+  bool shutdown_requested() const
+  {
+    return fin_requested_;
+  }
+
+  // Whether the peer has acknowledged our FIN.
+  bool shutdown_complete() const
+  {
+    return fin_acked_;
+  }
+
+  // Whether both directions have been shut down gracefully.
+  bool finished() const
+  {
+    return fin_acked_ && peer_finished_;
+  }
+
+  // Close with an error, telling the peer if it can be reached.
+  ASIO_DECL void abort(const asio::error_code& ec);
+
+  // Switch congestion controllers, starting again from the initial window.
+  ASIO_DECL void set_congestion_control(
+      stream_base::congestion_control_type type);
+
+  ASIO_DECL stream_base::statistics statistics() const;
+
+private:
+  enum
+  {
+    // The longest an ACK is delayed, and the most packets it may cover.
+    max_ack_delay = 5000,
+    ack_every = 2,
+
+    // Retransmission timeout bounds.
+    initial_rto = 500000,
+    min_rto = 200000,
+    max_rto = 60000000,
+    max_timeouts = 10,
+
+    // SYN retries, doubling from the first interval.
+    syn_interval = 250000,
+    max_syn_attempts = 7,
+
+    // How far behind schedule pacing may fall before it stops catching up.
+    pacing_burst = 2000
+  };
+
+  struct segment
+  {
+    uint64_t offset;
+    uint32_t length;
+    bool fin;
+    bool lost;
+    bool sacked;
+    unsigned char transmissions;
+    uint64_t sent_time;
+
+    // The offset after the segment, counting the FIN.
+    uint64_t end() const
+    {
+      return offset + length + (fin ? 1 : 0);
+    }
+  };
+
+  // Close with an error without telling the peer.
+  ASIO_DECL void fail(const asio::error_code& ec);
+
+  // Handle DATA and ACK packets.
+  ASIO_DECL void on_data(const packet_header& h,
+      const unsigned char* body, std::size_t n, uint64_t now);
+  ASIO_DECL void on_ack(const packet_header& h,
+      const unsigned char* body, std::size_t n, uint64_t now);
+
+  // Account for a segment being delivered, by cumulative ACK or SACK.
+  ASIO_DECL void deliver(segment& s, std::size_t& bytes, uint64_t& rack);
+
+  // Feed an RTT sample into the estimators.
+  ASIO_DECL void update_rtt(uint64_t sample, uint64_t ack_delay);
+
+  // The retransmission timeout.
+  ASIO_DECL uint64_t rto() const;
+
+  // Append in-order data to the receive buffer and pull in any out-of-order
+  // data it makes contiguous.
+  ASIO_DECL void receive_in_order(const unsigned char* data,
+      uint64_t offset, std::size_t length);
+
+  // Write the packet header for a packet type.
+  ASIO_DECL std::size_t write_header(unsigned char* buf,
+      unsigned char type, unsigned char flags, unsigned char sack_count,
+      uint64_t now) const;
+
+  // Build an ACK. Returns its size.
+  ASIO_DECL std::size_t write_ack(unsigned char* buf, uint64_t now);
+
+  // Build a DATA packet if the windows and pacing allow. Returns its size.
+  ASIO_DECL std::size_t write_data(unsigned char* buf, uint64_t now);
+
+  // The next segment to send: a lost one, or fresh filled in with new data,
+  // or 0 if there is none.
+  ASIO_DECL segment* next_segment(segment& fresh);
+
+  // Whether the windows allow sending length more bytes.
+  ASIO_DECL bool window_allows(std::size_t length) const;
+
+  uint32_t local_id_;
+  uint32_t peer_id_;
+  state_type state_;
+  asio::error_code error_;
+
+  // Handshake.
+  bool syn_pending_;
+  bool syn_ack_pending_;
+  unsigned syn_attempts_;
+  uint64_t syn_retry_time_;
+  bool rst_pending_;
+
+  // Send side. Offsets below send_una_ are acknowledged, send_next_ is the
+  // next new byte to send, and send_end_ follows the last byte written.
+  byte_ring send_buffer_;
+  uint64_t send_una_;
+  uint64_t send_next_;
+  uint64_t send_end_;
+  std::deque<segment> segments_;
+  std::size_t bytes_in_flight_;
+  std::size_t lost_count_;
+  std::size_t peer_window_;
+  bool fin_requested_;
+  bool fin_sent_;
+  bool fin_acked_;
+  bool probe_;
+
+  // Loss recovery and timers. Losses below the recovery point belong to a
+  // congestion event already responded to. The window does not grow in fast
+  // recovery.
+  bool in_recovery_;
+  uint64_t recovery_point_;
+  uint64_t rack_sent_time_;
+  uint64_t rto_deadline_;
+  unsigned rto_backoff_;
+  unsigned consecutive_timeouts_;
+  uint64_t next_send_time_;
+
+  // RTT estimation.
+  bool have_rtt_;
+  uint64_t smoothed_rtt_;
+  uint64_t rtt_variance_;
+  uint64_t min_rtt_;
+
+  congestion_controller congestion_;
+
+  // Receive side. Offsets below receive_next_ have been received in order.
+  byte_ring receive_buffer_;
+  uint64_t receive_next_;
+  std::map<uint64_t, std::vector<unsigned char> > out_of_order_;
+  uint64_t peer_fin_offset_;
+  bool peer_finished_;
+
+  // Acknowledgement state.
+  bool ack_pending_;
+  uint64_t ack_due_;
+  unsigned unacked_packets_;
+  uint64_t last_data_time_;
+  uint32_t last_timestamp_;
+  uint32_t last_one_way_delay_;
+  uint64_t last_out_of_order_;
+  std::size_t advertised_window_;
+
+  stream_base::statistics stats_;
+};
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/rudp/detail/impl/connection.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_RUDP_DETAIL_CONNECTION_HPP
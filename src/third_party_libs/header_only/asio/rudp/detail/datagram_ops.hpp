@@ -0,0 +1,201 @@
+//
+// rudp/detail/datagram_ops.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_DATAGRAM_OPS_HPP
+#define ASIO_RUDP_DETAIL_DATAGRAM_OPS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <algorithm>
+#include <cstring>
+#include "asio/buffer.hpp"
+#include "asio/ip/udp.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/fenced_block.hpp"
+#include "asio/detail/handler_alloc_helpers.hpp"
+#include "asio/detail/handler_invoke_helpers.hpp"
+#include "asio/detail/handler_work.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/operation.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+// A send or receive on a simulated socket.
+class datagram_op
+  : public asio::detail::operation
+{
+public:
+  // The error code to be passed to the completion handler.
+  asio::error_code ec_;
+
+  // The number of bytes transferred, to be passed to the completion handler.
+  std::size_t bytes_transferred_;
+
+  // Copy a datagram into a receive operation's buffers.
+  void deliver(const unsigned char* data, std::size_t n,
+      const asio::ip::udp::endpoint& sender)
+  {
+    deliver_func_(this, data, n, sender);
+  }
+
+protected:
+  typedef void (*deliver_func_type)(datagram_op*,
+      const unsigned char*, std::size_t, const asio::ip::udp::endpoint&);
+
+  datagram_op(deliver_func_type deliver_func, func_type complete_func)
+    : asio::detail::operation(complete_func),
+      bytes_transferred_(0),
+      deliver_func_(deliver_func)
+  {
+  }
+
+private:
+  deliver_func_type deliver_func_;
+};
+
+template <typename MutableBufferSequence>
+class datagram_receive_op_base : public datagram_op
+{
+public:
+  datagram_receive_op_base(const MutableBufferSequence& buffers,
+      asio::ip::udp::endpoint& sender, func_type complete_func)
+    : datagram_op(&datagram_receive_op_base::do_deliver, complete_func),
+      buffers_(buffers),
+      sender_(sender)
+  {
+  }
+
+  // Datagrams larger than the buffers are truncated, as with a real socket
+  // on a POSIX system.
+  static void do_deliver(datagram_op* base, const unsigned char* data,
+      std::size_t n, const asio::ip::udp::endpoint& sender)
+  {
+    datagram_receive_op_base* o(static_cast<datagram_receive_op_base*>(base));
+
+    typename MutableBufferSequence::const_iterator iter
+      = o->buffers_.begin();
+    typename MutableBufferSequence::const_iterator end = o->buffers_.end();
+    for (; iter != end && n > 0; ++iter)
+    {
+      asio::mutable_buffer buffer(*iter);
+      std::size_t size = (std::min)(n, asio::buffer_size(buffer));
+      std::memcpy(asio::buffer_cast<void*>(buffer), data, size);
+      data += size;
+      n -= size;
+      o->bytes_transferred_ += size;
+    }
+    o->sender_ = sender;
+  }
+
+private:
+  MutableBufferSequence buffers_;
+  asio::ip::udp::endpoint& sender_;
+};
+
+template <typename MutableBufferSequence, typename Handler>
+class datagram_receive_op
+  : public datagram_receive_op_base<MutableBufferSequence>
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(datagram_receive_op);
+
+  datagram_receive_op(const MutableBufferSequence& buffers,
+      asio::ip::udp::endpoint& sender, Handler& handler)
+    : datagram_receive_op_base<MutableBufferSequence>(
+        buffers, sender, &datagram_receive_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler))
+  {
+    asio::detail::handler_work<Handler>::start(handler_);
+  }
+
+  static void do_complete(void* owner, asio::detail::operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    datagram_receive_op* o(static_cast<datagram_receive_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    asio::detail::handler_work<Handler> w(o->handler_);
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    asio::detail::binder2<Handler, asio::error_code, std::size_t>
+      handler(o->handler_, o->ec_, o->bytes_transferred_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      asio::detail::fenced_block b(asio::detail::fenced_block::half);
+      w.complete(handler, handler.handler_);
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+// Sends are handed to the network at once, so only the completion remains.
+template <typename Handler>
+class datagram_send_op : public datagram_op
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(datagram_send_op);
+
+  datagram_send_op(Handler& handler)
+    : datagram_op(0, &datagram_send_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler))
+  {
+    asio::detail::handler_work<Handler>::start(handler_);
+  }
+
+  static void do_complete(void* owner, asio::detail::operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    datagram_send_op* o(static_cast<datagram_send_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    asio::detail::handler_work<Handler> w(o->handler_);
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    asio::detail::binder2<Handler, asio::error_code, std::size_t>
+      handler(o->handler_, o->ec_, o->bytes_transferred_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      asio::detail::fenced_block b(asio::detail::fenced_block::half);
+      w.complete(handler, handler.handler_);
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_DETAIL_DATAGRAM_OPS_HPP
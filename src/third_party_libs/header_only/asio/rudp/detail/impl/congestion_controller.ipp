@@ -0,0 +1,151 @@
+//
+// rudp/detail/impl/congestion_controller.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_IMPL_CONGESTION_CONTROLLER_IPP
+#define ASIO_RUDP_DETAIL_IMPL_CONGESTION_CONTROLLER_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <algorithm>
+#include <limits>
+#include "asio/rudp/detail/congestion_controller.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+congestion_controller::congestion_controller(
+    stream_base::congestion_control_type type, std::size_t mss)
+  : type_(type),
+    mss_(static_cast<double>(mss)),
+    cwnd_(10.0 * mss),
+    ssthresh_((std::numeric_limits<double>::max)()),
+    have_delay_(false),
+    delay_origin_(0),
+    base_minute_(0),
+    base_count_(0),
+    current_count_(0)
+{
+}
+
+void congestion_controller::on_ack(std::size_t bytes_acked,
+    std::size_t bytes_in_flight, uint32_t one_way_delay, uint64_t now)
+{
+  double acked = static_cast<double>(bytes_acked);
+
+  if (type_ == stream_base::reno)
+  {
+    if (cwnd_ < ssthresh_)
+      cwnd_ += acked;
+    else
+      cwnd_ += mss_ * acked / cwnd_;
+    return;
+  }
+
+  add_delay_sample(one_way_delay, now);
+  double queueing = static_cast<double>(queueing_delay());
+  double target = static_cast<double>(target_delay);
+
+  if (cwnd_ < ssthresh_)
+  {
+    // Leave slow start before the queue reaches the target.
+    if (queueing > 0.75 * target)
+      ssthresh_ = cwnd_;
+    else
+    {
+      cwnd_ += acked;
+      return;
+    }
+  }
+
+  double previous = cwnd_;
+  double off_target = (target - queueing) / target;
+  cwnd_ += off_target * acked * mss_ / cwnd_;
+
+  // Do not grow a window that is not being used.
+  double in_use = static_cast<double>(bytes_in_flight) + mss_;
+  if (cwnd_ > previous)
+    cwnd_ = (std::min)(cwnd_, (std::max)(previous, in_use));
+  cwnd_ = (std::max)(cwnd_, 2.0 * mss_);
+}
+
+void congestion_controller::on_congestion_event()
+{
+  ssthresh_ = (std::max)(cwnd_ / 2, 2.0 * mss_);
+  cwnd_ = ssthresh_;
+}
+
+void congestion_controller::on_timeout()
+{
+  ssthresh_ = (std::max)(cwnd_ / 2, 2.0 * mss_);
+  cwnd_ = 2.0 * mss_;
+}
+
+void congestion_controller::add_delay_sample(
+    uint32_t one_way_delay, uint64_t now)
+{
+  if (!have_delay_)
+  {
+    have_delay_ = true;
+    delay_origin_ = one_way_delay;
+  }
+  int64_t delay = static_cast<int32_t>(one_way_delay - delay_origin_);
+
+  uint64_t minute = now / 60000000;
+  if (base_count_ == 0)
+  {
+    base_delays_[0] = delay;
+    base_count_ = 1;
+    base_minute_ = minute;
+  }
+  else if (minute != base_minute_)
+  {
+    if (base_count_ == base_history)
+    {
+      std::copy(base_delays_ + 1, base_delays_ + base_history, base_delays_);
+      --base_count_;
+    }
+    base_delays_[base_count_++] = delay;
+    base_minute_ = minute;
+  }
+  else if (delay < base_delays_[base_count_ - 1])
+    base_delays_[base_count_ - 1] = delay;
+
+  if (current_count_ == current_history)
+  {
+    std::copy(current_delays_ + 1,
+        current_delays_ + current_history, current_delays_);
+    --current_count_;
+  }
+  current_delays_[current_count_++] = delay;
+}
+
+int64_t congestion_controller::queueing_delay() const
+{
+  if (base_count_ == 0 || current_count_ == 0)
+    return 0;
+  int64_t base = *std::min_element(base_delays_, base_delays_ + base_count_);
+  int64_t current = *std::min_element(
+      current_delays_, current_delays_ + current_count_);
+  return current > base ? current - base : 0;
+}
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_DETAIL_IMPL_CONGESTION_CONTROLLER_IPP
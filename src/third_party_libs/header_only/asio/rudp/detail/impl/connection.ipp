@@ -0,0 +1,717 @@
+//
+// rudp/detail/impl/connection.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_IMPL_CONNECTION_IPP
+#define ASIO_RUDP_DETAIL_IMPL_CONNECTION_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <algorithm>
+#include <limits>
+#include "asio/error.hpp"
+#include "asio/rudp/detail/connection.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+connection::connection(uint32_t local_id,
+    stream_base::congestion_control_type congestion_control,
+    std::size_t send_buffer_size, std::size_t receive_buffer_size)
+  : local_id_(local_id),
+    peer_id_(0),
+    state_(syn_sent),
+    error_(),
+    syn_pending_(false),
+    syn_ack_pending_(false),
+    syn_attempts_(0),
+    syn_retry_time_(0),
+    rst_pending_(false),
+    send_buffer_(send_buffer_size),
+    send_una_(0),
+    send_next_(0),
+    send_end_(0),
+    bytes_in_flight_(0),
+    lost_count_(0),
+    peer_window_(65536),
+    fin_requested_(false),
+    fin_sent_(false),
+    fin_acked_(false),
+    probe_(false),
+    in_recovery_(false),
+    recovery_point_(0),
+    rack_sent_time_(0),
+    rto_deadline_(0),
+    rto_backoff_(1),
+    consecutive_timeouts_(0),
+    next_send_time_(0),
+    have_rtt_(false),
+    smoothed_rtt_(0),
+    rtt_variance_(0),
+    min_rtt_(0),
+    congestion_(congestion_control, max_segment_size),
+    receive_buffer_(receive_buffer_size),
+    receive_next_(0),
+    out_of_order_(),
+    peer_fin_offset_((std::numeric_limits<uint64_t>::max)()),
+    peer_finished_(false),
+    ack_pending_(false),
+    ack_due_(0),
+    unacked_packets_(0),
+    last_data_time_(0),
+    last_timestamp_(0),
+    last_one_way_delay_(0),
+    last_out_of_order_(0),
+    advertised_window_(0)
+{
+  stats_.smoothed_rtt = 0;
+  stats_.min_rtt = 0;
+  stats_.congestion_window = 0;
+  stats_.bytes_sent = 0;
+  stats_.bytes_retransmitted = 0;
+  stats_.timeouts = 0;
+}
+
+void connection::connect(uint64_t now)
+{
+  state_ = syn_sent;
+  syn_pending_ = true;
+  syn_attempts_ = 1;
+  syn_retry_time_ = now + syn_interval;
+}
+
+void connection::accept(uint32_t peer_id, uint64_t now)
+{
+  (void)now;
+  peer_id_ = peer_id;
+  state_ = established;
+  syn_ack_pending_ = true;
+}
+
+void connection::on_packet(const packet_header& h,
+    const unsigned char* body, std::size_t n, uint64_t now)
+{
+  if (state_ == closed)
+    return;
+
+  switch (h.type)
+  {
+  case packet_rst:
+    fail(asio::error::connection_reset);
+    return;
+  case packet_syn:
+    // Our SYN_ACK was lost.
+    if (state_ == established)
+      syn_ack_pending_ = true;
+    return;
+  default:
+    break;
+  }
+
+  // Anything else from the peer completes an active open, even if the
+  // SYN_ACK itself was lost.
+  if (state_ == syn_sent)
+  {
+    peer_id_ = h.source;
+    state_ = established;
+    syn_pending_ = false;
+  }
+
+  if (h.type == packet_data)
+    on_data(h, body, n, now);
+  else if (h.type == packet_ack)
+    on_ack(h, body, n, now);
+}
+
+void connection::on_timer(uint64_t now)
+{
+  if (state_ == syn_sent && now >= syn_retry_time_)
+  {
+    if (syn_attempts_ >= max_syn_attempts)
+    {
+      fail(asio::error::timed_out);
+      return;
+    }
+    syn_pending_ = true;
+    syn_retry_time_ = now + (static_cast<uint64_t>(syn_interval)
+        << syn_attempts_++);
+  }
+
+  if (state_ != established || rto_deadline_ == 0 || now < rto_deadline_)
+    return;
+
+  rto_deadline_ = 0;
+  if (++consecutive_timeouts_ > max_timeouts)
+  {
+    abort(asio::error::timed_out);
+    return;
+  }
+
+  ++stats_.timeouts;
+  rto_backoff_ = (std::min)(rto_backoff_ * 2, 64u);
+
+  if (bytes_in_flight_ == 0 && lost_count_ == 0)
+  {
+    // Nothing outstanding: the peer's window is closed, so probe it.
+    probe_ = true;
+    return;
+  }
+
+  // Everything outstanding is presumed lost.
+  for (std::deque<segment>::iterator i = segments_.begin();
+      i != segments_.end(); ++i)
+  {
+    if (!i->sacked && !i->lost)
+    {
+      i->lost = true;
+      ++lost_count_;
+    }
+  }
+  bytes_in_flight_ = 0;
+  congestion_.on_timeout();
+  in_recovery_ = false;
+  recovery_point_ = send_next_ + (fin_sent_ ? 1 : 0);
+}
+
+std::size_t connection::poll_send(unsigned char* buf, uint64_t now)
+{
+  if (rst_pending_)
+  {
+    rst_pending_ = false;
+    return write_header(buf, packet_rst, 0, 0, now);
+  }
+
+  if (state_ == closed)
+    return 0;
+
+  if (syn_pending_)
+  {
+    syn_pending_ = false;
+    return write_header(buf, packet_syn, 0, 0, now);
+  }
+
+  if (syn_ack_pending_)
+  {
+    syn_ack_pending_ = false;
+    return write_header(buf, packet_syn_ack, 0, 0, now);
+  }
+
+  if (state_ != established)
+    return 0;
+
+  if (ack_pending_ || (ack_due_ != 0 && now >= ack_due_))
+    return write_ack(buf, now);
+
+  return write_data(buf, now);
+}
+
+uint64_t connection::next_event(uint64_t now) const
+{
+  uint64_t never = (std::numeric_limits<uint64_t>::max)();
+
+  if (rst_pending_)
+    return now;
+  if (state_ == closed)
+    return never;
+  if (syn_pending_ || syn_ack_pending_)
+    return now;
+  if (state_ == syn_sent)
+    return syn_retry_time_;
+
+  uint64_t t = never;
+  if (ack_pending_)
+    return now;
+  if (ack_due_ != 0)
+    t = ack_due_;
+  if (rto_deadline_ != 0)
+    t = (std::min)(t, rto_deadline_);
+
+  // Pacing only matters when there is something the windows allow.
+  bool has_data = lost_count_ > 0 || send_next_ < send_end_
+    || (fin_requested_ && !fin_sent_);
+  if (has_data && (probe_ || window_allows(max_segment_size)
+        || (lost_count_ == 0 && window_allows(send_end_ - send_next_))))
+    t = (std::min)(t, (std::max)(now, next_send_time_));
+
+  return t;
+}
+
+std::size_t connection::write(const void* data, std::size_t n)
+{
+  if (!writable())
+    return 0;
+  n = send_buffer_.push(data, n);
+  send_end_ += n;
+  return n;
+}
+
+std::size_t connection::read(void* data, std::size_t n, uint64_t now)
+{
+  (void)now;
+  n = (std::min)(n, receive_buffer_.size());
+  receive_buffer_.peek(0, data, n);
+  receive_buffer_.consume(n);
+
+  // Reopen a window the sender may be waiting on.
+  if (n > 0 && state_ == established && !peer_finished_
+      && advertised_window_ < 2 * max_segment_size
+      && receive_buffer_.space() >= receive_buffer_.capacity() / 4)
+    ack_pending_ = true;
+
+  return n;
+}
+
+void connection::shutdown()
+{
+  fin_requested_ = true;
+}
+
+void connection::abort(const asio::error_code& ec)
+{
+  if (state_ != closed && peer_id_ != 0)
+    rst_pending_ = true;
+  fail(ec);
+}
+
+void connection::set_congestion_control(
+    stream_base::congestion_control_type type)
+{
+  congestion_ = congestion_controller(type, max_segment_size);
+}
+
+stream_base::statistics connection::statistics() const
+{
+  stream_base::statistics s = stats_;
+  s.smoothed_rtt = static_cast<std::size_t>(smoothed_rtt_);
+  s.min_rtt = static_cast<std::size_t>(min_rtt_);
+  s.congestion_window = congestion_.window();
+  return s;
+}
+
+void connection::fail(const asio::error_code& ec)
+{
+  if (state_ == closed)
+    return;
+  state_ = closed;
+  error_ = ec;
+  syn_pending_ = false;
+  syn_ack_pending_ = false;
+  ack_pending_ = false;
+  ack_due_ = 0;
+  rto_deadline_ = 0;
+}
+
+void connection::on_data(const packet_header& h,
+    const unsigned char* body, std::size_t n, uint64_t now)
+{
+  uint64_t offset = decode_uint64(body);
+  const unsigned char* data = body + 8;
+  std::size_t length = n - 8;
+
+  last_data_time_ = now;
+  last_timestamp_ = h.timestamp;
+  last_one_way_delay_ = static_cast<uint32_t>(now) - h.timestamp;
+
+  if (h.flags & flag_fin)
+    peer_fin_offset_ = offset + length;
+
+  // Only accept what fits in the receive buffer.
+  uint64_t limit = receive_next_ + receive_buffer_.space();
+  if (offset + length > limit)
+    length = offset < limit ? static_cast<std::size_t>(limit - offset) : 0;
+
+  uint64_t previous_next = receive_next_;
+  bool in_order = offset <= receive_next_;
+  if (in_order && offset + length > receive_next_)
+    receive_in_order(data, offset, length);
+  else if (!in_order && length > 0)
+  {
+    std::vector<unsigned char>& stored = out_of_order_[offset];
+    if (stored.size() < length)
+      stored.assign(data, data + length);
+    last_out_of_order_ = offset;
+  }
+
+  if (!peer_finished_ && receive_next_ == peer_fin_offset_)
+  {
+    peer_finished_ = true;
+    receive_next_ += 1;
+  }
+
+  // Acknowledge at once anything unusual, so the sender learns of holes.
+  if (receive_next_ == previous_next || !out_of_order_.empty()
+      || peer_finished_ || ++unacked_packets_ >= ack_every)
+    ack_pending_ = true;
+  else if (ack_due_ == 0)
+    ack_due_ = now + max_ack_delay;
+}
+
+void connection::receive_in_order(const unsigned char* data,
+    uint64_t offset, std::size_t length)
+{
+  std::size_t skip = static_cast<std::size_t>(receive_next_ - offset);
+  receive_next_ += receive_buffer_.push(data + skip, length - skip);
+
+  while (!out_of_order_.empty())
+  {
+    std::map<uint64_t, std::vector<unsigned char> >::iterator i
+      = out_of_order_.begin();
+    if (i->first > receive_next_)
+      break;
+    uint64_t end = i->first + i->second.size();
+    if (end > receive_next_)
+    {
+      std::size_t s = static_cast<std::size_t>(receive_next_ - i->first);
+      receive_next_ += receive_buffer_.push(&i->second[s],
+          i->second.size() - s);
+    }
+    out_of_order_.erase(i);
+  }
+}
+
+void connection::on_ack(const packet_header& h,
+    const unsigned char* body, std::size_t n, uint64_t now)
+{
+  ack_body a;
+  if (!decode_ack(body, n, h.sack_count, a))
+    return;
+
+  uint64_t highest = send_next_ + (fin_sent_ ? 1 : 0);
+  if (a.cumulative > highest)
+    return;
+
+  peer_window_ = a.window;
+  std::size_t flight_before = bytes_in_flight_;
+  std::size_t delivered = 0;
+  uint64_t rack = 0;
+
+  // Cumulatively acknowledged segments.
+  while (!segments_.empty() && segments_.front().end() <= a.cumulative)
+  {
+    segment& s = segments_.front();
+    deliver(s, delivered, rack);
+    if (s.fin)
+      fin_acked_ = true;
+    segments_.pop_front();
+  }
+  if (a.cumulative > send_una_)
+  {
+    uint64_t data_acked = (std::min)(a.cumulative, send_end_) - send_una_;
+    send_buffer_.consume(static_cast<std::size_t>(data_acked));
+    send_una_ += data_acked;
+  }
+
+  // Selectively acknowledged segments.
+  for (std::size_t b = 0; b < h.sack_count; ++b)
+  {
+    for (std::deque<segment>::iterator i = segments_.begin();
+        i != segments_.end() && i->offset < a.blocks[b].end; ++i)
+    {
+      if (!i->sacked && i->offset >= a.blocks[b].start
+          && i->end() <= a.blocks[b].end)
+        deliver(*i, delivered, rack);
+    }
+  }
+
+  // The echo identifies the transmission acknowledged, retransmission or not.
+  if (delivered > 0)
+  {
+    uint32_t sample = static_cast<uint32_t>(now) - a.echo;
+    if (sample < max_rto)
+      update_rtt(sample, a.ack_delay);
+    consecutive_timeouts_ = 0;
+    rto_backoff_ = 1;
+  }
+  if (rack > rack_sent_time_)
+    rack_sent_time_ = rack;
+
+  // A segment sent well before one that has been delivered is lost. Only
+  // losses of data sent since the last response count as a new event.
+  bool loss = false;
+  uint64_t reorder_window = (std::max<uint64_t>)(min_rtt_ / 4, 1000);
+  for (std::deque<segment>::iterator i = segments_.begin();
+      i != segments_.end(); ++i)
+  {
+    if (!i->sacked && !i->lost
+        && i->sent_time + reorder_window < rack_sent_time_)
+    {
+      i->lost = true;
+      ++lost_count_;
+      bytes_in_flight_ -= i->length;
+      if (i->offset >= recovery_point_)
+        loss = true;
+    }
+  }
+
+  if (in_recovery_ && a.cumulative >= recovery_point_)
+    in_recovery_ = false;
+
+  if (loss)
+  {
+    congestion_.on_congestion_event();
+    in_recovery_ = true;
+    recovery_point_ = send_next_ + (fin_sent_ ? 1 : 0);
+  }
+  else if (delivered > 0 && !in_recovery_)
+  {
+    congestion_.on_ack(delivered, flight_before, a.one_way_delay, now);
+  }
+
+  // Restart the retransmission timer on progress.
+  if (bytes_in_flight_ == 0)
+    rto_deadline_ = 0;
+  else if (delivered > 0)
+    rto_deadline_ = now + rto();
+
+  // Probe a closed window on the retransmission timer.
+  bool blocked = send_next_ < send_end_ && bytes_in_flight_ == 0
+    && lost_count_ == 0 && !window_allows(1);
+  if (blocked && rto_deadline_ == 0)
+    rto_deadline_ = now + rto();
+}
+
+void connection::deliver(segment& s, std::size_t& bytes, uint64_t& rack)
+{
+  if (s.sacked)
+    return;
+  s.sacked = true;
+  bytes += s.length;
+
+  if (s.lost)
+  {
+    // Delivered by an earlier transmission after all.
+    s.lost = false;
+    --lost_count_;
+  }
+  else
+    bytes_in_flight_ -= s.length;
+
+  rack = (std::max)(rack, s.sent_time);
+}
+
+void connection::update_rtt(uint64_t sample, uint64_t ack_delay)
+{
+  if (!have_rtt_ || sample < min_rtt_)
+    min_rtt_ = sample;
+  if (sample > min_rtt_ + ack_delay)
+    sample -= ack_delay;
+
+  if (!have_rtt_)
+  {
+    have_rtt_ = true;
+    smoothed_rtt_ = sample;
+    rtt_variance_ = sample / 2;
+    return;
+  }
+
+  uint64_t error = sample > smoothed_rtt_
+    ? sample - smoothed_rtt_ : smoothed_rtt_ - sample;
+  rtt_variance_ = (3 * rtt_variance_ + error) / 4;
+  smoothed_rtt_ = (7 * smoothed_rtt_ + sample) / 8;
+}
+
+uint64_t connection::rto() const
+{
+  uint64_t base = have_rtt_
+    ? (std::max<uint64_t>)(smoothed_rtt_ + 4 * rtt_variance_ + max_ack_delay,
+        min_rto)
+    : static_cast<uint64_t>(initial_rto);
+  return (std::min<uint64_t>)(base * rto_backoff_, max_rto);
+}
+
+std::size_t connection::write_header(unsigned char* buf,
+    unsigned char type, unsigned char flags, unsigned char sack_count,
+    uint64_t now) const
+{
+  packet_header h;
+  h.type = type;
+  h.flags = flags;
+  h.sack_count = sack_count;
+  h.destination = peer_id_;
+  h.source = local_id_;
+  h.timestamp = static_cast<uint32_t>(now);
+  return encode_header(buf, h);
+}
+
+std::size_t connection::write_ack(unsigned char* buf, uint64_t now)
+{
+  ack_body a;
+  a.cumulative = receive_next_;
+  a.echo = last_timestamp_;
+  a.ack_delay = static_cast<uint32_t>(now - last_data_time_);
+  a.one_way_delay = last_one_way_delay_;
+  a.window = static_cast<uint32_t>(receive_buffer_.space());
+
+  // Report the ranges received beyond the cumulative point. The one holding
+  // the latest arrival goes first, as it matters most to the sender's loss
+  // detection when there are more ranges than fit.
+  typedef std::map<uint64_t, std::vector<unsigned char> >::const_iterator
+    iterator;
+  std::size_t count = 0;
+  iterator latest = out_of_order_.find(last_out_of_order_);
+  if (latest != out_of_order_.end())
+  {
+    sack_block& first = a.blocks[count++];
+    first.start = latest->first;
+    first.end = latest->first + latest->second.size();
+    for (iterator i = latest; i != out_of_order_.begin()
+        && (--i)->first + i->second.size() >= first.start; )
+      first.start = i->first;
+    for (iterator i = latest; ++i != out_of_order_.end()
+        && i->first <= first.end; )
+      first.end = (std::max)(first.end, i->first + i->second.size());
+  }
+
+  sack_block range = { 0, 0 };
+  for (iterator i = out_of_order_.begin(); ; ++i)
+  {
+    if (i != out_of_order_.end() && range.end != 0 && i->first <= range.end)
+    {
+      range.end = (std::max)(range.end, i->first + i->second.size());
+      continue;
+    }
+    if (range.end != 0 && (count == 0 || range.start != a.blocks[0].start))
+      a.blocks[count++] = range;
+    if (i == out_of_order_.end() || count == max_sack_blocks)
+      break;
+    range.start = i->first;
+    range.end = i->first + i->second.size();
+  }
+
+  ack_pending_ = false;
+  ack_due_ = 0;
+  unacked_packets_ = 0;
+  advertised_window_ = a.window;
+
+  std::size_t size = write_header(buf, packet_ack, 0,
+      static_cast<unsigned char>(count), now);
+  return size + encode_ack(buf + size, a, count);
+}
+
+std::size_t connection::write_data(unsigned char* buf, uint64_t now)
+{
+  if (now < next_send_time_)
+    return 0;
+
+  segment fresh;
+  segment* s = next_segment(fresh);
+  if (!s)
+    return 0;
+
+  if (s == &fresh)
+  {
+    segments_.push_back(fresh);
+    s = &segments_.back();
+    send_next_ += s->length;
+    if (s->fin)
+      fin_sent_ = true;
+  }
+  else
+  {
+    s->lost = false;
+    --lost_count_;
+    stats_.bytes_retransmitted += s->length;
+  }
+
+  s->transmissions += 1;
+  s->sent_time = now;
+  bytes_in_flight_ += s->length;
+  stats_.bytes_sent += s->length;
+  probe_ = false;
+  if (rto_deadline_ == 0)
+    rto_deadline_ = now + rto();
+
+  packet_header h;
+  h.type = packet_data;
+  h.flags = s->fin ? flag_fin : 0;
+  h.sack_count = 0;
+  h.destination = peer_id_;
+  h.source = local_id_;
+  h.timestamp = static_cast<uint32_t>(now);
+  std::size_t size = encode_header(buf, h);
+  encode_uint64(buf + size, s->offset);
+  size += 8;
+  send_buffer_.peek(static_cast<std::size_t>(s->offset - send_una_),
+      buf + size, s->length);
+  size += s->length;
+
+  // Pace at a little over one window per round trip, faster while the
+  // window is still growing.
+  if (have_rtt_ && smoothed_rtt_ > 0)
+  {
+    double gain = congestion_.in_slow_start() ? 2.0 : 1.25;
+    double rate = gain * congestion_.window() / smoothed_rtt_;
+    uint64_t interval = static_cast<uint64_t>(size / rate);
+    uint64_t start = (std::max<uint64_t>)(next_send_time_,
+        now > pacing_burst ? now - pacing_burst : 0);
+    next_send_time_ = start + interval;
+  }
+
+  return size;
+}
+
+connection::segment* connection::next_segment(segment& fresh)
+{
+  // Retransmissions come first, and are not limited by the peer's window
+  // since the data was inside it when first sent.
+  if (lost_count_ > 0)
+  {
+    for (std::deque<segment>::iterator i = segments_.begin();
+        i != segments_.end(); ++i)
+    {
+      if (i->lost)
+      {
+        if (!probe_ && bytes_in_flight_ > 0
+            && bytes_in_flight_ + i->length > congestion_.window())
+          return 0;
+        return &*i;
+      }
+    }
+  }
+
+  std::size_t available = static_cast<std::size_t>(send_end_ - send_next_);
+  bool fin = fin_requested_ && !fin_sent_;
+  if (available == 0 && !fin)
+    return 0;
+
+  std::size_t length = (std::min<std::size_t>)(available, max_segment_size);
+  if (!probe_ && !window_allows(length))
+    return 0;
+
+  fresh.offset = send_next_;
+  fresh.length = static_cast<uint32_t>(length);
+  fresh.fin = fin && length == available;
+  fresh.lost = false;
+  fresh.sacked = false;
+  fresh.transmissions = 0;
+  fresh.sent_time = 0;
+  return &fresh;
+}
+
+bool connection::window_allows(std::size_t length) const
+{
+  if (bytes_in_flight_ > 0
+      && bytes_in_flight_ + length > congestion_.window())
+    return false;
+  return send_next_ + length <= send_una_ + peer_window_;
+}
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_DETAIL_IMPL_CONNECTION_IPP
@@ -0,0 +1,598 @@
+//
+// rudp/detail/impl/multiplexer_core.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_IMPL_MULTIPLEXER_CORE_HPP
+#define ASIO_RUDP_DETAIL_IMPL_MULTIPLEXER_CORE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include "asio/buffer.hpp"
+#include "asio/error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+template <typename DatagramSocket>
+template <typename Arg>
+multiplexer_core<DatagramSocket>::multiplexer_core(Arg& arg,
+    const endpoint_type& local_endpoint, std::size_t send_buffer_size,
+    std::size_t receive_buffer_size)
+  : socket_(arg, local_endpoint),
+    scheduler_(asio::use_service<asio::detail::io_service_impl>(
+          socket_.get_io_service())),
+    timer_(socket_.get_io_service()),
+    timer_armed_(false),
+    receiving_(false),
+    sending_(false),
+    shutdown_(false),
+    send_buffer_size_(send_buffer_size),
+    receive_buffer_size_(receive_buffer_size),
+    next_id_(static_cast<uint32_t>(now() ^ (now() >> 32))),
+    last_sender_(0)
+{
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::start(
+    const asio::detail::shared_ptr<multiplexer_core>& self)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  start_receive(self);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::shutdown()
+{
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    shutdown_ = true;
+
+    for (typename std::map<uint32_t, state_ptr>::iterator
+        i = connections_.begin(); i != connections_.end(); ++i)
+    {
+      i->second->connection_.abort(asio::error::operation_aborted);
+      abort_ops(*i->second, ready);
+    }
+    connections_.clear();
+    passive_opens_.clear();
+    backlog_.clear();
+    pending_rsts_.clear();
+
+    while (accept_op* op = accept_ops_.front())
+    {
+      accept_ops_.pop();
+      op->ec_ = asio::error::operation_aborted;
+      ready.push(op);
+    }
+
+    asio::error_code ec;
+    timer_.cancel(ec);
+    socket_.close(ec);
+  }
+  scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::start_connect(
+    const asio::detail::shared_ptr<multiplexer_core>& self,
+    state_ptr& target, const endpoint_type& peer,
+    stream_base::congestion_control_type type, stream_op* op)
+{
+  scheduler_.work_started();
+
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (shutdown_)
+    {
+      op->ec_ = asio::error::operation_aborted;
+      ready.push(op);
+    }
+    else if (target)
+    {
+      op->ec_ = asio::error::already_open;
+      ready.push(op);
+    }
+    else
+    {
+      uint64_t t = now();
+      state_ptr state(new stream_state(new_id(), type,
+            send_buffer_size_, receive_buffer_size_));
+      state->peer_ = peer;
+      state->connection_.connect(t);
+      state->connect_ops_.push(op);
+      connections_[state->connection_.local_id()] = state;
+      target = state;
+      run(self, t, ready);
+    }
+  }
+  scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::start_op(
+    const asio::detail::shared_ptr<multiplexer_core>& self,
+    const state_ptr& state, queue_type queue, stream_op* op)
+{
+  scheduler_.work_started();
+
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (shutdown_)
+    {
+      op->ec_ = asio::error::operation_aborted;
+      ready.push(op);
+    }
+    else if (!state)
+    {
+      op->ec_ = asio::error::not_connected;
+      ready.push(op);
+    }
+    else
+    {
+      ((*state).*queue).push(op);
+      run(self, now(), ready);
+    }
+  }
+  scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::start_accept(
+    const asio::detail::shared_ptr<multiplexer_core>& /*self*/,
+    accept_op* op)
+{
+  scheduler_.work_started();
+
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (shutdown_)
+    {
+      op->ec_ = asio::error::operation_aborted;
+      ready.push(op);
+    }
+    else if (op->target_)
+    {
+      op->ec_ = asio::error::already_open;
+      ready.push(op);
+    }
+    else
+    {
+      accept_ops_.push(op);
+      match_accepts(ready);
+    }
+  }
+  scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::start_shutdown(
+    const asio::detail::shared_ptr<multiplexer_core>& self,
+    const state_ptr& state, stream_op* op)
+{
+  if (state)
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    state->connection_.shutdown();
+  }
+  start_op(self, state, &stream_state::shutdown_ops_, op);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::close_stream(
+    const asio::detail::shared_ptr<multiplexer_core>& self,
+    const state_ptr& state)
+{
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    uint64_t t = now();
+    state->attached_ = false;
+    abort_ops(*state, ready);
+
+    connection& c = state->connection_;
+    if (c.state() == connection::established)
+    {
+      c.shutdown();
+      state->linger_deadline_ = t + max_linger;
+    }
+    else
+      c.abort(asio::error::operation_aborted);
+
+    if (!shutdown_)
+      run(self, t, ready);
+  }
+  scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+std::size_t multiplexer_core<DatagramSocket>::cancel(const state_ptr& state)
+{
+  asio::detail::op_queue<asio::detail::operation> ready;
+  std::size_t n;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    n = abort_ops(*state, ready);
+  }
+  scheduler_.post_deferred_completions(ready);
+  return n;
+}
+
+template <typename DatagramSocket>
+std::size_t multiplexer_core<DatagramSocket>::cancel_accept()
+{
+  asio::detail::op_queue<asio::detail::operation> ready;
+  std::size_t n = 0;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    while (accept_op* op = accept_ops_.front())
+    {
+      accept_ops_.pop();
+      op->ec_ = asio::error::operation_aborted;
+      ready.push(op);
+      ++n;
+    }
+  }
+  scheduler_.post_deferred_completions(ready);
+  return n;
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::set_congestion_control(
+    const state_ptr& state, stream_base::congestion_control_type type)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  state->connection_.set_congestion_control(type);
+}
+
+template <typename DatagramSocket>
+stream_base::statistics multiplexer_core<DatagramSocket>::statistics(
+    const state_ptr& state)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  return state->connection_.statistics();
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::receive_handler::operator()(
+    const asio::error_code& ec, std::size_t n)
+{
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    core_->receiving_ = false;
+    if (core_->shutdown_ || ec == asio::error::operation_aborted)
+      return;
+
+    // Other errors, such as an ICMP port unreachable reported on the next
+    // receive, concern a single peer. Its connection will time out.
+    uint64_t t = now();
+    if (!ec)
+      core_->handle_datagram(n, t, ready);
+    core_->start_receive(core_);
+    core_->run(core_, t, ready);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::send_handler::operator()(
+    const asio::error_code& /*ec*/, std::size_t /*n*/)
+{
+  // A failed send is a lost datagram, which the protocol recovers from.
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    core_->sending_ = false;
+    if (!core_->shutdown_)
+      core_->run(core_, now(), ready);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::timer_handler::operator()(
+    const asio::error_code& ec)
+{
+  if (ec == asio::error::operation_aborted)
+    return;
+
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    core_->timer_armed_ = false;
+    if (!core_->shutdown_)
+      core_->run(core_, now(), ready);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+template <typename DatagramSocket>
+uint64_t multiplexer_core<DatagramSocket>::now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      steady_timer::clock_type::now().time_since_epoch()).count();
+}
+
+template <typename DatagramSocket>
+uint32_t multiplexer_core<DatagramSocket>::new_id()
+{
+  // Ids need only be unique here, and unlikely to match a previous run's.
+  do
+    next_id_ = next_id_ * 1664525 + 1013904223;
+  while (next_id_ == 0 || connections_.count(next_id_));
+  return next_id_;
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::start_receive(
+    const asio::detail::shared_ptr<multiplexer_core>& self)
+{
+  if (!receiving_ && !shutdown_)
+  {
+    receiving_ = true;
+    receive_handler handler = { self };
+    socket_.async_receive_from(asio::buffer(receive_datagram_),
+        sender_, handler);
+  }
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::handle_datagram(std::size_t n,
+    uint64_t t, asio::detail::op_queue<asio::detail::operation>& ready)
+{
+  packet_header h;
+  if (n > max_datagram_size || !decode_header(receive_datagram_, n, h))
+    return;
+  const unsigned char* body = receive_datagram_ + header_size;
+  std::size_t body_size = n - header_size;
+
+  if (h.type == packet_syn && h.destination == 0)
+  {
+    // A repeated SYN goes to the connection it created.
+    std::pair<endpoint_type, uint32_t> key(sender_, h.source);
+    typename std::map<std::pair<endpoint_type, uint32_t>,
+      uint32_t>::iterator existing = passive_opens_.find(key);
+    if (existing != passive_opens_.end())
+    {
+      typename std::map<uint32_t, state_ptr>::iterator i
+        = connections_.find(existing->second);
+      if (i != connections_.end())
+      {
+        i->second->connection_.on_packet(h, body, body_size, t);
+        return;
+      }
+      passive_opens_.erase(existing);
+    }
+
+    // Without room in the backlog the peer will retry.
+    if (h.source == 0 || backlog_.size() >= max_backlog)
+      return;
+
+    state_ptr state(new stream_state(new_id(), stream_base::reno,
+          send_buffer_size_, receive_buffer_size_));
+    state->peer_ = sender_;
+    state->connection_.accept(h.source, t);
+    connections_[state->connection_.local_id()] = state;
+    passive_opens_[key] = state->connection_.local_id();
+    backlog_.push_back(state);
+    match_accepts(ready);
+    return;
+  }
+
+  typename std::map<uint32_t, state_ptr>::iterator i
+    = connections_.find(h.destination);
+  if (i == connections_.end() || i->second->peer_ != sender_)
+  {
+    // Tell the peer the connection is gone, unless it is saying the same.
+    if (h.type != packet_rst && h.source != 0
+        && pending_rsts_.size() < max_pending_rsts)
+      pending_rsts_.push_back(std::make_pair(sender_, h.source));
+    return;
+  }
+
+  i->second->connection_.on_packet(h, body, body_size, t);
+  complete_ops(*i->second, t, ready);
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::complete_ops(stream_state& state,
+    uint64_t t, asio::detail::op_queue<asio::detail::operation>& ready)
+{
+  queue_type queues[] = { &stream_state::connect_ops_,
+    &stream_state::read_ops_, &stream_state::write_ops_,
+    &stream_state::shutdown_ops_ };
+  for (std::size_t q = 0; q < sizeof(queues) / sizeof(queues[0]); ++q)
+  {
+    asio::detail::op_queue<stream_op>& ops = state.*queues[q];
+    while (stream_op* op = ops.front())
+    {
+      if (!op->perform(state.connection_, t))
+        break;
+      ops.pop();
+      ready.push(op);
+    }
+  }
+}
+
+template <typename DatagramSocket>
+std::size_t multiplexer_core<DatagramSocket>::abort_ops(stream_state& state,
+    asio::detail::op_queue<asio::detail::operation>& ready)
+{
+  queue_type queues[] = { &stream_state::connect_ops_,
+    &stream_state::read_ops_, &stream_state::write_ops_,
+    &stream_state::shutdown_ops_ };
+  std::size_t n = 0;
+  for (std::size_t q = 0; q < sizeof(queues) / sizeof(queues[0]); ++q)
+  {
+    asio::detail::op_queue<stream_op>& ops = state.*queues[q];
+    while (stream_op* op = ops.front())
+    {
+      ops.pop();
+      op->ec_ = asio::error::operation_aborted;
+      op->bytes_transferred_ = 0;
+      ready.push(op);
+      ++n;
+    }
+  }
+  return n;
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::match_accepts(
+    asio::detail::op_queue<asio::detail::operation>& ready)
+{
+  while (!backlog_.empty() && accept_ops_.front())
+  {
+    accept_op* op = accept_ops_.front();
+    accept_ops_.pop();
+    op->target_ = backlog_.front();
+    backlog_.pop_front();
+    op->ec_ = asio::error_code();
+    ready.push(op);
+  }
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::run(
+    const asio::detail::shared_ptr<multiplexer_core>& self,
+    uint64_t t, asio::detail::op_queue<asio::detail::operation>& ready)
+{
+  uint64_t never = (std::numeric_limits<uint64_t>::max)();
+  unsigned char discard[4096];
+
+  for (typename std::map<uint32_t, state_ptr>::iterator
+      i = connections_.begin(); i != connections_.end(); ++i)
+  {
+    stream_state& state = *i->second;
+    connection& c = state.connection_;
+    c.on_timer(t);
+    complete_ops(state, t, ready);
+
+    // Nobody will read what arrives on a closed stream.
+    if (!state.attached_)
+      while (c.read(discard, sizeof(discard), t) > 0) {}
+
+    // Finished connections stay a while to acknowledge retransmitted FINs.
+    // Closed streams that cannot finish in time are reset.
+    if (c.finished() && (state.linger_deadline_ == 0
+          || state.linger_deadline_ > t + time_wait))
+      state.linger_deadline_ = t + time_wait;
+    else if (!c.finished() && state.linger_deadline_ != 0
+        && t >= state.linger_deadline_)
+      c.abort(asio::error::timed_out);
+  }
+
+  flush(self, t);
+
+  // Discard connections with nothing left to do, and find the next deadline.
+  uint64_t next = never;
+  for (typename std::map<uint32_t, state_ptr>::iterator
+      i = connections_.begin(); i != connections_.end(); )
+  {
+    stream_state& state = *i->second;
+    connection& c = state.connection_;
+    uint64_t event = c.next_event(t);
+    bool closed = c.state() == connection::closed && event == never;
+    bool expired = state.linger_deadline_ != 0
+      && t >= state.linger_deadline_ && c.finished();
+    bool waiting = std::find(backlog_.begin(), backlog_.end(),
+        i->second) != backlog_.end();
+    if ((closed || expired) && !waiting)
+    {
+      complete_ops(state, t, ready);
+      passive_opens_.erase(std::make_pair(state.peer_, c.peer_id()));
+      connections_.erase(i++);
+      continue;
+    }
+    next = (std::min)(next, event);
+    if (state.linger_deadline_ != 0)
+      next = (std::min)(next, state.linger_deadline_);
+    ++i;
+  }
+
+  // A send in progress runs everything again when it completes.
+  if (next != never && !(sending_ && next <= t))
+  {
+    steady_timer::time_point expiry(std::chrono::duration_cast<
+        steady_timer::duration>(std::chrono::microseconds(next)));
+    if (!timer_armed_ || expiry < timer_.expires_at())
+    {
+      // Re-arming cancels the earlier wait, whose handler then does nothing.
+      timer_armed_ = true;
+      timer_.expires_at(expiry);
+      timer_handler handler = { self };
+      timer_.async_wait(handler);
+    }
+  }
+}
+
+template <typename DatagramSocket>
+void multiplexer_core<DatagramSocket>::flush(
+    const asio::detail::shared_ptr<multiplexer_core>& self, uint64_t t)
+{
+  if (sending_ || shutdown_)
+    return;
+
+  std::size_t n = 0;
+  endpoint_type destination;
+  if (!pending_rsts_.empty())
+  {
+    packet_header h = { packet_rst, 0, 0, pending_rsts_.front().second, 0,
+      static_cast<uint32_t>(t) };
+    n = encode_header(send_datagram_, h);
+    destination = pending_rsts_.front().first;
+    pending_rsts_.pop_front();
+  }
+  else if (!connections_.empty())
+  {
+    // Connections take turns, starting after the last one to send.
+    typename std::map<uint32_t, state_ptr>::iterator i
+      = connections_.upper_bound(last_sender_);
+    for (std::size_t k = 0; k < connections_.size() && n == 0; ++k, ++i)
+    {
+      if (i == connections_.end())
+        i = connections_.begin();
+      n = i->second->connection_.poll_send(send_datagram_, t);
+      if (n > 0)
+      {
+        destination = i->second->peer_;
+        last_sender_ = i->first;
+      }
+    }
+  }
+
+  if (n > 0)
+  {
+    sending_ = true;
+    send_handler handler = { self };
+    socket_.async_send_to(asio::buffer(send_datagram_, n),
+        destination, handler);
+  }
+}
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_DETAIL_IMPL_MULTIPLEXER_CORE_HPP
@@ -0,0 +1,129 @@
+//
+// rudp/detail/impl/packet.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_IMPL_PACKET_IPP
+#define ASIO_RUDP_DETAIL_IMPL_PACKET_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/rudp/detail/packet.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+void encode_uint32(unsigned char* p, uint32_t v)
+{
+  p[0] = static_cast<unsigned char>(v >> 24);
+  p[1] = static_cast<unsigned char>(v >> 16);
+  p[2] = static_cast<unsigned char>(v >> 8);
+  p[3] = static_cast<unsigned char>(v);
+}
+
+uint32_t decode_uint32(const unsigned char* p)
+{
+  return (static_cast<uint32_t>(p[0]) << 24)
+    | (static_cast<uint32_t>(p[1]) << 16)
+    | (static_cast<uint32_t>(p[2]) << 8)
+    | static_cast<uint32_t>(p[3]);
+}
+
+void encode_uint64(unsigned char* p, uint64_t v)
+{
+  encode_uint32(p, static_cast<uint32_t>(v >> 32));
+  encode_uint32(p + 4, static_cast<uint32_t>(v));
+}
+
+uint64_t decode_uint64(const unsigned char* p)
+{
+  return (static_cast<uint64_t>(decode_uint32(p)) << 32)
+    | decode_uint32(p + 4);
+}
+
+std::size_t encode_header(unsigned char* p, const packet_header& h)
+{
+  p[0] = protocol_version;
+  p[1] = h.type;
+  p[2] = h.flags;
+  p[3] = h.sack_count;
+  encode_uint32(p + 4, h.destination);
+  encode_uint32(p + 8, h.source);
+  encode_uint32(p + 12, h.timestamp);
+  return header_size;
+}
+
+bool decode_header(const unsigned char* p, std::size_t n, packet_header& h)
+{
+  if (n < header_size || p[0] != protocol_version
+      || p[1] < packet_syn || p[1] > packet_rst)
+    return false;
+  h.type = p[1];
+  h.flags = p[2];
+  h.sack_count = p[3];
+  h.destination = decode_uint32(p + 4);
+  h.source = decode_uint32(p + 8);
+  h.timestamp = decode_uint32(p + 12);
+  if (h.type == packet_data && n < data_header_size)
+    return false;
+  if (h.type == packet_ack && (h.sack_count > max_sack_blocks
+        || n < static_cast<std::size_t>(
+          ack_header_size + h.sack_count * sack_block_size)))
+    return false;
+  return true;
+}
+
+std::size_t encode_ack(unsigned char* p,
+    const ack_body& a, std::size_t sack_count)
+{
+  encode_uint64(p, a.cumulative);
+  encode_uint32(p + 8, a.echo);
+  encode_uint32(p + 12, a.ack_delay);
+  encode_uint32(p + 16, a.one_way_delay);
+  encode_uint32(p + 20, a.window);
+  unsigned char* q = p + 24;
+  for (std::size_t i = 0; i < sack_count; ++i, q += sack_block_size)
+  {
+    encode_uint64(q, a.blocks[i].start);
+    encode_uint64(q + 8, a.blocks[i].end);
+  }
+  return q - p;
+}
+
+bool decode_ack(const unsigned char* p, std::size_t n,
+    std::size_t sack_count, ack_body& a)
+{
+  if (sack_count > max_sack_blocks || n < 24 + sack_count * sack_block_size)
+    return false;
+  a.cumulative = decode_uint64(p);
+  a.echo = decode_uint32(p + 8);
+  a.ack_delay = decode_uint32(p + 12);
+  a.one_way_delay = decode_uint32(p + 16);
+  a.window = decode_uint32(p + 20);
+  const unsigned char* q = p + 24;
+  for (std::size_t i = 0; i < sack_count; ++i, q += sack_block_size)
+  {
+    a.blocks[i].start = decode_uint64(q);
+    a.blocks[i].end = decode_uint64(q + 8);
+  }
+  return true;
+}
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_DETAIL_IMPL_PACKET_IPP
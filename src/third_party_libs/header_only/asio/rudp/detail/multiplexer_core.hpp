@@ -0,0 +1,252 @@
+//
+// rudp/detail/multiplexer_core.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_MULTIPLEXER_CORE_HPP
+#define ASIO_RUDP_DETAIL_MULTIPLEXER_CORE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO)
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <utility>
+#include "asio/io_service.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/op_queue.hpp"
+#include "asio/rudp/detail/connection.hpp"
+#include "asio/rudp/detail/packet.hpp"
+#include "asio/rudp/detail/stream_ops.hpp"
+#include "asio/rudp/stream_base.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+// Runs the connections that share a datagram socket. One receive and one
+// send are kept outstanding on the socket; datagrams are routed to
+// connections by the destination connection id, and connections take turns
+// to send. A single timer covers every connection's deadlines.
+//
+// The core is shared between the multiplexer, its streams and the handlers
+// of outstanding socket and timer operations, and a mutex guards all of its
+// state, including the connections.
+template <typename DatagramSocket>
+class multiplexer_core
+  : private asio::detail::noncopyable
+{
+public:
+  typedef typename DatagramSocket::endpoint_type endpoint_type;
+
+  // A connection and the operations waiting on it.
+  struct stream_state
+    : private asio::detail::noncopyable
+  {
+    stream_state(uint32_t id, stream_base::congestion_control_type type,
+        std::size_t send_buffer_size, std::size_t receive_buffer_size)
+      : connection_(id, type, send_buffer_size, receive_buffer_size),
+        attached_(true),
+        linger_deadline_(0)
+    {
+    }
+
+    connection connection_;
+    endpoint_type peer_;
+    asio::detail::op_queue<stream_op> connect_ops_;
+    asio::detail::op_queue<stream_op> read_ops_;
+    asio::detail::op_queue<stream_op> write_ops_;
+    asio::detail::op_queue<stream_op> shutdown_ops_;
+
+    // Whether a stream object owns the connection. Once it is closed, the
+    // connection lingers to finish sending.
+    bool attached_;
+
+    // When a lingering or finished connection is discarded.
+    uint64_t linger_deadline_;
+  };
+
+  typedef asio::detail::shared_ptr<stream_state> state_ptr;
+  typedef asio::detail::op_queue<stream_op> stream_state::* queue_type;
+  typedef stream_accept_op_base<stream_state> accept_op;
+
+  template <typename Arg>
+  multiplexer_core(Arg& arg, const endpoint_type& local_endpoint,
+      std::size_t send_buffer_size, std::size_t receive_buffer_size);
+
+  DatagramSocket& socket()
+  {
+    return socket_;
+  }
+
+  asio::io_service& get_io_service()
+  {
+    return socket_.get_io_service();
+  }
+
+  // Start receiving. The core must already be owned by self.
+  void start(const asio::detail::shared_ptr<multiplexer_core>& self);
+
+  // Close the socket and abort every operation.
+  void shutdown();
+
+  // Start an active open, storing the new connection in target.
+  void start_connect(const asio::detail::shared_ptr<multiplexer_core>& self,
+      state_ptr& target, const endpoint_type& peer,
+      stream_base::congestion_control_type type, stream_op* op);
+
+  // Queue an operation on a connection.
+  void start_op(const asio::detail::shared_ptr<multiplexer_core>& self,
+      const state_ptr& state, queue_type queue, stream_op* op);
+
+  // Queue a request for an incoming connection.
+  void start_accept(const asio::detail::shared_ptr<multiplexer_core>& self,
+      accept_op* op);
+
+  // Send a FIN after the data already written, and wait for it to be
+  // acknowledged.
+  void start_shutdown(const asio::detail::shared_ptr<multiplexer_core>& self,
+      const state_ptr& state, stream_op* op);
+
+  // Give up a connection, letting it finish sending in the background.
+  void close_stream(const asio::detail::shared_ptr<multiplexer_core>& self,
+      const state_ptr& state);
+
+  // Abort a connection's operations. Returns the number aborted.
+  std::size_t cancel(const state_ptr& state);
+
+  // Abort the accept operations. Returns the number aborted.
+  std::size_t cancel_accept();
+
+  void set_congestion_control(const state_ptr& state,
+      stream_base::congestion_control_type type);
+
+  stream_base::statistics statistics(const state_ptr& state);
+
+private:
+  enum
+  {
+    // The most connections waiting to be accepted.
+    max_backlog = 64,
+
+    // The most RSTs waiting to be sent to unknown connections.
+    max_pending_rsts = 64,
+
+    // How long a closed stream may take to finish sending.
+    max_linger = 10000000,
+
+    // How long a finished connection answers retransmissions.
+    time_wait = 2000000
+  };
+
+  struct receive_handler
+  {
+    asio::detail::shared_ptr<multiplexer_core> core_;
+
+    void operator()(const asio::error_code& ec, std::size_t n);
+  };
+
+  struct send_handler
+  {
+    asio::detail::shared_ptr<multiplexer_core> core_;
+
+    void operator()(const asio::error_code& ec, std::size_t n);
+  };
+
+  struct timer_handler
+  {
+    asio::detail::shared_ptr<multiplexer_core> core_;
+
+    void operator()(const asio::error_code& ec);
+  };
+
+  // Microseconds on the steady clock.
+  static uint64_t now();
+
+  // A connection id that is not in use.
+  uint32_t new_id();
+
+  void start_receive(const asio::detail::shared_ptr<multiplexer_core>& self);
+
+  // Route a received datagram.
+  void handle_datagram(std::size_t n, uint64_t now,
+      asio::detail::op_queue<asio::detail::operation>& ready);
+
+  // Complete whatever operations a connection's state allows.
+  void complete_ops(stream_state& state, uint64_t now,
+      asio::detail::op_queue<asio::detail::operation>& ready);
+
+  // Abort all of a connection's operations.
+  std::size_t abort_ops(stream_state& state,
+      asio::detail::op_queue<asio::detail::operation>& ready);
+
+  // Pair waiting connections with accept operations.
+  void match_accepts(asio::detail::op_queue<asio::detail::operation>& ready);
+
+  // Process timers, complete operations, send, discard finished connections
+  // and arm the timer.
+  void run(const asio::detail::shared_ptr<multiplexer_core>& self,
+      uint64_t now, asio::detail::op_queue<asio::detail::operation>& ready);
+
+  // Start a send if there is something to send.
+  void flush(const asio::detail::shared_ptr<multiplexer_core>& self,
+      uint64_t now);
+
+  DatagramSocket socket_;
+  asio::detail::io_service_impl& scheduler_;
+  asio::detail::mutex mutex_;
+  steady_timer timer_;
+  bool timer_armed_;
+  bool receiving_;
+  bool sending_;
+  bool shutdown_;
+  std::size_t send_buffer_size_;
+  std::size_t receive_buffer_size_;
+  uint32_t next_id_;
+
+  // Connections by local id, and the round-robin position for sending.
+  std::map<uint32_t, state_ptr> connections_;
+  uint32_t last_sender_;
+
+  // Passive opens by peer endpoint and peer id, to recognise repeated SYNs.
+  std::map<std::pair<endpoint_type, uint32_t>, uint32_t> passive_opens_;
+
+  std::deque<state_ptr> backlog_;
+  asio::detail::op_queue<accept_op> accept_ops_;
+
+  // RSTs for datagrams addressed to unknown connections.
+  std::deque<std::pair<endpoint_type, uint32_t> > pending_rsts_;
+
+  endpoint_type sender_;
+  unsigned char receive_datagram_[max_datagram_size + 1];
+  unsigned char send_datagram_[max_datagram_size];
+};
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/rudp/detail/impl/multiplexer_core.hpp"
+
+#endif // defined(ASIO_HAS_STD_CHRONO)
+
+#endif // ASIO_RUDP_DETAIL_MULTIPLEXER_CORE_HPP
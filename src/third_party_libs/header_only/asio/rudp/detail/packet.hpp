@@ -0,0 +1,129 @@
+//
+// rudp/detail/packet.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_PACKET_HPP
+#define ASIO_RUDP_DETAIL_PACKET_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/detail/cstdint.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+// Every datagram starts with a fixed header, in network byte order:
+//
+//   version(1) type(1) flags(1) sack_count(1)
+//   destination connection id(4) source connection id(4)
+//   timestamp(4)
+//
+// DATA packets continue with the stream offset(8) and the payload. ACK
+// packets continue with the cumulative offset(8), the timestamp echoed from
+// the latest DATA packet(4), the time since it arrived(4), its one-way delay
+// (4), the receive window(4) and sack_count blocks of start(8) end(8).
+// Control packets (SYN, SYN_ACK, RST) have no body.
+enum packet_type
+{
+  packet_syn = 1,
+  packet_syn_ack = 2,
+  packet_data = 3,
+  packet_ack = 4,
+  packet_rst = 5
+};
+
+enum
+{
+  protocol_version = 1,
+
+  // The final DATA packet of the stream.
+  flag_fin = 1,
+
+  // Sizes of the fixed parts.
+  header_size = 16,
+  data_header_size = header_size + 8,
+  ack_header_size = header_size + 24,
+  sack_block_size = 16,
+
+  // The largest datagram sent, chosen to avoid IP fragmentation on any path
+  // that carries IPv6.
+  max_datagram_size = 1200,
+
+  // The largest payload of a DATA packet.
+  max_segment_size = max_datagram_size - data_header_size,
+
+  // The most SACK blocks an ACK carries.
+  max_sack_blocks = 64
+};
+
+struct packet_header
+{
+  unsigned char type;
+  unsigned char flags;
+  unsigned char sack_count;
+  uint32_t destination;
+  uint32_t source;
+  uint32_t timestamp;
+};
+
+struct sack_block
+{
+  uint64_t start;
+  uint64_t end;
+};
+
+struct ack_body
+{
+  uint64_t cumulative;
+  uint32_t echo;
+  uint32_t ack_delay;
+  uint32_t one_way_delay;
+  uint32_t window;
+  sack_block blocks[max_sack_blocks];
+};
+
+// Write a header. Returns the number of bytes written.
+ASIO_DECL std::size_t encode_header(unsigned char* p,
+    const packet_header& h);
+
+// Read a header. Returns false if the datagram is not one of ours.
+ASIO_DECL bool decode_header(const unsigned char* p, std::size_t n,
+    packet_header& h);
+
+ASIO_DECL void encode_uint32(unsigned char* p, uint32_t v);
+ASIO_DECL uint32_t decode_uint32(const unsigned char* p);
+ASIO_DECL void encode_uint64(unsigned char* p, uint64_t v);
+ASIO_DECL uint64_t decode_uint64(const unsigned char* p);
+
+// Write an ACK body after the header. Returns the number of bytes written.
+ASIO_DECL std::size_t encode_ack(unsigned char* p,
+    const ack_body& a, std::size_t sack_count);
+
+// Read an ACK body. Returns false if it is truncated.
+ASIO_DECL bool decode_ack(const unsigned char* p, std::size_t n,
+    std::size_t sack_count, ack_body& a);
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/rudp/detail/impl/packet.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_RUDP_DETAIL_PACKET_HPP
@@ -0,0 +1,405 @@
+//
+// rudp/detail/stream_ops.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_DETAIL_STREAM_OPS_HPP
+#define ASIO_RUDP_DETAIL_STREAM_OPS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/buffer.hpp"
+#include "asio/error.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/fenced_block.hpp"
+#include "asio/detail/handler_alloc_helpers.hpp"
+#include "asio/detail/handler_invoke_helpers.hpp"
+#include "asio/detail/handler_work.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/operation.hpp"
+#include "asio/rudp/detail/connection.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+namespace detail {
+
+// An operation on a connection, retried whenever the connection's state
+// changes until perform() reports that it is done.
+class stream_op
+  : public asio::detail::operation
+{
+public:
+  // The error code to be passed to the completion handler.
+  asio::error_code ec_;
+
+  // The number of bytes transferred, to be passed to the completion handler.
+  std::size_t bytes_transferred_;
+
+  // Returns true if the operation is complete.
+  bool perform(connection& c, uint64_t now)
+  {
+    return perform_func_(this, c, now);
+  }
+
+protected:
+  typedef bool (*perform_func_type)(stream_op*, connection&, uint64_t);
+
+  stream_op(perform_func_type perform_func, func_type complete_func)
+    : asio::detail::operation(complete_func),
+      bytes_transferred_(0),
+      perform_func_(perform_func)
+  {
+  }
+
+  // The error for an operation that can make no further progress.
+  static asio::error_code closed_error(const connection& c)
+  {
+    return c.error() ? c.error() : asio::error::not_connected;
+  }
+
+private:
+  perform_func_type perform_func_;
+};
+
+template <typename MutableBufferSequence>
+class stream_read_op_base : public stream_op
+{
+public:
+  stream_read_op_base(const MutableBufferSequence& buffers,
+      func_type complete_func)
+    : stream_op(&stream_read_op_base::do_perform, complete_func),
+      buffers_(buffers)
+  {
+  }
+
+  static bool do_perform(stream_op* base, connection& c, uint64_t now)
+  {
+    stream_read_op_base* o(static_cast<stream_read_op_base*>(base));
+
+    typename MutableBufferSequence::const_iterator iter
+      = o->buffers_.begin();
+    typename MutableBufferSequence::const_iterator end = o->buffers_.end();
+    std::size_t total = 0;
+    for (; iter != end; ++iter)
+      total += asio::buffer_size(asio::mutable_buffer(*iter));
+
+    // A zero-sized read completes immediately, as it does for sockets.
+    if (total == 0)
+      return true;
+    if (!c.readable())
+      return false;
+
+    for (iter = o->buffers_.begin(); iter != end; ++iter)
+    {
+      asio::mutable_buffer buffer(*iter);
+      std::size_t size = asio::buffer_size(buffer);
+      std::size_t n = c.read(asio::buffer_cast<void*>(buffer), size, now);
+      o->bytes_transferred_ += n;
+      if (n < size)
+        break;
+    }
+
+    if (o->bytes_transferred_ == 0)
+      o->ec_ = c.at_eof() ? asio::error_code(asio::error::eof)
+        : closed_error(c);
+    return true;
+  }
+
+private:
+  MutableBufferSequence buffers_;
+};
+
+template <typename MutableBufferSequence, typename Handler>
+class stream_read_op
+  : public stream_read_op_base<MutableBufferSequence>
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(stream_read_op);
+
+  stream_read_op(const MutableBufferSequence& buffers, Handler& handler)
+    : stream_read_op_base<MutableBufferSequence>(
+        buffers, &stream_read_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler))
+  {
+    asio::detail::handler_work<Handler>::start(handler_);
+  }
+
+  static void do_complete(void* owner, asio::detail::operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    stream_read_op* o(static_cast<stream_read_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    asio::detail::handler_work<Handler> w(o->handler_);
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    asio::detail::binder2<Handler, asio::error_code, std::size_t>
+      handler(o->handler_, o->ec_, o->bytes_transferred_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      asio::detail::fenced_block b(asio::detail::fenced_block::half);
+      w.complete(handler, handler.handler_);
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+template <typename ConstBufferSequence>
+class stream_write_op_base : public stream_op
+{
+public:
+  stream_write_op_base(const ConstBufferSequence& buffers,
+      func_type complete_func)
+    : stream_op(&stream_write_op_base::do_perform, complete_func),
+      buffers_(buffers)
+  {
+  }
+
+  static bool do_perform(stream_op* base, connection& c, uint64_t /*now*/)
+  {
+    stream_write_op_base* o(static_cast<stream_write_op_base*>(base));
+
+    typename ConstBufferSequence::const_iterator iter = o->buffers_.begin();
+    typename ConstBufferSequence::const_iterator end = o->buffers_.end();
+    std::size_t total = 0;
+    for (; iter != end; ++iter)
+      total += asio::buffer_size(asio::const_buffer(*iter));
+
+    if (total == 0)
+      return true;
+    if (c.state() == connection::closed)
+    {
+      o->ec_ = closed_error(c);
+      return true;
+    }
+    if (c.shutdown_requested())
+    {
+      o->ec_ = asio::error::shut_down;
+      return true;
+    }
+    if (!c.writable())
+      return false;
+
+    for (iter = o->buffers_.begin(); iter != end; ++iter)
+    {
+      asio::const_buffer buffer(*iter);
+      std::size_t size = asio::buffer_size(buffer);
+      std::size_t n = c.write(asio::buffer_cast<const void*>(buffer), size);
+      o->bytes_transferred_ += n;
+      if (n < size)
+        break;
+    }
+    return true;
+  }
+
+private:
+  ConstBufferSequence buffers_;
+};
+
+template <typename ConstBufferSequence, typename Handler>
+class stream_write_op
+  : public stream_write_op_base<ConstBufferSequence>
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(stream_write_op);
+
+  stream_write_op(const ConstBufferSequence& buffers, Handler& handler)
+    : stream_write_op_base<ConstBufferSequence>(
+        buffers, &stream_write_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler))
+  {
+    asio::detail::handler_work<Handler>::start(handler_);
+  }
+
+  static void do_complete(void* owner, asio::detail::operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    stream_write_op* o(static_cast<stream_write_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    asio::detail::handler_work<Handler> w(o->handler_);
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    asio::detail::binder2<Handler, asio::error_code, std::size_t>
+      handler(o->handler_, o->ec_, o->bytes_transferred_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      asio::detail::fenced_block b(asio::detail::fenced_block::half);
+      w.complete(handler, handler.handler_);
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+// Waits for a connection to reach a state: established for a connect, or
+// our FIN acknowledged for a shutdown.
+class stream_wait_op_base : public stream_op
+{
+public:
+  enum wait_type
+  {
+    wait_connected,
+    wait_shutdown
+  };
+
+  stream_wait_op_base(wait_type type, func_type complete_func)
+    : stream_op(&stream_wait_op_base::do_perform, complete_func),
+      type_(type)
+  {
+  }
+
+  static bool do_perform(stream_op* base, connection& c, uint64_t /*now*/)
+  {
+    stream_wait_op_base* o(static_cast<stream_wait_op_base*>(base));
+
+    if (o->type_ == wait_shutdown && c.shutdown_complete())
+      return true;
+    if (c.state() == connection::closed)
+    {
+      o->ec_ = closed_error(c);
+      return true;
+    }
+    return o->type_ == wait_connected
+      && c.state() == connection::established;
+  }
+
+private:
+  wait_type type_;
+};
+
+template <typename Handler>
+class stream_wait_op : public stream_wait_op_base
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(stream_wait_op);
+
+  stream_wait_op(wait_type type, Handler& handler)
+    : stream_wait_op_base(type, &stream_wait_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler))
+  {
+    asio::detail::handler_work<Handler>::start(handler_);
+  }
+
+  static void do_complete(void* owner, asio::detail::operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    stream_wait_op* o(static_cast<stream_wait_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    asio::detail::handler_work<Handler> w(o->handler_);
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    asio::detail::binder1<Handler, asio::error_code>
+      handler(o->handler_, o->ec_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      asio::detail::fenced_block b(asio::detail::fenced_block::half);
+      w.complete(handler, handler.handler_);
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+// Waits for an incoming connection, which the multiplexer stores through
+// target_ before completing the operation.
+template <typename State>
+class stream_accept_op_base : public asio::detail::operation
+{
+public:
+  // The error code to be passed to the completion handler.
+  asio::error_code ec_;
+
+  // Where the accepted connection goes.
+  asio::detail::shared_ptr<State>& target_;
+
+protected:
+  stream_accept_op_base(asio::detail::shared_ptr<State>& target,
+      func_type complete_func)
+    : asio::detail::operation(complete_func),
+      target_(target)
+  {
+  }
+};
+
+template <typename State, typename Handler>
+class stream_accept_op : public stream_accept_op_base<State>
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(stream_accept_op);
+
+  stream_accept_op(asio::detail::shared_ptr<State>& target, Handler& handler)
+    : stream_accept_op_base<State>(target, &stream_accept_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler))
+  {
+    asio::detail::handler_work<Handler>::start(handler_);
+  }
+
+  static void do_complete(void* owner, asio::detail::operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    stream_accept_op* o(static_cast<stream_accept_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    asio::detail::handler_work<Handler> w(o->handler_);
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    asio::detail::binder1<Handler, asio::error_code>
+      handler(o->handler_, o->ec_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      asio::detail::fenced_block b(asio::detail::fenced_block::half);
+      w.complete(handler, handler.handler_);
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+} // namespace detail
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_DETAIL_STREAM_OPS_HPP
@@ -0,0 +1,85 @@
+//
+// rudp/impl/simulated_network.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_IMPL_SIMULATED_NETWORK_HPP
+#define ASIO_RUDP_IMPL_SIMULATED_NETWORK_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/buffer.hpp"
+#include "asio/detail/handler_type_requirements.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+
+template <typename ConstBufferSequence, typename WriteHandler>
+ASIO_INITFN_RESULT_TYPE(WriteHandler,
+    void (asio::error_code, std::size_t))
+simulated_socket::async_send_to(const ConstBufferSequence& buffers,
+    const endpoint_type& destination, ASIO_MOVE_ARG(WriteHandler) handler)
+{
+  // If you get an error on the following line it means that your handler does
+  // not meet the documented type requirements for a WriteHandler.
+  ASIO_WRITE_HANDLER_CHECK(WriteHandler, handler) type_check;
+
+  async_completion<WriteHandler,
+    void (asio::error_code, std::size_t)> init(handler);
+
+  std::vector<unsigned char> datagram(asio::buffer_size(buffers));
+  asio::buffer_copy(asio::buffer(datagram), buffers);
+
+  typedef detail::datagram_send_op<ASIO_HANDLER_TYPE(WriteHandler,
+    void (asio::error_code, std::size_t))> op;
+  typename op::ptr p = { asio::detail::addressof(init.handler),
+    op::ptr::allocate(init.handler), 0 };
+  p.p = new (p.v) op(init.handler);
+
+  start_send(datagram, destination, p.p);
+  p.v = p.p = 0;
+
+  return init.result.get();
+}
+
+template <typename MutableBufferSequence, typename ReadHandler>
+ASIO_INITFN_RESULT_TYPE(ReadHandler,
+    void (asio::error_code, std::size_t))
+simulated_socket::async_receive_from(const MutableBufferSequence& buffers,
+    endpoint_type& sender_endpoint, ASIO_MOVE_ARG(ReadHandler) handler)
+{
+  // If you get an error on the following line it means that your handler does
+  // not meet the documented type requirements for a ReadHandler.
+  ASIO_READ_HANDLER_CHECK(ReadHandler, handler) type_check;
+
+  async_completion<ReadHandler,
+    void (asio::error_code, std::size_t)> init(handler);
+
+  typedef detail::datagram_receive_op<MutableBufferSequence,
+    ASIO_HANDLER_TYPE(ReadHandler,
+      void (asio::error_code, std::size_t))> op;
+  typename op::ptr p = { asio::detail::addressof(init.handler),
+    op::ptr::allocate(init.handler), 0 };
+  p.p = new (p.v) op(buffers, sender_endpoint, init.handler);
+
+  start_receive(p.p);
+  p.v = p.p = 0;
+
+  return init.result.get();
+}
+
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_IMPL_SIMULATED_NETWORK_HPP
@@ -0,0 +1,458 @@
+//
+// rudp/impl/simulated_network.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_IMPL_SIMULATED_NETWORK_IPP
+#define ASIO_RUDP_IMPL_SIMULATED_NETWORK_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO)
+
+#include <chrono>
+#include <map>
+#include "asio/error.hpp"
+#include "asio/rudp/simulated_network.hpp"
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/throw_error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+
+struct simulated_network::core
+{
+  typedef steady_timer::clock_type clock_type;
+  typedef steady_timer::time_point time_point;
+
+  struct link
+  {
+    double rate_;
+    duration delay_;
+    std::size_t queue_limit_;
+    double loss_rate_;
+    double reorder_rate_;
+
+    // When the queue will have drained, if nothing more joins it.
+    time_point free_at_;
+
+    std::size_t dropped_;
+  };
+
+  struct host
+  {
+    link_type uplink_;
+    link_type downlink_;
+  };
+
+  struct packet
+  {
+    bool on_downlink_;
+    simulated_socket::endpoint_type source_;
+    simulated_socket::endpoint_type destination_;
+    std::vector<unsigned char> data_;
+  };
+
+  core(asio::io_service& io_service, unsigned int seed)
+    : io_service_(io_service),
+      scheduler_(asio::use_service<asio::detail::io_service_impl>(
+            io_service)),
+      random_(seed ? seed : 1),
+      next_port_(49152),
+      timer_(io_service),
+      timer_armed_(false),
+      shutdown_(false)
+  {
+  }
+
+  // Delivers packets when the timer expires.
+  struct timer_handler
+  {
+    asio::detail::shared_ptr<core> core_;
+
+    void operator()(const asio::error_code& ec);
+  };
+
+  // A uniform random number in [0, 1).
+  double random()
+  {
+    // xorshift32, which is plenty for choosing losses and reorderings.
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 17;
+    random_ ^= random_ << 5;
+    return random_ / 4294967296.0;
+  }
+
+  // Queue n bytes on a link at the given time. Returns false if they are
+  // dropped, otherwise sets exit to when they reach the far end.
+  bool traverse(link& l, std::size_t n, const time_point& at,
+      time_point& exit);
+
+  // Add a packet to those in flight, taking its data.
+  void schedule(const time_point& at, packet& p);
+
+  // Put a datagram on the sender's uplink.
+  void send(const simulated_socket::endpoint_type& source,
+      const simulated_socket::endpoint_type& destination,
+      std::vector<unsigned char>& data);
+
+  // Move every packet that is due along, and arm the timer for the next.
+  void process(const asio::detail::shared_ptr<core>& self,
+      asio::detail::op_queue<asio::detail::operation>& ready);
+
+  asio::io_service& io_service_;
+  asio::detail::io_service_impl& scheduler_;
+  asio::detail::mutex mutex_;
+  std::vector<link> links_;
+  std::map<asio::ip::address, host> hosts_;
+  std::map<simulated_socket::endpoint_type, simulated_socket*> sockets_;
+  std::multimap<time_point, packet> in_flight_;
+  uint32_t random_;
+  unsigned short next_port_;
+  steady_timer timer_;
+  bool timer_armed_;
+  bool shutdown_;
+};
+
+bool simulated_network::core::traverse(link& l, std::size_t n,
+    const time_point& at, time_point& exit)
+{
+  if (l.free_at_ < at)
+    l.free_at_ = at;
+
+  double backlog = l.rate_ * std::chrono::duration_cast<
+    std::chrono::duration<double> >(l.free_at_ - at).count();
+  if (backlog + n > l.queue_limit_
+      || (l.loss_rate_ > 0 && random() < l.loss_rate_))
+  {
+    ++l.dropped_;
+    return false;
+  }
+
+  l.free_at_ += std::chrono::duration_cast<duration>(
+      std::chrono::duration<double>(n / l.rate_));
+  exit = l.free_at_ + l.delay_;
+
+  // A reordered datagram is held back after leaving the queue, so those
+  // behind it overtake it without being delayed themselves.
+  if (l.reorder_rate_ > 0 && random() < l.reorder_rate_)
+    exit += l.delay_;
+  return true;
+}
+
+void simulated_network::core::send(
+    const simulated_socket::endpoint_type& source,
+    const simulated_socket::endpoint_type& destination,
+    std::vector<unsigned char>& data)
+{
+  std::map<asio::ip::address, host>::iterator h
+    = hosts_.find(source.address());
+  time_point exit;
+  if (h == hosts_.end() || !traverse(links_[h->second.uplink_],
+        data.size(), clock_type::now(), exit))
+    return;
+
+  packet p = { false, source, destination, std::vector<unsigned char>() };
+  p.data_.swap(data);
+  schedule(exit, p);
+}
+
+void simulated_network::core::schedule(const time_point& at, packet& p)
+{
+  packet& q = in_flight_.insert(std::make_pair(at, packet()))->second;
+  q.on_downlink_ = p.on_downlink_;
+  q.source_ = p.source_;
+  q.destination_ = p.destination_;
+  q.data_.swap(p.data_);
+}
+
+void simulated_network::core::process(
+    const asio::detail::shared_ptr<core>& self,
+    asio::detail::op_queue<asio::detail::operation>& ready)
+{
+  time_point now = clock_type::now();
+  while (!in_flight_.empty() && in_flight_.begin()->first <= now)
+  {
+    time_point due = in_flight_.begin()->first;
+    packet p;
+    p.on_downlink_ = in_flight_.begin()->second.on_downlink_;
+    p.source_ = in_flight_.begin()->second.source_;
+    p.destination_ = in_flight_.begin()->second.destination_;
+    p.data_.swap(in_flight_.begin()->second.data_);
+    in_flight_.erase(in_flight_.begin());
+
+    if (!p.on_downlink_)
+    {
+      // Arrived at the far end of the uplink: queue on the downlink as of
+      // the arrival time, so a late timer does not distort the queue.
+      std::map<asio::ip::address, host>::iterator h
+        = hosts_.find(p.destination_.address());
+      time_point exit;
+      if (h != hosts_.end() && traverse(links_[h->second.downlink_],
+            p.data_.size(), due, exit))
+      {
+        p.on_downlink_ = true;
+        schedule(exit, p);
+      }
+      continue;
+    }
+
+    std::map<simulated_socket::endpoint_type, simulated_socket*>::iterator s
+      = sockets_.find(p.destination_);
+    if (s == sockets_.end())
+      continue;
+
+    simulated_socket& socket = *s->second;
+    if (detail::datagram_op* op = socket.ops_.front())
+    {
+      socket.ops_.pop();
+      op->deliver(p.data_.empty() ? 0 : &p.data_[0],
+          p.data_.size(), p.source_);
+      ready.push(op);
+    }
+    else if (socket.queued_bytes_ + p.data_.size()
+        <= simulated_socket::receive_buffer_size)
+    {
+      socket.queued_bytes_ += p.data_.size();
+      socket.queue_.push_back(std::make_pair(p.source_,
+            std::vector<unsigned char>()));
+      socket.queue_.back().second.swap(p.data_);
+    }
+  }
+
+  // Re-arming cancels the earlier wait, whose handler then does nothing.
+  if (!in_flight_.empty())
+  {
+    time_point next = in_flight_.begin()->first;
+    if (!timer_armed_ || next < timer_.expires_at())
+    {
+      timer_armed_ = true;
+      timer_.expires_at(next);
+      timer_handler handler = { self };
+      timer_.async_wait(handler);
+    }
+  }
+}
+
+void simulated_network::core::timer_handler::operator()(
+    const asio::error_code& ec)
+{
+  if (ec == asio::error::operation_aborted)
+    return;
+
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    core_->timer_armed_ = false;
+    if (!core_->shutdown_)
+      core_->process(core_, ready);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+simulated_network::simulated_network(
+    asio::io_service& io_service, unsigned int seed)
+  : core_(new core(io_service, seed))
+{
+}
+
+simulated_network::~simulated_network()
+{
+  asio::detail::mutex::scoped_lock lock(core_->mutex_);
+  core_->shutdown_ = true;
+  core_->in_flight_.clear();
+  asio::error_code ec;
+  core_->timer_.cancel(ec);
+}
+
+asio::io_service& simulated_network::get_io_service()
+{
+  return core_->io_service_;
+}
+
+simulated_network::link_type simulated_network::add_link(
+    std::size_t bytes_per_second, const duration& delay,
+    std::size_t queue_limit, double loss_rate, double reorder_rate)
+{
+  asio::detail::mutex::scoped_lock lock(core_->mutex_);
+  core::link l = { static_cast<double>(bytes_per_second ? bytes_per_second : 1),
+    delay, queue_limit, loss_rate, reorder_rate, core::time_point(), 0 };
+  core_->links_.push_back(l);
+  return core_->links_.size() - 1;
+}
+
+void simulated_network::add_host(const asio::ip::address& address,
+    link_type uplink, link_type downlink)
+{
+  asio::detail::mutex::scoped_lock lock(core_->mutex_);
+  if (uplink >= core_->links_.size() || downlink >= core_->links_.size())
+  {
+    lock.unlock();
+    asio::detail::throw_error(asio::error::invalid_argument, "add_host");
+    return;
+  }
+  core::host h = { uplink, downlink };
+  core_->hosts_[address] = h;
+}
+
+std::size_t simulated_network::dropped(link_type link) const
+{
+  asio::detail::mutex::scoped_lock lock(core_->mutex_);
+  return link < core_->links_.size() ? core_->links_[link].dropped_ : 0;
+}
+
+simulated_socket::simulated_socket(simulated_network& network,
+    const endpoint_type& endpoint)
+  : core_(network.core_),
+    endpoint_(endpoint),
+    open_(false),
+    queued_bytes_(0)
+{
+  asio::error_code ec;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    if (core_->hosts_.find(endpoint.address()) == core_->hosts_.end())
+      ec = asio::error::host_unreachable;
+    else
+    {
+      // Pick a free port when asked for port zero.
+      for (unsigned n = 0; endpoint_.port() == 0 && n < 16384; ++n)
+      {
+        endpoint_type candidate(endpoint.address(), core_->next_port_);
+        core_->next_port_ = core_->next_port_ == 65535
+          ? 49152 : core_->next_port_ + 1;
+        if (core_->sockets_.find(candidate) == core_->sockets_.end())
+          endpoint_ = candidate;
+      }
+      if (endpoint_.port() == 0
+          || core_->sockets_.find(endpoint_) != core_->sockets_.end())
+        ec = asio::error::address_in_use;
+      else
+      {
+        core_->sockets_[endpoint_] = this;
+        open_ = true;
+      }
+    }
+  }
+  asio::detail::throw_error(ec, "bind");
+}
+
+simulated_socket::~simulated_socket()
+{
+  asio::error_code ec;
+  close(ec);
+}
+
+asio::io_service& simulated_socket::get_io_service()
+{
+  return core_->io_service_;
+}
+
+simulated_socket::endpoint_type simulated_socket::local_endpoint() const
+{
+  return endpoint_;
+}
+
+void simulated_socket::close()
+{
+  asio::error_code ec;
+  close(ec);
+  asio::detail::throw_error(ec, "close");
+}
+
+asio::error_code simulated_socket::close(asio::error_code& ec)
+{
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    if (open_)
+    {
+      core_->sockets_.erase(endpoint_);
+      open_ = false;
+    }
+    while (detail::datagram_op* op = ops_.front())
+    {
+      ops_.pop();
+      op->ec_ = asio::error::operation_aborted;
+      ready.push(op);
+    }
+    queue_.clear();
+    queued_bytes_ = 0;
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+
+  ec = asio::error_code();
+  return ec;
+}
+
+void simulated_socket::start_send(std::vector<unsigned char>& datagram,
+    const endpoint_type& destination, detail::datagram_op* op)
+{
+  core_->scheduler_.work_started();
+
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    if (!open_)
+      op->ec_ = asio::error::bad_descriptor;
+    else
+    {
+      op->bytes_transferred_ = datagram.size();
+      if (!core_->shutdown_)
+      {
+        core_->send(endpoint_, destination, datagram);
+        core_->process(core_, ready);
+      }
+    }
+    ready.push(op);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+void simulated_socket::start_receive(detail::datagram_op* op)
+{
+  core_->scheduler_.work_started();
+
+  asio::detail::op_queue<asio::detail::operation> ready;
+  {
+    asio::detail::mutex::scoped_lock lock(core_->mutex_);
+    if (!open_)
+    {
+      op->ec_ = asio::error::bad_descriptor;
+      ready.push(op);
+    }
+    else if (!queue_.empty())
+    {
+      std::vector<unsigned char>& data = queue_.front().second;
+      op->deliver(data.empty() ? 0 : &data[0], data.size(),
+          queue_.front().first);
+      queued_bytes_ -= data.size();
+      queue_.pop_front();
+      ready.push(op);
+    }
+    else
+      ops_.push(op);
+  }
+  core_->scheduler_.post_deferred_completions(ready);
+}
+
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_STD_CHRONO)
+
+#endif // ASIO_RUDP_IMPL_SIMULATED_NETWORK_IPP
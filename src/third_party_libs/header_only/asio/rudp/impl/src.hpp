@@ -0,0 +1,27 @@
+//
+// rudp/impl/src.hpp
+// ~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_IMPL_SRC_HPP
+#define ASIO_RUDP_IMPL_SRC_HPP
+
+#define ASIO_SOURCE
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# error Do not compile Asio library source with ASIO_HEADER_ONLY defined
+#endif
+
+#include "asio/rudp/detail/impl/congestion_controller.ipp"
+#include "asio/rudp/detail/impl/connection.ipp"
+#include "asio/rudp/detail/impl/packet.ipp"
+#include "asio/rudp/impl/simulated_network.ipp"
+
+#endif // ASIO_RUDP_IMPL_SRC_HPP
@@ -0,0 +1,282 @@
+//
+// rudp/simulated_network.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_SIMULATED_NETWORK_HPP
+#define ASIO_RUDP_SIMULATED_NETWORK_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+#include "asio/async_result.hpp"
+#include "asio/error_code.hpp"
+#include "asio/io_service.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/ip/address.hpp"
+#include "asio/ip/udp.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/op_queue.hpp"
+#include "asio/rudp/detail/datagram_ops.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+
+class simulated_socket;
+
+/// Simulates the links between hosts, in real time, within one process.
+/**
+ * Each host sends through an uplink and receives through a downlink. A link
+ * has a rate, a propagation delay, a drop-tail queue and a random loss rate,
+ * so a bulk transfer builds a queue in front of the bottleneck and anything
+ * sharing the link sees the delay grow. Hosts that share an uplink model a
+ * shared home connection.
+ *
+ * Datagrams sent to an address with no host, or to a port with no socket,
+ * are discarded.
+ *
+ * The network and its sockets must be destroyed before the io_service.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ *
+ * @par Example
+ * @code
+ * asio::rudp::simulated_network net(io_service);
+ * asio::rudp::simulated_network::link_type wan = net.add_link(
+ *     1250000, std::chrono::milliseconds(20), 100000);
+ * asio::rudp::simulated_network::link_type lan = net.add_link(
+ *     125000000, std::chrono::microseconds(50), 1000000);
+ * net.add_host(asio::ip::address::from_string("10.0.0.1"), wan, lan);
+ * net.add_host(asio::ip::address::from_string("10.0.0.2"), lan, lan);
+ * @endcode
+ */
+class simulated_network
+  : private asio::detail::noncopyable
+{
+public:
+  /// Identifies a link.
+  typedef std::size_t link_type;
+
+  /// The type used to express link delays.
+  typedef steady_timer::duration duration;
+
+  /// Construct a network with no links or hosts.
+  /**
+   * @param io_service The io_service used to deliver datagrams.
+   *
+   * @param seed Seeds the random losses, so that runs can be repeated.
+   */
+  ASIO_DECL explicit simulated_network(asio::io_service& io_service,
+      unsigned int seed = 1);
+
+  /// Destructor. Datagrams in flight are discarded.
+  ASIO_DECL ~simulated_network();
+
+  /// Get the io_service associated with the network.
+  ASIO_DECL asio::io_service& get_io_service();
+
+  /// Add a link.
+  /**
+   * @param bytes_per_second The rate at which the link drains its queue.
+   *
+   * @param delay The propagation delay added after a datagram leaves the
+   * queue.
+   *
+   * @param queue_limit The most bytes the queue may hold. Datagrams that do
+   * not fit are dropped.
+   *
+   * @param loss_rate The probability of a datagram being dropped at random.
+   *
+   * @param reorder_rate The probability of a datagram being delayed by twice
+   * the propagation delay, so that datagrams sent after it arrive first.
+   */
+  ASIO_DECL link_type add_link(std::size_t bytes_per_second,
+      const duration& delay, std::size_t queue_limit, double loss_rate = 0,
+      double reorder_rate = 0);
+
+  /// Add a host.
+  /**
+   * @param address The host's address. Sockets bind to it.
+   *
+   * @param uplink The link the host sends through.
+   *
+   * @param downlink The link the host receives through.
+   */
+  ASIO_DECL void add_host(const asio::ip::address& address,
+      link_type uplink, link_type downlink);
+
+  /// The number of datagrams a link has dropped, by queue overflow or loss.
+  ASIO_DECL std::size_t dropped(link_type link) const;
+
+private:
+  friend class simulated_socket;
+  struct core;
+  asio::detail::shared_ptr<core> core_;
+};
+
+/// A datagram socket on a simulated_network.
+/**
+ * The socket provides the subset of the asio::ip::udp::socket interface that
+ * asio::rudp::basic_multiplexer uses.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class simulated_socket
+  : private asio::detail::noncopyable
+{
+public:
+  /// The protocol type.
+  typedef asio::ip::udp protocol_type;
+
+  /// The endpoint type.
+  typedef asio::ip::udp::endpoint endpoint_type;
+
+  /// The type of the executor associated with the object.
+  typedef asio::io_service::executor_type executor_type;
+
+  /// Construct a socket bound to an endpoint.
+  /**
+   * @param network The network. Its host with the endpoint's address must
+   * already have been added.
+   *
+   * @param endpoint The local endpoint. A port of zero picks a free port.
+   *
+   * @throws asio::system_error Thrown on failure.
+   */
+  ASIO_DECL simulated_socket(simulated_network& network,
+      const endpoint_type& endpoint);
+
+  /// Destructor. Outstanding receives complete with
+  /// asio::error::operation_aborted.
+  ASIO_DECL ~simulated_socket();
+
+  /// Get the io_service associated with the socket.
+  ASIO_DECL asio::io_service& get_io_service();
+
+  /// Get the executor associated with the socket.
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return get_io_service().get_executor();
+  }
+
+  /// Get the local endpoint.
+  ASIO_DECL endpoint_type local_endpoint() const;
+
+  /// Close the socket.
+  /**
+   * @throws asio::system_error Thrown on failure.
+   */
+  ASIO_DECL void close();
+
+  /// Close the socket.
+  /**
+   * Outstanding receives complete with asio::error::operation_aborted.
+   *
+   * @param ec Set to indicate what error occurred, if any.
+   */
+  ASIO_DECL asio::error_code close(asio::error_code& ec);
+
+  /// Start an asynchronous send.
+  /**
+   * The datagram is handed to the network before this function returns, so
+   * the buffers need not outlive the call. The handler is always called as
+   * if the datagram was sent; whether it arrives is up to the network.
+   *
+   * @param buffers The datagram.
+   *
+   * @param destination The remote endpoint.
+   *
+   * @param handler The handler to be called when the send completes. The
+   * function signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   std::size_t bytes_transferred  // Number of bytes sent.
+   * ); @endcode
+   */
+  template <typename ConstBufferSequence, typename WriteHandler>
+  ASIO_INITFN_RESULT_TYPE(WriteHandler,
+      void (asio::error_code, std::size_t))
+  async_send_to(const ConstBufferSequence& buffers,
+      const endpoint_type& destination,
+      ASIO_MOVE_ARG(WriteHandler) handler);
+
+  /// Start an asynchronous receive.
+  /**
+   * @param buffers The buffers into which the datagram will be received.
+   * Ownership of the underlying memory blocks is retained by the caller,
+   * which must guarantee that they remain valid until the handler is called.
+   *
+   * @param sender_endpoint Set to the sender's endpoint. Ownership is
+   * retained by the caller, which must guarantee that it is valid until the
+   * handler is called.
+   *
+   * @param handler The handler to be called when the receive completes. The
+   * function signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   std::size_t bytes_transferred  // Number of bytes received.
+   * ); @endcode
+   */
+  template <typename MutableBufferSequence, typename ReadHandler>
+  ASIO_INITFN_RESULT_TYPE(ReadHandler,
+      void (asio::error_code, std::size_t))
+  async_receive_from(const MutableBufferSequence& buffers,
+      endpoint_type& sender_endpoint,
+      ASIO_MOVE_ARG(ReadHandler) handler);
+
+private:
+  friend struct simulated_network::core;
+
+  // Hand a datagram to the network, taking its contents, and complete the
+  // send.
+  ASIO_DECL void start_send(std::vector<unsigned char>& datagram,
+      const endpoint_type& destination, detail::datagram_op* op);
+
+  // Complete a receive now if a datagram is waiting, or queue it.
+  ASIO_DECL void start_receive(detail::datagram_op* op);
+
+  asio::detail::shared_ptr<simulated_network::core> core_;
+  endpoint_type endpoint_;
+  bool open_;
+
+  // Received datagrams waiting for a receive, up to receive_buffer_size.
+  enum { receive_buffer_size = 212992 };
+  std::deque<std::pair<endpoint_type, std::vector<unsigned char> > > queue_;
+  std::size_t queued_bytes_;
+  asio::detail::op_queue<detail::datagram_op> ops_;
+};
+
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/rudp/impl/simulated_network.hpp"
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/rudp/impl/simulated_network.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RUDP_SIMULATED_NETWORK_HPP
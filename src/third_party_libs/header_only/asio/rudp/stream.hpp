@@ -0,0 +1,36 @@
+//
+// rudp/stream.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_STREAM_HPP
+#define ASIO_RUDP_STREAM_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#include "asio/ip/udp.hpp"
+#include "asio/rudp/basic_stream.hpp"
+
+namespace asio {
+namespace rudp {
+
+/// Typedef for a stream on a UDP socket.
+typedef basic_stream<asio::ip::udp::socket> stream;
+
+} // namespace rudp
+} // namespace asio
+
+#endif // defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RUDP_STREAM_HPP
@@ -0,0 +1,78 @@
+//
+// rudp/stream_base.hpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUDP_STREAM_BASE_HPP
+#define ASIO_RUDP_STREAM_BASE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace rudp {
+
+/// The stream_base class is used as a base for the asio::rudp::basic_stream
+/// class template so that we have a common place to define various enums.
+class stream_base
+{
+public:
+  /// Congestion controllers.
+  enum congestion_control_type
+  {
+    /// Loss-based control with slow start and additive increase, competing
+    /// evenly with TCP. Suits interactive traffic.
+    reno,
+
+    /// Delay-based control that keeps queueing delay near a small target and
+    /// backs off as soon as other traffic builds a queue. Suits background
+    /// transfers.
+    ledbat
+  };
+
+  /// Transport counters for a connection.
+  struct statistics
+  {
+    /// Smoothed round-trip time, in microseconds.
+    std::size_t smoothed_rtt;
+
+    /// Smallest round-trip time seen, in microseconds.
+    std::size_t min_rtt;
+
+    /// Congestion window, in bytes.
+    std::size_t congestion_window;
+
+    /// Bytes of data sent, including retransmissions.
+    std::size_t bytes_sent;
+
+    /// Bytes of data retransmitted.
+    std::size_t bytes_retransmitted;
+
+    /// Number of retransmission timeouts.
+    std::size_t timeouts;
+  };
+
+protected:
+  /// Protected destructor to prevent deletion through this type.
+  ~stream_base()
+  {
+  }
+};
+
+} // namespace rudp
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_RUDP_STREAM_BASE_HPP
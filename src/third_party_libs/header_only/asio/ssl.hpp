@@ -19,6 +19,7 @@
 #include "asio/ssl/context_base.hpp"
 #include "asio/ssl/error.hpp"
 #include "asio/ssl/rfc2818_verification.hpp"
+#include "asio/ssl/session_cache.hpp"
 #include "asio/ssl/stream.hpp"
 #include "asio/ssl/stream_base.hpp"
 #include "asio/ssl/verify_context.hpp"
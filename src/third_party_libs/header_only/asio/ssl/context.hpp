@@ -198,6 +198,37 @@ public:
   ASIO_DECL asio::error_code set_verify_depth(
       int depth, asio::error_code& ec);
 
+  /// Set the session ID context.
+  /**
+   * This function may be used to name the context in which a server's cached
+   * sessions are valid. OpenSSL only resumes sessions on a server that
+   * verifies its peers once this has been set.
+   *
+   * @param sid_ctx An identifier for the application or service, at most
+   * 32 bytes long.
+   *
+   * @throws asio::system_error Thrown on failure.
+   *
+   * @note Calls @c SSL_CTX_set_session_id_context.
+   */
+  ASIO_DECL void set_session_id_context(const std::string& sid_ctx);
+
+  /// Set the session ID context.
+  /**
+   * This function may be used to name the context in which a server's cached
+   * sessions are valid. OpenSSL only resumes sessions on a server that
+   * verifies its peers once this has been set.
+   *
+   * @param sid_ctx An identifier for the application or service, at most
+   * 32 bytes long.
+   *
+   * @param ec Set to indicate what error occurred, if any.
+   *
+   * @note Calls @c SSL_CTX_set_session_id_context.
+   */
+  ASIO_DECL asio::error_code set_session_id_context(
+      const std::string& sid_ctx, asio::error_code& ec);
+
   /// Set the callback used to verify peer certificates.
   /**
    * This function is used to specify a callback function that will be called
@@ -0,0 +1,276 @@
+//
+// ssl/detail/impl/kernel_tls.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_SSL_DETAIL_IMPL_KERNEL_TLS_IPP
+#define ASIO_SSL_DETAIL_IMPL_KERNEL_TLS_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include "asio/error.hpp"
+#include "asio/ssl/detail/kernel_tls.hpp"
+#include "asio/ssl/error.hpp"
+
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+# include <openssl/kdf.h>
+# define ASIO_SSL_HAS_TLS12_KEY_EXPORT 1
+#endif // (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+
+// Kernel TLS is experimental, and is only compiled in on request.
+#if defined(__linux__) && defined(ASIO_SSL_HAS_TLS12_KEY_EXPORT) \
+  && defined(ASIO_SSL_ENABLE_KERNEL_TLS)
+# include <linux/tls.h>
+# include <netinet/tcp.h>
+# include <sys/socket.h>
+# if !defined(SOL_TLS)
+#  define SOL_TLS 282
+# endif // !defined(SOL_TLS)
+# if !defined(TCP_ULP)
+#  define TCP_ULP 31
+# endif // !defined(TCP_ULP)
+# define ASIO_SSL_HAS_KERNEL_TLS 1
+#endif // defined(__linux__) && defined(ASIO_SSL_HAS_TLS12_KEY_EXPORT)
+       //   && defined(ASIO_SSL_ENABLE_KERNEL_TLS)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace ssl {
+namespace detail {
+
+asio::error_code export_tls12_keys(SSL* ssl,
+    tls_record_keys& tx, tls_record_keys& rx, asio::error_code& ec)
+{
+#if defined(ASIO_SSL_HAS_TLS12_KEY_EXPORT)
+  const SSL_CIPHER* cipher = ::SSL_get_current_cipher(ssl);
+  int nid = cipher ? ::SSL_CIPHER_get_cipher_nid(cipher) : NID_undef;
+  std::size_t key_size = nid == NID_aes_128_gcm ? 16
+    : nid == NID_aes_256_gcm ? 32 : 0;
+
+  // The record sequence numbers are not exposed, but after a TLS 1.2
+  // handshake each direction has carried exactly one encrypted record, the
+  // Finished message, provided nothing has been sent since.
+  if (::SSL_version(ssl) != TLS1_2_VERSION || key_size == 0
+      || !::SSL_is_init_finished(ssl) || ::SSL_has_pending(ssl)
+      || ::BIO_ctrl_pending(::SSL_get_rbio(ssl)) != 0
+      || ::BIO_ctrl_wpending(::SSL_get_wbio(ssl)) != 0)
+  {
+    ec = asio::error::operation_not_supported;
+    return ec;
+  }
+
+  unsigned char master_key[SSL_MAX_MASTER_KEY_LENGTH];
+  std::size_t master_key_size = ::SSL_SESSION_get_master_key(
+      ::SSL_get_session(ssl), master_key, sizeof(master_key));
+  unsigned char client_random[SSL3_RANDOM_SIZE];
+  unsigned char server_random[SSL3_RANDOM_SIZE];
+  ::SSL_get_client_random(ssl, client_random, sizeof(client_random));
+  ::SSL_get_server_random(ssl, server_random, sizeof(server_random));
+
+  // RFC 5246 section 6.3. AEAD ciphers have no MAC keys, and the block holds
+  // client key, server key, client salt, server salt.
+  static const char label[] = "key expansion";
+  unsigned char key_block[2 * 32 + 2 * 4];
+  std::size_t key_block_size = 2 * key_size + 2 * 4;
+  EVP_PKEY_CTX* pctx = ::EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, 0);
+  bool derived = pctx
+    && ::EVP_PKEY_derive_init(pctx) > 0
+    && ::EVP_PKEY_CTX_set_tls1_prf_md(pctx,
+      ::SSL_CIPHER_get_handshake_digest(cipher)) > 0
+    && ::EVP_PKEY_CTX_set1_tls1_prf_secret(pctx,
+      master_key, static_cast<int>(master_key_size)) > 0
+    && ::EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+      reinterpret_cast<const unsigned char*>(label), sizeof(label) - 1) > 0
+    && ::EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+      server_random, sizeof(server_random)) > 0
+    && ::EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+      client_random, sizeof(client_random)) > 0
+    && ::EVP_PKEY_derive(pctx, key_block, &key_block_size) > 0;
+  ::EVP_PKEY_CTX_free(pctx);
+  ::OPENSSL_cleanse(master_key, sizeof(master_key));
+  if (!derived)
+  {
+    ec = asio::error_code(static_cast<int>(::ERR_get_error()),
+        asio::error::get_ssl_category());
+    return ec;
+  }
+
+  bool server = ::SSL_is_server(ssl) != 0;
+  tls_record_keys* client = server ? &rx : &tx;
+  tls_record_keys* server_keys = server ? &tx : &rx;
+  tls_record_keys* keys[2] = { client, server_keys };
+  for (int i = 0; i < 2; ++i)
+  {
+    keys[i]->version = TLS1_2_VERSION;
+    keys[i]->cipher_nid = nid;
+    keys[i]->key_size = key_size;
+    std::memcpy(keys[i]->key, key_block + i * key_size, key_size);
+    std::memcpy(keys[i]->salt, key_block + 2 * key_size + i * 4, 4);
+    std::memset(keys[i]->sequence, 0, sizeof(keys[i]->sequence));
+    keys[i]->sequence[7] = 1;
+  }
+  ::OPENSSL_cleanse(key_block, sizeof(key_block));
+
+  ec = asio::error_code();
+  return ec;
+#else // defined(ASIO_SSL_HAS_TLS12_KEY_EXPORT)
+  (void)ssl;
+  (void)tx;
+  (void)rx;
+  ec = asio::error::operation_not_supported;
+  return ec;
+#endif // defined(ASIO_SSL_HAS_TLS12_KEY_EXPORT)
+}
+
+#if defined(ASIO_SSL_HAS_KERNEL_TLS)
+// Returns 0 on success, otherwise the errno value.
+template <typename CryptoInfo>
+inline int set_kernel_tls_keys(asio::detail::socket_type s,
+    int direction, int cipher_type, const tls_record_keys& keys)
+{
+  CryptoInfo info;
+  std::memset(&info, 0, sizeof(info));
+  info.info.version = TLS_1_2_VERSION;
+  info.info.cipher_type = cipher_type;
+  std::memcpy(info.key, keys.key, sizeof(info.key));
+  std::memcpy(info.salt, keys.salt, sizeof(info.salt));
+  // The GCM nonce is the salt (the implicit IV from the key block) followed
+  // by an 8-byte explicit part carried in each record (RFC 5288). When
+  // receiving, the kernel takes that part from the records and ignores iv.
+  // When sending, iv is the explicit part of the first record it sends, and
+  // it is incremented per record along with rec_seq.
+  //
+  // OpenSSL does not use the sequence number as the explicit part. Its GCM
+  // IV generator starts from a random value it does not expose, and has used
+  // it only for the Finished record. Here the explicit part instead starts at
+  // the sequence number of the next record, as RFC 5288 suggests; the peer
+  // accepts any value. A nonce repeats only if OpenSSL's random start equals
+  // one of the sequence numbers the kernel goes on to use.
+  std::memcpy(info.iv, keys.sequence, sizeof(info.iv));
+  std::memcpy(info.rec_seq, keys.sequence, sizeof(info.rec_seq));
+  int result = ::setsockopt(s, SOL_TLS, direction, &info, sizeof(info));
+  int error = result == 0 ? 0 : errno;
+  ::OPENSSL_cleanse(&info, sizeof(info));
+  return error;
+}
+
+inline int set_kernel_tls_keys(asio::detail::socket_type s,
+    int direction, const tls_record_keys& keys)
+{
+  if (keys.cipher_nid == NID_aes_128_gcm)
+    return set_kernel_tls_keys<tls12_crypto_info_aes_gcm_128>(
+        s, direction, TLS_CIPHER_AES_GCM_128, keys);
+  return set_kernel_tls_keys<tls12_crypto_info_aes_gcm_256>(
+      s, direction, TLS_CIPHER_AES_GCM_256, keys);
+}
+
+// The errors with which kernels lacking the tls module, receive support
+// (before 4.17) or a cipher reject the setup.
+inline bool is_kernel_tls_unsupported(int error)
+{
+  return error == ENOENT || error == ENOPROTOOPT
+    || error == EOPNOTSUPP || error == EINVAL;
+}
+
+#endif // defined(ASIO_SSL_HAS_KERNEL_TLS)
+
+asio::error_code enable_kernel_tls(SSL* ssl,
+    asio::detail::socket_type s, asio::error_code& ec)
+{
+#if defined(ASIO_SSL_HAS_KERNEL_TLS)
+  tls_record_keys tx, rx;
+  if (export_tls12_keys(ssl, tx, rx, ec))
+    return ec;
+
+  // Until keys are installed the upper layer protocol passes data straight
+  // through, so the stream is still usable if either of the first two steps
+  // fails. Receive support came later than transmit, so it goes first.
+  static const char ulp[] = "tls";
+  int error = ::setsockopt(s, IPPROTO_TCP, TCP_ULP, ulp, sizeof(ulp)) == 0
+    ? 0 : errno;
+  if (error == 0)
+    error = set_kernel_tls_keys(s, TLS_RX, rx);
+  bool partial = false;
+  if (error == 0)
+  {
+    error = set_kernel_tls_keys(s, TLS_TX, tx);
+    partial = error != 0;
+  }
+  ::OPENSSL_cleanse(&tx, sizeof(tx));
+  ::OPENSSL_cleanse(&rx, sizeof(rx));
+  if (error != 0)
+  {
+    if (!partial && is_kernel_tls_unsupported(error))
+      ec = asio::error::operation_not_supported;
+    else
+      ec = asio::error_code(error, asio::error::get_system_category());
+    return ec;
+  }
+
+  // Keep OpenSSL from acting on a connection it no longer drives.
+  ::SSL_set_quiet_shutdown(ssl, 1);
+  ec = asio::error_code();
+  return ec;
+#else // defined(ASIO_SSL_HAS_KERNEL_TLS)
+  (void)ssl;
+  (void)s;
+  ec = asio::error::operation_not_supported;
+  return ec;
+#endif // defined(ASIO_SSL_HAS_KERNEL_TLS)
+}
+
+asio::error_code kernel_tls_close_notify(
+    asio::detail::socket_type s, asio::error_code& ec)
+{
+#if defined(ASIO_SSL_HAS_KERNEL_TLS)
+  // A warning-level close_notify alert, sent as a record of type alert.
+  unsigned char alert[2] = { 1, 0 };
+  unsigned char record_type = 21;
+  char control[CMSG_SPACE(sizeof(record_type))];
+  std::memset(control, 0, sizeof(control));
+  iovec iov = { alert, sizeof(alert) };
+  msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(record_type));
+  std::memcpy(CMSG_DATA(cmsg), &record_type, sizeof(record_type));
+  if (::sendmsg(s, &msg, MSG_NOSIGNAL) < 0)
+  {
+    ec = asio::error_code(errno, asio::error::get_system_category());
+    return ec;
+  }
+
+  ec = asio::error_code();
+  return ec;
+#else // defined(ASIO_SSL_HAS_KERNEL_TLS)
+  (void)s;
+  ec = asio::error::operation_not_supported;
+  return ec;
+#endif // defined(ASIO_SSL_HAS_KERNEL_TLS)
+}
+
+} // namespace detail
+} // namespace ssl
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_SSL_DETAIL_IMPL_KERNEL_TLS_IPP
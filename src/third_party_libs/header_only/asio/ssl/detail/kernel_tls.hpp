@@ -0,0 +1,76 @@
+//
+// ssl/detail/kernel_tls.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_SSL_DETAIL_KERNEL_TLS_HPP
+#define ASIO_SSL_DETAIL_KERNEL_TLS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#include <cstddef>
+#include "asio/detail/socket_types.hpp"
+#include "asio/error_code.hpp"
+#include "asio/ssl/detail/openssl_types.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace ssl {
+namespace detail {
+
+// The symmetric state for one direction of an established TLS connection.
+struct tls_record_keys
+{
+  int version;
+  int cipher_nid;
+  std::size_t key_size;
+  unsigned char key[32];
+
+  // The implicit part of the AES-GCM nonce.
+  unsigned char salt[4];
+
+  // The big-endian sequence number of the next record.
+  unsigned char sequence[8];
+};
+
+// Derive the record keys of a TLS 1.2 AES-GCM connection whose handshake has
+// just completed and which has not yet carried application data. Fails with
+// operation_not_supported for other versions and ciphers, or if records are
+// still buffered in the SSL object.
+ASIO_DECL asio::error_code export_tls12_keys(SSL* ssl,
+    tls_record_keys& tx, tls_record_keys& rx, asio::error_code& ec);
+
+// Install the connection's record keys on the socket with the Linux TLS upper
+// layer protocol, so that the socket reads and writes plaintext. Fails with
+// operation_not_supported, leaving the socket as it was, if the kernel can't
+// offload both directions or ASIO_SSL_ENABLE_KERNEL_TLS is not defined. Any
+// other error may leave the receive side offloaded and the connection
+// unusable.
+ASIO_DECL asio::error_code enable_kernel_tls(SSL* ssl,
+    asio::detail::socket_type s, asio::error_code& ec);
+
+// Send a close_notify alert on a socket using kernel TLS.
+ASIO_DECL asio::error_code kernel_tls_close_notify(
+    asio::detail::socket_type s, asio::error_code& ec);
+
+} // namespace detail
+} // namespace ssl
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/ssl/detail/impl/kernel_tls.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_SSL_DETAIL_KERNEL_TLS_HPP
@@ -39,6 +39,7 @@ struct stream_core
 
   stream_core(SSL_CTX* context, asio::io_service& io_service)
     : engine_(context),
+      kernel_tls_(false),
       pending_read_(io_service),
       pending_write_(io_service),
       output_buffer_space_(max_tls_record_size),
@@ -57,6 +58,10 @@ struct stream_core
   // The SSL engine.
   engine engine_;
 
+  // Whether record encryption has been handed over to the kernel, after which
+  // reads and writes go straight to the transport.
+  bool kernel_tls_;
+
 #if defined(ASIO_HAS_BOOST_DATE_TIME)
   // Timer used for storing queued read operations.
   asio::deadline_timer pending_read_;
@@ -303,6 +303,32 @@ asio::error_code context::set_verify_depth(
   return ec;
 }
 
+void context::set_session_id_context(const std::string& sid_ctx)
+{
+  asio::error_code ec;
+  set_session_id_context(sid_ctx, ec);
+  asio::detail::throw_error(ec, "set_session_id_context");
+}
+
+asio::error_code context::set_session_id_context(
+    const std::string& sid_ctx, asio::error_code& ec)
+{
+  ::ERR_clear_error();
+
+  if (::SSL_CTX_set_session_id_context(handle_,
+        reinterpret_cast<const unsigned char*>(sid_ctx.data()),
+        static_cast<unsigned int>(sid_ctx.size())) != 1)
+  {
+    ec = asio::error_code(
+        static_cast<int>(::ERR_get_error()),
+        asio::error::get_ssl_category());
+    return ec;
+  }
+
+  ec = asio::error_code();
+  return ec;
+}
+
 void context::load_verify_file(const std::string& filename)
 {
   asio::error_code ec;
@@ -0,0 +1,148 @@
+//
+// ssl/impl/session_cache.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_SSL_IMPL_SESSION_CACHE_IPP
+#define ASIO_SSL_IMPL_SESSION_CACHE_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#include "asio/detail/static_mutex.hpp"
+#include "asio/ssl/session_cache.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace ssl {
+
+session_cache::session_cache(context& ctx, std::size_t max_sessions)
+  : ctx_(ctx.native_handle()),
+    max_sessions_(max_sessions ? max_sessions : 1)
+{
+  ::SSL_CTX_set_ex_data(ctx_, cache_index(), this);
+  ::SSL_CTX_set_session_cache_mode(ctx_,
+      SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  ::SSL_CTX_sess_set_new_cb(ctx_, &session_cache::new_session_callback);
+}
+
+session_cache::~session_cache()
+{
+  ::SSL_CTX_sess_set_new_cb(ctx_, 0);
+  ::SSL_CTX_set_ex_data(ctx_, cache_index(), 0);
+  for (list_type::iterator i = sessions_.begin(); i != sessions_.end(); ++i)
+    ::SSL_SESSION_free(i->second);
+}
+
+void session_cache::prepare(SSL* ssl, const std::string& key)
+{
+  int slot = key_index();
+  delete static_cast<std::string*>(::SSL_get_ex_data(ssl, slot));
+  ::SSL_set_ex_data(ssl, slot, new std::string(key));
+
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  std::map<std::string, list_type::iterator>::iterator i = index_.find(key);
+  if (i != index_.end())
+  {
+    sessions_.splice(sessions_.begin(), sessions_, i->second);
+    ::SSL_set_session(ssl, i->second->second);
+  }
+}
+
+void session_cache::erase(const std::string& key)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  std::map<std::string, list_type::iterator>::iterator i = index_.find(key);
+  if (i != index_.end())
+  {
+    ::SSL_SESSION_free(i->second->second);
+    sessions_.erase(i->second);
+    index_.erase(i);
+  }
+}
+
+std::size_t session_cache::size() const
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  return index_.size();
+}
+
+int session_cache::key_index()
+{
+  static asio::detail::static_mutex mutex = ASIO_STATIC_MUTEX_INIT;
+  static int index = -1;
+  mutex.init();
+  asio::detail::static_mutex::scoped_lock lock(mutex);
+  if (index < 0)
+    index = ::SSL_get_ex_new_index(0, 0, 0, 0, &session_cache::free_key);
+  return index;
+}
+
+int session_cache::cache_index()
+{
+  static asio::detail::static_mutex mutex = ASIO_STATIC_MUTEX_INIT;
+  static int index = -1;
+  mutex.init();
+  asio::detail::static_mutex::scoped_lock lock(mutex);
+  if (index < 0)
+    index = ::SSL_CTX_get_ex_new_index(0, 0, 0, 0, 0);
+  return index;
+}
+
+void session_cache::free_key(void*, void* ptr,
+    CRYPTO_EX_DATA*, int, long, void*)
+{
+  delete static_cast<std::string*>(ptr);
+}
+
+int session_cache::new_session_callback(SSL* ssl, SSL_SESSION* session)
+{
+  std::string* key = static_cast<std::string*>(
+      ::SSL_get_ex_data(ssl, key_index()));
+  session_cache* cache = static_cast<session_cache*>(
+      ::SSL_CTX_get_ex_data(::SSL_get_SSL_CTX(ssl), cache_index()));
+  if (!key || !cache)
+    return 0;
+
+  // Returning 1 keeps the reference OpenSSL passed in.
+  cache->insert(*key, session);
+  return 1;
+}
+
+void session_cache::insert(const std::string& key, SSL_SESSION* session)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  std::map<std::string, list_type::iterator>::iterator i = index_.find(key);
+  if (i != index_.end())
+  {
+    ::SSL_SESSION_free(i->second->second);
+    i->second->second = session;
+    sessions_.splice(sessions_.begin(), sessions_, i->second);
+    return;
+  }
+
+  sessions_.push_front(std::make_pair(key, session));
+  index_[key] = sessions_.begin();
+  if (index_.size() > max_sessions_)
+  {
+    ::SSL_SESSION_free(sessions_.back().second);
+    index_.erase(sessions_.back().first);
+    sessions_.pop_back();
+  }
+}
+
+} // namespace ssl
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_SSL_IMPL_SESSION_CACHE_IPP
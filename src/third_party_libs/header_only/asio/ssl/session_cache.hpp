@@ -0,0 +1,137 @@
+//
+// ssl/session_cache.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_SSL_SESSION_CACHE_HPP
+#define ASIO_SSL_SESSION_CACHE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#include <list>
+#include <map>
+#include <string>
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/ssl/context.hpp"
+#include "asio/ssl/detail/openssl_types.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace ssl {
+
+/// A client-side cache of TLS sessions for fast resumption.
+/**
+ * The cache remembers the most recent session established with each server,
+ * identified by a key chosen by the application (typically "host:port"), and
+ * offers it on the next connection to that server so that the handshake can
+ * skip the key exchange. Sessions are captured from OpenSSL's new-session
+ * callback, so TLS 1.3 tickets that arrive after the handshake are cached as
+ * well as TLS 1.2 session IDs and tickets.
+ *
+ * A cache is attached to one client context and may be shared by all streams
+ * created from it. Servers need no cache object: OpenSSL keeps a server-side
+ * session cache in each context and issues session tickets by default; see
+ * context::set_session_id_context().
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ *
+ * @par Example
+ * @code
+ * asio::ssl::context ctx(asio::ssl::context::tlsv12_client);
+ * asio::ssl::session_cache cache(ctx);
+ * ...
+ * asio::ssl::stream<asio::ip::tcp::socket> sock(io_service, ctx);
+ * cache.prepare(sock.native_handle(), "example.com:443");
+ * asio::connect(sock.lowest_layer(), endpoints);
+ * sock.handshake(asio::ssl::stream_base::client);
+ * bool resumed = SSL_session_reused(sock.native_handle()) != 0;
+ * @endcode
+ */
+class session_cache
+  : private noncopyable
+{
+public:
+  /// Construct a cache and attach it to a client context.
+  /**
+   * @param ctx The context. It must outlive the cache, and the cache must
+   * outlive every stream created from the context.
+   *
+   * @param max_sessions The number of servers to remember. When full, the
+   * least recently used entry is dropped.
+   *
+   * @note Calls @c SSL_CTX_set_session_cache_mode and
+   * @c SSL_CTX_sess_set_new_cb.
+   */
+  ASIO_DECL explicit session_cache(context& ctx,
+      std::size_t max_sessions = 1024);
+
+  /// Destructor.
+  ASIO_DECL ~session_cache();
+
+  /// Prepare a client connection for resumption.
+  /**
+   * Offers the cached session for @c key, if any, and arranges for sessions
+   * the connection receives to be cached under @c key. Must be called before
+   * the handshake.
+   *
+   * @param ssl The stream's native handle.
+   *
+   * @param key Identifies the server.
+   */
+  ASIO_DECL void prepare(SSL* ssl, const std::string& key);
+
+  /// Forget the session cached for @c key.
+  ASIO_DECL void erase(const std::string& key);
+
+  /// The number of cached sessions.
+  ASIO_DECL std::size_t size() const;
+
+private:
+  typedef std::list<std::pair<std::string, SSL_SESSION*> > list_type;
+
+  // Index of the ex_data slot holding a connection's key.
+  ASIO_DECL static int key_index();
+
+  // Index of the ex_data slot holding a context's cache.
+  ASIO_DECL static int cache_index();
+
+  // Frees a connection's key.
+  ASIO_DECL static void free_key(void* parent, void* ptr,
+      CRYPTO_EX_DATA* ad, int idx, long argl, void* argp);
+
+  // Called by OpenSSL when a connection receives a session.
+  ASIO_DECL static int new_session_callback(SSL* ssl, SSL_SESSION* session);
+
+  // Store a session, taking ownership of the caller's reference.
+  ASIO_DECL void insert(const std::string& key, SSL_SESSION* session);
+
+  SSL_CTX* ctx_;
+  std::size_t max_sessions_;
+  mutable asio::detail::mutex mutex_;
+  list_type sessions_;
+  std::map<std::string, list_type::iterator> index_;
+};
+
+} // namespace ssl
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/ssl/impl/session_cache.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_SSL_SESSION_CACHE_HPP
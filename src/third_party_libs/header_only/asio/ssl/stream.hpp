@@ -18,14 +18,17 @@
 #include "asio/detail/config.hpp"
 
 #include "asio/async_result.hpp"
+#include "asio/detail/bind_handler.hpp"
 #include "asio/detail/buffer_sequence_adapter.hpp"
 #include "asio/detail/handler_type_requirements.hpp"
 #include "asio/detail/noncopyable.hpp"
 #include "asio/detail/type_traits.hpp"
+#include "asio/post.hpp"
 #include "asio/ssl/context.hpp"
 #include "asio/ssl/detail/buffered_handshake_op.hpp"
 #include "asio/ssl/detail/handshake_op.hpp"
 #include "asio/ssl/detail/io.hpp"
+#include "asio/ssl/detail/kernel_tls.hpp"
 #include "asio/ssl/detail/read_op.hpp"
 #include "asio/ssl/detail/shutdown_op.hpp"
 #include "asio/ssl/detail/stream_core.hpp"
@@ -483,6 +486,74 @@ public:
     return init.result.get();
   }
 
+  /// Hand record encryption over to the kernel.
+  /**
+   * This function installs the connection's symmetric keys on the underlying
+   * socket using Linux kernel TLS. Afterwards reads and writes on the stream
+   * are plain socket calls that move no data through OpenSSL, and the socket
+   * itself may be used with @c sendfile.
+   *
+   * This is experimental, and is compiled in only if ASIO_SSL_ENABLE_KERNEL_TLS
+   * is defined. Otherwise the function always fails with
+   * asio::error::operation_not_supported and the stream is left unchanged.
+   *
+   * It must be called immediately after the handshake, before any data has
+   * been exchanged, on a TLS 1.2 connection using AES-GCM. The lowest layer
+   * must be a socket.
+   *
+   * Once enabled, records other than application data (e.g. the peer's
+   * close_notify alert) make reads fail with an I/O error, and renegotiation
+   * is not possible.
+   *
+   * @throws asio::system_error Thrown on failure. The error is
+   * asio::error::operation_not_supported where the connection, kernel or
+   * platform does not allow it, and the stream remains usable in that case.
+   * After any other error the kernel may already be decrypting received
+   * records, and the stream must be closed.
+   */
+  void enable_kernel_tls()
+  {
+    asio::error_code ec;
+    enable_kernel_tls(ec);
+    asio::detail::throw_error(ec, "enable_kernel_tls");
+  }
+
+  /// Hand record encryption over to the kernel.
+  /**
+   * This function installs the connection's symmetric keys on the underlying
+   * socket using Linux kernel TLS. See enable_kernel_tls().
+   *
+   * @param ec Set to indicate what error occurred, if any. If the connection,
+   * kernel or platform does not allow it, the stream remains usable and @c ec
+   * is set to asio::error::operation_not_supported. After any other error the
+   * stream must be closed.
+   */
+  asio::error_code enable_kernel_tls(asio::error_code& ec)
+  {
+    if (core_.kernel_tls_)
+    {
+      ec = asio::error_code();
+      return ec;
+    }
+
+    if (asio::buffer_size(core_.input_) != 0)
+    {
+      ec = asio::error::operation_not_supported;
+      return ec;
+    }
+
+    if (!detail::enable_kernel_tls(core_.engine_.native_handle(),
+          next_layer_.lowest_layer().native_handle(), ec))
+      core_.kernel_tls_ = true;
+    return ec;
+  }
+
+  /// Determine whether record encryption has been handed over to the kernel.
+  bool kernel_tls() const
+  {
+    return core_.kernel_tls_;
+  }
+
   /// Shut down SSL on the stream.
   /**
    * This function is used to shut down SSL on the stream. The function call
@@ -506,6 +577,10 @@ public:
    */
   asio::error_code shutdown(asio::error_code& ec)
   {
+    if (core_.kernel_tls_)
+      return detail::kernel_tls_close_notify(
+          next_layer_.lowest_layer().native_handle(), ec);
+
     detail::io(next_layer_, core_, detail::shutdown_op(), ec);
     return ec;
   }
@@ -534,6 +609,20 @@ public:
     asio::async_completion<ShutdownHandler,
       void (asio::error_code)> init(handler);
 
+    if (core_.kernel_tls_)
+    {
+      // The alert fits in the socket's send buffer, so is sent immediately.
+      asio::error_code ec;
+      detail::kernel_tls_close_notify(
+          next_layer_.lowest_layer().native_handle(), ec);
+      asio::post(next_layer_.lowest_layer().get_executor(),
+          asio::detail::bind_handler(
+            ASIO_MOVE_CAST(ASIO_HANDLER_TYPE(
+              ShutdownHandler, void (asio::error_code)))(
+                init.handler), ec));
+      return init.result.get();
+    }
+
     detail::async_io(next_layer_, core_, detail::shutdown_op(), init.handler);
 
     return init.result.get();
@@ -584,6 +673,9 @@ public:
   std::size_t write_some(const ConstBufferSequence& buffers,
       asio::error_code& ec)
   {
+    if (core_.kernel_tls_)
+      return next_layer_.write_some(buffers, ec);
+
     return detail::io(next_layer_, core_,
         detail::write_op<ConstBufferSequence>(buffers), ec);
   }
@@ -623,8 +715,13 @@ public:
     asio::async_completion<WriteHandler,
       void (asio::error_code, std::size_t)> init(handler);
 
-    detail::async_io(next_layer_, core_,
-        detail::write_op<ConstBufferSequence>(buffers), init.handler);
+    if (core_.kernel_tls_)
+      next_layer_.async_write_some(buffers,
+          ASIO_MOVE_CAST(ASIO_HANDLER_TYPE(WriteHandler,
+            void (asio::error_code, std::size_t)))(init.handler));
+    else
+      detail::async_io(next_layer_, core_,
+          detail::write_op<ConstBufferSequence>(buffers), init.handler);
 
     return init.result.get();
   }
@@ -674,6 +771,9 @@ public:
   std::size_t read_some(const MutableBufferSequence& buffers,
       asio::error_code& ec)
   {
+    if (core_.kernel_tls_)
+      return next_layer_.read_some(buffers, ec);
+
     return detail::io(next_layer_, core_,
         detail::read_op<MutableBufferSequence>(buffers), ec);
   }
@@ -714,8 +814,13 @@ public:
     asio::async_completion<ReadHandler,
       void (asio::error_code, std::size_t)> init(handler);
 
-    detail::async_io(next_layer_, core_,
-        detail::read_op<MutableBufferSequence>(buffers), init.handler);
+    if (core_.kernel_tls_)
+      next_layer_.async_read_some(buffers,
+          ASIO_MOVE_CAST(ASIO_HANDLER_TYPE(ReadHandler,
+            void (asio::error_code, std::size_t)))(init.handler));
+    else
+      detail::async_io(next_layer_, core_,
+          detail::read_op<MutableBufferSequence>(buffers), init.handler);
 
     return init.result.get();
   }
@@ -0,0 +1,301 @@
+//
+// traffic_shaper.hpp
+// ~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_TRAFFIC_SHAPER_HPP
+#define ASIO_TRAFFIC_SHAPER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#include <chrono>
+#include <cstddef>
+#include "asio/async_result.hpp"
+#include "asio/io_service.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/op_queue.hpp"
+#include "asio/detail/shaper_op.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A token bucket which may run into debt, so that a send of any size can go
+// ahead whenever the balance is positive.
+class token_bucket
+{
+public:
+  typedef steady_timer::clock_type clock_type;
+  typedef steady_timer::time_point time_point;
+  typedef steady_timer::duration duration;
+
+  // A rate of zero means unlimited.
+  token_bucket(std::size_t rate, std::size_t burst, const time_point& now)
+    : rate_(static_cast<double>(rate)),
+      burst_(static_cast<double>(burst)),
+      tokens_(static_cast<double>(burst)),
+      last_(now)
+  {
+  }
+
+  bool limited() const
+  {
+    return rate_ > 0;
+  }
+
+  void refill(const time_point& now)
+  {
+    if (rate_ > 0 && now > last_)
+    {
+      tokens_ += rate_ * chrono_seconds(now - last_);
+      if (tokens_ > burst_)
+        tokens_ = burst_;
+    }
+    last_ = now;
+  }
+
+  bool ready() const
+  {
+    return rate_ == 0 || tokens_ > 0;
+  }
+
+  void consume(std::size_t bytes)
+  {
+    if (rate_ > 0)
+      tokens_ -= static_cast<double>(bytes);
+  }
+
+  // The time until ready() becomes true, assuming no further consumption.
+  duration time_until_ready() const
+  {
+    if (ready())
+      return duration::zero();
+    return std::chrono::duration_cast<duration>(
+        std::chrono::duration<double>(-tokens_ / rate_)) + duration(1);
+  }
+
+private:
+  static double chrono_seconds(const duration& d)
+  {
+    return std::chrono::duration_cast<
+      std::chrono::duration<double> >(d).count();
+  }
+
+  double rate_;
+  double burst_;
+  double tokens_;
+  time_point last_;
+};
+
+} // namespace detail
+
+/// Shapes outgoing traffic with hierarchical token buckets.
+/**
+ * A traffic_shaper limits the rate at which many connections write, and
+ * decides which of them goes next when the link is busy. Traffic is limited
+ * at three levels: the link as a whole, each traffic class, and each peer.
+ *
+ * @li Classes are served in priority order. A class may always send at its
+ * guaranteed rate; beyond that it borrows whatever link capacity the other
+ * classes leave, up to its ceiling.
+ *
+ * @li Within a class, peers take turns by deficit round-robin, each turn
+ * granting up to the quantum, so that one greedy peer cannot starve the rest.
+ *
+ * Keeping the link rate a little below the real uplink keeps the queue in
+ * the shaper rather than in socket buffers, which is what lets a small control
+ * message overtake bulk transfers.
+ *
+ * Writes go through a traffic_shaper::peer, either with async_write_shaped()
+ * or by asking for permission with traffic_shaper::peer::async_acquire().
+ *
+ * The shaper and its peers must be destroyed before the io_service.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ *
+ * @par Example
+ * @code
+ * asio::traffic_shaper shaper(io_service, 10 * 1024 * 1024);
+ * asio::traffic_shaper::class_type control = shaper.add_class(
+ *     1024 * 1024, 0, 0);
+ * asio::traffic_shaper::class_type bulk = shaper.add_class(
+ *     0, 0, 1);
+ *
+ * asio::traffic_shaper::peer p(shaper, bulk, 2 * 1024 * 1024);
+ * asio::async_write_shaped(socket, p, asio::buffer(chunk), handler);
+ * @endcode
+ */
+class traffic_shaper
+  : private noncopyable
+{
+public:
+  /// Identifies a traffic class.
+  typedef std::size_t class_type;
+
+  class peer;
+
+  /// Construct a shaper for a link.
+  /**
+   * @param io_service The io_service used to dispatch completion handlers.
+   *
+   * @param bytes_per_second The link rate.
+   *
+   * @param burst The most the link may send at once after being idle. Zero
+   * means the larger of @c quantum and 20 milliseconds at the link rate.
+   *
+   * @param quantum The most a peer is granted per turn.
+   */
+  ASIO_DECL traffic_shaper(asio::io_service& io_service,
+      std::size_t bytes_per_second, std::size_t burst = 0,
+      std::size_t quantum = 16384);
+
+  /// Destructor. Outstanding requests complete with
+  /// asio::error::operation_aborted.
+  ASIO_DECL ~traffic_shaper();
+
+  /// Add a traffic class.
+  /**
+   * @param guaranteed_rate The rate, in bytes per second, the class may
+   * always send at. Zero gives the class only what others leave.
+   *
+   * @param ceiling The most the class may send, in bytes per second,
+   * borrowing included. Zero means the link rate.
+   *
+   * @param priority Lower values are served first, both for guaranteed
+   * traffic and for borrowing.
+   */
+  ASIO_DECL class_type add_class(std::size_t guaranteed_rate,
+      std::size_t ceiling = 0, int priority = 0);
+
+private:
+  struct core;
+  detail::shared_ptr<core> core_;
+};
+
+/// A connection whose writes are shaped.
+/**
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ */
+class traffic_shaper::peer
+  : private noncopyable
+{
+public:
+  /// Construct a peer in a traffic class.
+  /**
+   * @param shaper The shaper.
+   *
+   * @param traffic_class The class, as returned by add_class().
+   *
+   * @param bytes_per_second A limit for this peer alone. Zero means none.
+   */
+  ASIO_DECL peer(traffic_shaper& shaper, class_type traffic_class,
+      std::size_t bytes_per_second = 0);
+
+  /// Destructor. Outstanding requests complete with
+  /// asio::error::operation_aborted.
+  ASIO_DECL ~peer();
+
+  /// Ask for permission to send.
+  /**
+   * Requests are granted in the order they were made for this peer.
+   *
+   * @param max_bytes The amount the caller has to send.
+   *
+   * @param handler The handler to be called when permission is granted.
+   * Copies will be made of the handler as required. The function signature
+   * of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   std::size_t bytes              // The amount that may now be sent,
+   *                                  // at most max_bytes.
+   * ); @endcode
+   */
+  template <typename AcquireHandler>
+  ASIO_INITFN_RESULT_TYPE(AcquireHandler,
+      void (asio::error_code, std::size_t))
+  async_acquire(std::size_t max_bytes,
+      ASIO_MOVE_ARG(AcquireHandler) handler);
+
+  /// Cancel outstanding requests, which complete with
+  /// asio::error::operation_aborted.
+  /**
+   * @returns The number of requests cancelled.
+   */
+  ASIO_DECL std::size_t cancel();
+
+private:
+  friend struct traffic_shaper::core;
+
+  // Queue a request and run the scheduler.
+  ASIO_DECL void start_acquire(detail::shaper_op* op);
+
+  detail::shared_ptr<core> core_;
+  class_type class_;
+  detail::token_bucket bucket_;
+  detail::op_queue<detail::shaper_op> ops_;
+  std::size_t deficit_;
+  bool active_;
+};
+
+/// Start an asynchronous operation to write data through a traffic shaper.
+/**
+ * This function writes all of the supplied data, asking @c p for permission
+ * before each part. It is otherwise equivalent to asio::async_write(), and
+ * the program must likewise ensure that the stream performs no other write
+ * operations until it completes.
+ *
+ * @param s The stream to write to.
+ *
+ * @param p The shaped peer the stream belongs to.
+ *
+ * @param buffers The data to write. Although the buffers object may be
+ * copied as necessary, ownership of the underlying memory blocks is retained
+ * by the caller, which must guarantee that they remain valid until the
+ * handler is called.
+ *
+ * @param handler The handler to be called when the write operation
+ * completes. Copies will be made of the handler as required. The function
+ * signature of the handler must be:
+ * @code void handler(
+ *   const asio::error_code& error, // Result of operation.
+ *   std::size_t bytes_transferred  // Number of bytes written.
+ * ); @endcode
+ */
+template <typename AsyncWriteStream, typename ConstBufferSequence,
+    typename WriteHandler>
+ASIO_INITFN_RESULT_TYPE(WriteHandler,
+    void (asio::error_code, std::size_t))
+async_write_shaped(AsyncWriteStream& s, traffic_shaper::peer& p,
+    const ConstBufferSequence& buffers,
+    ASIO_MOVE_ARG(WriteHandler) handler);
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/traffic_shaper.hpp"
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/traffic_shaper.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_STD_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_TRAFFIC_SHAPER_HPP
@@ -0,0 +1,73 @@
+//
+// use_awaitable.hpp
+// ~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2015 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_USE_AWAITABLE_HPP
+#define ASIO_USE_AWAITABLE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CO_AWAIT) || defined(GENERATING_DOCUMENTATION)
+
+#include "asio/awaitable.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+/// A completion token that makes an asynchronous operation awaitable.
+/**
+ * The use_awaitable_t class, with its value use_awaitable, is used to make
+ * an asynchronous operation's initiating function return an object that can
+ * be awaited with @c co_await inside an asio::awaitable coroutine:
+ *
+ * @code std::size_t n = co_await my_socket.async_read_some(
+ *     my_buffer, asio::use_awaitable); @endcode
+ *
+ * The operation starts when the initiating function is called, and the
+ * result of @c co_await is the operation's result. If the operation's first
+ * argument is an error_code, a failure is thrown as asio::system_error
+ * instead; the remaining arguments are returned, as a @c std::tuple if there
+ * are more than one.
+ *
+ * The operation completes on the coroutine's executor. The token may only be
+ * used from a coroutine whose executor type is @c Executor.
+ */
+template <typename Executor = executor>
+struct use_awaitable_t
+{
+  /// Default constructor.
+  ASIO_CONSTEXPR use_awaitable_t()
+  {
+  }
+};
+
+/// A completion token object that makes an asynchronous operation awaitable.
+/**
+ * See the documentation for asio::use_awaitable_t for a usage example.
+ */
+#if defined(ASIO_HAS_CONSTEXPR) || defined(GENERATING_DOCUMENTATION)
+constexpr use_awaitable_t<> use_awaitable;
+#elif defined(ASIO_MSVC)
+__declspec(selectany) use_awaitable_t<> use_awaitable;
+#endif
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/use_awaitable.hpp"
+
+#endif // defined(ASIO_HAS_CO_AWAIT) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_USE_AWAITABLE_HPP
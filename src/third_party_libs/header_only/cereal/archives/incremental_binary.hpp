@@ -0,0 +1,320 @@
+/*! \file incremental_binary.hpp
+    \brief Binary input archive that decodes from a queue of received buffers */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_INCREMENTAL_BINARY_HPP_
+#define CEREAL_ARCHIVES_INCREMENTAL_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A run of bytes inside a buffer that is kept alive by owner
+  struct BinarySegment
+  {
+    std::shared_ptr<const char> owner;
+    const char * data;
+    std::size_t size;
+  };
+
+  // ######################################################################
+  //! Bytes that an IncrementalBinaryInputArchive loads without copying
+  /*! On the wire this is identical to a std::string or std::vector<char>: a
+      size tag followed by the bytes, so either side of a message can switch
+      to it without the other noticing.
+
+      Loaded by an IncrementalBinaryInputArchive, the result refers directly
+      to the received buffers, as one segment per buffer the bytes spanned.
+      Any other archive loads it into a single new buffer.
+
+      \ingroup OtherTypes */
+  class BinarySegments
+  {
+    public:
+      //! The total number of bytes
+      std::size_t size() const
+      {
+        std::size_t total = 0;
+        for( auto const & segment : itsSegments )
+          total += segment.size;
+        return total;
+      }
+
+      //! The pieces, in order
+      std::vector<BinarySegment> const & segments() const { return itsSegments; }
+
+      //! Copies the bytes to out, which must hold size() bytes
+      void copy( void * out ) const
+      {
+        char * pos = static_cast<char *>( out );
+        for( auto const & segment : itsSegments )
+        {
+          std::memcpy( pos, segment.data, segment.size );
+          pos += segment.size;
+        }
+      }
+
+      //! Appends a segment
+      void append( BinarySegment segment )
+      {
+        if( segment.size )
+          itsSegments.push_back( std::move( segment ) );
+      }
+
+      //! Appends a copy of size bytes
+      void append( const void * data, std::size_t size )
+      {
+        std::shared_ptr<char> copy( new char[size], std::default_delete<char[]>() );
+        std::memcpy( copy.get(), data, size );
+        append( BinarySegment{ copy, copy.get(), size } );
+      }
+
+      //! Releases every segment
+      void clear() { itsSegments.clear(); }
+
+    private:
+      std::vector<BinarySegment> itsSegments;
+  };
+
+  // ######################################################################
+  //! An input archive that decodes data saved by BinaryOutputArchive from buffers as they arrive
+  /*! BinaryInputArchive needs the whole message in a stream before it can
+      start, so a receiver must first collect the complete frame. This
+      archive instead reads from a queue of buffers, and when the queue runs
+      dry it calls a refill function to get the next one. The refill
+      function can block, or suspend the decoding, until more bytes arrive.
+      For example, with asio::spawn it waits on the socket:
+
+      @code{cpp}
+      asio::spawn(strand, [&](asio::yield_context yield)
+      {
+        cereal::IncrementalBinaryInputArchive archive(
+          [&](cereal::IncrementalBinaryInputArchive & ar)
+          {
+            std::shared_ptr<char> buffer(new char[65536], std::default_delete<char[]>());
+            std::size_t received = socket.async_read_some(asio::buffer(buffer.get(), 65536), yield);
+            ar.append(buffer, received);
+            return true;
+          });
+        Message message;
+        archive(message);   // starts on the first buffer, suspends when it needs more
+      });
+      @endcode
+
+      Fields are copied out of a buffer as they are decoded, and the archive
+      releases each buffer once it has read past it. Peak memory is then
+      the decoded message plus the buffers in flight, rather than the whole
+      encoded frame as well. Fields of type BinarySegments take their bytes
+      as references to the buffers instead of copies.
+
+      Bytes left over after the value are kept, so a single archive can
+      decode a sequence of messages from one connection.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class IncrementalBinaryInputArchive : public InputArchive<IncrementalBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Supplies more input by calling append; returns false if there is none
+      typedef std::function<bool ( IncrementalBinaryInputArchive & )> RefillFunction;
+
+      //! Construct, loading from buffers passed to append and then to those supplied by refill
+      /*! Without a refill function, running out of input throws an Exception, as
+          BinaryInputArchive does at the end of its stream. */
+      explicit IncrementalBinaryInputArchive( RefillFunction refill = RefillFunction() ) :
+        InputArchive<IncrementalBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsRefill( std::move( refill ) ),
+        itsAvailable( 0 )
+      { }
+
+      //! Queues size bytes at data, keeping owner alive until they have been read
+      void append( std::shared_ptr<const char> owner, const char * data, std::size_t size )
+      {
+        if( size )
+        {
+          itsBuffers.push_back( BinarySegment{ std::move( owner ), data, size } );
+          itsAvailable += size;
+        }
+      }
+
+      //! Queues the first size bytes of buffer
+      void append( std::shared_ptr<const char> buffer, std::size_t size )
+      {
+        const char * data = buffer.get();
+        append( std::move( buffer ), data, size );
+      }
+
+      //! The number of queued bytes not yet read
+      std::size_t available() const { return itsAvailable; }
+
+      //! Reads size bytes of data
+      void loadBinary( void * const data, std::size_t size )
+      {
+        char * out = static_cast<char *>( data );
+        while( size )
+        {
+          BinarySegment & front = next( size );
+          std::size_t const count = size < front.size ? size : front.size;
+          std::memcpy( out, front.data, count );
+          consume( front, count );
+          out += count;
+          size -= count;
+        }
+      }
+
+      //! Appends the next size bytes to out as references to the queued buffers
+      void loadSegments( std::size_t size, BinarySegments & out )
+      {
+        while( size )
+        {
+          BinarySegment & front = next( size );
+          std::size_t const count = size < front.size ? size : front.size;
+          out.append( BinarySegment{ front.owner, front.data, count } );
+          consume( front, count );
+          size -= count;
+        }
+      }
+
+    private:
+      //! Returns the first queued buffer, refilling until there is one
+      BinarySegment & next( std::size_t wanted )
+      {
+        while( itsBuffers.empty() )
+          if( !itsRefill || !itsRefill( *this ) )
+            throw Exception("Failed to read " + std::to_string(wanted) + " bytes from incremental input! Input ended");
+        return itsBuffers.front();
+      }
+
+      void consume( BinarySegment & front, std::size_t count )
+      {
+        front.data += count;
+        front.size -= count;
+        itsAvailable -= count;
+        if( !front.size )
+          itsBuffers.pop_front();
+      }
+
+      RefillFunction itsRefill;
+      std::deque<BinarySegment> itsBuffers;
+      std::size_t itsAvailable;
+  };
+
+  // ######################################################################
+  // IncrementalBinaryInputArchive serialization functions
+
+  //! Loading for POD types from binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(IncrementalBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to binary
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( IncrementalBinaryInputArchive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to binary
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( IncrementalBinaryInputArchive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Loading binary data
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(IncrementalBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    ar.loadBinary(bd.data, static_cast<std::size_t>(bd.size));
+  }
+
+  // ######################################################################
+  // BinarySegments serialization functions
+
+  //! Saving BinarySegments
+  template <class Archive> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, BinarySegments const & segments )
+  {
+    ar( make_size_tag( static_cast<size_type>( segments.size() ) ) );
+    for( auto const & segment : segments.segments() )
+      ar( binary_data( static_cast<const void *>( segment.data ), segment.size ) );
+  }
+
+  //! Loading BinarySegments into a new buffer
+  template <class Archive> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, BinarySegments & segments )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    segments.clear();
+    if( size )
+    {
+      std::shared_ptr<char> buffer( new char[static_cast<std::size_t>( size )], std::default_delete<char[]>() );
+      ar( binary_data( buffer.get(), static_cast<std::size_t>( size ) ) );
+      segments.append( BinarySegment{ buffer, buffer.get(), static_cast<std::size_t>( size ) } );
+    }
+  }
+
+  //! Loading BinarySegments by reference to the received buffers
+  inline void CEREAL_LOAD_FUNCTION_NAME( IncrementalBinaryInputArchive & ar, BinarySegments & segments )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    segments.clear();
+    ar.loadSegments( static_cast<std::size_t>( size ), segments );
+  }
+
+  namespace traits
+  {
+    namespace detail
+    {
+      //! IncrementalBinaryInputArchive reads what BinaryOutputArchive writes
+      /*! Only this direction is set up, since BinaryOutputArchive already maps back to BinaryInputArchive. */
+      template <> struct get_output_from_input<IncrementalBinaryInputArchive>
+      { using type = BinaryOutputArchive; };
+    }
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::IncrementalBinaryInputArchive)
+
+#endif // CEREAL_ARCHIVES_INCREMENTAL_BINARY_HPP_
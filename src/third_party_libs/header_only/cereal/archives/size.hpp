@@ -0,0 +1,278 @@
+/*! \file size.hpp
+    \brief Computing the encoded size of values for the binary archives */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_SIZE_HPP_
+#define CEREAL_ARCHIVES_SIZE_HPP_
+
+#include <cereal/cereal.hpp>
+#include <array>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace cereal
+{
+  class PortableBinaryOutputArchive;
+
+  // ######################################################################
+  //! An output archive that counts the bytes BinaryOutputArchive would write
+  /*! Saving a value to this archive runs the same serialization functions as
+      BinaryOutputArchive, including class versions and shared pointer ids, but
+      only adds up the sizes.  The result is the exact length of the encoding,
+      so a buffer of that size can be allocated once before the real save.
+
+      PortableBinaryOutputArchive writes the same data after a one byte
+      endianness flag; see serialized_size.
+
+      \ingroup Archives */
+  class SizeArchive : public OutputArchive<SizeArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, with a count of zero
+      SizeArchive() :
+        OutputArchive<SizeArchive, AllowEmptyClassElision>(this),
+        itsSize( 0 )
+      { }
+
+      //! Counts size bytes of data
+      void saveBinary( const void *, std::size_t size )
+      {
+        itsSize += size;
+      }
+
+      //! The number of bytes counted so far
+      std::size_t size() const { return itsSize; }
+
+    private:
+      std::size_t itsSize;
+  };
+
+  // ######################################################################
+  // SizeArchive serialization functions
+
+  //! Counting POD types
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(SizeArchive & ar, T const &)
+  {
+    ar.saveBinary(nullptr, sizeof(T));
+  }
+
+  //! Counting NVP types
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( SizeArchive & ar, NameValuePair<T> const & t )
+  {
+    ar( t.value );
+  }
+
+  //! Counting SizeTags
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( SizeArchive & ar, SizeTag<T> const & t )
+  {
+    ar( t.size );
+  }
+
+  //! Counting binary data
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(SizeArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  namespace traits
+  {
+    // ######################################################################
+    //! The encoded size of T in the binary archives, if it is the same for every value
+    /*! Specializations have a constexpr member value; the primary template has
+        none, meaning the size depends on the value and must be computed with a
+        SizeArchive.  Arithmetic types, enums, and std::array, C arrays,
+        std::pair and std::tuple of such types are covered here.
+
+        A user type may specialize this when its serialization always writes
+        the same number of bytes, e.g. a struct of arithmetic members.  It must
+        not use CEREAL_CLASS_VERSION, since the version is only written the
+        first time the type is saved to an archive.
+
+        @code{cpp}
+        static_assert( cereal::traits::binary_size<std::array<float, 4>>::value == 16, "" );
+        @endcode */
+    template <class T, class SFINAE = void>
+    struct binary_size {};
+
+    namespace detail
+    {
+      template <class T>
+      struct has_binary_size_impl
+      {
+        template <class TT>
+        static std::true_type test( decltype( binary_size<TT>::value ) * );
+        template <class>
+        static std::false_type test( ... );
+        using type = decltype( test<T>( nullptr ) );
+      };
+    }
+
+    //! Checks whether binary_size<T> has a value
+    template <class T>
+    struct has_binary_size : detail::has_binary_size_impl<T>::type {};
+
+    template <class T>
+    struct binary_size<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> :
+      std::integral_constant<std::size_t, sizeof(T)> {};
+
+    template <class T>
+    struct binary_size<T, typename std::enable_if<std::is_enum<T>::value>::type> :
+      std::integral_constant<std::size_t, sizeof(typename std::underlying_type<T>::type)> {};
+
+    template <class T, std::size_t N>
+    struct binary_size<std::array<T, N>, typename std::enable_if<has_binary_size<T>::value>::type> :
+      std::integral_constant<std::size_t, N * binary_size<T>::value> {};
+
+    template <class T, std::size_t N>
+    struct binary_size<T[N], typename std::enable_if<has_binary_size<T>::value>::type> :
+      std::integral_constant<std::size_t, N * binary_size<T>::value> {};
+
+    template <class T1, class T2>
+    struct binary_size<std::pair<T1, T2>, typename std::enable_if<has_binary_size<T1>::value &&
+                                                                  has_binary_size<T2>::value>::type> :
+      std::integral_constant<std::size_t, binary_size<T1>::value + binary_size<T2>::value> {};
+
+    namespace detail
+    {
+      template <class ... Types>
+      struct all_binary_size : std::true_type {};
+
+      template <class T, class ... Types>
+      struct all_binary_size<T, Types...> :
+        std::integral_constant<bool, has_binary_size<T>::value && all_binary_size<Types...>::value> {};
+
+      template <class ... Types>
+      struct sum_binary_size : std::integral_constant<std::size_t, 0> {};
+
+      template <class T, class ... Types>
+      struct sum_binary_size<T, Types...> :
+        std::integral_constant<std::size_t, binary_size<T>::value + sum_binary_size<Types...>::value> {};
+    }
+
+    template <class ... Types>
+    struct binary_size<std::tuple<Types...>, typename std::enable_if<detail::all_binary_size<Types...>::value>::type> :
+      std::integral_constant<std::size_t, detail::sum_binary_size<Types...>::value> {};
+
+    //! The bytes an output archive writes on construction, before any value
+    template <class Archive>
+    struct binary_header_size : std::integral_constant<std::size_t, 0> {};
+
+    //! PortableBinaryOutputArchive starts with its endianness flag
+    template <>
+    struct binary_header_size<PortableBinaryOutputArchive> : std::integral_constant<std::size_t, sizeof(bool)> {};
+  } // namespace traits
+
+  namespace size_detail
+  {
+    //! Values whose size is known at compile time
+    template <class T> inline
+    typename std::enable_if<traits::has_binary_size<T>::value, std::size_t>::type
+    binary_size( T const & )
+    {
+      return traits::binary_size<T>::value;
+    }
+
+    //! Everything else is counted by a SizeArchive
+    template <class T> inline
+    typename std::enable_if<!traits::has_binary_size<T>::value, std::size_t>::type
+    binary_size( T const & t )
+    {
+      SizeArchive ar;
+      ar( t );
+      return ar.size();
+    }
+  }
+
+  // ######################################################################
+  //! Returns the number of bytes an Archive constructed now would write to save t
+  /*! Archive is BinaryOutputArchive or PortableBinaryOutputArchive.  The size
+      is a compile time constant when traits::binary_size<T> is defined, and is
+      otherwise computed with a SizeArchive. */
+  template <class Archive, class T> inline
+  std::size_t serialized_size( T const & t )
+  {
+    return traits::binary_header_size<Archive>::value + size_detail::binary_size( t );
+  }
+
+  // ######################################################################
+  //! A stream buffer over a fixed block of memory
+  /*! Writes past the end of the block fail rather than reallocating, so an
+      archive saving into it throws if the block is too small. */
+  class FixedStreamBuffer : public std::streambuf
+  {
+    public:
+      //! Construct, writing to the size bytes at data
+      FixedStreamBuffer( char * data, std::size_t size )
+      {
+        setp( data, data + size );
+      }
+
+      //! The number of bytes written
+      std::size_t size() const { return static_cast<std::size_t>( pptr() - pbase() ); }
+  };
+
+  // ######################################################################
+  //! Saves t with Archive into a string sized by serialized_size
+  /*! The string is allocated once, at its final size, and the archive writes
+      straight into it without the reallocation and copying a growing
+      std::stringstream does.
+
+      @code{cpp}
+      std::string message = cereal::save_to_string<cereal::BinaryOutputArchive>( value );
+      @endcode */
+  template <class Archive, class T> inline
+  std::string save_to_string( T const & t )
+  {
+    std::size_t const size = serialized_size<Archive>( t );
+    std::string out( size, '\0' );
+
+    FixedStreamBuffer buffer( &out[0], size );
+    std::ostream stream( &buffer );
+    {
+      Archive ar( stream );
+      ar( t );
+    }
+
+    if( buffer.size() != size )
+      throw Exception("Computed a size of " + std::to_string(size) + " bytes but wrote " + std::to_string(buffer.size()));
+
+    return out;
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::SizeArchive)
+
+#endif // CEREAL_ARCHIVES_SIZE_HPP_
@@ -0,0 +1,200 @@
+#ifndef RAPIDJSON_INTERNAL_DIYFP_H_
+#define RAPIDJSON_INTERNAL_DIYFP_H_
+
+#include <cstring>	// memcpy()
+#include <limits>
+
+namespace rapidjson {
+namespace internal {
+
+//! A "do it yourself" floating point number: f * 2^e with a 64-bit significand.
+/*! Used by the Grisu2 double to string conversion in dtoa.h. Products are
+	rounded to the upper 64 bits, so each one is accurate to within half a
+	unit in the last place.
+*/
+struct DiyFp {
+	DiyFp() : f(), e() {}
+
+	DiyFp(uint64_t fp, int exp) : f(fp), e(exp) {}
+
+	//! Exact value of a finite, positive double.
+	explicit DiyFp(double d) {
+		uint64_t u;
+		memcpy(&u, &d, sizeof(u));
+
+		int biased_e = static_cast<int>((u & kDpExponentMask) >> kDpSignificandSize);
+		uint64_t significand = (u & kDpSignificandMask);
+		if (biased_e != 0) {
+			f = significand + kDpHiddenBit;
+			e = biased_e - kDpExponentBias;
+		}
+		else {
+			f = significand;
+			e = kDpMinExponent + 1;
+		}
+	}
+
+	//! The double with this value; f must fit in 53 bits, with the hidden bit set unless e is the denormal exponent.
+	double ToDouble() const {
+		if (e < kDpDenormalExponent)	// Underflow.
+			return 0.0;
+		if (e >= kDpMaxExponent)	// Overflow.
+			return std::numeric_limits<double>::infinity();
+		const uint64_t be = (e == kDpDenormalExponent && (f & kDpHiddenBit) == 0) ? 0 :
+			static_cast<uint64_t>(e + kDpExponentBias);
+		const uint64_t u = (f & kDpSignificandMask) | (be << kDpSignificandSize);
+		double d;
+		memcpy(&d, &u, sizeof(d));
+		return d;
+	}
+
+	DiyFp operator-(const DiyFp& rhs) const {
+		return DiyFp(f - rhs.f, e);
+	}
+
+	DiyFp operator*(const DiyFp& rhs) const {
+#if defined(__GNUC__) && defined(__SIZEOF_INT128__)
+		__extension__ typedef unsigned __int128 uint128;
+		uint128 p = static_cast<uint128>(f) * static_cast<uint128>(rhs.f);
+		uint64_t h = static_cast<uint64_t>(p >> 64);
+		uint64_t l = static_cast<uint64_t>(p);
+		if (l & (static_cast<uint64_t>(1) << 63))	// rounding
+			h++;
+		return DiyFp(h, e + rhs.e + 64);
+#else
+		const uint64_t M32 = 0xFFFFFFFFu;
+		const uint64_t a = f >> 32;
+		const uint64_t b = f & M32;
+		const uint64_t c = rhs.f >> 32;
+		const uint64_t d = rhs.f & M32;
+		const uint64_t ac = a * c;
+		const uint64_t bc = b * c;
+		const uint64_t ad = a * d;
+		const uint64_t bd = b * d;
+		uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+		tmp += 1U << 31;	// round
+		return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+#endif
+	}
+
+	//! Shifts the significand left until its top bit is set; f must not be zero.
+	DiyFp Normalize() const {
+#if defined(__GNUC__)
+		int s = __builtin_clzll(f);
+		return DiyFp(f << s, e - s);
+#else
+		DiyFp res = *this;
+		while (!(res.f & (static_cast<uint64_t>(1) << 63))) {
+			res.f <<= 1;
+			res.e--;
+		}
+		return res;
+#endif
+	}
+
+	DiyFp NormalizeBoundary() const {
+		DiyFp res = *this;
+		while (!(res.f & (kDpHiddenBit << 1))) {
+			res.f <<= 1;
+			res.e--;
+		}
+		res.f <<= (kDiySignificandSize - kDpSignificandSize - 2);
+		res.e = res.e - (kDiySignificandSize - kDpSignificandSize - 2);
+		return res;
+	}
+
+	//! The points halfway to the neighbouring doubles, with a common exponent.
+	void NormalizedBoundaries(DiyFp* minus, DiyFp* plus) const {
+		DiyFp pl = DiyFp((f << 1) + 1, e - 1).NormalizeBoundary();
+		DiyFp mi = (f == kDpHiddenBit) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+		mi.f <<= mi.e - pl.e;
+		mi.e = pl.e;
+		*plus = pl;
+		*minus = mi;
+	}
+
+	static const int kDiySignificandSize = 64;
+	static const int kDpSignificandSize = 52;
+	static const int kDpExponentBias = 0x3FF + kDpSignificandSize;
+	static const int kDpMinExponent = -kDpExponentBias;
+	static const int kDpMaxExponent = 0x7FF - kDpExponentBias;
+	static const int kDpDenormalExponent = -kDpExponentBias + 1;
+	static const uint64_t kDpExponentMask = 0x7FF0000000000000ULL;
+	static const uint64_t kDpSignificandMask = 0x000FFFFFFFFFFFFFULL;
+	static const uint64_t kDpHiddenBit = 0x0010000000000000ULL;
+
+	uint64_t f;
+	int e;
+};
+
+//! Returns 10^(-348 + 8 * index), normalized and rounded to 64 bits.
+inline DiyFp GetCachedPowerByIndex(unsigned index) {
+	// 10^-348, 10^-340, ..., 10^340
+	static const uint64_t kCachedPowers_F[] = {
+		0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+		0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+		0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+		0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+		0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+		0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+		0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+		0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+		0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+		0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+		0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+		0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+		0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+		0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+		0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+		0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+		0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+		0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+		0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+		0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+		0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+		0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+	};
+	static const int16_t kCachedPowers_E[] = {
+		-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+		-901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+		-582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+		-263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+		56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+		375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+		694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+		1013, 1039, 1066
+	};
+	return DiyFp(kCachedPowers_F[index], kCachedPowers_E[index]);
+}
+
+//! Returns a normalized power of ten, c = 10^-K, that brings a number with binary exponent e into range for Grisu2.
+/*!	\param e Binary exponent of the number to be scaled.
+	\param K Receives the decimal exponent of the power's reciprocal.
+	\return The cached power 10^-K, rounded to 64 bits.
+*/
+inline DiyFp GetCachedPower(int e, int* K) {
+	double dk = (-61 - e) * 0.30102999566398114 + 347;	// dk must be positive, so can do ceiling in positive
+	int k = static_cast<int>(dk);
+	if (dk - k > 0.0)
+		k++;
+
+	unsigned index = static_cast<unsigned>((k >> 3) + 1);
+	*K = -(-348 + static_cast<int>(index << 3));	// decimal exponent no need lookup table
+
+	return GetCachedPowerByIndex(index);
+}
+
+//! Returns the largest cached power of ten 10^outExp with outExp <= exp.
+/*!	\param exp Decimal exponent, at least -348.
+	\param outExp Receives the exponent of the power returned; exp - outExp is in [0, 8).
+*/
+inline DiyFp GetCachedPower10(int exp, int* outExp) {
+	unsigned index = static_cast<unsigned>(exp + 348) / 8u;
+	*outExp = -348 + static_cast<int>(index) * 8;
+	return GetCachedPowerByIndex(index);
+}
+
+} // namespace internal
+} // namespace rapidjson
+
+#endif // RAPIDJSON_INTERNAL_DIYFP_H_
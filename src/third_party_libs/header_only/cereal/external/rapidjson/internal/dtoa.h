@@ -0,0 +1,198 @@
+#ifndef RAPIDJSON_INTERNAL_DTOA_H_
+#define RAPIDJSON_INTERNAL_DTOA_H_
+
+// Grisu2 from Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+// Accurately with Integers", PLDI 2010, as implemented by Milo Yip.
+
+#include "diyfp.h"
+#include <cmath>	// signbit()
+
+namespace rapidjson {
+namespace internal {
+
+inline void GrisuRound(char* buffer, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+	while (rest < wp_w && delta - rest >= ten_kappa &&
+		   (rest + ten_kappa < wp_w ||	/// closer
+			wp_w - rest > rest + ten_kappa - wp_w)) {
+		buffer[len - 1]--;
+		rest += ten_kappa;
+	}
+}
+
+inline int CountDecimalDigit32(uint32_t n) {
+	// Simple pure C++ implementation was faster than __builtin_clz version in this situation.
+	if (n < 10) return 1;
+	if (n < 100) return 2;
+	if (n < 1000) return 3;
+	if (n < 10000) return 4;
+	if (n < 100000) return 5;
+	if (n < 1000000) return 6;
+	if (n < 10000000) return 7;
+	if (n < 100000000) return 8;
+	if (n < 1000000000) return 9;
+	return 10;
+}
+
+inline void DigitGen(const DiyFp& W, const DiyFp& Mp, uint64_t delta, char* buffer, int* len, int* K) {
+	static const uint64_t kPow10[] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+									   1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+									   10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+									   10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+									   10000000000000000000ULL };
+	const DiyFp one(static_cast<uint64_t>(1) << -Mp.e, Mp.e);
+	const DiyFp wp_w = Mp - W;
+	uint32_t p1 = static_cast<uint32_t>(Mp.f >> -one.e);
+	uint64_t p2 = Mp.f & (one.f - 1);
+	int kappa = CountDecimalDigit32(p1);	// kappa in [0, 9]
+	*len = 0;
+
+	while (kappa > 0) {
+		const uint32_t divisor = static_cast<uint32_t>(kPow10[kappa - 1]);
+		const uint32_t d = p1 / divisor;
+		p1 %= divisor;
+		if (d || *len)
+			buffer[(*len)++] = static_cast<char>('0' + d);
+		kappa--;
+		uint64_t tmp = (static_cast<uint64_t>(p1) << -one.e) + p2;
+		if (tmp <= delta) {
+			*K += kappa;
+			GrisuRound(buffer, *len, delta, tmp, kPow10[kappa] << -one.e, wp_w.f);
+			return;
+		}
+	}
+
+	// kappa = 0
+	for (;;) {
+		p2 *= 10;
+		delta *= 10;
+		char d = static_cast<char>(p2 >> -one.e);
+		if (d || *len)
+			buffer[(*len)++] = static_cast<char>('0' + d);
+		p2 &= one.f - 1;
+		kappa--;
+		if (p2 < delta) {
+			*K += kappa;
+			int index = -kappa;
+			GrisuRound(buffer, *len, delta, p2, one.f, wp_w.f * (index < 20 ? kPow10[index] : 0));
+			return;
+		}
+	}
+}
+
+//! Generates the shortest digits that read back as value.
+/*!	\param value A finite, positive double.
+	\param buffer Receives the digits, at most 17, without a terminator.
+	\param length Receives the number of digits.
+	\param K Receives the decimal exponent: value is buffer * 10^K.
+*/
+inline void Grisu2(double value, char* buffer, int* length, int* K) {
+	const DiyFp v(value);
+	DiyFp w_m, w_p;
+	v.NormalizedBoundaries(&w_m, &w_p);
+
+	const DiyFp c_mk = GetCachedPower(w_p.e, K);
+	const DiyFp W = v.Normalize() * c_mk;
+	DiyFp Wp = w_p * c_mk;
+	DiyFp Wm = w_m * c_mk;
+	Wm.f++;
+	Wp.f--;
+	DigitGen(W, Wp, Wp.f - Wm.f, buffer, length, K);
+}
+
+inline char* WriteExponent(int K, char* buffer) {
+	*buffer++ = 'e';
+	if (K < 0) {
+		*buffer++ = '-';
+		K = -K;
+	}
+	else
+		*buffer++ = '+';
+
+	if (K >= 100) {
+		*buffer++ = static_cast<char>('0' + K / 100);
+		K %= 100;
+	}
+	*buffer++ = static_cast<char>('0' + K / 10);
+	*buffer++ = static_cast<char>('0' + K % 10);
+	return buffer;
+}
+
+//! Lays out the digits as printf's %g does.
+/*!	\param buffer Holds length digits whose value is buffer * 10^k; see dtoa() for its size.
+	\param precision Decimal exponents from -4 up to precision - 1 are written without an exponent.
+	\return The end of the output.
+*/
+inline char* Prettify(char* buffer, int length, int k, int precision) {
+	// %g never shows trailing zeros in the significand
+	while (length > 1 && buffer[length - 1] == '0') {
+		length--;
+		k++;
+	}
+
+	const int kk = length + k;	// 10^(kk-1) <= v < 10^kk
+	const int exp10 = kk - 1;
+
+	if (exp10 < -4 || exp10 >= precision) {
+		// 1.2345e+67
+		if (length > 1) {
+			memmove(&buffer[2], &buffer[1], static_cast<size_t>(length - 1));
+			buffer[1] = '.';
+			length++;
+		}
+		return WriteExponent(exp10, &buffer[length]);
+	}
+	else if (kk >= length) {
+		// 1234e7 -> 12340000000
+		for (int i = length; i < kk; i++)
+			buffer[i] = '0';
+		return &buffer[kk];
+	}
+	else if (kk > 0) {
+		// 1234e-2 -> 12.34
+		memmove(&buffer[kk + 1], &buffer[kk], static_cast<size_t>(length - kk));
+		buffer[kk] = '.';
+		return &buffer[length + 1];
+	}
+	else {
+		// 1234e-6 -> 0.001234
+		const int offset = 2 - kk;
+		memmove(&buffer[offset], &buffer[0], static_cast<size_t>(length));
+		buffer[0] = '0';
+		buffer[1] = '.';
+		for (int i = 2; i < offset; i++)
+			buffer[i] = '0';
+		return &buffer[length + offset];
+	}
+}
+
+//! Writes the shortest decimal representation of value that reads back exactly.
+/*!	The layout is that of printf's "%.*g" with the given precision, so the
+	output differs from snprintf only in leaving out digits that are not
+	needed to identify the double.
+	\param value A finite double.
+	\param buffer At least 26 and precision + 2 chars; no terminator is written.
+	\param precision As for %g: decimal exponents from -4 up to precision - 1 are written without an exponent.
+	\return The end of the output.
+*/
+inline char* dtoa(double value, char* buffer, int precision) {
+	if (value == 0) {
+		if (std::signbit(value))
+			*buffer++ = '-';	// -0.0, as printf writes it
+		*buffer++ = '0';
+		return buffer;
+	}
+	else {
+		if (value < 0) {
+			*buffer++ = '-';
+			value = -value;
+		}
+		int length, K;
+		Grisu2(value, buffer, &length, &K);
+		return Prettify(buffer, length, K, precision);
+	}
+}
+
+} // namespace internal
+} // namespace rapidjson
+
+#endif // RAPIDJSON_INTERNAL_DTOA_H_
@@ -0,0 +1,103 @@
+#ifndef RAPIDJSON_INTERNAL_ITOA_H_
+#define RAPIDJSON_INTERNAL_ITOA_H_
+
+namespace rapidjson {
+namespace internal {
+
+//! The two digit strings "00" to "99", back to back.
+inline const char* GetDigitsLut() {
+	static const char cDigitsLut[200] = {
+		'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+		'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+		'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+		'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+		'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+		'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+		'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+		'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+		'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+		'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+	};
+	return cDigitsLut;
+}
+
+//! Writes the decimal digits of value, two at a time from a lookup table.
+/*!	\param buffer At least 20 chars; no terminator is written.
+	\return The end of the output.
+*/
+inline char* u64toa(uint64_t value, char* buffer) {
+	const char* cDigitsLut = GetDigitsLut();
+	char temp[20];
+	char* p = temp + sizeof(temp);
+
+	while (value >= 100) {
+		const unsigned i = static_cast<unsigned>(value % 100) << 1;
+		value /= 100;
+		*--p = cDigitsLut[i + 1];
+		*--p = cDigitsLut[i];
+	}
+	if (value < 10)
+		*--p = static_cast<char>('0' + value);
+	else {
+		const unsigned i = static_cast<unsigned>(value) << 1;
+		*--p = cDigitsLut[i + 1];
+		*--p = cDigitsLut[i];
+	}
+
+	while (p != temp + sizeof(temp))
+		*buffer++ = *p++;
+	return buffer;
+}
+
+//! As u64toa(), but the divisions are 32-bit.
+/*!	\param buffer At least 10 chars; no terminator is written.
+	\return The end of the output.
+*/
+inline char* u32toa(uint32_t value, char* buffer) {
+	const char* cDigitsLut = GetDigitsLut();
+	char temp[10];
+	char* p = temp + sizeof(temp);
+
+	while (value >= 100) {
+		const unsigned i = (value % 100) << 1;
+		value /= 100;
+		*--p = cDigitsLut[i + 1];
+		*--p = cDigitsLut[i];
+	}
+	if (value < 10)
+		*--p = static_cast<char>('0' + value);
+	else {
+		const unsigned i = value << 1;
+		*--p = cDigitsLut[i + 1];
+		*--p = cDigitsLut[i];
+	}
+
+	while (p != temp + sizeof(temp))
+		*buffer++ = *p++;
+	return buffer;
+}
+
+//! Writes value with a leading '-' if it is negative; buffer must hold 11 chars.
+inline char* i32toa(int32_t value, char* buffer) {
+	uint32_t u = static_cast<uint32_t>(value);
+	if (value < 0) {
+		*buffer++ = '-';
+		u = ~u + 1;
+	}
+	return u32toa(u, buffer);
+}
+
+//! Writes value with a leading '-' if it is negative; buffer must hold 21 chars.
+inline char* i64toa(int64_t value, char* buffer) {
+	uint64_t u = static_cast<uint64_t>(value);
+	if (value < 0) {
+		*buffer++ = '-';
+		u = ~u + 1;
+	}
+	return u64toa(u, buffer);
+}
+
+} // namespace internal
+} // namespace rapidjson
+
+#endif // RAPIDJSON_INTERNAL_ITOA_H_
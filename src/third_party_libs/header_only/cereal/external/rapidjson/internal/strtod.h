@@ -0,0 +1,226 @@
+#ifndef RAPIDJSON_INTERNAL_STRTOD_H_
+#define RAPIDJSON_INTERNAL_STRTOD_H_
+
+#include "diyfp.h"
+#include "pow10.h"
+#include "itoa.h"
+#include <cstdlib>	// strtod()
+#include <cstring>	// memcpy()
+
+namespace rapidjson {
+namespace internal {
+
+//! Digits beyond this many can't change which double is nearest except by being non-zero.
+static const int kStrtodMaxDigits = 768;
+
+//! Number of significant bits a double has at binary order 2^order, fewer for denormals.
+inline int EffectiveSignificandSize(int order) {
+	if (order >= -1021)
+		return 53;
+	else if (order <= -1074)
+		return 0;
+	else
+		return order + 1074;
+}
+
+//! Approximates digits * 10^exp with 64-bit arithmetic, tracking the error bound.
+/*!	\return true if result is certainly the nearest double, false if the
+	value is too close to halfway between two doubles to tell.
+*/
+inline bool StrtodDiyFp(const char* digits, int length, int exp, double* result) {
+	uint64_t significand = 0;
+	int i = 0;	// 2^64 - 1 = 18446744073709551615, 1844674407370955161 = 0x1999999999999999
+	for (; i < length; i++) {
+		if (significand > 0x1999999999999999ULL ||
+			(significand == 0x1999999999999999ULL && digits[i] > '5'))
+			break;
+		significand = significand * 10u + static_cast<unsigned>(digits[i] - '0');
+	}
+
+	if (i < length && digits[i] >= '5')	// Rounding
+		significand++;
+
+	const int remaining = length - i;
+	const int kUlpShift = 3;
+	const int kUlp = 1 << kUlpShift;
+	int64_t error = (remaining == 0) ? 0 : kUlp / 2;
+
+	DiyFp v(significand, 0);
+	v = v.Normalize();
+	error <<= -v.e;
+
+	exp += remaining;
+
+	int actualExp;
+	DiyFp cachedPower = GetCachedPower10(exp, &actualExp);
+	if (actualExp != exp) {
+		static const DiyFp kPow10[] = {
+			DiyFp(0xa000000000000000ULL, -60),	// 10^1
+			DiyFp(0xc800000000000000ULL, -57),	// 10^2
+			DiyFp(0xfa00000000000000ULL, -54),	// 10^3
+			DiyFp(0x9c40000000000000ULL, -50),	// 10^4
+			DiyFp(0xc350000000000000ULL, -47),	// 10^5
+			DiyFp(0xf424000000000000ULL, -44),	// 10^6
+			DiyFp(0x9896800000000000ULL, -40)	// 10^7
+		};
+		const int adjustment = exp - actualExp;
+		v = v * kPow10[adjustment - 1];
+		if (length + adjustment > 19)	// has more digits than decimal digits in 64-bit
+			error += kUlp / 2;
+	}
+
+	v = v * cachedPower;
+
+	error += kUlp + (error == 0 ? 0 : 1);
+
+	const int oldExp = v.e;
+	v = v.Normalize();
+	error <<= oldExp - v.e;
+
+	int precisionSize = 64 - EffectiveSignificandSize(64 + v.e);
+	if (precisionSize + kUlpShift >= 64) {
+		int scaleExp = (precisionSize + kUlpShift) - 63;
+		v.f >>= scaleExp;
+		v.e += scaleExp;
+		error = (error >> scaleExp) + 1 + kUlp;
+		precisionSize -= scaleExp;
+	}
+
+	DiyFp rounded(v.f >> precisionSize, v.e + precisionSize);
+	const uint64_t precisionBits = (v.f & ((static_cast<uint64_t>(1) << precisionSize) - 1)) * kUlp;
+	const uint64_t halfWay = (static_cast<uint64_t>(1) << (precisionSize - 1)) * kUlp;
+	if (precisionBits >= halfWay + static_cast<uint64_t>(error)) {
+		rounded.f++;
+		if (rounded.f & (DiyFp::kDpHiddenBit << 1)) {	// rounding overflows the significand
+			rounded.f >>= 1;
+			rounded.e++;
+		}
+	}
+
+	*result = rounded.ToDouble();
+
+	return halfWay - static_cast<uint64_t>(error) >= precisionBits || precisionBits >= halfWay + static_cast<uint64_t>(error);
+}
+
+//! Converts digits * 10^exp to the nearest double.
+/*!	Numbers of up to 15 or so significant digits and a modest exponent are
+	converted exactly with one multiplication or division (Clinger's fast
+	path). Most others are settled by StrtodDiyFp(). The rare values too
+	close to halfway between two doubles for that are handed to the C
+	library's correctly rounded strtod(), written without a decimal point
+	so that the locale can't affect it.
+	\param digits Decimal digits, without leading zeros.
+	\param length Number of digits, at most kStrtodMaxDigits + 1.
+	\param exp Decimal exponent applied to the digits as an integer.
+*/
+inline double Strtod(const char* digits, int length, int exp) {
+	while (length > 0 && digits[length - 1] == '0') {
+		length--;
+		exp++;
+	}
+	if (length == 0)
+		return 0.0;
+
+	if (length <= 19) {
+		uint64_t significand = 0;
+		for (int i = 0; i < length; i++)
+			significand = significand * 10 + static_cast<unsigned>(digits[i] - '0');
+
+		// Both the significand and 10^|exp| are exact doubles, so the result is correctly rounded.
+		const uint64_t kMaxExact = static_cast<uint64_t>(1) << 53;
+		if (significand <= kMaxExact) {
+			if (exp > 22 && exp <= 22 + 15) {
+				// 123e30 = 123000000e24, if the significand stays exact
+				const int shift = exp - 22;
+				const uint64_t scale = static_cast<uint64_t>(Pow10(shift));
+				if (significand <= kMaxExact / scale) {
+					significand *= scale;
+					exp = 22;
+				}
+			}
+			if (exp >= -22 && exp <= 22) {
+				const double d = static_cast<double>(significand);
+				return exp < 0 ? d / Pow10(-exp) : d * Pow10(exp);
+			}
+		}
+	}
+
+	if (length + exp <= -324)	// below half the smallest denormal
+		return 0.0;
+	if (length + exp > 309)
+		return std::numeric_limits<double>::infinity();
+
+	double result;
+	if (StrtodDiyFp(digits, length, exp, &result))
+		return result;
+
+	char buffer[kStrtodMaxDigits + 16];
+	memcpy(buffer, digits, static_cast<size_t>(length));
+	char* p = buffer + length;
+	*p++ = 'e';
+	p = i32toa(exp, p);
+	*p = '\0';
+	return strtod(buffer, 0);
+}
+
+//! Collects the significant digits of a number as a reader takes them from a stream.
+/*!	Of the digits past kStrtodMaxDigits, only whether any was non-zero is kept. */
+class DecimalDigits {
+public:
+	DecimalDigits() : length_(0), exp_(0), sticky_(false) {}
+
+	//! Starts from an integer part already parsed as a number.
+	void SetInteger(uint64_t value) {
+		length_ = value ? static_cast<int>(u64toa(value, digits_) - digits_) : 0;
+		exp_ = 0;
+		sticky_ = false;
+	}
+
+	//! Appends a digit before the decimal point.
+	void PushInteger(char c) {
+		if (length_ == 0 && c == '0')
+			return;
+		if (length_ < kStrtodMaxDigits)
+			digits_[length_++] = c;
+		else {
+			exp_++;
+			sticky_ |= (c != '0');
+		}
+	}
+
+	//! Appends a digit after the decimal point.
+	void PushFraction(char c) {
+		if (length_ == 0 && c == '0') {
+			exp_--;
+			return;
+		}
+		if (length_ < kStrtodMaxDigits) {
+			digits_[length_++] = c;
+			exp_--;
+		}
+		else
+			sticky_ |= (c != '0');
+	}
+
+	//! The nearest double to the digits times 10^exp.
+	double ToDouble(int exp) {
+		if (sticky_) {
+			// Stands in for the dropped digits: above the kept ones, below the next value up.
+			digits_[length_++] = '1';
+			exp_--;
+			sticky_ = false;
+		}
+		return Strtod(digits_, length_, exp_ + exp);
+	}
+
+private:
+	char digits_[kStrtodMaxDigits + 1];
+	int length_;
+	int exp_;
+	bool sticky_;
+};
+
+} // namespace internal
+} // namespace rapidjson
+
+#endif // RAPIDJSON_INTERNAL_STRTOD_H_
@@ -5,14 +5,12 @@
 // Version 0.1
 
 #include "rapidjson.h"
-#include "internal/pow10.h"
 #include "internal/stack.h"
+#include "internal/strtod.h"
 #include <csetjmp>
-
-// All part of denormalized parsing
 #include <limits> // for numeric_limits
-#include <cmath> // for fpclassify
-#include <sstream>
+#include <string> // for char_traits
+#include <type_traits>
 
 #ifdef RAPIDJSON_SSE42
 #include <nmmintrin.h>
@@ -614,50 +612,37 @@ private:
 		}
 
 		// Force double for big integer
-		double d = 0.0;
+		internal::DecimalDigits digits;
 		if (useDouble) {
-			d = (double)i64;
-			while (s.Peek() >= '0' && s.Peek() <= '9') {
-				if (d >= 1E307) {
-					RAPIDJSON_PARSE_ERROR("Number too big to store in double", stream.Tell());
-					return;
-				}
-				d = d * 10 + (s.Take() - '0');
-			}
+			digits.SetInteger(i64);
+			while (s.Peek() >= '0' && s.Peek() <= '9')
+				digits.PushInteger(s.Take());
 		}
 
 		// Parse frac = decimal-point 1*DIGIT
-		int expFrac = 0;
 		if (s.Peek() == '.') {
 			if (!useDouble) {
-				d = try64bit ? (double)i64 : (double)i;
+				digits.SetInteger(try64bit ? i64 : i);
 				useDouble = true;
 			}
 			s.Take();
 
-			if (s.Peek() >= '0' && s.Peek() <= '9') {
-				d = d * 10 + (s.Take() - '0');
-				--expFrac;
-			}
+			if (s.Peek() >= '0' && s.Peek() <= '9')
+				digits.PushFraction(s.Take());
 			else {
 				RAPIDJSON_PARSE_ERROR("At least one digit in fraction part", stream.Tell());
 				return;
 			}
 
-			while (s.Peek() >= '0' && s.Peek() <= '9') {
-				if (expFrac > -20) {
-					d = d * 10 + (s.Peek() - '0');
-					--expFrac;
-				}
-				s.Take();
-			}
+			while (s.Peek() >= '0' && s.Peek() <= '9')
+				digits.PushFraction(s.Take());
 		}
 
 		// Parse exp = e [ minus / plus ] 1*DIGIT
 		int exp = 0;
 		if (s.Peek() == 'e' || s.Peek() == 'E') {
 			if (!useDouble) {
-				d = try64bit ? (double)i64 : (double)i;
+				digits.SetInteger(try64bit ? i64 : i);
 				useDouble = true;
 			}
 			s.Take();
@@ -673,23 +658,9 @@ private:
 			if (s.Peek() >= '0' && s.Peek() <= '9') {
 				exp = s.Take() - '0';
 				while (s.Peek() >= '0' && s.Peek() <= '9') {
-					exp = exp * 10 + (s.Take() - '0');
-					if (exp > 308) {
-            // Attempt denormalized construction
-            std::stringstream ss;
-            ss.precision( std::numeric_limits<double>::max_digits10 );
-            ss << d * internal::Pow10(expFrac) << 'e' << (expMinus ? '-' : '+') << exp;
-
-            double dd;
-            ss >> dd;
-
-            if( std::fpclassify( dd ) == FP_SUBNORMAL )
-              handler.Double( dd );
-            else
-						  RAPIDJSON_PARSE_ERROR("Number too big to store in double", stream.Tell());
-
-						return;
-					}
+					if (exp < 100000)	// far beyond any double; keep the sum from overflowing
+						exp = exp * 10 + (s.Peek() - '0');
+					s.Take();
 				}
 			}
 			else {
@@ -703,7 +674,11 @@ private:
 
 		// Finish parsing, call event according to the type of number.
 		if (useDouble) {
-			d *= internal::Pow10(exp + expFrac);
+			double d = digits.ToDouble(exp);
+			if (d > std::numeric_limits<double>::max()) {
+				RAPIDJSON_PARSE_ERROR("Number too big to store in double", stream.Tell());
+				return;
+			}
 			handler.Double(minus ? -d : d);
 		}
 		else {
@@ -4,9 +4,13 @@
 #include "rapidjson.h"
 #include "internal/stack.h"
 #include "internal/strfunc.h"
+#include "internal/dtoa.h"
+#include "internal/itoa.h"
 #include <cstdio>	// snprintf() or _sprintf_s()
 #include <new>		// placement new
 #include <limits>
+#include <cmath>	// isfinite()
+#include <type_traits>
 
 #if defined(__GNUC__)
 #pragma GCC diagnostic push
@@ -38,7 +42,7 @@ public:
 	typedef typename Encoding::Ch Ch;
 
 	Writer(Stream& stream, int precision = 20, Allocator* allocator = 0, size_t levelDepth = kDefaultLevelDepth) :
-		stream_(stream), level_stack_(allocator, levelDepth * sizeof(Level))
+		double_precision_(precision), stream_(stream), level_stack_(allocator, levelDepth * sizeof(Level))
   {
 #ifdef _MSC_VER
     (void) sprintf_s(double_format, sizeof(double_format), "%%0.%dg", precision);
@@ -53,6 +57,7 @@ public:
 protected:
   char double_format[32];
   char long_double_format[32];
+  int double_precision_;
 public:
 
 	//@name Implementation of Handler
@@ -136,47 +141,31 @@ protected:
 	}
 
 	void WriteInt(int i) {
-		if (i < 0) {
-			stream_.Put('-');
-			i = -i;
-		}
-		WriteUint((unsigned)i);
+		char buffer[11];
+		const char* end = internal::i32toa(i, buffer);
+		for (const char* p = buffer; p != end; ++p)
+			stream_.Put(*p);
 	}
 
 	void WriteUint(unsigned u) {
 		char buffer[10];
-		char *p = buffer;
-		do {
-			*p++ = (u % 10) + '0';
-			u /= 10;
-		} while (u > 0);
-
-		do {
-			--p;
+		const char* end = internal::u32toa(u, buffer);
+		for (const char* p = buffer; p != end; ++p)
 			stream_.Put(*p);
-		} while (p != buffer);
 	}
 
 	void WriteInt64(int64_t i64) {
-		if (i64 < 0) {
-			stream_.Put('-');
-			i64 = -i64;
-		}
-		WriteUint64((uint64_t)i64);
+		char buffer[21];
+		const char* end = internal::i64toa(i64, buffer);
+		for (const char* p = buffer; p != end; ++p)
+			stream_.Put(*p);
 	}
 
 	void WriteUint64(uint64_t u64) {
 		char buffer[20];
-		char *p = buffer;
-		do {
-			*p++ = char(u64 % 10) + '0';
-			u64 /= 10;
-		} while (u64 > 0);
-
-		do {
-			--p;
+		const char* end = internal::u64toa(u64, buffer);
+		for (const char* p = buffer; p != end; ++p)
 			stream_.Put(*p);
-		} while (p != buffer);
 	}
 
   // cereal Temporary until constexpr support is added in RTM
@@ -211,14 +200,24 @@ protected:
   { return c < 256; }
 #endif
 
-	//! \todo Optimization with custom double-to-string converter.
+	//! Writes the shortest digits that read back as d, laid out as double_format would.
+	/*! Precisions below 17 ask for rounding, and non-finite values have no
+		digits, so those still go through printf.
+	*/
 	void WriteDouble(double d) {
 		char buffer[100];
+		int ret;
+		if (double_precision_ >= std::numeric_limits<double>::max_digits10 && std::isfinite(d)) {
+			const int precision = double_precision_ < 64 ? double_precision_ : 64;
+			ret = static_cast<int>(internal::dtoa(d, buffer, precision) - buffer);
+		}
+		else {
 #ifdef _MSC_VER
-    int ret = sprintf_s(buffer, sizeof(buffer), double_format, d);
+			ret = sprintf_s(buffer, sizeof(buffer), double_format, d);
 #else
-		int ret = snprintf(buffer, sizeof(buffer), double_format, d);
+			ret = snprintf(buffer, sizeof(buffer), double_format, d);
 #endif
+		}
 		RAPIDJSON_ASSERT(ret >= 1);
 		for (int i = 0; i < ret; i++)
 			stream_.Put(buffer[i]);
@@ -237,27 +236,17 @@ protected:
 	}
 
 	void WriteLongLong(long long d) {
-		char buffer[256];
-#ifdef _MSC_VER
-    int ret = sprintf_s(buffer, sizeof(buffer), "%lld", d);
-#else
-		int ret = snprintf(buffer, sizeof(buffer), "%lld", d);
-#endif
-		RAPIDJSON_ASSERT(ret >= 1);
-		for (int i = 0; i < ret; i++)
-			stream_.Put(buffer[i]);
+		char buffer[21];
+		const char* end = internal::i64toa(static_cast<int64_t>(d), buffer);
+		for (const char* p = buffer; p != end; ++p)
+			stream_.Put(*p);
 	}
 
 	void WriteULongLong(unsigned long long d) {
-		char buffer[256];
-#ifdef _MSC_VER
-    int ret = sprintf_s(buffer, sizeof(buffer), "%llu", d);
-#else
-		int ret = snprintf(buffer, sizeof(buffer), "%llu", d);
-#endif
-		RAPIDJSON_ASSERT(ret >= 1);
-		for (int i = 0; i < ret; i++)
-			stream_.Put(buffer[i]);
+		char buffer[20];
+		const char* end = internal::u64toa(static_cast<uint64_t>(d), buffer);
+		for (const char* p = buffer; p != end; ++p)
+			stream_.Put(*p);
 	}
 
 	void WriteString(const Ch* str, SizeType length)  {
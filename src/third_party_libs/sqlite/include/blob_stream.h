@@ -0,0 +1,131 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef SQLITE_BLOB_STREAM_H_
+#define SQLITE_BLOB_STREAM_H_
+
+#include <string>
+#include <utility>
+
+#include "cryptopp/filters.h"
+
+#include "sqlite3.h"
+
+namespace maidsafe {
+
+namespace sqlite {
+
+// Identifies one BLOB cell, as passed to sqlite3_blob_open().
+struct BlobLocation {
+  BlobLocation(sqlite3* db_in, std::string table_in, std::string column_in, sqlite3_int64 rowid_in,
+               std::string database_in = "main")
+      : db(db_in),
+        database(std::move(database_in)),
+        table(std::move(table_in)),
+        column(std::move(column_in)),
+        rowid(rowid_in) {}
+
+  sqlite3* db;
+  std::string database, table, column;
+  sqlite3_int64 rowid;
+};
+
+// Sets the cell to 'size' zero bytes so a BlobSink can fill it in place.  New rows can instead
+// bind sqlite3_bind_zeroblob() or use zeroblob(N) in the INSERT.  A BLOB's size is fixed once it
+// exists, so the final size must be known up front.
+void ReserveBlob(const BlobLocation& location, sqlite3_int64 size);
+
+class BlobError : public CryptoPP::Exception {
+ public:
+  explicit BlobError(const std::string& message) : CryptoPP::Exception(IO_ERROR, message) {}
+};
+
+// Reads a BLOB through sqlite3_blob_read() in fixed-size chunks, so a value of any size can be
+// pumped into a hash or cipher pipeline without holding it in memory.  Retrieval starts at the
+// current position, which Seek() and Skip() move.
+class BlobStore : public CryptoPP::Store, public CryptoPP::NotCopyable {
+ public:
+  BlobStore();
+  explicit BlobStore(const BlobLocation& location);
+  ~BlobStore();
+
+  void Seek(CryptoPP::lword position);
+  CryptoPP::lword Position() const { return position_; }
+  CryptoPP::lword Size() const { return size_; }
+
+  CryptoPP::lword MaxRetrievable() const { return size_ - position_; }
+  size_t TransferTo2(CryptoPP::BufferedTransformation& target, CryptoPP::lword& transfer_bytes,
+                     const std::string& channel = CryptoPP::DEFAULT_CHANNEL, bool blocking = true);
+  size_t CopyRangeTo2(CryptoPP::BufferedTransformation& target, CryptoPP::lword& begin,
+                      CryptoPP::lword end = CryptoPP::LWORD_MAX,
+                      const std::string& channel = CryptoPP::DEFAULT_CHANNEL,
+                      bool blocking = true) const;
+  CryptoPP::lword Skip(CryptoPP::lword skip_max = ULONG_MAX);
+
+  enum { kChunkSize = 64 * 1024 };
+
+ private:
+  void StoreInitialize(const CryptoPP::NameValuePairs& parameters);
+  void Read(CryptoPP::lword offset, byte* output, size_t length) const;
+
+  sqlite3_blob* blob_;
+  CryptoPP::lword size_, position_;
+  CryptoPP::SecByteBlock buffer_;
+  size_t buffered_;
+  bool waiting_;
+};
+
+// Source over a BLOB; see BlobStore.
+class BlobSource : public CryptoPP::SourceTemplate<BlobStore> {
+ public:
+  explicit BlobSource(CryptoPP::BufferedTransformation* attachment = nullptr)
+      : CryptoPP::SourceTemplate<BlobStore>(attachment) {}
+  BlobSource(const BlobLocation& location, bool pump_all,
+             CryptoPP::BufferedTransformation* attachment = nullptr);
+
+  void Seek(CryptoPP::lword position) { m_store.Seek(position); }
+  CryptoPP::lword Position() const { return m_store.Position(); }
+  CryptoPP::lword Size() const { return m_store.Size(); }
+};
+
+// Writes into an existing BLOB through sqlite3_blob_write(), starting at the current position.
+// Writes past the end of the BLOB throw BlobError; size it with ReserveBlob() or zeroblob first.
+class BlobSink : public CryptoPP::Sink, public CryptoPP::NotCopyable {
+ public:
+  BlobSink();
+  explicit BlobSink(const BlobLocation& location);
+  ~BlobSink();
+
+  void Seek(CryptoPP::lword position);
+  CryptoPP::lword Position() const { return position_; }
+  CryptoPP::lword Size() const { return size_; }
+
+  void IsolatedInitialize(const CryptoPP::NameValuePairs& parameters);
+  size_t Put2(const byte* in_string, size_t length, int message_end, bool blocking);
+  bool IsolatedFlush(bool /*hard_flush*/, bool /*blocking*/) { return false; }
+
+ private:
+  sqlite3_blob* blob_;
+  CryptoPP::lword size_, position_;
+};
+
+}  // namespace sqlite
+
+}  // namespace maidsafe
+
+#endif  // SQLITE_BLOB_STREAM_H_
@@ -0,0 +1,113 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef SQLITE_PATH_INDEX_H_
+#define SQLITE_PATH_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct sqlite3;
+
+namespace maidsafe {
+
+namespace sqlite {
+
+// Metadata for one file or directory.  'path' uses '/' separators and has no trailing separator.
+struct PathMetadata {
+  PathMetadata() : path(), is_directory(false), size(0), last_write_time(0) {}
+  PathMetadata(std::string path_in, bool is_directory_in, uint64_t size_in,
+               int64_t last_write_time_in)
+      : path(std::move(path_in)),
+        is_directory(is_directory_in),
+        size(size_in),
+        last_write_time(last_write_time_in) {}
+
+  std::string path;
+  bool is_directory;
+  uint64_t size;
+  int64_t last_write_time;
+};
+
+// A group of metadata changes applied to a PathIndex in one transaction.
+class PathChangeBatch {
+ public:
+  // Adds 'metadata.path' or updates its metadata if already present.
+  void Upsert(PathMetadata metadata);
+  // Removes 'path' and everything beneath it.
+  void Remove(std::string path);
+  // Moves 'old_path' and everything beneath it to 'new_path'.
+  void Rename(std::string old_path, std::string new_path);
+  bool empty() const { return changes_.empty(); }
+
+ private:
+  friend class PathIndex;
+  enum class Type { kUpsert, kRemove, kRename };
+  struct Change {
+    Type type;
+    PathMetadata metadata;
+    std::string new_path;
+  };
+  std::vector<Change> changes_;
+};
+
+// Searchable index of a drive's file and directory names, kept in an FTS4 table alongside the
+// metadata.  Names are tokenised into words at separators ('/', '.', '_', '-', spaces and other
+// ASCII punctuation) and at camelCase boundaries ("MyHTMLParser.cpp" -> "my html parser cpp"), and
+// ASCII letters are case-folded.  The index is fed incrementally from metadata change
+// notifications via Apply() or the single-change helpers.  Not thread-safe.
+class PathIndex {
+ public:
+  typedef std::vector<PathMetadata> PathMetadataVector;
+
+  // Opens or creates the index at 'db_path' (":memory:" gives a transient index).
+  explicit PathIndex(const std::string& db_path);
+  ~PathIndex();
+  PathIndex(const PathIndex&) = delete;
+  PathIndex& operator=(const PathIndex&) = delete;
+
+  void Apply(const PathChangeBatch& batch);
+  void Upsert(PathMetadata metadata);
+  void Remove(std::string path);
+  void Rename(std::string old_path, std::string new_path);
+
+  bool Get(const std::string& path, PathMetadata* metadata) const;
+  uint64_t size() const;
+
+  // Entries whose name starts with 'prefix', compared case-insensitively.
+  PathMetadataVector PrefixSearch(const std::string& prefix, size_t max_results) const;
+  // Entries whose name contains 'text', compared case-insensitively, where the match begins at
+  // the start of a word; e.g. "parser" and "html" find "MyHTMLParser.cpp" but "arser" does not.
+  // Queries with no word characters fall back to a linear scan, as do queries whose words are
+  // common enough that a scan of the first few tens of thousands of entries finds 'max_results'
+  // matches sooner than the full-text index would.
+  PathMetadataVector Search(const std::string& text, size_t max_results) const;
+
+ private:
+  PathMetadataVector Find(const std::string& text, bool anchored, size_t max_results) const;
+
+  sqlite3* db_;
+};
+
+}  // namespace sqlite
+
+}  // namespace maidsafe
+
+#endif  // SQLITE_PATH_INDEX_H_
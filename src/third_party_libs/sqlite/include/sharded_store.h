@@ -0,0 +1,89 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef SQLITE_SHARDED_STORE_H_
+#define SQLITE_SHARDED_STORE_H_
+
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace maidsafe {
+
+namespace sqlite {
+
+// A group of puts and deletes.  Operations on keys in the same shard are committed in one
+// transaction; a batch spanning several shards is not atomic across them.
+class WriteBatch {
+ public:
+  void Put(std::string key, std::string value);
+  void Delete(std::string key);
+  bool empty() const { return operations_.empty(); }
+
+ private:
+  friend class ShardedStore;
+  struct Operation {
+    std::string key, value;
+    bool is_delete;
+  };
+  std::vector<Operation> operations_;
+};
+
+// Key-value store hash-partitioned across 'shard_count' SQLite databases named "shard_<n>.db" in
+// an existing 'directory'.  Each shard runs in WAL mode with its own writer thread, which commits
+// everything queued since its last transaction together, so writers to different shards never
+// wait on the same database lock.  The shard count is recorded in each file and must not change.
+class ShardedStore {
+ public:
+  typedef std::vector<std::pair<std::string, std::string>> KeyValueVector;
+
+  ShardedStore(const std::string& directory, int shard_count);
+  ~ShardedStore();
+  ShardedStore(const ShardedStore&) = delete;
+  ShardedStore& operator=(const ShardedStore&) = delete;
+
+  // The returned futures become ready once the write is committed, or hold the SQLite error.
+  std::future<void> Put(std::string key, std::string value);
+  std::future<void> Delete(std::string key);
+  std::future<void> Write(WriteBatch batch);
+  // Blocks until every write queued before the call has been committed.
+  void Flush();
+
+  bool Get(const std::string& key, std::string* value) const;
+  // Returns entries with 'begin' <= key < 'end' in key order, merged from all shards.  An empty
+  // 'end' means no upper bound.
+  KeyValueVector Scan(const std::string& begin, const std::string& end) const;
+  KeyValueVector ScanPrefix(const std::string& prefix) const;
+
+  int shard_count() const { return static_cast<int>(shards_.size()); }
+  int ShardOf(const std::string& key) const;
+
+ private:
+  class Shard;
+  struct Completion;
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace sqlite
+
+}  // namespace maidsafe
+
+#endif  // SQLITE_SHARDED_STORE_H_
@@ -0,0 +1,88 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef SQLITE_VALUE_COMPRESSION_H_
+#define SQLITE_VALUE_COMPRESSION_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+namespace maidsafe {
+
+namespace sqlite {
+
+class CompressionError : public std::runtime_error {
+ public:
+  explicit CompressionError(const std::string& message) : std::runtime_error(message) {}
+};
+
+// Compresses values with Crypto++'s Deflator, leaving values below 'threshold' bytes, and values
+// that don't shrink, as they are.  Every encoded value starts with a one-byte header saying which
+// it is; compressed values using a dictionary follow it with the dictionary's 4-byte id.
+//
+// A shared dictionary of content typical of the values (e.g. a few concatenated sample records)
+// primes the compressor, which is what makes small records worth compressing.  Dictionaries are
+// identified by id so values written with a retired one stay readable: keep every dictionary that
+// was ever current registered.
+class ValueCodec {
+ public:
+  enum { kDefaultThreshold = 64 };
+
+  explicit ValueCodec(size_t threshold = kDefaultThreshold, int deflate_level = 6);
+  ~ValueCodec();
+  ValueCodec(const ValueCodec&) = delete;
+  ValueCodec& operator=(const ValueCodec&) = delete;
+
+  // Registers 'dictionary' under 'id' for decoding, and for encoding too if 'make_current'.
+  void AddDictionary(uint32_t id, std::string dictionary, bool make_current = true);
+
+  std::string Encode(const std::string& value) const;
+  std::string Decode(const std::string& encoded) const;
+  static bool IsCompressed(const std::string& encoded);
+
+  size_t threshold() const { return threshold_; }
+
+ private:
+  struct Decoder;
+
+  size_t threshold_;
+  int deflate_level_;
+  std::map<uint32_t, std::string> dictionaries_;
+  const std::pair<const uint32_t, std::string>* current_dictionary_;
+  // Idle inflators, reused since each owns a 32 KiB window that is costly to set up per value.
+  mutable std::mutex mutex_;
+  mutable std::vector<std::unique_ptr<Decoder>> decoders_;
+};
+
+// Registers compress(X) and decompress(X) SQL functions on 'db' which apply 'codec' to BLOB or
+// TEXT arguments; NULL passes through.  decompress() returns a BLOB.  'codec' must not be modified
+// while 'db' is open, since the functions may run on any thread using the connection.
+void RegisterCompressionFunctions(sqlite3* db, std::shared_ptr<const ValueCodec> codec);
+
+}  // namespace sqlite
+
+}  // namespace maidsafe
+
+#endif  // SQLITE_VALUE_COMPRESSION_H_
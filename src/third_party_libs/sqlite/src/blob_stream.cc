@@ -0,0 +1,222 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "blob_stream.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace maidsafe {
+
+namespace sqlite {
+
+namespace {
+
+const char kBlobLocationParameter[] = "BlobLocation";
+
+std::string QuoteIdentifier(const std::string& identifier) {
+  std::string quoted("\"");
+  for (char c : identifier) {
+    quoted += c;
+    if (c == '"')
+      quoted += c;
+  }
+  return quoted + '"';
+}
+
+sqlite3_blob* OpenBlob(const BlobLocation& location, bool writable, CryptoPP::lword* size) {
+  sqlite3_blob* blob(nullptr);
+  if (sqlite3_blob_open(location.db, location.database.c_str(), location.table.c_str(),
+                        location.column.c_str(), location.rowid, writable ? 1 : 0,
+                        &blob) != SQLITE_OK) {
+    std::string message(sqlite3_errmsg(location.db));
+    sqlite3_blob_close(blob);
+    throw BlobError("can't open BLOB " + location.table + "." + location.column + " at rowid " +
+                    std::to_string(location.rowid) + ": " + message);
+  }
+  *size = static_cast<CryptoPP::lword>(sqlite3_blob_bytes(blob));
+  return blob;
+}
+
+const BlobLocation& GetLocation(const CryptoPP::NameValuePairs& parameters, const char* caller) {
+  const BlobLocation* location(nullptr);
+  parameters.GetRequiredParameter(caller, kBlobLocationParameter, location);
+  return *location;
+}
+
+}  // unnamed namespace
+
+void ReserveBlob(const BlobLocation& location, sqlite3_int64 size) {
+  std::string sql("UPDATE " + QuoteIdentifier(location.database) + "." +
+                  QuoteIdentifier(location.table) + " SET " + QuoteIdentifier(location.column) +
+                  " = zeroblob(?1) WHERE rowid = ?2");
+  sqlite3_stmt* statement(nullptr);
+  int result(sqlite3_prepare_v2(location.db, sql.c_str(), -1, &statement, nullptr));
+  if (result == SQLITE_OK) {
+    sqlite3_bind_int64(statement, 1, size);
+    sqlite3_bind_int64(statement, 2, location.rowid);
+    result = sqlite3_step(statement);
+  }
+  sqlite3_finalize(statement);
+  if (result != SQLITE_DONE)
+    throw BlobError("can't reserve BLOB: " + std::string(sqlite3_errmsg(location.db)));
+  if (sqlite3_changes(location.db) == 0)
+    throw BlobError("can't reserve BLOB: no row " + std::to_string(location.rowid));
+}
+
+// BlobStore
+
+BlobStore::BlobStore()
+    : blob_(nullptr), size_(0), position_(0), buffer_(), buffered_(0), waiting_(false) {}
+
+BlobStore::BlobStore(const BlobLocation& location)
+    : blob_(nullptr), size_(0), position_(0), buffer_(), buffered_(0), waiting_(false) {
+  StoreInitialize(CryptoPP::MakeParameters(kBlobLocationParameter, &location));
+}
+
+BlobStore::~BlobStore() { sqlite3_blob_close(blob_); }
+
+void BlobStore::StoreInitialize(const CryptoPP::NameValuePairs& parameters) {
+  const BlobLocation& location(GetLocation(parameters, "BlobStore"));
+  sqlite3_blob_close(blob_);
+  blob_ = nullptr;
+  size_ = position_ = 0;
+  buffered_ = 0;
+  waiting_ = false;
+  blob_ = OpenBlob(location, false, &size_);
+  buffer_.New(kChunkSize);
+}
+
+void BlobStore::Seek(CryptoPP::lword position) {
+  if (position > size_)
+    throw BlobError("BlobStore: can't seek past the end of the BLOB");
+  position_ = position;
+  waiting_ = false;
+}
+
+void BlobStore::Read(CryptoPP::lword offset, byte* output, size_t length) const {
+  if (sqlite3_blob_read(blob_, output, static_cast<int>(length), static_cast<int>(offset)) !=
+      SQLITE_OK) {
+    throw BlobError("BlobStore: error reading BLOB (the row may have changed)");
+  }
+}
+
+size_t BlobStore::TransferTo2(CryptoPP::BufferedTransformation& target,
+                              CryptoPP::lword& transfer_bytes, const std::string& channel,
+                              bool blocking) {
+  CryptoPP::lword requested(transfer_bytes);
+  transfer_bytes = 0;
+  if (!blob_)
+    return 0;
+
+  while (waiting_ || (transfer_bytes < requested && position_ < size_)) {
+    if (!waiting_) {
+      buffered_ = static_cast<size_t>(std::min(std::min(requested - transfer_bytes,
+                                                        size_ - position_),
+                                               static_cast<CryptoPP::lword>(kChunkSize)));
+      Read(position_, buffer_, buffered_);
+    }
+    size_t blocked_bytes(target.ChannelPutModifiable2(channel, buffer_, buffered_, 0, blocking));
+    waiting_ = blocked_bytes > 0;
+    if (waiting_)
+      return blocked_bytes;
+    position_ += buffered_;
+    transfer_bytes += buffered_;
+  }
+  return 0;
+}
+
+size_t BlobStore::CopyRangeTo2(CryptoPP::BufferedTransformation& target, CryptoPP::lword& begin,
+                               CryptoPP::lword end, const std::string& channel,
+                               bool blocking) const {
+  if (!blob_)
+    return 0;
+
+  // buffer_ may still hold a blocked TransferTo2() chunk, so copies use their own buffer
+  end = std::min(end, size_ - position_);
+  CryptoPP::SecByteBlock chunk(static_cast<size_t>(
+      std::min(end > begin ? end - begin : 0, static_cast<CryptoPP::lword>(kChunkSize))));
+  while (begin < end) {
+    size_t length(static_cast<size_t>(std::min(end - begin, CryptoPP::lword(chunk.size()))));
+    Read(position_ + begin, chunk, length);
+    size_t blocked_bytes(target.ChannelPut2(channel, chunk, length, 0, blocking));
+    if (blocked_bytes)
+      return blocked_bytes;
+    begin += length;
+  }
+  return 0;
+}
+
+CryptoPP::lword BlobStore::Skip(CryptoPP::lword skip_max) {
+  CryptoPP::lword skipped(std::min(skip_max, size_ - position_));
+  position_ += skipped;
+  return skipped;
+}
+
+// BlobSource
+
+BlobSource::BlobSource(const BlobLocation& location, bool pump_all,
+                       CryptoPP::BufferedTransformation* attachment)
+    : CryptoPP::SourceTemplate<BlobStore>(attachment) {
+  SourceInitialize(pump_all, CryptoPP::MakeParameters(kBlobLocationParameter, &location));
+}
+
+// BlobSink
+
+BlobSink::BlobSink() : blob_(nullptr), size_(0), position_(0) {}
+
+BlobSink::BlobSink(const BlobLocation& location) : blob_(nullptr), size_(0), position_(0) {
+  IsolatedInitialize(CryptoPP::MakeParameters(kBlobLocationParameter, &location));
+}
+
+BlobSink::~BlobSink() { sqlite3_blob_close(blob_); }
+
+void BlobSink::IsolatedInitialize(const CryptoPP::NameValuePairs& parameters) {
+  const BlobLocation& location(GetLocation(parameters, "BlobSink"));
+  sqlite3_blob_close(blob_);
+  blob_ = nullptr;
+  size_ = position_ = 0;
+  blob_ = OpenBlob(location, true, &size_);
+}
+
+void BlobSink::Seek(CryptoPP::lword position) {
+  if (position > size_)
+    throw BlobError("BlobSink: can't seek past the end of the BLOB");
+  position_ = position;
+}
+
+size_t BlobSink::Put2(const byte* in_string, size_t length, int /*message_end*/,
+                      bool /*blocking*/) {
+  if (!blob_)
+    throw BlobError("BlobSink: no BLOB open");
+  if (length > size_ - position_) {
+    throw BlobError("BlobSink: write of " + std::to_string(length) + " bytes at offset " +
+                    std::to_string(position_) + " overruns the " + std::to_string(size_) +
+                    "-byte BLOB");
+  }
+  if (length != 0 && sqlite3_blob_write(blob_, in_string, static_cast<int>(length),
+                                        static_cast<int>(position_)) != SQLITE_OK) {
+    throw BlobError("BlobSink: error writing BLOB (the row may have changed)");
+  }
+  position_ += length;
+  return 0;
+}
+
+}  // namespace sqlite
+
+}  // namespace maidsafe
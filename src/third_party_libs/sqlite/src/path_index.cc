@@ -0,0 +1,463 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "path_index.h"
+
+extern "C" {
+#include "sqlite3.h"
+}
+
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace maidsafe {
+
+namespace sqlite {
+
+namespace {
+
+// The FTS3/4 tokenizer interface from SQLite's fts3_tokenizer.h, which is not part of the
+// amalgamation's public header.  Layouts must match exactly.
+struct sqlite3_tokenizer_module;
+
+struct sqlite3_tokenizer {
+  const sqlite3_tokenizer_module* pModule;
+};
+
+struct sqlite3_tokenizer_cursor {
+  sqlite3_tokenizer* pTokenizer;
+};
+
+struct sqlite3_tokenizer_module {
+  int iVersion;
+  int (*xCreate)(int argc, const char* const* argv, sqlite3_tokenizer** ppTokenizer);
+  int (*xDestroy)(sqlite3_tokenizer* pTokenizer);
+  int (*xOpen)(sqlite3_tokenizer* pTokenizer, const char* pInput, int nBytes,
+               sqlite3_tokenizer_cursor** ppCursor);
+  int (*xClose)(sqlite3_tokenizer_cursor* pCursor);
+  int (*xNext)(sqlite3_tokenizer_cursor* pCursor, const char** ppToken, int* pnBytes,
+               int* piStartOffset, int* piEndOffset, int* piPosition);
+};
+
+const char kTokenizerName[] = "maidsafe_path";
+
+typedef std::unique_ptr<sqlite3_stmt, int (*)(sqlite3_stmt*)> Statement;
+
+void ThrowOnError(int result, sqlite3* db, const std::string& context) {
+  if (result != SQLITE_OK && result != SQLITE_ROW && result != SQLITE_DONE)
+    throw std::runtime_error(context + ": " + (db ? sqlite3_errmsg(db) : sqlite3_errstr(result)));
+}
+
+void Execute(sqlite3* db, const char* sql) {
+  ThrowOnError(sqlite3_exec(db, sql, nullptr, nullptr, nullptr), db, sql);
+}
+
+Statement Prepare(sqlite3* db, const std::string& sql) {
+  sqlite3_stmt* statement(nullptr);
+  ThrowOnError(sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr), db, sql);
+  return Statement(statement, sqlite3_finalize);
+}
+
+void BindText(sqlite3_stmt* statement, int index, const std::string& text) {
+  sqlite3_bind_text(statement, index, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+}
+
+std::string ColumnText(sqlite3_stmt* statement, int column) {
+  return std::string(reinterpret_cast<const char*>(sqlite3_column_text(statement, column)),
+                     static_cast<size_t>(sqlite3_column_bytes(statement, column)));
+}
+
+void Step(sqlite3* db, sqlite3_stmt* statement) {
+  ThrowOnError(sqlite3_step(statement), db, sqlite3_sql(statement));
+}
+
+char FoldCase(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+std::string FoldCase(std::string text) {
+  for (char& c : text)
+    c = FoldCase(c);
+  return text;
+}
+
+// Non-ASCII bytes are treated as lower-case letters, so UTF-8 sequences are never split.
+bool IsUpper(char c) { return c >= 'A' && c <= 'Z'; }
+bool IsWordChar(char c) {
+  return (c >= 'a' && c <= 'z') || IsUpper(c) || (c >= '0' && c <= '9') ||
+         static_cast<unsigned char>(c) >= 0x80;
+}
+
+// Finds the next word in input[*offset, length), setting [*start, *end) and advancing *offset.  A
+// word ends at a non-word character, before an upper-case letter that follows a lower-case letter
+// or digit ("myFile"), and before the last of a run of capitals followed by a lower-case letter
+// ("HTMLParser").
+bool NextWord(const char* input, int length, int* offset, int* start, int* end) {
+  int i(*offset);
+  while (i < length && !IsWordChar(input[i]))
+    ++i;
+  if (i == length) {
+    *offset = i;
+    return false;
+  }
+  *start = i++;
+  for (; i < length && IsWordChar(input[i]); ++i) {
+    if (IsUpper(input[i]) &&
+        (!IsUpper(input[i - 1]) || (i + 1 < length && IsWordChar(input[i + 1]) &&
+                                    !IsUpper(input[i + 1]) &&
+                                    !(input[i + 1] >= '0' && input[i + 1] <= '9')))) {
+      break;
+    }
+  }
+  *end = *offset = i;
+  return true;
+}
+
+std::vector<std::string> Words(const std::string& text) {
+  std::vector<std::string> words;
+  int offset(0), start(0), end(0);
+  while (NextWord(text.data(), static_cast<int>(text.size()), &offset, &start, &end))
+    words.push_back(FoldCase(text.substr(start, end - start)));
+  return words;
+}
+
+// True if the words of 'name' include 'words' consecutively, the last one as a prefix, and at the
+// start of the name if 'anchored'; what the full-text phrase query built by Find() matches.
+bool HasWords(const std::string& name, const std::vector<std::string>& words, bool anchored) {
+  if (words.empty())
+    return true;
+  std::vector<std::string> name_words(Words(name));
+  for (size_t i(0); i + words.size() <= name_words.size(); ++i) {
+    size_t j(0);
+    while (j + 1 < words.size() && name_words[i + j] == words[j])
+      ++j;
+    if (j + 1 == words.size() && name_words[i + j].compare(0, words[j].size(), words[j]) == 0)
+      return true;
+    if (anchored)
+      break;
+  }
+  return false;
+}
+
+struct PathCursor {
+  sqlite3_tokenizer_cursor base;
+  const char* input;
+  int length, offset, position;
+  std::string token;
+};
+
+int TokenizerCreate(int /*argc*/, const char* const* /*argv*/, sqlite3_tokenizer** tokenizer) {
+  *tokenizer = new sqlite3_tokenizer;
+  return SQLITE_OK;
+}
+
+int TokenizerDestroy(sqlite3_tokenizer* tokenizer) {
+  delete tokenizer;
+  return SQLITE_OK;
+}
+
+int TokenizerOpen(sqlite3_tokenizer* /*tokenizer*/, const char* input, int length,
+                  sqlite3_tokenizer_cursor** cursor) {
+  PathCursor* path_cursor(new PathCursor);
+  path_cursor->input = input;
+  path_cursor->length = length < 0 ? static_cast<int>(std::char_traits<char>::length(input))
+                                   : length;
+  path_cursor->offset = path_cursor->position = 0;
+  *cursor = &path_cursor->base;
+  return SQLITE_OK;
+}
+
+int TokenizerClose(sqlite3_tokenizer_cursor* cursor) {
+  delete reinterpret_cast<PathCursor*>(cursor);
+  return SQLITE_OK;
+}
+
+int TokenizerNext(sqlite3_tokenizer_cursor* cursor, const char** token, int* token_length,
+                  int* start, int* end, int* position) {
+  PathCursor* path_cursor(reinterpret_cast<PathCursor*>(cursor));
+  if (!NextWord(path_cursor->input, path_cursor->length, &path_cursor->offset, start, end))
+    return SQLITE_DONE;
+  path_cursor->token.assign(path_cursor->input + *start, path_cursor->input + *end);
+  for (char& c : path_cursor->token)
+    c = FoldCase(c);
+  *token = path_cursor->token.data();
+  *token_length = static_cast<int>(path_cursor->token.size());
+  *position = path_cursor->position++;
+  return SQLITE_OK;
+}
+
+const sqlite3_tokenizer_module kPathTokenizer = {0, TokenizerCreate, TokenizerDestroy,
+                                                 TokenizerOpen, TokenizerClose, TokenizerNext};
+
+// Tokenizers are registered per connection through the fts3_tokenizer() SQL function.
+void RegisterTokenizer(sqlite3* db) {
+  const sqlite3_tokenizer_module* module(&kPathTokenizer);
+  Statement statement(Prepare(db, "SELECT fts3_tokenizer(?1, ?2)"));
+  sqlite3_bind_text(statement.get(), 1, kTokenizerName, -1, SQLITE_STATIC);
+  sqlite3_bind_blob(statement.get(), 2, &module, sizeof(module), SQLITE_TRANSIENT);
+  Step(db, statement.get());
+}
+
+// The index is an external-content FTS4 table over 'entries', kept in step by triggers.  Only the
+// name is indexed, so metadata-only updates and the path rewrites done by a directory rename
+// don't touch the full-text index.  Two- and three-byte prefixes are indexed as well, which keeps
+// short prefix queries from having to merge every term that starts with them.
+const char kSchema[] =
+    "CREATE TABLE IF NOT EXISTS entries(id INTEGER PRIMARY KEY, path TEXT UNIQUE NOT NULL, "
+    "name TEXT NOT NULL, is_directory INTEGER NOT NULL, size INTEGER NOT NULL, "
+    "last_write_time INTEGER NOT NULL);"
+    "CREATE VIRTUAL TABLE IF NOT EXISTS names USING fts4(content=\"entries\", name, "
+    "prefix=\"2,3\", tokenize=maidsafe_path);"
+    "CREATE TRIGGER IF NOT EXISTS entries_bd BEFORE DELETE ON entries BEGIN "
+    "DELETE FROM names WHERE docid = old.id; END;"
+    "CREATE TRIGGER IF NOT EXISTS entries_bu BEFORE UPDATE OF name ON entries BEGIN "
+    "DELETE FROM names WHERE docid = old.id; END;"
+    "CREATE TRIGGER IF NOT EXISTS entries_au AFTER UPDATE OF name ON entries BEGIN "
+    "INSERT INTO names(docid, name) VALUES(new.id, new.name); END;"
+    "CREATE TRIGGER IF NOT EXISTS entries_ai AFTER INSERT ON entries BEGIN "
+    "INSERT INTO names(docid, name) VALUES(new.id, new.name); END;";
+
+const char kSelectColumns[] =
+    "SELECT path, is_directory, size, last_write_time, entries.id FROM entries ";
+
+// Find() scans this many entries before deciding whether to carry on scanning or to use the
+// full-text index, and scans no more than kMaxScanRows in all.
+const uint64_t kProbeRows(1000), kMaxScanRows(50000);
+
+PathMetadata ColumnMetadata(sqlite3_stmt* statement) {
+  return PathMetadata(ColumnText(statement, 0), sqlite3_column_int(statement, 1) != 0,
+                      static_cast<uint64_t>(sqlite3_column_int64(statement, 2)),
+                      sqlite3_column_int64(statement, 3));
+}
+
+std::string NameOf(const std::string& path) { return path.substr(path.find_last_of('/') + 1); }
+
+// Descendants of 'path' are the paths in ['path/', 'path0'), since '0' follows '/'.
+void BindDescendants(sqlite3_stmt* statement, int index, const std::string& path) {
+  sqlite3_bind_text(statement, index, (path + '/').c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(statement, index + 1, (path + '0').c_str(), -1, SQLITE_TRANSIENT);
+}
+
+}  // unnamed namespace
+
+void PathChangeBatch::Upsert(PathMetadata metadata) {
+  Change change = {Type::kUpsert, std::move(metadata), std::string()};
+  changes_.push_back(std::move(change));
+}
+
+void PathChangeBatch::Remove(std::string path) {
+  Change change = {Type::kRemove, PathMetadata(std::move(path), false, 0, 0), std::string()};
+  changes_.push_back(std::move(change));
+}
+
+void PathChangeBatch::Rename(std::string old_path, std::string new_path) {
+  Change change = {Type::kRename, PathMetadata(std::move(old_path), false, 0, 0),
+                   std::move(new_path)};
+  changes_.push_back(std::move(change));
+}
+
+PathIndex::PathIndex(const std::string& db_path) : db_(nullptr) {
+  int result(sqlite3_open(db_path.c_str(), &db_));
+  try {
+    ThrowOnError(result, db_, "can't open " + db_path);
+    RegisterTokenizer(db_);
+    Execute(db_, kSchema);
+  }
+  catch (const std::exception&) {
+    sqlite3_close(db_);
+    throw;
+  }
+}
+
+PathIndex::~PathIndex() { sqlite3_close(db_); }
+
+void PathIndex::Apply(const PathChangeBatch& batch) {
+  if (batch.empty())
+    return;
+  Statement update(Prepare(db_,
+      "UPDATE entries SET is_directory = ?2, size = ?3, last_write_time = ?4 WHERE path = ?1"));
+  Statement insert(Prepare(db_,
+      "INSERT INTO entries(path, is_directory, size, last_write_time, name) "
+      "VALUES(?1, ?2, ?3, ?4, ?5)"));
+  Statement remove(Prepare(db_, "DELETE FROM entries WHERE path = ?1 OR (path >= ?2 AND path < ?3)"));
+  Statement rename(Prepare(db_, "UPDATE entries SET path = ?2, name = ?3 WHERE path = ?1"));
+  Statement move(Prepare(db_,
+      "UPDATE entries SET path = ?1 || substr(path, length(?2) + 1) WHERE path >= ?3 AND path < ?4"));
+
+  Execute(db_, "BEGIN IMMEDIATE");
+  try {
+    for (const auto& change : batch.changes_) {
+      const PathMetadata& metadata(change.metadata);
+      sqlite3_stmt* statement(nullptr);
+      switch (change.type) {
+        case PathChangeBatch::Type::kUpsert:
+          statement = update.get();
+          BindText(statement, 1, metadata.path);
+          sqlite3_bind_int(statement, 2, metadata.is_directory ? 1 : 0);
+          sqlite3_bind_int64(statement, 3, static_cast<sqlite3_int64>(metadata.size));
+          sqlite3_bind_int64(statement, 4, metadata.last_write_time);
+          Step(db_, statement);
+          sqlite3_reset(statement);
+          if (sqlite3_changes(db_) != 0)
+            continue;
+          statement = insert.get();
+          BindText(statement, 1, metadata.path);
+          sqlite3_bind_int(statement, 2, metadata.is_directory ? 1 : 0);
+          sqlite3_bind_int64(statement, 3, static_cast<sqlite3_int64>(metadata.size));
+          sqlite3_bind_int64(statement, 4, metadata.last_write_time);
+          sqlite3_bind_text(statement, 5, NameOf(metadata.path).c_str(), -1, SQLITE_TRANSIENT);
+          break;
+        case PathChangeBatch::Type::kRemove:
+          statement = remove.get();
+          BindText(statement, 1, metadata.path);
+          BindDescendants(statement, 2, metadata.path);
+          break;
+        case PathChangeBatch::Type::kRename:
+          statement = rename.get();
+          BindText(statement, 1, metadata.path);
+          BindText(statement, 2, change.new_path);
+          sqlite3_bind_text(statement, 3, NameOf(change.new_path).c_str(), -1, SQLITE_TRANSIENT);
+          Step(db_, statement);
+          sqlite3_reset(statement);
+          statement = move.get();
+          BindText(statement, 1, change.new_path);
+          BindText(statement, 2, metadata.path);
+          BindDescendants(statement, 3, metadata.path);
+          break;
+      }
+      Step(db_, statement);
+      sqlite3_reset(statement);
+    }
+    Execute(db_, "COMMIT");
+  }
+  catch (const std::exception&) {
+    sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+    throw;
+  }
+}
+
+void PathIndex::Upsert(PathMetadata metadata) {
+  PathChangeBatch batch;
+  batch.Upsert(std::move(metadata));
+  Apply(batch);
+}
+
+void PathIndex::Remove(std::string path) {
+  PathChangeBatch batch;
+  batch.Remove(std::move(path));
+  Apply(batch);
+}
+
+void PathIndex::Rename(std::string old_path, std::string new_path) {
+  PathChangeBatch batch;
+  batch.Rename(std::move(old_path), std::move(new_path));
+  Apply(batch);
+}
+
+bool PathIndex::Get(const std::string& path, PathMetadata* metadata) const {
+  Statement statement(Prepare(db_, std::string(kSelectColumns) + "WHERE path = ?1"));
+  BindText(statement.get(), 1, path);
+  int result(sqlite3_step(statement.get()));
+  ThrowOnError(result, db_, "PathIndex::Get");
+  if (result != SQLITE_ROW)
+    return false;
+  *metadata = ColumnMetadata(statement.get());
+  return true;
+}
+
+uint64_t PathIndex::size() const {
+  Statement statement(Prepare(db_, "SELECT count(*) FROM entries"));
+  Step(db_, statement.get());
+  return static_cast<uint64_t>(sqlite3_column_int64(statement.get(), 0));
+}
+
+PathIndex::PathMetadataVector PathIndex::PrefixSearch(const std::string& prefix,
+                                                      size_t max_results) const {
+  return Find(prefix, true, max_results);
+}
+
+PathIndex::PathMetadataVector PathIndex::Search(const std::string& text,
+                                                size_t max_results) const {
+  return Find(text, false, max_results);
+}
+
+// The full-text query narrows the candidates to names containing the words of 'text' in order,
+// the last one as a prefix; each candidate's name is then checked against 'text' itself, since
+// words alone ignore the separators between them.  Entries found by scanning are checked against
+// the words with HasWords() instead.
+//
+// FTS4 reads the whole doclist of every word before returning the first row, so for words found
+// in a large share of the names (e.g. "report" in a tree of "ProjectReport_NNN.docx" files) the
+// query is slower than scanning the table, which can stop as soon as it has 'max_results'
+// matches.  The table is therefore scanned in id order first: if the first kProbeRows entries
+// hold enough matches that the scan should be done within kMaxScanRows entries, it carries on up
+// to that limit; otherwise, and for whatever the scan did not reach, the full-text query is used
+// for the entries after the last one scanned.
+PathIndex::PathMetadataVector PathIndex::Find(const std::string& text, bool anchored,
+                                              size_t max_results) const {
+  const std::string folded_text(FoldCase(text));
+  const std::vector<std::string> words(Words(text));
+  Statement scan(Prepare(db_, std::string(kSelectColumns) + "ORDER BY id"));
+  PathMetadataVector results;
+  sqlite3_int64 last_id(0);
+  // Steps 'statement', keeping the row if its name matches.  Returns false once there are no rows.
+  auto next_row([&](sqlite3_stmt* statement) {
+    int result(sqlite3_step(statement));
+    ThrowOnError(result, db_, "PathIndex::Find");
+    if (result != SQLITE_ROW)
+      return false;
+    last_id = sqlite3_column_int64(statement, 4);
+    PathMetadata metadata(ColumnMetadata(statement));
+    std::string name(NameOf(metadata.path));
+    auto position(FoldCase(name).find(folded_text));
+    if ((anchored ? position == 0 : position != std::string::npos) &&
+        (statement != scan.get() || HasWords(name, words, anchored))) {
+      results.push_back(std::move(metadata));
+    }
+    return true;
+  });
+
+  // Queries with no words can only be answered by a scan.
+  uint64_t scan_limit(words.empty() ? std::numeric_limits<uint64_t>::max() : kProbeRows);
+  for (uint64_t rows(0); results.size() < max_results && rows < scan_limit; ++rows) {
+    if (!next_row(scan.get()))
+      return results;
+    if (rows + 1 == kProbeRows && !results.empty() &&
+        static_cast<double>(max_results - results.size()) * kProbeRows / results.size() <
+            static_cast<double>(kMaxScanRows - kProbeRows)) {
+      scan_limit = kMaxScanRows;
+    }
+  }
+  if (results.size() == max_results)
+    return results;
+
+  std::string phrase(anchored ? "^" : "");
+  for (const auto& word : words)
+    phrase += word + ' ';
+  phrase.back() = '*';
+  Statement statement(Prepare(db_, std::string(kSelectColumns) +
+      "JOIN names ON names.docid = entries.id WHERE names MATCH '\"" + phrase +
+      "\"' AND names.docid > ?1"));
+  sqlite3_bind_int64(statement.get(), 1, last_id);
+  while (results.size() < max_results && next_row(statement.get())) {
+  }
+  return results;
+}
+
+}  // namespace sqlite
+
+}  // namespace maidsafe
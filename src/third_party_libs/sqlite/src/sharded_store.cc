@@ -0,0 +1,426 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "sharded_store.h"
+
+extern "C" {
+#include "sqlite3.h"
+}
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+namespace maidsafe {
+
+namespace sqlite {
+
+namespace {
+
+void ThrowOnError(int result, sqlite3* db, const std::string& context) {
+  if (result != SQLITE_OK && result != SQLITE_ROW && result != SQLITE_DONE)
+    throw std::runtime_error(context + ": " + (db ? sqlite3_errmsg(db) : sqlite3_errstr(result)));
+}
+
+void Execute(sqlite3* db, const char* sql) {
+  ThrowOnError(sqlite3_exec(db, sql, nullptr, nullptr, nullptr), db, sql);
+}
+
+sqlite3_stmt* Prepare(sqlite3* db, const char* sql) {
+  sqlite3_stmt* statement(nullptr);
+  ThrowOnError(sqlite3_prepare_v2(db, sql, -1, &statement, nullptr), db, sql);
+  return statement;
+}
+
+void BindBlob(sqlite3_stmt* statement, int index, const std::string& blob) {
+  sqlite3_bind_blob(statement, index, blob.data(), static_cast<int>(blob.size()), SQLITE_STATIC);
+}
+
+std::string ColumnBlob(sqlite3_stmt* statement, int column) {
+  return std::string(static_cast<const char*>(sqlite3_column_blob(statement, column)),
+                     static_cast<size_t>(sqlite3_column_bytes(statement, column)));
+}
+
+// Keys are partitioned by FNV-1a rather than std::hash, which is free to differ between builds
+// and would strand keys in the wrong file.
+uint64_t Fnv1a(const std::string& key) {
+  uint64_t hash(14695981039346656037ULL);
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// The smallest string greater than every string starting with 'prefix', or "" if there is none.
+std::string PrefixEnd(std::string prefix) {
+  while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xff)
+    prefix.pop_back();
+  if (!prefix.empty())
+    prefix.back() = static_cast<char>(static_cast<unsigned char>(prefix.back()) + 1);
+  return prefix;
+}
+
+}  // unnamed namespace
+
+void WriteBatch::Put(std::string key, std::string value) {
+  Operation operation = {std::move(key), std::move(value), false};
+  operations_.push_back(std::move(operation));
+}
+
+void WriteBatch::Delete(std::string key) {
+  Operation operation = {std::move(key), std::string(), true};
+  operations_.push_back(std::move(operation));
+}
+
+// Shared by the per-shard parts of one write; the promise is satisfied when the last part is done.
+struct ShardedStore::Completion {
+  explicit Completion(int parts_in) : mutex(), parts(parts_in), error(), promise() {}
+
+  void Done(std::exception_ptr part_error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (part_error && !error)
+      error = part_error;
+    if (--parts == 0) {
+      if (error)
+        promise.set_exception(error);
+      else
+        promise.set_value();
+    }
+  }
+
+  std::mutex mutex;
+  int parts;
+  std::exception_ptr error;
+  std::promise<void> promise;
+};
+
+class ShardedStore::Shard {
+ public:
+  Shard(const std::string& path, int shard_count);
+  ~Shard();
+
+  void Submit(std::vector<WriteBatch::Operation> operations,
+              std::shared_ptr<Completion> completion);
+  bool Get(const std::string& key, std::string* value);
+  KeyValueVector Scan(const std::string& begin, const std::string& end);
+
+ private:
+  struct Request {
+    std::vector<WriteBatch::Operation> operations;
+    std::shared_ptr<Completion> completion;
+  };
+
+  sqlite3* Open(const std::string& path);
+  void Run();
+  std::exception_ptr Commit(std::deque<Request>::iterator first,
+                            std::deque<Request>::iterator last);
+
+  sqlite3* writer_;
+  sqlite3* reader_;
+  sqlite3_stmt *put_, *delete_, *get_, *scan_, *scan_to_end_;
+  std::mutex reader_mutex_, mutex_;
+  std::condition_variable condition_;
+  std::deque<Request> pending_;
+  bool stop_;
+  std::thread thread_;
+};
+
+ShardedStore::Shard::Shard(const std::string& path, int shard_count)
+    : writer_(nullptr),
+      reader_(nullptr),
+      put_(nullptr),
+      delete_(nullptr),
+      get_(nullptr),
+      scan_(nullptr),
+      scan_to_end_(nullptr),
+      reader_mutex_(),
+      mutex_(),
+      condition_(),
+      pending_(),
+      stop_(false),
+      thread_() {
+  try {
+    writer_ = Open(path);
+    Execute(writer_, "PRAGMA journal_mode=WAL");
+    Execute(writer_, "PRAGMA synchronous=NORMAL");
+    Execute(writer_,
+            "CREATE TABLE IF NOT EXISTS kv (key BLOB PRIMARY KEY, value BLOB NOT NULL) "
+            "WITHOUT ROWID");
+
+    sqlite3_stmt* version(Prepare(writer_, "PRAGMA user_version"));
+    ThrowOnError(sqlite3_step(version), writer_, path);
+    int existing_count(sqlite3_column_int(version, 0));
+    sqlite3_finalize(version);
+    if (existing_count == 0) {
+      Execute(writer_, ("PRAGMA user_version=" + std::to_string(shard_count)).c_str());
+    } else if (existing_count != shard_count) {
+      throw std::runtime_error(path + " belongs to a store of " + std::to_string(existing_count) +
+                               " shards, not " + std::to_string(shard_count));
+    }
+
+    put_ = Prepare(writer_, "INSERT OR REPLACE INTO kv (key, value) VALUES (?1, ?2)");
+    delete_ = Prepare(writer_, "DELETE FROM kv WHERE key = ?1");
+
+    reader_ = Open(path);
+    get_ = Prepare(reader_, "SELECT value FROM kv WHERE key = ?1");
+    scan_ = Prepare(reader_, "SELECT key, value FROM kv WHERE key >= ?1 AND key < ?2 ORDER BY key");
+    scan_to_end_ = Prepare(reader_, "SELECT key, value FROM kv WHERE key >= ?1 ORDER BY key");
+  }
+  catch (...) {
+    for (sqlite3_stmt* statement : {put_, delete_, get_, scan_, scan_to_end_})
+      sqlite3_finalize(statement);
+    sqlite3_close(reader_);
+    sqlite3_close(writer_);
+    throw;
+  }
+  thread_ = std::thread([this] { Run(); });
+}
+
+ShardedStore::Shard::~Shard() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+  for (sqlite3_stmt* statement : {put_, delete_, get_, scan_, scan_to_end_})
+    sqlite3_finalize(statement);
+  sqlite3_close(reader_);
+  sqlite3_close(writer_);
+}
+
+// Each connection is only ever used by one thread at a time, so SQLite's own mutexes are skipped.
+sqlite3* ShardedStore::Shard::Open(const std::string& path) {
+  sqlite3* db(nullptr);
+  int result(sqlite3_open_v2(path.c_str(), &db,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+                             nullptr));
+  if (result != SQLITE_OK) {
+    std::string message(path + ": " + (db ? sqlite3_errmsg(db) : sqlite3_errstr(result)));
+    sqlite3_close(db);
+    throw std::runtime_error(message);
+  }
+  sqlite3_busy_timeout(db, 10000);
+  return db;
+}
+
+void ShardedStore::Shard::Submit(std::vector<WriteBatch::Operation> operations,
+                                 std::shared_ptr<Completion> completion) {
+  Request request = {std::move(operations), std::move(completion)};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(std::move(request));
+  }
+  condition_.notify_one();
+}
+
+void ShardedStore::Shard::Run() {
+  for (;;) {
+    std::deque<Request> requests;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+      if (pending_.empty())
+        return;
+      requests.swap(pending_);
+    }
+
+    // Group commit everything that queued up; if that fails, retry each request on its own so
+    // only the offending one reports the error.
+    std::exception_ptr error(Commit(requests.begin(), requests.end()));
+    if (!error || requests.size() == 1) {
+      for (auto& request : requests)
+        request.completion->Done(error);
+    } else {
+      for (auto it(requests.begin()); it != requests.end(); ++it)
+        it->completion->Done(Commit(it, it + 1));
+    }
+  }
+}
+
+std::exception_ptr ShardedStore::Shard::Commit(std::deque<Request>::iterator first,
+                                               std::deque<Request>::iterator last) {
+  try {
+    Execute(writer_, "BEGIN IMMEDIATE");
+    for (; first != last; ++first) {
+      for (const auto& operation : first->operations) {
+        sqlite3_stmt* statement(operation.is_delete ? delete_ : put_);
+        BindBlob(statement, 1, operation.key);
+        if (!operation.is_delete)
+          BindBlob(statement, 2, operation.value);
+        int result(sqlite3_step(statement));
+        sqlite3_reset(statement);
+        ThrowOnError(result, writer_, "writing to shard");
+      }
+    }
+    Execute(writer_, "COMMIT");
+    return std::exception_ptr();
+  }
+  catch (...) {
+    if (!sqlite3_get_autocommit(writer_))
+      sqlite3_exec(writer_, "ROLLBACK", nullptr, nullptr, nullptr);
+    return std::current_exception();
+  }
+}
+
+bool ShardedStore::Shard::Get(const std::string& key, std::string* value) {
+  std::lock_guard<std::mutex> lock(reader_mutex_);
+  BindBlob(get_, 1, key);
+  int result(sqlite3_step(get_));
+  if (result == SQLITE_ROW && value)
+    *value = ColumnBlob(get_, 0);
+  sqlite3_reset(get_);
+  ThrowOnError(result, reader_, "reading from shard");
+  return result == SQLITE_ROW;
+}
+
+ShardedStore::KeyValueVector ShardedStore::Shard::Scan(const std::string& begin,
+                                                       const std::string& end) {
+  std::lock_guard<std::mutex> lock(reader_mutex_);
+  sqlite3_stmt* statement(end.empty() ? scan_to_end_ : scan_);
+  BindBlob(statement, 1, begin);
+  if (!end.empty())
+    BindBlob(statement, 2, end);
+
+  KeyValueVector entries;
+  int result;
+  while ((result = sqlite3_step(statement)) == SQLITE_ROW)
+    entries.emplace_back(ColumnBlob(statement, 0), ColumnBlob(statement, 1));
+  sqlite3_reset(statement);
+  ThrowOnError(result, reader_, "scanning shard");
+  return entries;
+}
+
+ShardedStore::ShardedStore(const std::string& directory, int shard_count) : shards_() {
+  if (shard_count < 1)
+    throw std::invalid_argument("ShardedStore needs at least one shard");
+  for (int i(0); i != shard_count; ++i) {
+    shards_.emplace_back(
+        new Shard(directory + "/shard_" + std::to_string(i) + ".db", shard_count));
+  }
+}
+
+ShardedStore::~ShardedStore() {}
+
+int ShardedStore::ShardOf(const std::string& key) const {
+  return static_cast<int>(Fnv1a(key) % shards_.size());
+}
+
+std::future<void> ShardedStore::Put(std::string key, std::string value) {
+  WriteBatch batch;
+  batch.Put(std::move(key), std::move(value));
+  return Write(std::move(batch));
+}
+
+std::future<void> ShardedStore::Delete(std::string key) {
+  WriteBatch batch;
+  batch.Delete(std::move(key));
+  return Write(std::move(batch));
+}
+
+std::future<void> ShardedStore::Write(WriteBatch batch) {
+  std::vector<std::vector<WriteBatch::Operation>> parts(shards_.size());
+  for (auto& operation : batch.operations_)
+    parts[ShardOf(operation.key)].push_back(std::move(operation));
+
+  int part_count(0);
+  for (const auto& part : parts)
+    part_count += part.empty() ? 0 : 1;
+  if (part_count == 0) {
+    std::promise<void> done;
+    done.set_value();
+    return done.get_future();
+  }
+
+  auto completion(std::make_shared<Completion>(part_count));
+  std::future<void> future(completion->promise.get_future());
+  for (size_t i(0); i != parts.size(); ++i) {
+    if (!parts[i].empty())
+      shards_[i]->Submit(std::move(parts[i]), completion);
+  }
+  return future;
+}
+
+void ShardedStore::Flush() {
+  // Requests are committed in order, so an empty request per shard marks everything before it.
+  auto completion(std::make_shared<Completion>(shard_count()));
+  std::future<void> future(completion->promise.get_future());
+  for (auto& shard : shards_)
+    shard->Submit(std::vector<WriteBatch::Operation>(), completion);
+  future.get();
+}
+
+bool ShardedStore::Get(const std::string& key, std::string* value) const {
+  return shards_[ShardOf(key)]->Get(key, value);
+}
+
+ShardedStore::KeyValueVector ShardedStore::Scan(const std::string& begin,
+                                                const std::string& end) const {
+  if (!end.empty() && end <= begin)
+    return KeyValueVector();
+
+  // Fan out to every shard, then k-way merge the sorted results.  Keys are unique to one shard,
+  // so there are no duplicates to resolve.
+  std::vector<std::future<KeyValueVector>> futures;
+  for (auto& shard : shards_) {
+    Shard* shard_ptr(shard.get());
+    futures.push_back(std::async(std::launch::async,
+                                 [shard_ptr, &begin, &end] { return shard_ptr->Scan(begin, end); }));
+  }
+  std::vector<KeyValueVector> results;
+  size_t total(0);
+  for (auto& future : futures) {
+    results.push_back(future.get());
+    total += results.back().size();
+  }
+
+  typedef std::pair<size_t, size_t> Cursor;  // (shard, position)
+  auto greater = [&results](const Cursor& lhs, const Cursor& rhs) {
+    return results[lhs.first][lhs.second].first > results[rhs.first][rhs.second].first;
+  };
+  std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heap(greater);
+  for (size_t i(0); i != results.size(); ++i) {
+    if (!results[i].empty())
+      heap.push(Cursor(i, 0));
+  }
+
+  KeyValueVector merged;
+  merged.reserve(total);
+  while (!heap.empty()) {
+    Cursor cursor(heap.top());
+    heap.pop();
+    merged.push_back(std::move(results[cursor.first][cursor.second]));
+    if (++cursor.second != results[cursor.first].size())
+      heap.push(cursor);
+  }
+  return merged;
+}
+
+ShardedStore::KeyValueVector ShardedStore::ScanPrefix(const std::string& prefix) const {
+  return Scan(prefix, PrefixEnd(prefix));
+}
+
+}  // namespace sqlite
+
+}  // namespace maidsafe
@@ -20,14 +20,28 @@ extern "C" {
 #include "sqlite3.h"
 }
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "boost/filesystem/path.hpp"
+#include "cryptopp/aes.h"
+#include "cryptopp/filters.h"
+#include "cryptopp/modes.h"
+#include "cryptopp/sha.h"
 
 #include "maidsafe/common/error.h"
 #include "maidsafe/common/test.h"
 #include "maidsafe/common/utils.h"
 
+#include "blob_stream.h"
+#include "path_index.h"
+#include "value_compression.h"
+#include "sharded_store.h"
+
 namespace maidsafe {
 
 namespace test {
@@ -41,6 +55,491 @@ TEST(SQLiteTest, BEH_Basic) {
   sqlite3_close(db);
  }
 
+TEST(SQLiteTest, BEH_ShardedStorePutGetDelete) {
+  TestPath test_path(CreateTestPath("MaidSafe_TestShardedStore"));
+  sqlite::ShardedStore store(test_path->string(), 4);
+  std::vector<std::string> keys;
+  for (int i(0); i != 100; ++i)
+    keys.push_back(RandomString(1 + i % 40));
+  for (const auto& key : keys)
+    store.Put(key, key + key);
+  store.Flush();
+
+  std::string value;
+  for (const auto& key : keys) {
+    ASSERT_TRUE(store.Get(key, &value));
+    EXPECT_EQ(key + key, value);
+  }
+  EXPECT_FALSE(store.Get("missing", &value));
+
+  store.Put(keys.front(), "replaced").get();
+  ASSERT_TRUE(store.Get(keys.front(), &value));
+  EXPECT_EQ("replaced", value);
+  store.Delete(keys.front()).get();
+  EXPECT_FALSE(store.Get(keys.front(), &value));
+}
+
+TEST(SQLiteTest, BEH_ShardedStoreScan) {
+  TestPath test_path(CreateTestPath("MaidSafe_TestShardedStore"));
+  sqlite::ShardedStore store(test_path->string(), 5);
+  sqlite::WriteBatch batch;
+  for (int i(0); i != 1000; ++i) {
+    std::string key(std::to_string(i));
+    batch.Put(std::string(i % 2 ? "odd/" : "even/") + std::string(4 - key.size(), '0') + key, key);
+  }
+  batch.Put(std::string("even\xff", 5), "high");
+  store.Write(std::move(batch)).get();
+
+  auto odd(store.ScanPrefix("odd/"));
+  ASSERT_EQ(500U, odd.size());
+  for (size_t i(0); i != odd.size(); ++i)
+    EXPECT_EQ(std::to_string(2 * i + 1), odd[i].second);
+
+  auto range(store.Scan("even/0100", "even/0200"));
+  ASSERT_EQ(50U, range.size());
+  EXPECT_EQ("even/0100", range.front().first);
+  EXPECT_EQ("even/0198", range.back().first);
+
+  EXPECT_EQ(1001U, store.Scan("", "").size());
+  EXPECT_EQ(501U, store.ScanPrefix("even").size());
+  EXPECT_TRUE(store.Scan("odd/", "even/").empty());
+}
+
+TEST(SQLiteTest, BEH_ShardedStoreConcurrentWritersAndReopen) {
+  TestPath test_path(CreateTestPath("MaidSafe_TestShardedStore"));
+  const int kThreads(8), kWritesPerThread(200);
+  {
+    sqlite::ShardedStore store(test_path->string(), 3);
+    std::vector<std::thread> writers;
+    for (int t(0); t != kThreads; ++t) {
+      writers.emplace_back([&store, t] {
+        std::vector<std::future<void>> results;
+        for (int i(0); i != kWritesPerThread; ++i) {
+          results.push_back(
+              store.Put(std::to_string(t) + "/" + std::to_string(i), std::to_string(i)));
+        }
+        for (auto& result : results)
+          result.get();
+      });
+    }
+    for (auto& writer : writers)
+      writer.join();
+  }
+
+  EXPECT_THROW(sqlite::ShardedStore(test_path->string(), 4), std::exception);
+  sqlite::ShardedStore store(test_path->string(), 3);
+  EXPECT_EQ(static_cast<size_t>(kThreads * kWritesPerThread), store.Scan("", "").size());
+  for (int t(0); t != kThreads; ++t)
+    EXPECT_EQ(static_cast<size_t>(kWritesPerThread), store.ScanPrefix(std::to_string(t) + "/").size());
+}
+
+TEST(SQLiteTest, FUNC_ShardedStoreInsertThroughput) {
+  const int kThreads(8), kWrites(20000);
+  const std::string value(RandomString(100));
+  for (int shard_count : {1, 2, 4, 8}) {
+    TestPath test_path(CreateTestPath("MaidSafe_TestShardedStore"));
+    sqlite::ShardedStore store(test_path->string(), shard_count);
+    auto start(std::chrono::steady_clock::now());
+    std::vector<std::thread> writers;
+    for (int t(0); t != kThreads; ++t) {
+      writers.emplace_back([&, t] {
+        for (int i(t); i < kWrites; i += kThreads)
+          store.Put(std::to_string(i), value);
+      });
+    }
+    for (auto& writer : writers)
+      writer.join();
+    store.Flush();
+    auto elapsed(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start));
+    EXPECT_EQ(static_cast<size_t>(kWrites), store.Scan("", "").size());
+    std::cout << shard_count << " shard(s): " << kWrites * 1000.0 / (elapsed.count() + 1)
+              << " inserts/s\n";
+  }
+}
+
+TEST(SQLiteTest, BEH_BlobStream) {
+  TestPath test_path(CreateTestPath("MaidSafe_TestBlobStream"));
+  sqlite3* db(nullptr);
+  ASSERT_EQ(SQLITE_OK, sqlite3_open((*test_path / "blobs.db").string().c_str(), &db));
+  ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, "CREATE TABLE chunks (name TEXT, content BLOB)", nullptr,
+                                    nullptr, nullptr));
+
+  const int kSize(3 * 1024 * 1024 + 17);
+  const std::string content(RandomString(kSize));
+  sqlite3_stmt* insert(nullptr);
+  ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "INSERT INTO chunks VALUES (?1, zeroblob(?2))", -1,
+                                          &insert, nullptr));
+  for (const char* name : {"plain", "encrypted"}) {
+    sqlite3_bind_text(insert, 1, name, -1, SQLITE_STATIC);
+    sqlite3_bind_int(insert, 2, kSize);
+    ASSERT_EQ(SQLITE_DONE, sqlite3_step(insert));
+    sqlite3_reset(insert);
+  }
+  sqlite3_finalize(insert);
+
+  {  // written in uneven pieces
+    sqlite::BlobSink sink(sqlite::BlobLocation(db, "chunks", "content", 1));
+    EXPECT_EQ(static_cast<CryptoPP::lword>(kSize), sink.Size());
+    for (size_t offset(0); offset < content.size(); offset += 100000)
+      sink.Put(reinterpret_cast<const byte*>(content.data()) + offset,
+               std::min(content.size() - offset, size_t(100000)));
+    EXPECT_THROW(sink.Put(reinterpret_cast<const byte*>("x"), 1), sqlite::BlobError);
+  }
+
+  std::string expected_digest, digest;
+  CryptoPP::StringSource(content, true, new CryptoPP::HashFilter(
+      *new CryptoPP::SHA256, new CryptoPP::StringSink(expected_digest)));
+  CryptoPP::SHA256 hash;
+  sqlite::BlobSource(sqlite::BlobLocation(db, "chunks", "content", 1), true,
+                     new CryptoPP::HashFilter(hash, new CryptoPP::StringSink(digest)));
+  EXPECT_EQ(expected_digest, digest);
+
+  {  // seeking and partial pumps
+    std::string part;
+    sqlite::BlobSource source(sqlite::BlobLocation(db, "chunks", "content", 1), false,
+                              new CryptoPP::StringSink(part));
+    source.Seek(kSize - 1000);
+    source.Pump(600);
+    EXPECT_EQ(content.substr(kSize - 1000, 600), part);
+    source.PumpAll();
+    EXPECT_EQ(content.substr(kSize - 1000), part);
+    EXPECT_THROW(source.Seek(kSize + 1), sqlite::BlobError);
+  }
+
+  {  // BLOB to BLOB through a cipher, never holding the value in memory
+    const byte key[16] = {0}, iv[16] = {0};
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption encryption(key, sizeof(key), iv);
+    sqlite::BlobSink sink(sqlite::BlobLocation(db, "chunks", "content", 2));
+    sqlite::BlobSource(sqlite::BlobLocation(db, "chunks", "content", 1), true,
+                       new CryptoPP::StreamTransformationFilter(encryption,
+                                                                new CryptoPP::Redirector(sink)));
+    EXPECT_EQ(sink.Size(), sink.Position());
+
+    std::string decrypted;
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption decryption(key, sizeof(key), iv);
+    sqlite::BlobSource(sqlite::BlobLocation(db, "chunks", "content", 2), true,
+                       new CryptoPP::StreamTransformationFilter(decryption,
+                                                                new CryptoPP::StringSink(decrypted)));
+    EXPECT_TRUE(decrypted == content);
+  }
+
+  sqlite::ReserveBlob(sqlite::BlobLocation(db, "chunks", "content", 2), 10);
+  EXPECT_EQ(10U, sqlite::BlobSource(sqlite::BlobLocation(db, "chunks", "content", 2), false)
+                     .Size());
+  EXPECT_THROW(sqlite::ReserveBlob(sqlite::BlobLocation(db, "chunks", "content", 3), 10),
+               sqlite::BlobError);
+  EXPECT_THROW(sqlite::BlobSource(sqlite::BlobLocation(db, "chunks", "missing", 1), false),
+               sqlite::BlobError);
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+}
+
+TEST(SQLiteTest, BEH_PathIndex) {
+  sqlite::PathIndex index(":memory:");
+  sqlite::PathChangeBatch batch;
+  batch.Upsert(sqlite::PathMetadata("Documents", true, 0, 1));
+  batch.Upsert(sqlite::PathMetadata("Documents/MyHTMLParser.cpp", false, 100, 2));
+  batch.Upsert(sqlite::PathMetadata("Documents/holiday_photos-2013", true, 0, 3));
+  batch.Upsert(sqlite::PathMetadata("Documents/holiday_photos-2013/IMG_0001.JPG", false, 4096, 4));
+  batch.Upsert(sqlite::PathMetadata("Music/parserSongs.mp3", false, 5, 5));
+  index.Apply(batch);
+  EXPECT_EQ(5U, index.size());
+
+  auto paths([](const sqlite::PathIndex::PathMetadataVector& results) {
+    std::vector<std::string> result_paths;
+    for (const auto& metadata : results)
+      result_paths.push_back(metadata.path);
+    std::sort(result_paths.begin(), result_paths.end());
+    return result_paths;
+  });
+  typedef std::vector<std::string> Paths;
+  EXPECT_EQ(Paths(1, "Documents/MyHTMLParser.cpp"), paths(index.Search("html", 10)));
+  EXPECT_EQ(Paths(1, "Documents/MyHTMLParser.cpp"), paths(index.Search("PARSER.c", 10)));
+  EXPECT_EQ(Paths({"Documents/MyHTMLParser.cpp", "Music/parserSongs.mp3"}),
+            paths(index.Search("pars", 10)));
+  EXPECT_TRUE(index.Search("arser", 10).empty());
+  EXPECT_EQ(Paths(1, "Music/parserSongs.mp3"), paths(index.PrefixSearch("Pars", 10)));
+  EXPECT_EQ(Paths(1, "Documents/holiday_photos-2013"), paths(index.PrefixSearch("holiday_p", 10)));
+  EXPECT_EQ(Paths(1, "Documents/holiday_photos-2013/IMG_0001.JPG"),
+            paths(index.Search("img_0001.jpg", 10)));
+  EXPECT_EQ(Paths(1, "Documents/holiday_photos-2013"), paths(index.Search("-", 10)));
+  EXPECT_EQ(1U, index.Search("pars", 1).size());
+  EXPECT_TRUE(index.Search("documents/my", 10).empty());
+
+  // Metadata updates don't duplicate entries.
+  index.Upsert(sqlite::PathMetadata("Music/parserSongs.mp3", false, 50, 6));
+  sqlite::PathMetadata metadata;
+  ASSERT_TRUE(index.Get("Music/parserSongs.mp3", &metadata));
+  EXPECT_EQ(50U, metadata.size);
+  EXPECT_EQ(6, metadata.last_write_time);
+  EXPECT_EQ(5U, index.size());
+
+  // Renaming a directory moves its contents; the renamed entry is searchable by its new name.
+  index.Rename("Documents/holiday_photos-2013", "Documents/Trip");
+  EXPECT_TRUE(index.Search("holiday", 10).empty());
+  EXPECT_EQ(Paths(1, "Documents/Trip"), paths(index.Search("trip", 10)));
+  EXPECT_EQ(Paths(1, "Documents/Trip/IMG_0001.JPG"), paths(index.Search("img", 10)));
+  EXPECT_FALSE(index.Get("Documents/holiday_photos-2013/IMG_0001.JPG", &metadata));
+  EXPECT_THROW(index.Rename("Documents/Trip", "Documents/MyHTMLParser.cpp"), std::exception);
+  EXPECT_TRUE(index.Get("Documents/Trip/IMG_0001.JPG", &metadata));
+
+  // Removing a directory removes its contents.
+  index.Remove("Documents");
+  EXPECT_EQ(1U, index.size());
+  EXPECT_TRUE(index.Search("img", 10).empty());
+  EXPECT_EQ(1U, index.Search("pars", 10).size());
+}
+
+TEST(SQLiteTest, BEH_PathIndexScanAndFullTextSearch) {
+  // Searches scan the first entries before deciding whether to use the full-text index, so a tree
+  // of a few thousand entries has matches on both sides of the switch.
+  sqlite::PathIndex index(":memory:");
+  sqlite::PathChangeBatch batch;
+  for (int i(0); i != 3000; ++i) {
+    std::string name("Filler_" + std::to_string(i) + ".dat");
+    if (i == 200)
+      name = "Haystackneedle.txt";  // contains "needle", but not as a word
+    else if (i == 500 || i == 1500 || i == 2500)
+      name = "Needles_" + std::to_string(i) + ".txt";
+    batch.Upsert(sqlite::PathMetadata("Folder/" + name, false, i, i));
+  }
+  index.Apply(batch);
+
+  auto paths([](const sqlite::PathIndex::PathMetadataVector& results) {
+    std::vector<std::string> result_paths;
+    for (const auto& metadata : results)
+      result_paths.push_back(metadata.path);
+    std::sort(result_paths.begin(), result_paths.end());
+    return result_paths;
+  });
+  typedef std::vector<std::string> Paths;
+  const Paths needles({"Folder/Needles_1500.txt", "Folder/Needles_2500.txt",
+                       "Folder/Needles_500.txt"});
+  // One match in the first entries: with room for many results the index finds the rest, and
+  // with room for few the scan carries on.
+  EXPECT_EQ(needles, paths(index.Search("needle", 100)));
+  EXPECT_EQ(needles, paths(index.PrefixSearch("needles_", 100)));
+  EXPECT_EQ(Paths({needles[0], needles[2]}), paths(index.Search("needles_", 2)));
+  // No match in the first entries: only the index is used beyond them.
+  EXPECT_EQ(Paths(1, "Folder/Needles_2500.txt"), paths(index.Search("needles_25", 100)));
+  EXPECT_EQ(Paths(1, "Folder/Haystackneedle.txt"), paths(index.Search("haystackneedle", 100)));
+  EXPECT_TRUE(index.Search("eedles", 100).empty());
+  // Common words fill the results from the scan.
+  EXPECT_EQ(100U, index.Search("filler", 100).size());
+  EXPECT_EQ(2996U, index.Search("filler", 5000).size());
+}
+
+TEST(SQLiteTest, FUNC_PathIndexSearchLatency) {
+  // 10 million entries: 10,000 directories of 1,000 files named like "BudgetDraft_1234.pdf".
+  const int kDirectories(10000), kFilesPerDirectory(1000);
+  const char* const kWords[] = {"Project", "Report", "Budget", "Draft", "Final", "Notes",
+                                "Invoice", "Scan", "Photo", "Backup", "Meeting", "Summary"};
+  const char* const kExtensions[] = {".docx", ".pdf", ".txt", ".jpg", ".xlsx"};
+  TestPath test_path(CreateTestPath("MaidSafe_TestPathIndex"));
+  const std::string db_path((*test_path / "index.db").string());
+  {
+    sqlite::PathIndex index(db_path);
+    for (int d(0); d != kDirectories; ++d) {
+      sqlite::PathChangeBatch batch;
+      std::string directory("Folder" + std::to_string(d));
+      batch.Upsert(sqlite::PathMetadata(directory, true, 0, d));
+      for (int f(0); f != kFilesPerDirectory; ++f) {
+        int n(d * kFilesPerDirectory + f);
+        std::string name(std::string(kWords[n % 12]) + kWords[(n / 12) % 12] + "_" +
+                         std::to_string(n) + kExtensions[n % 5]);
+        if (n == kDirectories * kFilesPerDirectory / 2)
+          name = "UniqueNeedle.txt";
+        batch.Upsert(sqlite::PathMetadata(directory + "/" + name, false, n, n));
+      }
+      index.Apply(batch);
+    }
+  }
+
+  sqlite::PathIndex index(db_path);
+  for (const std::string query : {"UniqueNeedle", "needle", "budgetDraft", "_1234567."}) {
+    auto start(std::chrono::steady_clock::now());
+    size_t indexed_matches(index.Search(query, 100).size());
+    auto indexed_time(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
+
+    // The linear scan an application would otherwise do over the names.
+    start = std::chrono::steady_clock::now();
+    sqlite3* db(nullptr);
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(db_path.c_str(), &db));
+    sqlite3_stmt* statement(nullptr);
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "SELECT name FROM entries", -1, &statement,
+                                            nullptr));
+    std::string folded_query(query);
+    std::transform(folded_query.begin(), folded_query.end(), folded_query.begin(), ::tolower);
+    size_t scanned_matches(0);
+    while (scanned_matches < 100 && sqlite3_step(statement) == SQLITE_ROW) {
+      std::string name(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+      std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+      if (name.find(folded_query) != std::string::npos)
+        ++scanned_matches;
+    }
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+    auto scan_time(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
+
+    EXPECT_EQ(scanned_matches, indexed_matches) << query;
+    std::cout << '"' << query << "\": " << indexed_matches << " match(es), FTS "
+              << indexed_time.count() << " us, linear scan " << scan_time.count() << " us\n";
+  }
+}
+
+TEST(SQLiteTest, BEH_ValueCompression) {
+  sqlite::ValueCodec codec(64);
+  const std::string small("short value"), repetitive(std::string(5000, 'a') + "tail"),
+      incompressible(RandomString(5000));
+  for (const auto& value : {small, repetitive, incompressible, std::string()}) {
+    std::string encoded(codec.Encode(value));
+    EXPECT_EQ(value, codec.Decode(encoded));
+    EXPECT_LE(encoded.size(), value.size() + 1);
+  }
+  EXPECT_FALSE(sqlite::ValueCodec::IsCompressed(codec.Encode(small)));
+  EXPECT_TRUE(sqlite::ValueCodec::IsCompressed(codec.Encode(repetitive)));
+  EXPECT_LT(codec.Encode(repetitive).size(), 100U);
+  EXPECT_FALSE(sqlite::ValueCodec::IsCompressed(codec.Encode(incompressible)));
+  EXPECT_THROW(codec.Decode(std::string(1, '\x7f') + repetitive), sqlite::CompressionError);
+  EXPECT_THROW(codec.Decode(codec.Encode(repetitive).substr(0, 10)), sqlite::CompressionError);
+
+  // A dictionary makes small records compressible; values written with an older dictionary stay
+  // readable while it is registered.  Dictionaries longer than the window keep their tail.
+  const std::string record("{\"name\":\"ProjectReport.docx\",\"type\":\"file\",\"owner\":\"");
+  sqlite::ValueCodec with_dictionary(16);
+  with_dictionary.AddDictionary(1, RandomString(40000) + record + record);
+  std::string value(record + RandomString(8) + "\"}");
+  std::string encoded_v1(with_dictionary.Encode(value));
+  EXPECT_LT(encoded_v1.size(), sqlite::ValueCodec(16).Encode(value).size());
+  EXPECT_LT(encoded_v1.size(), value.size() / 2);
+  with_dictionary.AddDictionary(2, "something else");
+  EXPECT_EQ(value, with_dictionary.Decode(encoded_v1));
+  EXPECT_EQ(value, with_dictionary.Decode(with_dictionary.Encode(value)));
+  EXPECT_THROW(codec.Decode(encoded_v1), sqlite::CompressionError);
+
+  sqlite3* db(nullptr);
+  ASSERT_EQ(SQLITE_OK, sqlite3_open(":memory:", &db));
+  sqlite::RegisterCompressionFunctions(db, std::make_shared<sqlite::ValueCodec>(64));
+  ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, "CREATE TABLE t(id INTEGER PRIMARY KEY, v BLOB)", nullptr,
+                                    nullptr, nullptr));
+  sqlite3_stmt* statement(nullptr);
+  ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "INSERT INTO t(v) VALUES(compress(?1))", -1,
+                                          &statement, nullptr));
+  for (const auto& value : {repetitive, small}) {
+    sqlite3_bind_blob(statement, 1, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+    EXPECT_EQ(SQLITE_DONE, sqlite3_step(statement));
+    sqlite3_reset(statement);
+  }
+  sqlite3_bind_null(statement, 1);
+  EXPECT_EQ(SQLITE_DONE, sqlite3_step(statement));
+  sqlite3_finalize(statement);
+  ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "SELECT length(v), decompress(v) FROM t ORDER BY id",
+                                          -1, &statement, nullptr));
+  ASSERT_EQ(SQLITE_ROW, sqlite3_step(statement));
+  EXPECT_LT(sqlite3_column_int(statement, 0), 100);
+  EXPECT_EQ(repetitive, std::string(static_cast<const char*>(sqlite3_column_blob(statement, 1)),
+                                    sqlite3_column_bytes(statement, 1)));
+  ASSERT_EQ(SQLITE_ROW, sqlite3_step(statement));
+  EXPECT_EQ(small, std::string(static_cast<const char*>(sqlite3_column_blob(statement, 1)),
+                               sqlite3_column_bytes(statement, 1)));
+  ASSERT_EQ(SQLITE_ROW, sqlite3_step(statement));
+  EXPECT_EQ(SQLITE_NULL, sqlite3_column_type(statement, 1));
+  sqlite3_finalize(statement);
+  EXPECT_NE(SQLITE_OK, sqlite3_exec(db, "SELECT decompress(x'7f00')", nullptr, nullptr, nullptr));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+}
+
+TEST(SQLiteTest, FUNC_ValueCompressionReadThroughput) {
+  // Records shaped like serialised directory-listing entries.
+  const int kRecords(200000), kReads(200000);
+  const char* const kWords[] = {"Project", "Report", "Budget", "Draft", "Photo", "Backup"};
+  auto make_record([&](int i) {
+    std::string record("{\"version\":3,\"name\":\"");
+    record += std::string(kWords[i % 6]) + kWords[(i / 6) % 6] + "_" + std::to_string(i) + ".docx";
+    record += "\",\"type\":\"regular_file\",\"size\":" + std::to_string(i * 37 % 1000000);
+    record += ",\"creation_time\":" + std::to_string(1400000000 + i) + ",\"last_write_time\":" +
+              std::to_string(1400000000 + i * 3) + ",\"attributes\":32,\"chunks\":[";
+    for (int c(0); c != 3; ++c) {
+      record += "{\"hash\":\"" + HexEncode(RandomString(16)) + "\",\"size\":1048576}";
+      record += c == 2 ? "]}" : ",";
+    }
+    return record;
+  });
+  std::string dictionary;
+  for (int i(0); i != 16; ++i)
+    dictionary += make_record(i * 7919);
+  std::vector<std::string> records;
+  size_t raw_bytes(0);
+  for (int i(0); i != kRecords; ++i) {
+    records.push_back(make_record(i));
+    raw_bytes += records.back().size();
+  }
+
+  TestPath test_path(CreateTestPath("MaidSafe_TestValueCompression"));
+  for (int mode(0); mode != 3; ++mode) {
+    auto codec(std::make_shared<sqlite::ValueCodec>(mode == 0 ? SIZE_MAX : 64));
+    if (mode == 2)
+      codec->AddDictionary(1, dictionary);
+    const std::string db_path((*test_path / ("values" + std::to_string(mode) + ".db")).string());
+    sqlite3* db(nullptr);
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(db_path.c_str(), &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, "CREATE TABLE t(id INTEGER PRIMARY KEY, v BLOB); BEGIN",
+                                      nullptr, nullptr, nullptr));
+    sqlite3_stmt* statement(nullptr);
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "INSERT INTO t(id, v) VALUES(?1, ?2)", -1,
+                                            &statement, nullptr));
+    size_t stored_bytes(0);
+    for (int i(0); i != kRecords; ++i) {
+      std::string encoded(codec->Encode(records[i]));
+      stored_bytes += encoded.size();
+      sqlite3_bind_int(statement, 1, i);
+      sqlite3_bind_blob(statement, 2, encoded.data(), static_cast<int>(encoded.size()),
+                        SQLITE_TRANSIENT);
+      ASSERT_EQ(SQLITE_DONE, sqlite3_step(statement));
+      sqlite3_reset(statement);
+    }
+    sqlite3_finalize(statement);
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    // Random point reads through a 4 MiB page cache on a fresh connection.
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(db_path.c_str(), &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, "PRAGMA cache_size = -4096", nullptr, nullptr, nullptr));
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "SELECT v FROM t WHERE id = ?1", -1, &statement,
+                                            nullptr));
+    uint32_t state(12345);
+    auto start(std::chrono::steady_clock::now());
+    for (int r(0); r != kReads; ++r) {
+      state = state * 1103515245 + 12345;
+      int id(static_cast<int>((state >> 8) % kRecords));
+      sqlite3_bind_int(statement, 1, id);
+      ASSERT_EQ(SQLITE_ROW, sqlite3_step(statement));
+      std::string value(codec->Decode(
+          std::string(static_cast<const char*>(sqlite3_column_blob(statement, 0)),
+                      sqlite3_column_bytes(statement, 0))));
+      ASSERT_EQ(records[id].size(), value.size());
+      sqlite3_reset(statement);
+    }
+    auto elapsed(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start));
+    sqlite3_finalize(statement);
+    int page_count(0);
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "PRAGMA page_count", -1, &statement, nullptr));
+    ASSERT_EQ(SQLITE_ROW, sqlite3_step(statement));
+    page_count = sqlite3_column_int(statement, 0);
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+
+    std::cout << (mode == 0 ? "raw:             " : mode == 1 ? "deflate:         "
+                                                               : "deflate + dict:  ")
+              << "ratio " << static_cast<double>(raw_bytes) / stored_bytes << ", "
+              << static_cast<double>(kRecords) / page_count << " rows/page, "
+              << kReads * 1000.0 / (elapsed.count() + 1) << " reads/s\n";
+  }
+}
+
 }  // namespace test
 
 }  // namespace maidsafe
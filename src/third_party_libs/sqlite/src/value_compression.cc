@@ -0,0 +1,231 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "value_compression.h"
+
+extern "C" {
+#include "sqlite3.h"
+}
+
+#include "cryptopp/algparam.h"
+#include "cryptopp/filters.h"
+#include "cryptopp/zdeflate.h"
+#include "cryptopp/zinflate.h"
+
+namespace maidsafe {
+
+namespace sqlite {
+
+namespace {
+
+enum Header : char { kRaw = 0, kDeflated = 1, kDeflatedWithDictionary = 2 };
+
+const size_t kDictionaryIdSize = 4;
+
+void AppendDictionaryId(uint32_t id, std::string* output) {
+  for (size_t i(0); i != kDictionaryIdSize; ++i)
+    *output += static_cast<char>((id >> (8 * i)) & 0xff);
+}
+
+uint32_t ParseDictionaryId(const std::string& encoded) {
+  if (encoded.size() < 1 + kDictionaryIdSize)
+    throw CompressionError("truncated compressed value");
+  uint32_t id(0);
+  for (size_t i(0); i != kDictionaryIdSize; ++i)
+    id |= static_cast<uint32_t>(static_cast<unsigned char>(encoded[1 + i])) << (8 * i);
+  return id;
+}
+
+// The Deflator clears a hash table the size of its window for every message, so small values get
+// the smallest window that still spans them and their dictionary.  The Inflator accepts any window
+// up to the maximum.
+int Log2WindowSize(size_t span) {
+  int log2_window_size(CryptoPP::Deflator::MIN_LOG2_WINDOW_SIZE);
+  while (log2_window_size < CryptoPP::Deflator::MAX_LOG2_WINDOW_SIZE &&
+         (size_t(1) << log2_window_size) < span) {
+    ++log2_window_size;
+  }
+  return log2_window_size;
+}
+
+std::string ValueArgument(sqlite3_value* value) {
+  int size(sqlite3_value_bytes(value));
+  return size == 0 ? std::string()
+                   : std::string(static_cast<const char*>(sqlite3_value_blob(value)),
+                                 static_cast<size_t>(size));
+}
+
+template <std::string (ValueCodec::*Transform)(const std::string&) const>
+void CodecFunction(sqlite3_context* context, int /*argc*/, sqlite3_value** argv) {
+  if (sqlite3_value_type(argv[0]) == SQLITE_NULL)
+    return sqlite3_result_null(context);
+  const ValueCodec& codec(**static_cast<std::shared_ptr<const ValueCodec>*>(
+      sqlite3_user_data(context)));
+  try {
+    std::string result((codec.*Transform)(ValueArgument(argv[0])));
+    sqlite3_result_blob(context, result.data(), static_cast<int>(result.size()), SQLITE_TRANSIENT);
+  }
+  catch (const std::exception& e) {
+    sqlite3_result_error(context, e.what(), -1);
+  }
+}
+
+void DeleteCodec(void* codec) { delete static_cast<std::shared_ptr<const ValueCodec>*>(codec); }
+
+}  // unnamed namespace
+
+struct ValueCodec::Decoder {
+  Decoder() : inflator(), output() { inflator.Attach(new CryptoPP::StringSink(output)); }
+
+  CryptoPP::Inflator inflator;
+  std::string output;
+};
+
+ValueCodec::ValueCodec(size_t threshold, int deflate_level)
+    : threshold_(threshold),
+      deflate_level_(deflate_level),
+      dictionaries_(),
+      current_dictionary_(nullptr),
+      mutex_(),
+      decoders_() {
+  if (deflate_level < CryptoPP::Deflator::MIN_DEFLATE_LEVEL ||
+      deflate_level > CryptoPP::Deflator::MAX_DEFLATE_LEVEL) {
+    throw CompressionError("invalid deflate level " + std::to_string(deflate_level));
+  }
+}
+
+ValueCodec::~ValueCodec() {}
+
+void ValueCodec::AddDictionary(uint32_t id, std::string dictionary, bool make_current) {
+  auto& entry(*dictionaries_.insert(std::make_pair(id, std::string())).first);
+  entry.second = std::move(dictionary);
+  if (make_current)
+    current_dictionary_ = &entry;
+}
+
+std::string ValueCodec::Encode(const std::string& value) const {
+  std::string encoded(1, kRaw);
+  if (value.size() < threshold_ || deflate_level_ == 0)
+    return encoded + value;
+
+  CryptoPP::ConstByteArrayParameter dictionary;
+  if (current_dictionary_) {
+    const std::string& bytes(current_dictionary_->second);
+    dictionary.Assign(reinterpret_cast<const byte*>(bytes.data()), bytes.size(), false);
+    encoded[0] = kDeflatedWithDictionary;
+    AppendDictionaryId(current_dictionary_->first, &encoded);
+  } else {
+    encoded[0] = kDeflated;
+  }
+
+  CryptoPP::Deflator deflator(
+      CryptoPP::MakeParameters("DeflateLevel", deflate_level_)(
+          "Log2WindowSize", Log2WindowSize(value.size() + dictionary.size()))(
+          "PresetDictionary", dictionary),
+      new CryptoPP::StringSink(encoded));
+  deflator.Put(reinterpret_cast<const byte*>(value.data()), value.size());
+  deflator.MessageEnd();
+
+  if (encoded.size() > value.size())
+    return std::string(1, kRaw) + value;
+  return encoded;
+}
+
+std::string ValueCodec::Decode(const std::string& encoded) const {
+  if (encoded.empty())
+    throw CompressionError("empty encoded value");
+  size_t header_size(1);
+  const std::string* dictionary(nullptr);
+  switch (encoded[0]) {
+    case kRaw:
+      return encoded.substr(1);
+    case kDeflated:
+      break;
+    case kDeflatedWithDictionary: {
+      uint32_t id(ParseDictionaryId(encoded));
+      auto itr(dictionaries_.find(id));
+      if (itr == dictionaries_.end())
+        throw CompressionError("unknown compression dictionary " + std::to_string(id));
+      dictionary = &itr->second;
+      header_size += kDictionaryIdSize;
+      break;
+    }
+    default:
+      throw CompressionError("unknown value header " +
+                             std::to_string(static_cast<unsigned char>(encoded[0])));
+  }
+
+  std::unique_ptr<Decoder> decoder;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!decoders_.empty()) {
+      decoder = std::move(decoders_.back());
+      decoders_.pop_back();
+    }
+  }
+  if (!decoder)
+    decoder.reset(new Decoder);
+
+  // A decoder that throws is discarded rather than returned to the pool.
+  decoder->output.clear();
+  decoder->inflator.IsolatedInitialize(CryptoPP::g_nullNameValuePairs);
+  if (dictionary) {
+    decoder->inflator.SetPresetDictionary(reinterpret_cast<const byte*>(dictionary->data()),
+                                          dictionary->size());
+  } else {
+    decoder->inflator.SetPresetDictionary(nullptr, 0);
+  }
+  try {
+    decoder->inflator.Put(reinterpret_cast<const byte*>(encoded.data()) + header_size,
+                          encoded.size() - header_size);
+    decoder->inflator.MessageEnd();
+  }
+  catch (const CryptoPP::Exception& e) {
+    throw CompressionError(e.what());
+  }
+  std::string value(decoder->output);
+  std::lock_guard<std::mutex> lock(mutex_);
+  decoders_.push_back(std::move(decoder));
+  return value;
+}
+
+bool ValueCodec::IsCompressed(const std::string& encoded) {
+  return !encoded.empty() && encoded[0] != kRaw;
+}
+
+void RegisterCompressionFunctions(sqlite3* db, std::shared_ptr<const ValueCodec> codec) {
+  struct Function {
+    const char* name;
+    void (*function)(sqlite3_context*, int, sqlite3_value**);
+  };
+  const Function functions[] = {{"compress", CodecFunction<&ValueCodec::Encode>},
+                                {"decompress", CodecFunction<&ValueCodec::Decode>}};
+  for (const auto& function : functions) {
+    int result(sqlite3_create_function_v2(
+        db, function.name, 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+        new std::shared_ptr<const ValueCodec>(codec), function.function, nullptr, nullptr,
+        DeleteCodec));
+    if (result != SQLITE_OK)
+      throw CompressionError(std::string("can't register ") + function.name + ": " +
+                             sqlite3_errmsg(db));
+  }
+}
+
+}  // namespace sqlite
+
+}  // namespace maidsafe